@@ -40,7 +40,8 @@ namespace {
 
         virtual ~Driver() 
         {
-            Cleanup();
+            // Static destruction, the gaze reactor may be gone already: only vrserver's Cleanup stops it
+            VR_CLEANUP_SERVER_DRIVER_CONTEXT();
         };
 
         vr::EVRInitError Init(vr::IVRDriverContext* pDriverContext) override 
@@ -70,6 +71,9 @@ namespace {
 
         void Cleanup() override 
         {
+            // While the driver context is still up, the reactor thread logs on its way out
+            StopHmdShimDrivers();
+
             VR_CLEANUP_SERVER_DRIVER_CONTEXT();
         }
 
@@ -78,7 +82,18 @@ namespace {
             return vr::k_InterfaceVersions;
         }
 
-        void RunFrame() override {};
+        void RunFrame() override 
+        {
+            // Pick up edits to the settings file without a SteamVR restart.
+            const auto now = std::chrono::steady_clock::now();
+            if (now - m_lastSettingsReload >= std::chrono::seconds(1)) 
+            {
+                m_lastSettingsReload = now;
+                ReloadShimSettings();
+            }
+
+            RunFrameHmdShimDrivers();
+        };
 
         bool ShouldBlockStandbyMode() override {
             return false;
@@ -86,9 +101,13 @@ namespace {
 
         void EnterStandby() override {};
 
-        void LeaveStandby() override {};
+        void LeaveStandby() override 
+        {
+            LeaveStandbyHmdShimDrivers();
+        };
 
         bool m_isLoaded = false;
+        std::chrono::steady_clock::time_point m_lastSettingsReload{};
     };
 } // namespace
 
@@ -28,9 +28,18 @@
 
 #include "defines.h"
 
-#if ENABLE_PSVR2_EYE_TRACKING
-#include "psvr2_eye_tracking.h"
-#endif
+#include "gaze_calibration.h"
+#include "gaze_debug_request.h"
+#include "gaze_flight_recorder.h"
+#include "gaze_poll_scheduler.h"
+#include "gaze_reactor.h"
+#include "gaze_thread_policy.h"
+#include "gaze_update_loop.h"
+#include "shim_config.h"
+
+#include <DirectXMath.h>
+
+#include <atomic>
 
 namespace vr {
     struct VREyeTrackingData_t {
@@ -71,9 +80,111 @@ namespace
 {
     using namespace driver_shim;
 
+    // The reactor's hooks into OpenVR and the driver log.
+    struct DriverReactorHost : public BVR::GazeReactorHost 
+    {
+        void on_thread_start() override 
+        {
+            DriverLog("Hello from the gaze reactor thread");
+            SetThreadDescription(GetCurrentThread(), L"HmdShimDriver_ReactorThread");
+        }
+
+        void before_poll(BVR::GazeUpdateLoop& loop, const BVR::ShimConfig& config, const int64_t nowUs) override 
+        {
+#if ENABLE_PSVR2_EYE_TRACKING
+            // The IPD follows the headset's dial, looked up once a second for the social gazes' origins.
+            if (config.social_gazes_ && nowUs >= m_nextIpdLookupUs) 
+            {
+                m_nextIpdLookupUs = nowUs + 1000000;
+                loop.set_ipd_meters(vr::VRProperties()->GetFloatProperty(m_container.load(), vr::Prop_UserIpdMeters_Float));
+            }
+#endif
+        }
+
+        void on_thread_stop(BVR::GazeReactor& reactor) override 
+        {
+            BVR::GazeUpdateLoop& loop = reactor.get_loop();
+            const BVR::GazePollScheduler& scheduler = loop.get_scheduler();
+
+#if ENABLE_PSVR2_EYE_TRACKING
+            {
+                const BVR::GazePublishStats& stats = loop.get_publish_stats();
+                DriverLog("Gaze samples: %llu published, %llu deduplicated, %llu stale (%s)",
+                          stats.published_.load(),
+                          stats.deduplicated_.load(),
+                          stats.stale_.load(),
+                          reactor.get_tracker().has_sequence_numbers() ? "sequence numbers" : "content hash");
+            }
+#endif
+
+#if ENABLE_ALLOCATION_COUNTING
+            DriverLog("Reactor thread heap allocations after warmup: %llu", reactor.get_steady_state_allocations());
+#endif
+
+            {
+                const BVR::GazeThreadStats& stats = reactor.get_thread_stats();
+                DriverLog("Reactor thread (%s priority): %llu polls, %llu late wakeups, %llu off the CPU for %llu us, %llu involuntary switches, %llu policy failures",
+                          BVR::get_thread_priority_name((BVR::GazeThreadPriority)stats.priority_.load()),
+                          stats.polls_.load(),
+                          stats.late_wakeups_.load(),
+                          stats.off_cpu_polls_.load(),
+                          stats.off_cpu_us_.load(),
+                          stats.involuntary_switches_.load(),
+                          stats.apply_failures_.load());
+            }
+
+            for (int state = 0; state < BVR::GazePowerStats::NUM_STATES; state++) 
+            {
+                const BVR::GazePowerStats& stats = scheduler.get_stats();
+                const double wallSeconds = stats.wall_time_us_[state].load() / 1e6;
+
+                if (wallSeconds > 0.0) 
+                {
+                    DriverLog("Eye tracking %s: %.1f s, %.1f wakeups/s, %.3f%% CPU",
+                              BVR::get_power_state_name((BVR::GazePowerState)state),
+                              wallSeconds,
+                              stats.wakeups_[state].load() / wallSeconds,
+                              100.0 * stats.cpu_time_us_[state].load() / stats.wall_time_us_[state].load());
+                }
+            }
+
+            {
+                const BVR::GazeCadenceStats& stats = scheduler.get_cadence_stats();
+                DriverLog("Eye tracking polls: %llu total, %llu empty, %llu scheduled from a %.0f us server period estimate",
+                          stats.polls_.load(),
+                          stats.empty_polls_.load(),
+                          stats.locked_polls_.load(),
+                          scheduler.get_cadence_estimator().get_period_us());
+            }
+
+            DriverLog("Bye from the gaze reactor thread");
+        }
+
+        // Of the HMD activated last, where the IPD is read from.
+        std::atomic<vr::PropertyContainerHandle_t> m_container = 0;
+        int64_t m_nextIpdLookupUs = 0;
+    };
+
+    DriverReactorHost g_reactorHost;
+
+    // One update thread and one connection to the server for the whole driver, however many HMDs get shimmed.
+    BVR::GazeReactor& GetGazeReactor() 
+    {
+        static BVR::GazeReactor& reactor = []() -> BVR::GazeReactor& {
+            BVR::GazeReactor& reactor = BVR::get_gaze_reactor();
+            reactor.set_host(&g_reactorHost);
+#if ENABLE_GAZE_FLIGHT_RECORDER
+            reactor.set_flight_recorder(&BVR::get_flight_recorder());
+#endif
+            return reactor;
+        }();
+
+        return reactor;
+    }
+
     // The HmdShimDriver driver wraps another ITrackedDeviceServerDriver instance with the intent to override
     // properties and behaviors.
-    struct HmdShimDriver : public vr::ITrackedDeviceServerDriver 
+    struct HmdShimDriver : public vr::ITrackedDeviceServerDriver, private BVR::GazePublisher, private BVR::GazeSettingsWriter 
     {
         HmdShimDriver(vr::ITrackedDeviceServerDriver* shimmedDevice)
             : m_shimmedDevice(shimmedDevice)
@@ -150,9 +261,28 @@ namespace
             }
             DriverLog("Eye Gaze Component: %lld", m_eyeTrackingComponent);
 
-            // Schedule updates in a background thread.
-            m_active = true;
-            m_updateThread = std::thread(&HmdShimDriver::UpdateThread, this);
+            // Pick up the current settings before the reactor thread starts using them.
+            ReloadShimSettings();
+
+            g_reactorHost.m_container = container;
+
+            // The first active device starts the reactor, later ones are fed by the same polls.
+            const int attached = GetGazeReactor().attach(*this);
+            m_attached = (attached > 0);
+
+            if (attached < 0) 
+            {
+                DriverLog("Too many devices shimmed with HmdShimDriver, this one gets no gazes");
+            }
+            else if (attached == 1) 
+            {
+#if ENABLE_GAZE_FLIGHT_RECORDER
+                BVR::get_flight_recorder().set_dump_directory(BVR::get_default_calibration_directory().c_str());
+                BVR::install_flight_recorder_crash_handler();
+#endif
+            }
+
+            DriverLog("HmdShimDriver activated, %d device(s) on the gaze reactor", GetGazeReactor().get_num_attached());
 
             TraceLoggingWriteStop(local, "HmdShimDriver_Activate");
 
@@ -164,10 +294,18 @@ namespace
             TraceLocalActivity(local);
             TraceLoggingWriteStart(local, "HmdShimDriver_Deactivate", TLArg(m_deviceIndex, "ObjectId"));
 
-            if (m_active.exchange(false)) 
+            // The last one stops the reactor, once it's detached it won't publish here again.
+            const bool isLast = m_attached && (GetGazeReactor().detach(*this) == 0);
+            m_attached = false;
+
+#if ENABLE_GAZE_FLIGHT_RECORDER
+            if (isLast) 
             {
-                m_updateThread.join();
+                BVR::get_flight_recorder().write_pending_dump();
+                BVR::get_flight_recorder().dump(BVR::GazeFlightDumpReason::DEACTIVATE_);
+                BVR::uninstall_flight_recorder_crash_handler();
             }
+#endif
 
             m_deviceIndex = vr::k_unTrackedDeviceIndexInvalid;
 
@@ -176,11 +314,23 @@ namespace
             DriverLog("Deactivated device shimmed with HmdShimDriver");
 
             TraceLoggingWriteStop(local, "HmdShimDriver_Deactivate");
+
+#if TRACE_BACKEND_RING && (TRACE_LEVEL > TRACE_LEVEL_OFF)
+            // No ETW in this build, the trace went to memory
+            if (isLast) 
+            {
+                const std::string tracePath = BVR::get_default_calibration_directory() + "trace.csv";
+                BVR::get_trace_ring().dump(tracePath.c_str());
+            }
+#endif
         }
 
         void EnterStandby() override 
         {
             m_shimmedDevice->EnterStandby();
+
+            // Park the reactor on a slow heartbeat until the headset is used again.
+            GetGazeReactor().enter_standby();
         }
 
         void* GetComponent(const char* pchComponentNameAndVersion) override 
@@ -193,98 +343,77 @@ namespace
             return m_shimmedDevice->GetPose();
         }
 
+        // "psvr2_shim ..." requests are answered here from the update loop's atomic counters, without
+        // touching the update thread. Everything else is for the real driver.
         void DebugRequest(const char* pchRequest, char* pchResponseBuffer, uint32_t unResponseBufferSize) override 
         {
-            m_shimmedDevice->DebugRequest(pchRequest, pchResponseBuffer, unResponseBufferSize);
-        }
-
-#if ENABLE_PSVR2_EYE_TRACKING
-        BVR::PSVR2EyeTracker psvr2_eye_tracker_;
+            BVR::GazeDebugSources sources;
+            sources.loop_ = &GetGazeReactor().get_loop();
+            sources.config_store_ = &BVR::get_shim_config_store();
+            sources.settings_writer_ = this;
+#if ENABLE_GAZE_FLIGHT_RECORDER
+            sources.flight_recorder_ = &BVR::get_flight_recorder();
 #endif
+            sources.thread_stats_ = &GetGazeReactor().get_thread_stats();
 
-        void UpdateThread() 
-        {
-            TraceLocalActivity(local);
-            TraceLoggingWriteStart(local, "HmdShimDriver_UpdateThread");
-
-            DriverLog("Hello from HmdShimDriver::UpdateThread");
-            SetThreadDescription(GetCurrentThread(), L"HmdShimDriver_UpdateThread");
+            if (BVR::handle_gaze_debug_request(pchRequest, pchResponseBuffer, unResponseBufferSize, sources)) 
+            {
+                TraceLoggingWrite(TraceProvider, "HmdShimDriver_DebugRequest", TLArg(pchRequest, "Request"));
+                return;
+            }
 
-            const vr::PropertyContainerHandle_t container =
-                vr::VRProperties()->TrackedDeviceToPropertyContainer(m_deviceIndex);
+            m_shimmedDevice->DebugRequest(pchRequest, pchResponseBuffer, unResponseBufferSize);
+        }
 
+        // Called by the reactor with every poll worth forwarding to vrserver, for each active device. The only place gazes turn
+        // into DirectXMath types, because that's what the eye tracking component takes.
+        void publish(const BVR::GazeUpdate& update) override 
+        {
             vr::VREyeTrackingData_t data{};
+            data.vector = DirectX::XMVectorSet(update.combined_gaze_.x, update.combined_gaze_.y, update.combined_gaze_.z, 1.0f);
 
-            while (true) 
+            if (update.is_available_) 
             {
-                // Wait for the next time to update.
-                {
-                    TraceLocalActivity(sleep);
-                    TraceLoggingWriteStart(sleep, "HmdShimDriver_UpdateThread_Sleep");
-
-                    // We refresh the data at this frequency.
-                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
-
-                    TraceLoggingWriteStop(sleep, "HmdShimDriver_UpdateThread_Sleep", TLArg(m_active.load(), "Active"));
-
-                    if (!m_active) 
-                    {
-                        break;
-                    }
-                }
-
-                data.vector = DirectX::XMVectorSet(0, 0, -1, 1);
-
-#if ENABLE_PSVR2_EYE_TRACKING
-                if(!psvr2_eye_tracker_.is_connected())
-                {
-                    psvr2_eye_tracker_.connect();
-                }
-
-                BVR::XrVector3f combined_gaze;
-                const bool isEyeTrackingDataAvailable = psvr2_eye_tracker_.is_connected() && psvr2_eye_tracker_.update_gazes() && psvr2_eye_tracker_.get_combined_gaze(combined_gaze, false);
-
-                if(isEyeTrackingDataAvailable)
-                {
-                    data.vector = DirectX::XMVectorSet(combined_gaze.x, combined_gaze.y, combined_gaze.z, 1.0f);
-                }
-#else
-                const bool isEyeTrackingDataAvailable = true;//&& state.TimeInSeconds > 0;
-#endif
-                
-
-                if (isEyeTrackingDataAvailable) 
-                {
-					data.flag1 = 0x101;
-					data.flag2 = 0x1;
-                } 
-                else 
-                {
-                    data.flag1 = 0;
-                    data.flag2 = 0;
-                }
+				data.flag1 = 0x101;
+				data.flag2 = 0x1;
+            } 
+            else 
+            {
+                data.flag1 = 0;
+                data.flag2 = 0;
+            }
 
-                if (IVRDriverInput_XXX) 
-                {
-                    IVRDriverInput_XXX->UpdateEyeTrackingComponent(m_eyeTrackingComponent, &data);
-                } 
-                else if (IVRDriverInputInternal_XXX) 
-                {
-                    IVRDriverInputInternal_XXX->UpdateEyeTrackingComponent(m_eyeTrackingComponent, &data);
-                }
+            if (IVRDriverInput_XXX) 
+            {
+                IVRDriverInput_XXX->UpdateEyeTrackingComponent(m_eyeTrackingComponent, &data);
+            } 
+            else if (IVRDriverInputInternal_XXX) 
+            {
+                IVRDriverInputInternal_XXX->UpdateEyeTrackingComponent(m_eyeTrackingComponent, &data);
             }
+        }
 
-            DriverLog("Bye from HmdShimDriver::UpdateThread");
+        // Runtime setting changes from DebugRequest(), persisted like any other edit of the settings section.
+        bool write_bool(const char* key, const bool value) override 
+        {
+            return WriteShimSettingBool(key, value);
+        }
+
+        bool write_int(const char* key, const int value) override 
+        {
+            return WriteShimSettingInt(key, value);
+        }
 
-            TraceLoggingWriteStop(local, "HmdShimDriver_UpdateThread");
+        void commit() override 
+        {
+            ReloadShimSettings();
         }
 
         vr::ITrackedDeviceServerDriver* const m_shimmedDevice;
 
         vr::TrackedDeviceIndex_t m_deviceIndex = vr::k_unTrackedDeviceIndexInvalid;
 
-        std::atomic<bool> m_active = false;
-        std::thread m_updateThread;
+        bool m_attached = false;
 
         vr::VRInputComponentHandle_t m_eyeTrackingComponent = 0;
         vr::IVRDriverInputInternal_XXX* IVRDriverInputInternal_XXX = nullptr;
@@ -299,4 +428,24 @@ namespace driver_shim {
         return new HmdShimDriver(shimmedDriver);
     }
 
+    void LeaveStandbyHmdShimDrivers() 
+    {
+        // Every shimmed HMD shares the reactor, waking it once wakes them all
+        GetGazeReactor().leave_standby();
+    }
+
+    void RunFrameHmdShimDrivers() 
+    {
+#if ENABLE_GAZE_FLIGHT_RECORDER
+        // Flagged by the reactor thread on repeated stalls, written here so it doesn't stall it further
+        BVR::get_flight_recorder().write_pending_dump();
+#endif
+    }
+
+    void StopHmdShimDrivers() 
+    {
+        // Normally the last Deactivate already did, then this is a no-op
+        GetGazeReactor().stop();
+    }
+
 } // namespace driver_shim
@@ -32,5 +32,19 @@ namespace driver_shim {
     bool IsTargetDriver(void* returnAddress);
 
     vr::ITrackedDeviceServerDriver* CreateHmdShimDriver(vr::ITrackedDeviceServerDriver* shimmedDriver);
+    void LeaveStandbyHmdShimDrivers();
+
+    // Housekeeping off the gaze reactor's thread, once per vrserver frame.
+    void RunFrameHmdShimDrivers();
+
+    // Stops the gaze reactor's thread if a shimmed HMD was never deactivated, from Cleanup rather than a static destructor.
+    void StopHmdShimDrivers();
+
+    // Reads the driver's settings section and publishes a new configuration snapshot if anything changed.
+    bool ReloadShimSettings();
+
+    // Persist one key of the driver's settings section, ReloadShimSettings() then picks it up.
+    bool WriteShimSettingBool(const char* key, bool value);
+    bool WriteShimSettingInt(const char* key, int value);
 
 } // namespace driver_shim
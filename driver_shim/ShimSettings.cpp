@@ -0,0 +1,162 @@
+// MIT License
+//
+// Copyright(c) 2025 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "ShimDriverManager.h"
+#include "Tracing.h"
+
+#include "shim_config.h"
+
+namespace 
+{
+    // Missing keys leave the compile-time default in place.
+    void ReadInt(const char* key, int& value) 
+    {
+        vr::EVRSettingsError error = vr::VRSettingsError_None;
+        const int32_t setting = vr::VRSettings()->GetInt32(SHIM_SETTINGS_SECTION, key, &error);
+        if (error == vr::VRSettingsError_None) 
+        {
+            value = setting;
+        }
+    }
+
+    void ReadBool(const char* key, bool& value) 
+    {
+        vr::EVRSettingsError error = vr::VRSettingsError_None;
+        const bool setting = vr::VRSettings()->GetBool(SHIM_SETTINGS_SECTION, key, &error);
+        if (error == vr::VRSettingsError_None) 
+        {
+            value = setting;
+        }
+    }
+
+    void ReadString(const char* key, char* value, uint32_t valueSize) 
+    {
+        char setting[SHIM_CONFIG_MAX_STRING] = {};
+        vr::EVRSettingsError error = vr::VRSettingsError_None;
+        vr::VRSettings()->GetString(SHIM_SETTINGS_SECTION, key, setting, sizeof(setting), &error);
+        if (error == vr::VRSettingsError_None) 
+        {
+            strncpy_s(value, valueSize, setting, _TRUNCATE);
+        }
+    }
+} // namespace
+
+namespace driver_shim 
+{
+
+    bool ReloadShimSettings() 
+    {
+        BVR::ShimConfig config;
+
+        ReadInt("pollingRateMs", config.polling_rate_ms_);
+        ReadInt("idlePollingRateMs", config.idle_polling_rate_ms_);
+        ReadInt("standbyPollingRateMs", config.standby_polling_rate_ms_);
+        ReadInt("idleTimeoutMs", config.idle_timeout_ms_);
+        ReadBool("adaptivePolling", config.adaptive_polling_);
+        ReadInt("adaptivePollingGuardUs", config.adaptive_polling_guard_us_);
+
+        ReadBool("deduplicateSamples", config.deduplicate_samples_);
+        ReadInt("keepAliveIntervalMs", config.keep_alive_interval_ms_);
+        ReadBool("telemetryEnabled", config.telemetry_enabled_);
+        ReadBool("gazeBroadcastEnabled", config.broadcast_enabled_);
+
+        ReadBool("eyeTrackingEnabled", config.eye_tracking_enabled_);
+        ReadBool("combinedGaze", config.combined_gaze_);
+        ReadBool("perEyeGazes", config.per_eye_gazes_);
+        ReadBool("applyCalibration", config.apply_calibration_);
+        ReadBool("adaptiveSmoothing", config.adaptive_smoothing_);
+        ReadBool("medianFilter", config.median_filter_);
+        ReadBool("socialGazes", config.social_gazes_);
+
+        ReadInt("updateThreadPriority", config.update_thread_priority_);
+        ReadInt("updateThreadAffinityMask", config.update_thread_affinity_mask_);
+        ReadBool("highResolutionTimer", config.high_resolution_timer_);
+
+        ReadInt("gazeSource", config.gaze_source_);
+        ReadString("serverPipeName", config.server_pipe_name_, sizeof(config.server_pipe_name_));
+        ReadString("replayFile", config.replay_file_, sizeof(config.replay_file_));
+
+        config.sanitize();
+
+        const bool changed = BVR::get_shim_config_store().publish(config);
+
+        if (changed) 
+        {
+            const BVR::ShimConfig& current = BVR::get_shim_config_store().get();
+
+            TraceLoggingWrite(TraceProvider,
+                              "ShimSettings_Changed",
+                              TLArg(current.generation_, "Generation"),
+                              TLArg(current.polling_rate_ms_, "PollingRateMs"),
+                              TLArg(current.adaptive_polling_, "AdaptivePolling"),
+                              TLArg(current.deduplicate_samples_, "DeduplicateSamples"),
+                              TLArg(current.eye_tracking_enabled_, "EyeTrackingEnabled"));
+
+            DriverLog("Settings (generation %llu): polling %d ms (%s), idle %d ms after %d ms, standby %d ms, "
+                      "deduplication %s, keep-alive %d ms, telemetry %s, broadcast %s, eye tracking %s, gazes %s%s, calibration %s, adaptive smoothing %s, median filter %s, social gazes %s, "
+                      "update thread %s priority on CPUs 0x%x, high resolution timer %s, source %s%s, pipe %s, replay %s",
+                      current.generation_,
+                      current.polling_rate_ms_,
+                      current.adaptive_polling_ ? "adaptive" : "fixed",
+                      current.idle_polling_rate_ms_,
+                      current.idle_timeout_ms_,
+                      current.standby_polling_rate_ms_,
+                      current.deduplicate_samples_ ? "on" : "off",
+                      current.keep_alive_interval_ms_,
+                      current.telemetry_enabled_ ? "on" : "off",
+                      current.broadcast_enabled_ ? "on" : "off",
+                      current.eye_tracking_enabled_ ? "on" : "off",
+                      current.combined_gaze_ ? "combined " : "",
+                      current.per_eye_gazes_ ? "per-eye" : "",
+                      current.apply_calibration_ ? "on" : "off",
+                      current.adaptive_smoothing_ ? "on" : "off",
+                      current.median_filter_ ? "on" : "off",
+                      current.social_gazes_ ? "on" : "off",
+                      BVR::get_thread_priority_name((BVR::GazeThreadPriority)current.update_thread_priority_),
+                      (unsigned int)current.update_thread_affinity_mask_,
+                      current.high_resolution_timer_ ? "on" : "off",
+                      BVR::get_gaze_source_name((BVR::GazeSourceType)current.gaze_source_),
+                      BVR::is_gaze_source_supported((BVR::GazeSourceType)current.gaze_source_) ? "" : " (not built in, using psvr2)",
+                      current.server_pipe_name_,
+                      current.replay_file_);
+        }
+
+        return changed;
+    }
+
+    bool WriteShimSettingBool(const char* key, bool value) 
+    {
+        vr::EVRSettingsError error = vr::VRSettingsError_None;
+        vr::VRSettings()->SetBool(SHIM_SETTINGS_SECTION, key, value, &error);
+        return error == vr::VRSettingsError_None;
+    }
+
+    bool WriteShimSettingInt(const char* key, int value) 
+    {
+        vr::EVRSettingsError error = vr::VRSettingsError_None;
+        vr::VRSettings()->SetInt32(SHIM_SETTINGS_SECTION, key, value, &error);
+        return error == vr::VRSettingsError_None;
+    }
+
+} // namespace driver_shim
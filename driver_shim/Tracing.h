@@ -22,6 +22,51 @@
 
 #pragma once
 
+// Trace levels, pick one with TRACE_LEVEL. Everything above it compiles to nothing.
+//
+//   TRACE_LEVEL_OFF        no tracing at all
+//   TRACE_LEVEL_LIFECYCLE  init, activation, settings and power state changes (the TraceLoggingWrite* calls)
+//   TRACE_LEVEL_SUMMARY    + per-second summaries of what happens every iteration (TraceSummary*)
+//   TRACE_LEVEL_VERBOSE    + every iteration (TraceVerbose*), one in TRACE_VERBOSE_SAMPLE_INTERVAL of them
+#define TRACE_LEVEL_OFF 0
+#define TRACE_LEVEL_LIFECYCLE 1
+#define TRACE_LEVEL_SUMMARY 2
+#define TRACE_LEVEL_VERBOSE 3
+
+#ifndef TRACE_LEVEL
+#define TRACE_LEVEL TRACE_LEVEL_SUMMARY
+#endif
+
+#ifndef TRACE_VERBOSE_SAMPLE_INTERVAL
+#define TRACE_VERBOSE_SAMPLE_INTERVAL 1
+#endif
+
+#define TRACE_SUMMARY_INTERVAL_US 1000000
+
+// Backends: ETW TraceLogging in the driver, or the in-memory ring of trace_ring.h (dumped to a file) where
+// there is no ETW, which is Linux and the CMake build of the gaze core.
+#ifndef TRACE_BACKEND_RING
+#ifdef _WIN32
+#define TRACE_BACKEND_RING 0
+#else
+#define TRACE_BACKEND_RING 1
+#endif
+#endif
+
+#include "trace_ring.h"
+
+#if !TRACE_BACKEND_RING
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <TraceLoggingActivity.h>
+#include <TraceLoggingProvider.h>
+
 TRACELOGGING_DECLARE_PROVIDER(TraceProvider);
 
 #define IsTraceEnabled() TraceLoggingProviderEnabled(TraceProvider, 0, 0)
@@ -30,3 +75,91 @@ TRACELOGGING_DECLARE_PROVIDER(TraceProvider);
 
 #define TLArg(var, ...) TraceLoggingValue(var, ##__VA_ARGS__)
 #define TLPArg(var, ...) TraceLoggingPointer(var, ##__VA_ARGS__)
+
+#else
+
+// Same macros as TraceLoggingProvider.h, so the instrumentation doesn't care which backend it goes to. pch.h
+// may have pulled in the real ones already.
+#undef TraceLoggingWrite
+#undef TraceLoggingWriteStart
+#undef TraceLoggingWriteStop
+#undef TraceLoggingWriteTagged
+
+#define IsTraceEnabled() true
+
+#define TraceLocalActivity(activity) BVR::TraceActivity activity;
+
+#define TraceLoggingWrite(provider, name, ...) BVR::get_trace_ring().write(BVR::TraceEventKind::EVENT_, 0, name, ##__VA_ARGS__)
+#define TraceLoggingWriteStart(activity, name, ...) BVR::get_trace_ring().write(BVR::TraceEventKind::START_, (activity).get_id(), name, ##__VA_ARGS__)
+#define TraceLoggingWriteStop(activity, name, ...) BVR::get_trace_ring().write(BVR::TraceEventKind::STOP_, (activity).get_id(), name, ##__VA_ARGS__)
+#define TraceLoggingWriteTagged(activity, name, ...) BVR::get_trace_ring().write(BVR::TraceEventKind::TAGGED_, (activity).get_id(), name, ##__VA_ARGS__)
+
+#define TLArg(var, ...) BVR::make_trace_arg(var, ##__VA_ARGS__)
+#define TLPArg(var, ...) BVR::make_trace_pointer_arg(var, ##__VA_ARGS__)
+
+#endif // !TRACE_BACKEND_RING
+
+#if TRACE_LEVEL < TRACE_LEVEL_LIFECYCLE
+#undef IsTraceEnabled
+#undef TraceLocalActivity
+#undef TraceLoggingWrite
+#undef TraceLoggingWriteStart
+#undef TraceLoggingWriteStop
+#undef TraceLoggingWriteTagged
+
+#define IsTraceEnabled() false
+#define TraceLocalActivity(activity)
+#define TraceLoggingWrite(provider, name, ...)
+#define TraceLoggingWriteStart(activity, name, ...)
+#define TraceLoggingWriteStop(activity, name, ...)
+#define TraceLoggingWriteTagged(activity, name, ...)
+#endif
+
+// Summaries: aggregate a per-iteration value, and trace count / mean / min / max once per interval.
+//
+//   TraceSummaryDeclare(sleep);                  // next to the loop
+//   TraceSummaryAdd(sleep, lateness_us);         // every iteration
+//   TraceSummaryFlush(activity, "Event", sleep, now_us);
+#if TRACE_LEVEL >= TRACE_LEVEL_SUMMARY
+#define TraceSummaryDeclare(summary) \
+    BVR::TraceAggregate summary; \
+    BVR::TraceInterval summary##_interval{TRACE_SUMMARY_INTERVAL_US}
+#define TraceSummaryAdd(summary, value) (summary).add(value)
+#define TraceSummaryFlush(activity, name, summary, now_us) \
+    do { \
+        if (summary##_interval.is_due(now_us)) { \
+            TraceLoggingWriteTagged(activity, \
+                                    name, \
+                                    TLArg((summary).count_, "Count"), \
+                                    TLArg((summary).get_mean(), "Mean"), \
+                                    TLArg((summary).min_, "Min"), \
+                                    TLArg((summary).max_, "Max")); \
+            (summary).reset(); \
+        } \
+    } while (0)
+#else
+#define TraceSummaryDeclare(summary)
+#define TraceSummaryAdd(summary, value)
+#define TraceSummaryFlush(activity, name, summary, now_us)
+#endif
+
+// Verbose: one event per iteration, sampled down by TRACE_VERBOSE_SAMPLE_INTERVAL.
+#if TRACE_LEVEL >= TRACE_LEVEL_VERBOSE
+#define TraceVerboseDeclare(sampler) BVR::TraceSampler sampler{TRACE_VERBOSE_SAMPLE_INTERVAL}
+#define TraceVerboseActivity(activity) TraceLocalActivity(activity)
+#define TraceVerboseStart(sampler, activity, name, ...) \
+    const bool activity##_sampled = (sampler).should_sample(); \
+    if (activity##_sampled) { TraceLoggingWriteStart(activity, name, ##__VA_ARGS__); }
+#define TraceVerboseStop(activity, name, ...) \
+    if (activity##_sampled) { TraceLoggingWriteStop(activity, name, ##__VA_ARGS__); }
+#define TraceVerboseWrite(sampler, name, ...) \
+    do { \
+        if ((sampler).should_sample()) { TraceLoggingWrite(TraceProvider, name, ##__VA_ARGS__); } \
+    } while (0)
+#else
+#define TraceVerboseDeclare(sampler)
+#define TraceVerboseActivity(activity)
+#define TraceVerboseStart(sampler, activity, name, ...)
+#define TraceVerboseStop(activity, name, ...)
+#define TraceVerboseWrite(sampler, name, ...)
+#endif
@@ -0,0 +1,180 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "alloc_counter.h"
+
+#include <new>
+#include <stdlib.h>
+
+#if ENABLE_ALLOCATION_COUNTING
+
+// Plain thread locals without constructors, so they're usable from inside operator new at any point
+// of a thread's life.
+static thread_local uint64_t t_allocations = 0;
+static thread_local uint64_t t_deallocations = 0;
+static thread_local uint64_t t_bytes = 0;
+
+namespace BVR
+{
+
+AllocationCounts get_thread_allocation_counts()
+{
+	AllocationCounts counts;
+	counts.allocations_ = t_allocations;
+	counts.deallocations_ = t_deallocations;
+	counts.bytes_ = t_bytes;
+
+	return counts;
+}
+
+} // BVR
+
+static void* counted_allocate(size_t size)
+{
+	t_allocations++;
+	t_bytes += size;
+
+	return malloc(size ? size : 1);
+}
+
+static void* counted_allocate_aligned(size_t size, const size_t alignment)
+{
+	t_allocations++;
+	t_bytes += size;
+
+	size = size ? size : 1;
+
+#ifdef _WIN32
+	return _aligned_malloc(size, alignment);
+#else
+	// aligned_alloc wants a multiple of the alignment
+	return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+static void counted_free(void* pointer)
+{
+	if(pointer)
+	{
+		t_deallocations++;
+		free(pointer);
+	}
+}
+
+static void counted_free_aligned(void* pointer)
+{
+	if(pointer)
+	{
+		t_deallocations++;
+#ifdef _WIN32
+		_aligned_free(pointer);
+#else
+		free(pointer);
+#endif
+	}
+}
+
+void* operator new(size_t size)
+{
+	void* pointer = counted_allocate(size);
+
+	if(!pointer)
+	{
+		throw std::bad_alloc();
+	}
+
+	return pointer;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return counted_allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return counted_allocate(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	void* pointer = counted_allocate_aligned(size, (size_t)alignment);
+
+	if(!pointer)
+	{
+		throw std::bad_alloc();
+	}
+
+	return pointer;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	return operator new(size, alignment);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return counted_allocate_aligned(size, (size_t)alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return counted_allocate_aligned(size, (size_t)alignment);
+}
+
+void operator delete(void* pointer) noexcept { counted_free(pointer); }
+void operator delete[](void* pointer) noexcept { counted_free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { counted_free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { counted_free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { counted_free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { counted_free(pointer); }
+
+void operator delete(void* pointer, std::align_val_t) noexcept { counted_free_aligned(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { counted_free_aligned(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { counted_free_aligned(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { counted_free_aligned(pointer); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { counted_free_aligned(pointer); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { counted_free_aligned(pointer); }
+
+#else
+
+namespace BVR
+{
+
+AllocationCounts get_thread_allocation_counts()
+{
+	return AllocationCounts();
+}
+
+} // BVR
+
+#endif // ENABLE_ALLOCATION_COUNTING
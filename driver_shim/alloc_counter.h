@@ -0,0 +1,62 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include "defines.h"
+
+#include <stdint.h>
+
+namespace BVR
+{
+	// Heap operations made by the calling thread so far. Counting happens in replacement global
+	// operator new / delete, defined in alloc_counter.cpp when ENABLE_ALLOCATION_COUNTING is set,
+	// otherwise everything reads 0.
+	struct AllocationCounts
+	{
+		uint64_t allocations_ = 0;
+		uint64_t deallocations_ = 0;
+		uint64_t bytes_ = 0;
+	};
+
+	AllocationCounts get_thread_allocation_counts();
+
+	// Counts since a given point, on the thread that created it.
+	class AllocationScope
+	{
+	public:
+		AllocationScope() : start_(get_thread_allocation_counts()) {}
+
+		uint64_t get_allocations() const { return get_thread_allocation_counts().allocations_ - start_.allocations_; }
+		uint64_t get_bytes() const { return get_thread_allocation_counts().bytes_ - start_.bytes_; }
+
+	private:
+		AllocationCounts start_;
+	};
+}
+
+#endif // ALLOC_COUNTER_H
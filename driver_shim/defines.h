@@ -13,18 +13,82 @@ namespace BVR
 	const int BOTH_EYES = 2;
 }
 
-#define EYE_TRACKING_POLLING_RATE_MS 4
+// The polling and publishing values below are only defaults, they can be overridden at runtime
+// from the driver_psvr2_shim section of the SteamVR settings (see shim_config.h).
+#define EYE_TRACKING_POLLING_RATE_MS 5
+
+// Slow heartbeat used once no valid gaze was seen for EYE_TRACKING_IDLE_TIMEOUT_MS, or the HMD is in standby.
+#define EYE_TRACKING_IDLE_TIMEOUT_MS 3000
+#define EYE_TRACKING_IDLE_POLLING_RATE_MS 250
+#define EYE_TRACKING_STANDBY_POLLING_RATE_MS 1000
+
+// Poll just after each sample the server is expected to produce, once its cadence is known.
+// EYE_TRACKING_POLLING_RATE_MS is the fallback until then.
+#define ENABLE_ADAPTIVE_POLLING 1
+#define ADAPTIVE_POLLING_GUARD_US 300
 
 #define ENABLE_PSVR2_EYE_TRACKING 1
 #define ENABLE_PSVR2_EYE_TRACKING_AUTOMATICALLY (ENABLE_PSVR2_EYE_TRACKING && 1)
+// Defaults for the combinedGaze / perEyeGazes / applyCalibration settings, all variants are always compiled in.
 #define ENABLE_GAZE_CALIBRATION (ENABLE_PSVR2_EYE_TRACKING && 0)
 #define ENABLE_PSVR2_EYE_TRACKING_COMBINED_GAZE (ENABLE_PSVR2_EYE_TRACKING && 1)
 #define ENABLE_PSVR2_EYE_TRACKING_PER_EYE_GAZES (ENABLE_PSVR2_EYE_TRACKING && 0)
-#define AUTO_CALIBRATE (ENABLE_PSVR2_EYE_TRACKING && 0)
-#define AUTO_INCREMENT_ON_CALIBRATION_DONE 0
+
+// Skip UpdateEyeTrackingComponent when the server handed us the same sample again,
+// but still re-send the last one at this interval so consumers never see it go quiet.
+#define ENABLE_GAZE_DEDUPLICATION (ENABLE_PSVR2_EYE_TRACKING && 1)
+#define GAZE_KEEPALIVE_INTERVAL_MS 100
+
+// Polls in a row without an answer after which the server counts as gone: the update loop drops the
+// connection and reconnects on its next poll, so a restarted server gets picked up again. Only transport
+// errors count, waiting longer than PSVR2_SERVER_RECEIVE_TIMEOUT_MS included, rejected answers don't.
+#define GAZE_MAX_RECEIVE_FAILURES 8
+#define PSVR2_SERVER_RECEIVE_TIMEOUT_MS 100
+
+// Default for the telemetryEnabled setting: a read-only shared memory block with live gaze and loop stats
+// for overlays and monitoring tools (gaze_telemetry.h).
+#define ENABLE_GAZE_TELEMETRY 1
+
+// Default for the gazeBroadcastEnabled setting: re-serve every sample to local consumers through a shared
+// memory ring (gaze_broadcast.h), so they don't each open their own connection to the server.
+#define ENABLE_GAZE_BROADCAST 0
+
+// Default for the adaptiveSmoothing setting: smooth the combined gaze more as its measured precision gets
+// worse (gaze_quality.h), none at all while the tracker is precise.
+#define ENABLE_ADAPTIVE_SMOOTHING 0
+
+// Default for the medianFilter setting: a median of 3 filter on every gaze after sanitization, which removes
+// single sample spikes but delays real movements by a sample (gaze_sanitizer.h).
+#define ENABLE_GAZE_MEDIAN_FILTER 0
+
+// Defaults for the update thread's scheduling settings (gaze_thread_policy.h). updateThreadPriority is
+// 0 as created, 1 raised, 2 the MMCSS "Games" task class, 3 "Pro Audio" (SCHED_FIFO off Windows).
+// updateThreadAffinityMask pins it to a set of CPUs, 0 lets it run anywhere. highResolutionTimer asks for
+// 1 ms timer resolution on Windows, process wide, while the thread runs.
+#define UPDATE_THREAD_PRIORITY 0
+#define UPDATE_THREAD_AFFINITY_MASK 0
+#define ENABLE_HIGH_RESOLUTION_TIMER 0
+
+// Defaults for the gazeSource / replayFile settings (gaze_source.h): 0 the PSVR2 server, 1 simulated eye
+// movements, 2 a flight recorder dump played back, looked up in the calibration directory unless absolute.
+#define GAZE_SOURCE 0
+#define GAZE_REPLAY_FILE "flight_deactivate.psfr"
+
+// Keep the last few thousand polls and connection events in memory and dump them to the calibration directory
+// on Deactivate, repeated stalls or a crash (gaze_flight_recorder.h).
+#define ENABLE_GAZE_FLIGHT_RECORDER 1
 
 #define INVALID_INDEX -1
 
+// Instrumentation builds: count heap allocations per thread (alloc_counter.cpp) and report any the update
+// thread makes once it's running. The update loop is meant to never touch the heap after startup.
+#ifndef ENABLE_ALLOCATION_COUNTING
+#define ENABLE_ALLOCATION_COUNTING 0
+#endif
+
+// Polls the update thread gets to settle (connect, load settings and calibrations) before allocations count.
+#define ALLOCATION_COUNTING_WARMUP_POLLS 100
+
 #ifndef FORCE_EXT
 #define FORCE_EXT 0
 #endif
@@ -40,6 +104,11 @@ namespace BVR
 #define ENABLE_PSVR2_SOCIAL_GAZES FORCE_SOCIAL
 
 #define ENABLE_SOCIAL_GAZES (ENABLE_DUMMY_SOCIAL_GAZES || ENABLE_PSVR2_SOCIAL_GAZES)
+
+// ENABLE_PSVR2_SOCIAL_GAZES is also the default for the socialGazes setting: both eyes' gazes of every sample,
+// with origins IPD apart, go out through the telemetry block for avatar eye animation. The IPD comes from the
+// headset, this stands in while it reports none.
+#define GAZE_DEFAULT_IPD_METERS 0.063f
 #define ENABLE_EXT_GAZE_INTERACTION (ENABLE_DUMMY_EXT_COMBINED_GAZE || ENABLE_PSVR2_EXT_COMBINED_GAZE)
 
 #define ENABLE_BOTH_PSVR2_LAYERS (ENABLE_PSVR2_EXT_COMBINED_GAZE && ENABLE_PSVR2_SOCIAL_GAZES)
@@ -48,7 +117,8 @@ namespace BVR
 #define SUPPORT_STEAMLINK 0
 #define SUPPORT_VIRTUAL_DESKTOP 0
 #define SUPPORT_WMR 0
-#define SUPPORT_SIMULATED_EYE_TRACKING 0
+#define SUPPORT_SIMULATED_EYE_TRACKING 1
+#define SUPPORT_GAZE_REPLAY 1
 
 #endif // BVR_DEFINES_H__
 
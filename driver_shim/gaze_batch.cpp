@@ -0,0 +1,684 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "gaze_batch.h"
+
+#include <limits>
+#include <math.h>
+
+#if GAZE_SIMD_X86
+#include <immintrin.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define GAZE_TARGET_AVX2
+#else
+#define GAZE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace BVR
+{
+
+static const float GAZE_BATCH_PI = 3.14159265358979323846f;
+static const float GAZE_BATCH_HALF_PI = 1.57079632679489661923f;
+static const float GAZE_BATCH_QUARTER_PI = 0.78539816339744830962f;
+static const float GAZE_BATCH_TAN_EIGHTH_PI = 0.41421356237309504880f;
+
+// Cephes atanf polynomial, good to a couple of ulps over [-tan(pi/8), tan(pi/8)]
+static const float ATAN_C0 = 8.05374449538e-2f;
+static const float ATAN_C1 = 1.38776856032e-1f;
+static const float ATAN_C2 = 1.99777106478e-1f;
+static const float ATAN_C3 = 3.33329491539e-1f;
+
+static inline uint32_t to_mask(const bool condition)
+{
+	return condition ? GAZE_BATCH_VALID : 0u;
+}
+
+// Scalar reference kernels. The SIMD ones below mirror them operation for operation, and use them for the
+// entries left over at the end.
+
+static void reject_invalid_scalar(float* x, float* y, float* z, uint32_t* valid, const size_t begin, const size_t end)
+{
+	for(size_t index = begin; index < end; index++)
+	{
+		const float vx = x[index];
+		const float vy = y[index];
+		const float vz = z[index];
+		const float length_squared = vx * vx + vy * vy + vz * vz;
+
+		// v - v is 0 for finite values only, exactly what the vector compare sees
+		const bool is_finite = ((vx - vx) == 0.0f) && ((vy - vy) == 0.0f) && ((vz - vz) == 0.0f) && ((length_squared - length_squared) == 0.0f);
+		const bool is_valid = (valid[index] != 0) && is_finite && (length_squared > GAZE_BATCH_MIN_LENGTH_SQUARED);
+
+		valid[index] = to_mask(is_valid);
+		x[index] = is_valid ? vx : 0.0f;
+		y[index] = is_valid ? vy : 0.0f;
+		z[index] = is_valid ? vz : -1.0f;
+	}
+}
+
+static void normalize_scalar(float* x, float* y, float* z, const size_t begin, const size_t end)
+{
+	for(size_t index = begin; index < end; index++)
+	{
+		const float vx = x[index];
+		const float vy = y[index];
+		const float vz = z[index];
+		const float length = sqrtf(vx * vx + vy * vy + vz * vz);
+		const bool has_length = length > 0.0f;
+
+		x[index] = has_length ? vx / length : 0.0f;
+		y[index] = has_length ? vy / length : 0.0f;
+		z[index] = has_length ? vz / length : -1.0f;
+	}
+}
+
+static void apply_calibration_scalar(const float* m, float* x, float* y, float* z, const size_t begin, const size_t end)
+{
+	for(size_t index = begin; index < end; index++)
+	{
+		const float vx = x[index];
+		const float vy = y[index];
+		const float vz = z[index];
+
+		x[index] = m[0] * vx + m[1] * vy + m[2] * vz;
+		y[index] = m[3] * vx + m[4] * vy + m[5] * vz;
+		z[index] = m[6] * vx + m[7] * vy + m[8] * vz;
+	}
+
+	normalize_scalar(x, y, z, begin, end);
+}
+
+// atan2(sine, cosine) for sine >= 0.
+static inline float atan2_positive_scalar(const float sine, const float cosine)
+{
+	const float abs_cosine = fabsf(cosine);
+	const bool is_steep = sine > abs_cosine;
+	const float numerator = is_steep ? abs_cosine : sine;
+	const float denominator = is_steep ? sine : abs_cosine;
+
+	const float ratio = (denominator > 0.0f) ? numerator / denominator : 0.0f;
+
+	// ratio is in [0, 1], fold (tan(pi/8), 1] back into the polynomial's range
+	const bool is_reduced = ratio > GAZE_BATCH_TAN_EIGHTH_PI;
+	const float t = is_reduced ? (ratio - 1.0f) / (ratio + 1.0f) : ratio;
+	const float offset = is_reduced ? GAZE_BATCH_QUARTER_PI : 0.0f;
+
+	const float t2 = t * t;
+	const float polynomial = (((ATAN_C0 * t2 - ATAN_C1) * t2 + ATAN_C2) * t2 - ATAN_C3) * t2;
+	float angle = offset + (polynomial * t + t);
+
+	angle = is_steep ? GAZE_BATCH_HALF_PI - angle : angle;
+	angle = (cosine < 0.0f) ? GAZE_BATCH_PI - angle : angle;
+
+	return angle;
+}
+
+static inline float angular_distance_scalar(const float ax, const float ay, const float az, const float bx, const float by, const float bz)
+{
+	const float cosine = ax * bx + ay * by + az * bz;
+	const float cx = ay * bz - az * by;
+	const float cy = az * bx - ax * bz;
+	const float cz = ax * by - ay * bx;
+	const float sine = sqrtf(cx * cx + cy * cy + cz * cz);
+
+	return atan2_positive_scalar(sine, cosine);
+}
+
+static void angular_distance_scalar(const GazeBatch& a, const GazeBatch& b, float* radians, const size_t begin, const size_t end)
+{
+	const float not_a_number = std::numeric_limits<float>::quiet_NaN();
+
+	for(size_t index = begin; index < end; index++)
+	{
+		const float angle = angular_distance_scalar(a.x()[index], a.y()[index], a.z()[index], b.x()[index], b.y()[index], b.z()[index]);
+		radians[index] = (a.valid()[index] && b.valid()[index]) ? angle : not_a_number;
+	}
+}
+
+#if GAZE_SIMD_X86
+
+// SSE2
+
+static inline __m128 select_sse(const __m128 mask, const __m128 if_true, const __m128 if_false)
+{
+	return _mm_or_ps(_mm_and_ps(mask, if_true), _mm_andnot_ps(mask, if_false));
+}
+
+static inline __m128 load_mask_sse(const uint32_t* mask)
+{
+	return _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)mask));
+}
+
+static inline __m128 is_finite_sse(const __m128 v)
+{
+	return _mm_cmpeq_ps(_mm_sub_ps(v, v), _mm_setzero_ps());
+}
+
+static inline __m128 length_squared_sse(const __m128 x, const __m128 y, const __m128 z)
+{
+	return _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+}
+
+static void reject_invalid_sse(float* x, float* y, float* z, uint32_t* valid, const size_t size)
+{
+	const __m128 min_length_squared = _mm_set1_ps(GAZE_BATCH_MIN_LENGTH_SQUARED);
+	const __m128 minus_one = _mm_set1_ps(-1.0f);
+	const size_t vector_end = size & ~(size_t)3;
+
+	for(size_t index = 0; index < vector_end; index += 4)
+	{
+		const __m128 vx = _mm_loadu_ps(x + index);
+		const __m128 vy = _mm_loadu_ps(y + index);
+		const __m128 vz = _mm_loadu_ps(z + index);
+		const __m128 length_squared = length_squared_sse(vx, vy, vz);
+
+		const __m128 is_finite = _mm_and_ps(_mm_and_ps(is_finite_sse(vx), is_finite_sse(vy)), _mm_and_ps(is_finite_sse(vz), is_finite_sse(length_squared)));
+		const __m128 is_long_enough = _mm_cmpgt_ps(length_squared, min_length_squared);
+		const __m128 is_valid = _mm_and_ps(_mm_and_ps(load_mask_sse(valid + index), is_finite), is_long_enough);
+
+		_mm_storeu_si128((__m128i*)(valid + index), _mm_castps_si128(is_valid));
+		_mm_storeu_ps(x + index, _mm_and_ps(is_valid, vx));
+		_mm_storeu_ps(y + index, _mm_and_ps(is_valid, vy));
+		_mm_storeu_ps(z + index, select_sse(is_valid, vz, minus_one));
+	}
+
+	reject_invalid_scalar(x, y, z, valid, vector_end, size);
+}
+
+static inline void normalize_sse(__m128& x, __m128& y, __m128& z)
+{
+	const __m128 length = _mm_sqrt_ps(length_squared_sse(x, y, z));
+	const __m128 has_length = _mm_cmpgt_ps(length, _mm_setzero_ps());
+
+	x = _mm_and_ps(has_length, _mm_div_ps(x, length));
+	y = _mm_and_ps(has_length, _mm_div_ps(y, length));
+	z = select_sse(has_length, _mm_div_ps(z, length), _mm_set1_ps(-1.0f));
+}
+
+static void normalize_sse(float* x, float* y, float* z, const size_t size)
+{
+	const size_t vector_end = size & ~(size_t)3;
+
+	for(size_t index = 0; index < vector_end; index += 4)
+	{
+		__m128 vx = _mm_loadu_ps(x + index);
+		__m128 vy = _mm_loadu_ps(y + index);
+		__m128 vz = _mm_loadu_ps(z + index);
+
+		normalize_sse(vx, vy, vz);
+
+		_mm_storeu_ps(x + index, vx);
+		_mm_storeu_ps(y + index, vy);
+		_mm_storeu_ps(z + index, vz);
+	}
+
+	normalize_scalar(x, y, z, vector_end, size);
+}
+
+static inline __m128 dot_sse(const __m128 m0, const __m128 m1, const __m128 m2, const __m128 x, const __m128 y, const __m128 z)
+{
+	return _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, x), _mm_mul_ps(m1, y)), _mm_mul_ps(m2, z));
+}
+
+static void apply_calibration_sse(const float* m, float* x, float* y, float* z, const size_t size)
+{
+	const __m128 m0 = _mm_set1_ps(m[0]), m1 = _mm_set1_ps(m[1]), m2 = _mm_set1_ps(m[2]);
+	const __m128 m3 = _mm_set1_ps(m[3]), m4 = _mm_set1_ps(m[4]), m5 = _mm_set1_ps(m[5]);
+	const __m128 m6 = _mm_set1_ps(m[6]), m7 = _mm_set1_ps(m[7]), m8 = _mm_set1_ps(m[8]);
+	const size_t vector_end = size & ~(size_t)3;
+
+	for(size_t index = 0; index < vector_end; index += 4)
+	{
+		const __m128 vx = _mm_loadu_ps(x + index);
+		const __m128 vy = _mm_loadu_ps(y + index);
+		const __m128 vz = _mm_loadu_ps(z + index);
+
+		__m128 cx = dot_sse(m0, m1, m2, vx, vy, vz);
+		__m128 cy = dot_sse(m3, m4, m5, vx, vy, vz);
+		__m128 cz = dot_sse(m6, m7, m8, vx, vy, vz);
+
+		normalize_sse(cx, cy, cz);
+
+		_mm_storeu_ps(x + index, cx);
+		_mm_storeu_ps(y + index, cy);
+		_mm_storeu_ps(z + index, cz);
+	}
+
+	apply_calibration_scalar(m, x, y, z, vector_end, size);
+}
+
+static void angular_distance_sse(const GazeBatch& a, const GazeBatch& b, float* radians, const size_t size)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 sign_bit = _mm_set1_ps(-0.0f);
+	const __m128 not_a_number = _mm_set1_ps(std::numeric_limits<float>::quiet_NaN());
+	const size_t vector_end = size & ~(size_t)3;
+
+	for(size_t index = 0; index < vector_end; index += 4)
+	{
+		const __m128 ax = _mm_loadu_ps(a.x() + index), ay = _mm_loadu_ps(a.y() + index), az = _mm_loadu_ps(a.z() + index);
+		const __m128 bx = _mm_loadu_ps(b.x() + index), by = _mm_loadu_ps(b.y() + index), bz = _mm_loadu_ps(b.z() + index);
+
+		const __m128 cosine = dot_sse(ax, ay, az, bx, by, bz);
+		const __m128 cx = _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by));
+		const __m128 cy = _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(ax, bz));
+		const __m128 cz = _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx));
+		const __m128 sine = _mm_sqrt_ps(length_squared_sse(cx, cy, cz));
+
+		// atan2_positive_scalar(), one lane at a time
+		const __m128 abs_cosine = _mm_andnot_ps(sign_bit, cosine);
+		const __m128 is_steep = _mm_cmpgt_ps(sine, abs_cosine);
+		const __m128 numerator = select_sse(is_steep, abs_cosine, sine);
+		const __m128 denominator = select_sse(is_steep, sine, abs_cosine);
+		const __m128 ratio = _mm_and_ps(_mm_cmpgt_ps(denominator, zero), _mm_div_ps(numerator, denominator));
+
+		const __m128 is_reduced = _mm_cmpgt_ps(ratio, _mm_set1_ps(GAZE_BATCH_TAN_EIGHTH_PI));
+		const __m128 t = select_sse(is_reduced, _mm_div_ps(_mm_sub_ps(ratio, one), _mm_add_ps(ratio, one)), ratio);
+		const __m128 offset = _mm_and_ps(is_reduced, _mm_set1_ps(GAZE_BATCH_QUARTER_PI));
+
+		const __m128 t2 = _mm_mul_ps(t, t);
+		__m128 polynomial = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(ATAN_C0), t2), _mm_set1_ps(ATAN_C1));
+		polynomial = _mm_add_ps(_mm_mul_ps(polynomial, t2), _mm_set1_ps(ATAN_C2));
+		polynomial = _mm_sub_ps(_mm_mul_ps(polynomial, t2), _mm_set1_ps(ATAN_C3));
+		polynomial = _mm_mul_ps(polynomial, t2);
+		__m128 angle = _mm_add_ps(offset, _mm_add_ps(_mm_mul_ps(polynomial, t), t));
+
+		angle = select_sse(is_steep, _mm_sub_ps(_mm_set1_ps(GAZE_BATCH_HALF_PI), angle), angle);
+		angle = select_sse(_mm_cmplt_ps(cosine, zero), _mm_sub_ps(_mm_set1_ps(GAZE_BATCH_PI), angle), angle);
+
+		const __m128 is_valid = _mm_and_ps(load_mask_sse(a.valid() + index), load_mask_sse(b.valid() + index));
+		_mm_storeu_ps(radians + index, select_sse(is_valid, angle, not_a_number));
+	}
+
+	angular_distance_scalar(a, b, radians, vector_end, size);
+}
+
+// AVX2, the same kernels eight lanes wide. Kept free of FMA on purpose, it would round differently. Each one
+// clears the upper halves before handing the tail to the scalar code, the compiler doesn't always do it
+// on its own and legacy SSE code after dirty AVX state runs a lot slower.
+
+static inline GAZE_TARGET_AVX2 __m256 select_avx2(const __m256 mask, const __m256 if_true, const __m256 if_false)
+{
+	return _mm256_blendv_ps(if_false, if_true, mask);
+}
+
+static inline GAZE_TARGET_AVX2 __m256 load_mask_avx2(const uint32_t* mask)
+{
+	return _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i*)mask));
+}
+
+static inline GAZE_TARGET_AVX2 __m256 is_finite_avx2(const __m256 v)
+{
+	return _mm256_cmp_ps(_mm256_sub_ps(v, v), _mm256_setzero_ps(), _CMP_EQ_OQ);
+}
+
+static inline GAZE_TARGET_AVX2 __m256 length_squared_avx2(const __m256 x, const __m256 y, const __m256 z)
+{
+	return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z));
+}
+
+static inline GAZE_TARGET_AVX2 __m256 dot_avx2(const __m256 m0, const __m256 m1, const __m256 m2, const __m256 x, const __m256 y, const __m256 z)
+{
+	return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m0, x), _mm256_mul_ps(m1, y)), _mm256_mul_ps(m2, z));
+}
+
+static GAZE_TARGET_AVX2 void reject_invalid_avx2(float* x, float* y, float* z, uint32_t* valid, const size_t size)
+{
+	const __m256 min_length_squared = _mm256_set1_ps(GAZE_BATCH_MIN_LENGTH_SQUARED);
+	const __m256 minus_one = _mm256_set1_ps(-1.0f);
+	const size_t vector_end = size & ~(size_t)7;
+
+	for(size_t index = 0; index < vector_end; index += 8)
+	{
+		const __m256 vx = _mm256_loadu_ps(x + index);
+		const __m256 vy = _mm256_loadu_ps(y + index);
+		const __m256 vz = _mm256_loadu_ps(z + index);
+		const __m256 length_squared = length_squared_avx2(vx, vy, vz);
+
+		const __m256 is_finite = _mm256_and_ps(_mm256_and_ps(is_finite_avx2(vx), is_finite_avx2(vy)), _mm256_and_ps(is_finite_avx2(vz), is_finite_avx2(length_squared)));
+		const __m256 is_long_enough = _mm256_cmp_ps(length_squared, min_length_squared, _CMP_GT_OQ);
+		const __m256 is_valid = _mm256_and_ps(_mm256_and_ps(load_mask_avx2(valid + index), is_finite), is_long_enough);
+
+		_mm256_storeu_si256((__m256i*)(valid + index), _mm256_castps_si256(is_valid));
+		_mm256_storeu_ps(x + index, _mm256_and_ps(is_valid, vx));
+		_mm256_storeu_ps(y + index, _mm256_and_ps(is_valid, vy));
+		_mm256_storeu_ps(z + index, select_avx2(is_valid, vz, minus_one));
+	}
+
+	_mm256_zeroupper();
+	reject_invalid_scalar(x, y, z, valid, vector_end, size);
+}
+
+static inline GAZE_TARGET_AVX2 void normalize_avx2(__m256& x, __m256& y, __m256& z)
+{
+	const __m256 length = _mm256_sqrt_ps(length_squared_avx2(x, y, z));
+	const __m256 has_length = _mm256_cmp_ps(length, _mm256_setzero_ps(), _CMP_GT_OQ);
+
+	x = _mm256_and_ps(has_length, _mm256_div_ps(x, length));
+	y = _mm256_and_ps(has_length, _mm256_div_ps(y, length));
+	z = select_avx2(has_length, _mm256_div_ps(z, length), _mm256_set1_ps(-1.0f));
+}
+
+static GAZE_TARGET_AVX2 void normalize_avx2(float* x, float* y, float* z, const size_t size)
+{
+	const size_t vector_end = size & ~(size_t)7;
+
+	for(size_t index = 0; index < vector_end; index += 8)
+	{
+		__m256 vx = _mm256_loadu_ps(x + index);
+		__m256 vy = _mm256_loadu_ps(y + index);
+		__m256 vz = _mm256_loadu_ps(z + index);
+
+		normalize_avx2(vx, vy, vz);
+
+		_mm256_storeu_ps(x + index, vx);
+		_mm256_storeu_ps(y + index, vy);
+		_mm256_storeu_ps(z + index, vz);
+	}
+
+	_mm256_zeroupper();
+	normalize_scalar(x, y, z, vector_end, size);
+}
+
+static GAZE_TARGET_AVX2 void apply_calibration_avx2(const float* m, float* x, float* y, float* z, const size_t size)
+{
+	const __m256 m0 = _mm256_set1_ps(m[0]), m1 = _mm256_set1_ps(m[1]), m2 = _mm256_set1_ps(m[2]);
+	const __m256 m3 = _mm256_set1_ps(m[3]), m4 = _mm256_set1_ps(m[4]), m5 = _mm256_set1_ps(m[5]);
+	const __m256 m6 = _mm256_set1_ps(m[6]), m7 = _mm256_set1_ps(m[7]), m8 = _mm256_set1_ps(m[8]);
+	const size_t vector_end = size & ~(size_t)7;
+
+	for(size_t index = 0; index < vector_end; index += 8)
+	{
+		const __m256 vx = _mm256_loadu_ps(x + index);
+		const __m256 vy = _mm256_loadu_ps(y + index);
+		const __m256 vz = _mm256_loadu_ps(z + index);
+
+		__m256 cx = dot_avx2(m0, m1, m2, vx, vy, vz);
+		__m256 cy = dot_avx2(m3, m4, m5, vx, vy, vz);
+		__m256 cz = dot_avx2(m6, m7, m8, vx, vy, vz);
+
+		normalize_avx2(cx, cy, cz);
+
+		_mm256_storeu_ps(x + index, cx);
+		_mm256_storeu_ps(y + index, cy);
+		_mm256_storeu_ps(z + index, cz);
+	}
+
+	_mm256_zeroupper();
+	apply_calibration_scalar(m, x, y, z, vector_end, size);
+}
+
+static GAZE_TARGET_AVX2 void angular_distance_avx2(const GazeBatch& a, const GazeBatch& b, float* radians, const size_t size)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 sign_bit = _mm256_set1_ps(-0.0f);
+	const __m256 not_a_number = _mm256_set1_ps(std::numeric_limits<float>::quiet_NaN());
+	const size_t vector_end = size & ~(size_t)7;
+
+	for(size_t index = 0; index < vector_end; index += 8)
+	{
+		const __m256 ax = _mm256_loadu_ps(a.x() + index), ay = _mm256_loadu_ps(a.y() + index), az = _mm256_loadu_ps(a.z() + index);
+		const __m256 bx = _mm256_loadu_ps(b.x() + index), by = _mm256_loadu_ps(b.y() + index), bz = _mm256_loadu_ps(b.z() + index);
+
+		const __m256 cosine = dot_avx2(ax, ay, az, bx, by, bz);
+		const __m256 cx = _mm256_sub_ps(_mm256_mul_ps(ay, bz), _mm256_mul_ps(az, by));
+		const __m256 cy = _mm256_sub_ps(_mm256_mul_ps(az, bx), _mm256_mul_ps(ax, bz));
+		const __m256 cz = _mm256_sub_ps(_mm256_mul_ps(ax, by), _mm256_mul_ps(ay, bx));
+		const __m256 sine = _mm256_sqrt_ps(length_squared_avx2(cx, cy, cz));
+
+		const __m256 abs_cosine = _mm256_andnot_ps(sign_bit, cosine);
+		const __m256 is_steep = _mm256_cmp_ps(sine, abs_cosine, _CMP_GT_OQ);
+		const __m256 numerator = select_avx2(is_steep, abs_cosine, sine);
+		const __m256 denominator = select_avx2(is_steep, sine, abs_cosine);
+		const __m256 ratio = _mm256_and_ps(_mm256_cmp_ps(denominator, zero, _CMP_GT_OQ), _mm256_div_ps(numerator, denominator));
+
+		const __m256 is_reduced = _mm256_cmp_ps(ratio, _mm256_set1_ps(GAZE_BATCH_TAN_EIGHTH_PI), _CMP_GT_OQ);
+		const __m256 t = select_avx2(is_reduced, _mm256_div_ps(_mm256_sub_ps(ratio, one), _mm256_add_ps(ratio, one)), ratio);
+		const __m256 offset = _mm256_and_ps(is_reduced, _mm256_set1_ps(GAZE_BATCH_QUARTER_PI));
+
+		const __m256 t2 = _mm256_mul_ps(t, t);
+		__m256 polynomial = _mm256_sub_ps(_mm256_mul_ps(_mm256_set1_ps(ATAN_C0), t2), _mm256_set1_ps(ATAN_C1));
+		polynomial = _mm256_add_ps(_mm256_mul_ps(polynomial, t2), _mm256_set1_ps(ATAN_C2));
+		polynomial = _mm256_sub_ps(_mm256_mul_ps(polynomial, t2), _mm256_set1_ps(ATAN_C3));
+		polynomial = _mm256_mul_ps(polynomial, t2);
+		__m256 angle = _mm256_add_ps(offset, _mm256_add_ps(_mm256_mul_ps(polynomial, t), t));
+
+		angle = select_avx2(is_steep, _mm256_sub_ps(_mm256_set1_ps(GAZE_BATCH_HALF_PI), angle), angle);
+		angle = select_avx2(_mm256_cmp_ps(cosine, zero, _CMP_LT_OQ), _mm256_sub_ps(_mm256_set1_ps(GAZE_BATCH_PI), angle), angle);
+
+		const __m256 is_valid = _mm256_and_ps(load_mask_avx2(a.valid() + index), load_mask_avx2(b.valid() + index));
+		_mm256_storeu_ps(radians + index, select_avx2(is_valid, angle, not_a_number));
+	}
+
+	_mm256_zeroupper();
+	angular_distance_scalar(a, b, radians, vector_end, size);
+}
+
+static bool detect_avx2()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+
+	if(info[0] < 7)
+	{
+		return false;
+	}
+
+	__cpuid(info, 1);
+	const bool has_avx = (info[2] & (1 << 28)) != 0;
+	const bool has_osxsave = (info[2] & (1 << 27)) != 0;
+
+	if(!has_avx || !has_osxsave || ((_xgetbv(0) & 0x6) != 0x6))
+	{
+		return false; // The OS doesn't save the YMM registers
+	}
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // GAZE_SIMD_X86
+
+bool is_gaze_simd_backend_supported(const GazeSimdBackend backend)
+{
+	switch(backend)
+	{
+		case GazeSimdBackend::SCALAR_:
+			return true;
+#if GAZE_SIMD_X86
+		case GazeSimdBackend::SSE_:
+			return true;
+		case GazeSimdBackend::AVX2_:
+		{
+			static const bool has_avx2 = detect_avx2();
+			return has_avx2;
+		}
+#endif
+		default:
+			return false;
+	}
+}
+
+GazeSimdBackend get_best_gaze_simd_backend()
+{
+	static const GazeSimdBackend best = is_gaze_simd_backend_supported(GazeSimdBackend::AVX2_) ? GazeSimdBackend::AVX2_ :
+		is_gaze_simd_backend_supported(GazeSimdBackend::SSE_) ? GazeSimdBackend::SSE_ : GazeSimdBackend::SCALAR_;
+
+	return best;
+}
+
+const char* get_gaze_simd_backend_name(const GazeSimdBackend backend)
+{
+	switch(backend)
+	{
+		case GazeSimdBackend::SSE_:
+			return "sse";
+		case GazeSimdBackend::AVX2_:
+			return "avx2";
+		default:
+			return "scalar";
+	}
+}
+
+void GazeBatch::resize(const size_t size)
+{
+	x_.resize(size, 0.0f);
+	y_.resize(size, 0.0f);
+	z_.resize(size, -1.0f);
+	valid_.resize(size, 0u);
+}
+
+void GazeBatch::set(const size_t index, const XRGazeState& gaze)
+{
+	x_[index] = gaze.direction_.x;
+	y_[index] = gaze.direction_.y;
+	z_[index] = gaze.direction_.z;
+	valid_[index] = to_mask(gaze.is_valid_);
+}
+
+XRGazeState GazeBatch::get(const size_t index) const
+{
+	XRGazeState gaze;
+	gaze.direction_ = { x_[index], y_[index], z_[index] };
+	gaze.is_valid_ = valid_[index] != 0;
+
+	return gaze;
+}
+
+void GazeBatch::push_back(const XRGazeState& gaze)
+{
+	x_.push_back(gaze.direction_.x);
+	y_.push_back(gaze.direction_.y);
+	z_.push_back(gaze.direction_.z);
+	valid_.push_back(to_mask(gaze.is_valid_));
+}
+
+// Unsupported backends fall through to the scalar kernels.
+
+void gaze_batch_reject_invalid(GazeBatch& batch, const GazeSimdBackend backend)
+{
+	const size_t size = batch.size();
+
+#if GAZE_SIMD_X86
+	if((backend == GazeSimdBackend::AVX2_) && is_gaze_simd_backend_supported(backend))
+	{
+		reject_invalid_avx2(batch.x(), batch.y(), batch.z(), batch.valid(), size);
+		return;
+	}
+
+	if(backend == GazeSimdBackend::SSE_)
+	{
+		reject_invalid_sse(batch.x(), batch.y(), batch.z(), batch.valid(), size);
+		return;
+	}
+#endif
+
+	(void)backend;
+	reject_invalid_scalar(batch.x(), batch.y(), batch.z(), batch.valid(), 0, size);
+}
+
+void gaze_batch_normalize(GazeBatch& batch, const GazeSimdBackend backend)
+{
+	const size_t size = batch.size();
+
+#if GAZE_SIMD_X86
+	if((backend == GazeSimdBackend::AVX2_) && is_gaze_simd_backend_supported(backend))
+	{
+		normalize_avx2(batch.x(), batch.y(), batch.z(), size);
+		return;
+	}
+
+	if(backend == GazeSimdBackend::SSE_)
+	{
+		normalize_sse(batch.x(), batch.y(), batch.z(), size);
+		return;
+	}
+#endif
+
+	(void)backend;
+	normalize_scalar(batch.x(), batch.y(), batch.z(), 0, size);
+}
+
+void gaze_batch_apply_calibration(const float matrix[9], GazeBatch& batch, const GazeSimdBackend backend)
+{
+	const size_t size = batch.size();
+
+#if GAZE_SIMD_X86
+	if((backend == GazeSimdBackend::AVX2_) && is_gaze_simd_backend_supported(backend))
+	{
+		apply_calibration_avx2(matrix, batch.x(), batch.y(), batch.z(), size);
+		return;
+	}
+
+	if(backend == GazeSimdBackend::SSE_)
+	{
+		apply_calibration_sse(matrix, batch.x(), batch.y(), batch.z(), size);
+		return;
+	}
+#endif
+
+	(void)backend;
+	apply_calibration_scalar(matrix, batch.x(), batch.y(), batch.z(), 0, size);
+}
+
+void gaze_batch_angular_distance(const GazeBatch& a, const GazeBatch& b, float* radians, const GazeSimdBackend backend)
+{
+	const size_t size = (a.size() < b.size()) ? a.size() : b.size();
+
+#if GAZE_SIMD_X86
+	if((backend == GazeSimdBackend::AVX2_) && is_gaze_simd_backend_supported(backend))
+	{
+		angular_distance_avx2(a, b, radians, size);
+		return;
+	}
+
+	if(backend == GazeSimdBackend::SSE_)
+	{
+		angular_distance_sse(a, b, radians, size);
+		return;
+	}
+#endif
+
+	(void)backend;
+	angular_distance_scalar(a, b, radians, 0, size);
+}
+
+float get_gaze_angular_distance(const XrVector3f& a, const XrVector3f& b)
+{
+	return angular_distance_scalar(a.x, a.y, a.z, b.x, b.y, b.z);
+}
+
+} // BVR
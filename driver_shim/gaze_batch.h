@@ -0,0 +1,110 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef GAZE_BATCH_H
+#define GAZE_BATCH_H
+
+#include "gaze_math.h"
+#include "psvr2_protocol.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#define GAZE_BATCH_VALID 0xFFFFFFFFu              // valid() entries are full masks, so the kernels can use them as is
+#define GAZE_BATCH_MIN_LENGTH_SQUARED 1.0e-12f    // Shorter directions have no meaningful orientation
+
+namespace BVR
+{
+	enum class GazeSimdBackend
+	{
+		SCALAR_,
+		SSE_,   // SSE2, always there on x64
+		AVX2_,  // Picked at runtime when the CPU and OS support it
+	};
+
+	bool is_gaze_simd_backend_supported(const GazeSimdBackend backend);
+
+	// Fastest supported backend, detected once.
+	GazeSimdBackend get_best_gaze_simd_backend();
+
+	const char* get_gaze_simd_backend_name(const GazeSimdBackend backend);
+
+	// Many gaze directions as a structure of arrays, for processing recordings and evaluating calibrations.
+	class GazeBatch
+	{
+	public:
+		// New entries are invalid and point forward.
+		void resize(const size_t size);
+		void clear() { resize(0); }
+		size_t size() const { return valid_.size(); }
+
+		void set(const size_t index, const XRGazeState& gaze);
+		XRGazeState get(const size_t index) const;
+		void push_back(const XRGazeState& gaze);
+
+		bool is_valid(const size_t index) const { return valid_[index] != 0; }
+
+		float* x() { return x_.data(); }
+		float* y() { return y_.data(); }
+		float* z() { return z_.data(); }
+		uint32_t* valid() { return valid_.data(); }
+
+		const float* x() const { return x_.data(); }
+		const float* y() const { return y_.data(); }
+		const float* z() const { return z_.data(); }
+		const uint32_t* valid() const { return valid_.data(); }
+
+	private:
+		std::vector<float> x_;
+		std::vector<float> y_;
+		std::vector<float> z_;
+		std::vector<uint32_t> valid_;
+	};
+
+	// Every backend produces bit for bit the same results as the scalar one: same operations in the same
+	// order, no FMA, and no approximate reciprocals.
+
+	// Invalidates NaN, infinite and (near) zero length directions, and resets them to point forward.
+	void gaze_batch_reject_invalid(GazeBatch& batch, const GazeSimdBackend backend = get_best_gaze_simd_backend());
+
+	// Same as GazeCalibration does to a single direction: zero length ones end up pointing forward.
+	void gaze_batch_normalize(GazeBatch& batch, const GazeSimdBackend backend = get_best_gaze_simd_backend());
+
+	// Row-major 3x3 (GazeCalibration::get_matrix()) followed by normalization, bit identical to
+	// GazeCalibration::apply_calibration().
+	void gaze_batch_apply_calibration(const float matrix[9], GazeBatch& batch, const GazeSimdBackend backend = get_best_gaze_simd_backend());
+
+	// Angle in radians between a[i] and b[i], NaN where either is invalid. Computed as atan2(|a x b|, a . b),
+	// which unlike acos(a . b) stays accurate for the small angles precision metrics care about.
+	// Processes min(a.size(), b.size()) pairs.
+	void gaze_batch_angular_distance(const GazeBatch& a, const GazeBatch& b, float* radians, const GazeSimdBackend backend = get_best_gaze_simd_backend());
+
+	// The scalar reference for a single pair of unit directions.
+	float get_gaze_angular_distance(const XrVector3f& a, const XrVector3f& b);
+}
+
+#endif // GAZE_BATCH_H
@@ -0,0 +1,214 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "gaze_broadcast.h"
+#include "gaze_seqlock.h"
+
+namespace BVR
+{
+
+void write_gaze_broadcast(GazeBroadcastBlock& block, const GazeBroadcastSample& sample)
+{
+	// Single writer
+	const uint64_t index = block.write_index_.load(std::memory_order_relaxed);
+	GazeBroadcastRecord& record = block.records_[index & (GAZE_BROADCAST_CAPACITY - 1)];
+
+	write_gaze_seqlock(record.sequence_, 2 * (index + 1), record.sample_, sample);
+	block.write_index_.store(index + 1, std::memory_order_release);
+}
+
+void GazeBroadcastWriter::set_enabled(const bool enabled, const int64_t now_us, const char* name)
+{
+	if(!enabled)
+	{
+		close();
+		has_open_attempt_ = false;
+		return;
+	}
+
+	if(is_open() || (has_open_attempt_ && (now_us - last_open_attempt_us_) < GAZE_BROADCAST_OPEN_RETRY_US))
+	{
+		return;
+	}
+
+	has_open_attempt_ = true;
+	last_open_attempt_us_ = now_us;
+	open(name);
+}
+
+bool GazeBroadcastWriter::open(const char* name)
+{
+	close();
+
+	if(!memory_.create(name, sizeof(GazeBroadcastBlock)))
+	{
+		return false;
+	}
+
+	// Start over on a stale block. Readers still attached to it see the index go backwards and resync.
+	block_ = (GazeBroadcastBlock*)memory_.get_data();
+	block_->write_index_.store(0, std::memory_order_relaxed);
+
+	for(GazeBroadcastRecord& record : block_->records_)
+	{
+		record.sequence_.store(0, std::memory_order_relaxed);
+	}
+
+	block_->capacity_ = GAZE_BROADCAST_CAPACITY;
+	block_->size_ = sizeof(GazeBroadcastBlock);
+	block_->version_ = GAZE_BROADCAST_VERSION;
+	block_->magic_ = GAZE_BROADCAST_MAGIC;
+	std::atomic_thread_fence(std::memory_order_release);
+
+	has_poll_ = false;
+
+	return true;
+}
+
+void GazeBroadcastWriter::close()
+{
+	memory_.close();
+	block_ = nullptr;
+}
+
+void GazeBroadcastWriter::record(const GazeUpdateLoop& loop)
+{
+	const GazeUpdate& update = loop.get_last_update();
+
+	if(!block_ || (update.new_samples_ == 0) || !update.slot_ ||
+		(has_poll_ && (update.poll_time_us_ == last_poll_time_us_)))
+	{
+		return;
+	}
+
+	has_poll_ = true;
+	last_poll_time_us_ = update.poll_time_us_;
+
+	const GazeSlot& slot = *update.slot_;
+	const AllXRGazeStates& gazes = slot.response_.gazes_;
+
+	GazeBroadcastSample sample = {};
+	sample.sequence_number_ = slot.has_sequence_number_ ? slot.response_.sequence_number_ : 0;
+	sample.poll_time_us_ = update.poll_time_us_;
+	sample.new_samples_ = update.new_samples_;
+	sample.has_sequence_number_ = slot.has_sequence_number_;
+
+	sample.combined_gaze_[0] = gazes.combined_gaze_.direction_.x;
+	sample.combined_gaze_[1] = gazes.combined_gaze_.direction_.y;
+	sample.combined_gaze_[2] = gazes.combined_gaze_.direction_.z;
+	sample.combined_gaze_valid_ = gazes.combined_gaze_.is_valid_;
+
+	for(int eye = 0; eye < NUM_EYES; eye++)
+	{
+		sample.per_eye_gazes_[eye][0] = gazes.per_eye_gazes_[eye].direction_.x;
+		sample.per_eye_gazes_[eye][1] = gazes.per_eye_gazes_[eye].direction_.y;
+		sample.per_eye_gazes_[eye][2] = gazes.per_eye_gazes_[eye].direction_.z;
+		sample.per_eye_gazes_valid_[eye] = gazes.per_eye_gazes_[eye].is_valid_;
+	}
+
+	write_gaze_broadcast(*block_, sample);
+}
+
+bool GazeBroadcastReader::open(const char* name)
+{
+	close();
+
+	if(!memory_.open(name, sizeof(GazeBroadcastBlock)))
+	{
+		return false;
+	}
+
+	const GazeBroadcastBlock* block = (const GazeBroadcastBlock*)memory_.get_data();
+
+	if(block->magic_ != GAZE_BROADCAST_MAGIC || block->version_ != GAZE_BROADCAST_VERSION ||
+		block->size_ < sizeof(GazeBroadcastBlock) || block->capacity_ != GAZE_BROADCAST_CAPACITY)
+	{
+		memory_.close();
+		return false;
+	}
+
+	attach(*block);
+	return true;
+}
+
+void GazeBroadcastReader::attach(const GazeBroadcastBlock& block)
+{
+	block_ = &block;
+	read_index_ = block.write_index_.load(std::memory_order_acquire);
+	dropped_ = 0;
+	read_ = 0;
+}
+
+void GazeBroadcastReader::close()
+{
+	memory_.close();
+	block_ = nullptr;
+}
+
+bool GazeBroadcastReader::read(GazeBroadcastSample& sample)
+{
+	if(!block_)
+	{
+		return false;
+	}
+
+	while(true)
+	{
+		const uint64_t write_index = block_->write_index_.load(std::memory_order_acquire);
+
+		if(write_index < read_index_)
+		{
+			// The writer restarted the ring
+			read_index_ = write_index;
+		}
+
+		if(read_index_ == write_index)
+		{
+			return false;
+		}
+
+		if(write_index - read_index_ > GAZE_BROADCAST_CAPACITY)
+		{
+			// Lapped, jump to the oldest record still there
+			dropped_ += write_index - GAZE_BROADCAST_CAPACITY - read_index_;
+			read_index_ = write_index - GAZE_BROADCAST_CAPACITY;
+		}
+
+		const GazeBroadcastRecord& record = block_->records_[read_index_ & (GAZE_BROADCAST_CAPACITY - 1)];
+		if(read_gaze_seqlock_at(record.sequence_, 2 * (read_index_ + 1), record.sample_, sample))
+		{
+			read_index_++;
+			read_++;
+			return true;
+		}
+
+		// Overwritten under us, that one is gone
+		dropped_++;
+		read_index_++;
+	}
+}
+
+} // BVR
@@ -0,0 +1,155 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef GAZE_BROADCAST_H
+#define GAZE_BROADCAST_H
+
+#include "defines.h"
+#include "gaze_shared_memory.h"
+#include "gaze_slot_pool.h"
+#include "gaze_update_loop.h"
+#include "psvr2_protocol.h"
+
+#include <atomic>
+#include <stdint.h>
+
+#ifdef _WIN32
+#define GAZE_BROADCAST_SHM_NAME "Local\\PSVR2GazeBroadcast"
+#else
+#define GAZE_BROADCAST_SHM_NAME "/psvr2_gaze_broadcast"
+#endif
+
+#define GAZE_BROADCAST_MAGIC 0x42475350 // "PSGB"
+#define GAZE_BROADCAST_VERSION 1
+#define GAZE_BROADCAST_CAPACITY 256     // Samples, about two seconds at the server's rate. Power of two.
+#define GAZE_BROADCAST_OPEN_RETRY_US 1000000
+
+namespace BVR
+{
+	// One sample exactly as the server sent it, before any calibration. Fixed layout, same rules as
+	// GazeTelemetrySnapshot.
+	struct GazeBroadcastSample
+	{
+		uint64_t sequence_number_;       // The server's, 0 if it doesn't send any
+		int64_t poll_time_us_;           // Writer's steady clock when the sample came in
+		uint64_t new_samples_;           // Server samples since the previous one, more than 1 means the shim missed some
+
+		float combined_gaze_[3];
+		float per_eye_gazes_[NUM_EYES][3];
+
+		uint32_t combined_gaze_valid_;
+		uint32_t per_eye_gazes_valid_[NUM_EYES];
+		uint32_t has_sequence_number_;
+	};
+
+	// sequence_ is a per record seqlock (gaze_seqlock.h) holding the record's index: 2 * (index + 1) once
+	// written, one less while the writer is in the middle of it.
+	struct alignas(GAZE_CACHE_LINE_SIZE) GazeBroadcastRecord
+	{
+		std::atomic<uint64_t> sequence_;
+		GazeBroadcastSample sample_;
+	};
+
+	// A single writer, many readers ring at the start of the shared memory. The writer never looks at the
+	// readers: it overwrites the oldest record whatever happens, so a slow or stuck consumer can't delay the
+	// update thread. Each reader keeps its own position, and one that falls more than a ring behind finds out
+	// and skips ahead, counting what it lost. That's the whole backpressure, and it's per reader.
+	struct GazeBroadcastBlock
+	{
+		uint32_t magic_;
+		uint32_t version_;
+		uint32_t size_;                  // sizeof(GazeBroadcastBlock) of the writer
+		uint32_t capacity_;              // GAZE_BROADCAST_CAPACITY of the writer
+
+		alignas(GAZE_CACHE_LINE_SIZE) std::atomic<uint64_t> write_index_; // Records written since the block was created
+
+		GazeBroadcastRecord records_[GAZE_BROADCAST_CAPACITY];
+	};
+
+	static_assert(std::atomic<uint64_t>::is_always_lock_free, "the ring must work across processes");
+	static_assert((GAZE_BROADCAST_CAPACITY & (GAZE_BROADCAST_CAPACITY - 1)) == 0, "GAZE_BROADCAST_CAPACITY must be a power of two");
+
+	void write_gaze_broadcast(GazeBroadcastBlock& block, const GazeBroadcastSample& sample);
+
+	// Re-serves every new sample the update loop receives to local consumers, so they don't each need their
+	// own connection to the server.
+	class GazeBroadcastWriter
+	{
+	public:
+		// Follows the gazeBroadcastEnabled setting, retrying a failed open once every GAZE_BROADCAST_OPEN_RETRY_US.
+		void set_enabled(const bool enabled, const int64_t now_us, const char* name = GAZE_BROADCAST_SHM_NAME);
+
+		bool open(const char* name = GAZE_BROADCAST_SHM_NAME);
+		void close();
+		bool is_open() const { return block_ != nullptr; }
+
+		// Call after every run_once(), writes the sample if the loop received a new one.
+		void record(const GazeUpdateLoop& loop);
+
+		uint64_t get_num_written() const { return block_ ? block_->write_index_.load(std::memory_order_relaxed) : 0; }
+
+	private:
+		GazeSharedMemory memory_;
+		GazeBroadcastBlock* block_ = nullptr;
+
+		int64_t last_open_attempt_us_ = 0;
+		bool has_open_attempt_ = false;
+
+		int64_t last_poll_time_us_ = 0;
+		bool has_poll_ = false;
+	};
+
+	// A consumer's view of the ring, read only.
+	class GazeBroadcastReader
+	{
+	public:
+		// Starts at the newest record, earlier ones aren't delivered. Fails if there's no block or it was
+		// written by an incompatible version.
+		bool open(const char* name = GAZE_BROADCAST_SHM_NAME);
+		void close();
+		bool is_open() const { return block_ != nullptr; }
+
+		// Never waits: false when there's nothing new.
+		bool read(GazeBroadcastSample& sample);
+
+		// Records overwritten before this reader got to them.
+		uint64_t get_num_dropped() const { return dropped_; }
+		uint64_t get_num_read() const { return read_; }
+
+		// Same, on a block that isn't in shared memory.
+		void attach(const GazeBroadcastBlock& block);
+
+	private:
+		GazeSharedMemory memory_;
+		const GazeBroadcastBlock* block_ = nullptr;
+
+		uint64_t read_index_ = 0;
+		uint64_t dropped_ = 0;
+		uint64_t read_ = 0;
+	};
+}
+
+#endif // GAZE_BROADCAST_H
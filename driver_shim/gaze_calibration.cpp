@@ -0,0 +1,363 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "gaze_calibration.h"
+#include "gaze_math.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace BVR
+{
+
+static const float CALIBRATION_DEGREES_TO_RADIANS = 3.14159265358979323846f / 180.0f;
+static const char* CALIBRATION_FILE_HEADER = "psvr2_gaze_calibration";
+static const int CALIBRATION_FILE_VERSION = 1;
+
+static inline XrVector3f normalized(const XrVector3f& v)
+{
+	return gaze_vector_store(gaze_vector_normalize3(gaze_vector_load(v)));
+}
+
+static inline bool is_finite(const XrVector3f& v)
+{
+	return gaze_vector_is_finite3(gaze_vector_load(v));
+}
+
+static void create_parent_directory(const std::string& file_path)
+{
+	const size_t separator = file_path.find_last_of("\\/");
+
+	if(separator == std::string::npos)
+	{
+		return;
+	}
+
+	// Fails harmlessly when it already exists
+	const std::string directory = file_path.substr(0, separator);
+#ifdef _WIN32
+	_mkdir(directory.c_str());
+#else
+	mkdir(directory.c_str(), 0755);
+#endif
+}
+
+bool CalibrationPoint::add_sample(const XrVector3f& gaze_direction)
+{
+	if(is_calibrated_ || !is_finite(gaze_direction))
+	{
+		return false;
+	}
+
+	const XrVector3f direction = normalized(gaze_direction);
+	measured_sum_.x += direction.x;
+	measured_sum_.y += direction.y;
+	measured_sum_.z += direction.z;
+	num_samples_++;
+
+	is_calibrated_ = (num_samples_ >= CALIBRATION_SAMPLES_PER_POINT);
+
+	return true;
+}
+
+XrVector3f CalibrationPoint::get_measured_direction() const
+{
+	return normalized(measured_sum_);
+}
+
+void CalibrationPoint::reset()
+{
+	measured_sum_ = { 0.0f, 0.0f, 0.0f };
+	num_samples_ = 0;
+	is_calibrated_ = false;
+}
+
+GazeCalibration::GazeCalibration()
+{
+	// Raster of yaw / pitch targets, row by row from the top left
+	for(int row = 0; row < CALIBRATION_RASTER_SIZE; row++)
+	{
+		for(int column = 0; column < CALIBRATION_RASTER_SIZE; column++)
+		{
+			const float u = (CALIBRATION_RASTER_SIZE > 1) ? ((float)column / (CALIBRATION_RASTER_SIZE - 1)) * 2.0f - 1.0f : 0.0f;
+			const float v = (CALIBRATION_RASTER_SIZE > 1) ? ((float)row / (CALIBRATION_RASTER_SIZE - 1)) * 2.0f - 1.0f : 0.0f;
+
+			const float yaw = u * CALIBRATION_RASTER_HALF_ANGLE_DEGREES * CALIBRATION_DEGREES_TO_RADIANS;
+			const float pitch = -v * CALIBRATION_RASTER_HALF_ANGLE_DEGREES * CALIBRATION_DEGREES_TO_RADIANS;
+
+			raster_[row * CALIBRATION_RASTER_SIZE + column].target_ = { sinf(yaw) * cosf(pitch), sinf(pitch), -cosf(yaw) * cosf(pitch) };
+		}
+	}
+
+	reset_calibration();
+}
+
+void GazeCalibration::start_calibration()
+{
+	for(CalibrationPoint& point : raster_)
+	{
+		point.reset();
+	}
+
+	raster_index_ = 0;
+	num_calibrated_ = 0;
+	is_calibrating_ = true;
+}
+
+void GazeCalibration::stop_calibration()
+{
+	is_calibrating_ = false;
+}
+
+bool GazeCalibration::reset_calibration()
+{
+	for(int index = 0; index < 9; index++)
+	{
+		matrix_[index] = ((index % 4) == 0) ? 1.0f : 0.0f;
+	}
+
+	for(CalibrationPoint& point : raster_)
+	{
+		point.reset();
+	}
+
+	raster_index_ = 0;
+	num_calibrated_ = 0;
+	is_calibrated_ = false;
+	is_calibrating_ = false;
+
+	return true;
+}
+
+bool GazeCalibration::set_matrix(const float matrix[9])
+{
+	for(int index = 0; index < 9; index++)
+	{
+		if(!isfinite(matrix[index]))
+		{
+			return false;
+		}
+	}
+
+	for(int index = 0; index < 9; index++)
+	{
+		matrix_[index] = matrix[index];
+	}
+
+	is_calibrated_ = true;
+	return true;
+}
+
+bool GazeCalibration::load_calibration()
+{
+	if(file_path_.empty())
+	{
+		return false;
+	}
+
+	FILE* file = fopen(file_path_.c_str(), "r");
+
+	if(!file)
+	{
+		return false;
+	}
+
+	char header[64] = {};
+	int version = 0;
+	float matrix[9] = {};
+
+	bool success = (fscanf(file, "%63s %d", header, &version) == 2) &&
+		(strcmp(header, CALIBRATION_FILE_HEADER) == 0) && (version == CALIBRATION_FILE_VERSION);
+
+	for(int index = 0; success && (index < 9); index++)
+	{
+		success = (fscanf(file, "%f", &matrix[index]) == 1);
+	}
+
+	fclose(file);
+
+	return success && set_matrix(matrix);
+}
+
+bool GazeCalibration::save_calibration() const
+{
+	if(file_path_.empty() || !is_calibrated_)
+	{
+		return false;
+	}
+
+	create_parent_directory(file_path_);
+
+	FILE* file = fopen(file_path_.c_str(), "w");
+
+	if(!file)
+	{
+		return false;
+	}
+
+	bool success = (fprintf(file, "%s %d\n", CALIBRATION_FILE_HEADER, CALIBRATION_FILE_VERSION) > 0);
+
+	for(int row = 0; success && (row < 3); row++)
+	{
+		success = (fprintf(file, "%.9g %.9g %.9g\n", matrix_[row * 3 + 0], matrix_[row * 3 + 1], matrix_[row * 3 + 2]) > 0);
+	}
+
+	return (fclose(file) == 0) && success;
+}
+
+XrVector3f GazeCalibration::apply_calibration(const XrVector3f& gaze_direction) const
+{
+	return gaze_vector_store(gaze_vector_normalize3(gaze_vector_transform3(matrix_, gaze_vector_load(gaze_direction))));
+}
+
+void GazeCalibration::increment_raster()
+{
+	if(!is_calibrating_)
+	{
+		return;
+	}
+
+	raster_index_++;
+
+	if(raster_index_ >= CALIBRATION_NUM_POINTS)
+	{
+		raster_index_ = 0;
+		is_calibrating_ = false;
+		solve();
+	}
+}
+
+GazeTargetPose GazeCalibration::get_calibration_cube() const
+{
+	const XrVector3f& target = raster_[raster_index_].target_;
+
+	GazeTargetPose pose;
+	pose.direction_ = target;
+	pose.position_ = { target.x * CALIBRATION_TARGET_DISTANCE_METERS, target.y * CALIBRATION_TARGET_DISTANCE_METERS, target.z * CALIBRATION_TARGET_DISTANCE_METERS };
+
+	return pose;
+}
+
+bool GazeCalibration::solve()
+{
+	// Least squares fit of M minimizing sum |M * measured - target|^2, i.e. M = (sum t m^T) (sum m m^T)^-1
+	double tm[9] = {};
+	double mm[9] = {};
+	int num_points = 0;
+
+	for(const CalibrationPoint& point : raster_)
+	{
+		if(!point.is_calibrated_)
+		{
+			continue;
+		}
+
+		const XrVector3f measured = point.get_measured_direction();
+		const double m[3] = { measured.x, measured.y, measured.z };
+		const double t[3] = { point.target_.x, point.target_.y, point.target_.z };
+
+		for(int row = 0; row < 3; row++)
+		{
+			for(int column = 0; column < 3; column++)
+			{
+				tm[row * 3 + column] += t[row] * m[column];
+				mm[row * 3 + column] += m[row] * m[column];
+			}
+		}
+
+		num_points++;
+	}
+
+	// Need targets in both directions to constrain all three axes
+	if(num_points < 4)
+	{
+		return false;
+	}
+
+	const double det = mm[0] * (mm[4] * mm[8] - mm[5] * mm[7]) -
+		mm[1] * (mm[3] * mm[8] - mm[5] * mm[6]) +
+		mm[2] * (mm[3] * mm[7] - mm[4] * mm[6]);
+
+	if(fabs(det) < 1e-12)
+	{
+		return false;
+	}
+
+	const double inv_det = 1.0 / det;
+	const double inv[9] =
+	{
+		(mm[4] * mm[8] - mm[5] * mm[7]) * inv_det,
+		(mm[2] * mm[7] - mm[1] * mm[8]) * inv_det,
+		(mm[1] * mm[5] - mm[2] * mm[4]) * inv_det,
+		(mm[5] * mm[6] - mm[3] * mm[8]) * inv_det,
+		(mm[0] * mm[8] - mm[2] * mm[6]) * inv_det,
+		(mm[2] * mm[3] - mm[0] * mm[5]) * inv_det,
+		(mm[3] * mm[7] - mm[4] * mm[6]) * inv_det,
+		(mm[1] * mm[6] - mm[0] * mm[7]) * inv_det,
+		(mm[0] * mm[4] - mm[1] * mm[3]) * inv_det,
+	};
+
+	float matrix[9];
+
+	for(int row = 0; row < 3; row++)
+	{
+		for(int column = 0; column < 3; column++)
+		{
+			matrix[row * 3 + column] = (float)(tm[row * 3 + 0] * inv[0 * 3 + column] +
+				tm[row * 3 + 1] * inv[1 * 3 + column] +
+				tm[row * 3 + 2] * inv[2 * 3 + column]);
+		}
+	}
+
+	return set_matrix(matrix);
+}
+
+std::string get_default_calibration_directory()
+{
+#ifdef _WIN32
+	const char* base_directory = getenv("LOCALAPPDATA");
+	const char* separator = "\\";
+#else
+	const char* base_directory = getenv("HOME");
+	const char* separator = "/";
+#endif
+
+	if(!base_directory || !base_directory[0])
+	{
+		return std::string();
+	}
+
+	return std::string(base_directory) + separator + "psvr2_shim" + separator;
+}
+
+} // BVR
@@ -0,0 +1,114 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef GAZE_CALIBRATION_H
+#define GAZE_CALIBRATION_H
+
+#include "psvr2_protocol.h"
+
+#include <string>
+
+#define CALIBRATION_RASTER_SIZE 3                                                 // 3x3 grid of targets
+#define CALIBRATION_NUM_POINTS (CALIBRATION_RASTER_SIZE * CALIBRATION_RASTER_SIZE)
+#define CALIBRATION_RASTER_HALF_ANGLE_DEGREES 15.0f                               // Targets span +/- this much yaw and pitch
+#define CALIBRATION_TARGET_DISTANCE_METERS 1.0f
+#define CALIBRATION_SAMPLES_PER_POINT 30
+
+namespace BVR
+{
+	// Where the calibration target cube should be drawn, in HMD space.
+	struct GazeTargetPose
+	{
+		XrVector3f position_ = { 0.0f, 0.0f, -CALIBRATION_TARGET_DISTANCE_METERS };
+		XrVector3f direction_ = { 0.0f, 0.0f, -1.0f };
+	};
+
+	struct CalibrationPoint
+	{
+		XrVector3f target_ = { 0.0f, 0.0f, -1.0f };
+		XrVector3f measured_sum_ = { 0.0f, 0.0f, 0.0f };
+		int num_samples_ = 0;
+		bool is_calibrated_ = false;
+
+		// Returns true if the sample was taken.
+		bool add_sample(const XrVector3f& gaze_direction);
+		XrVector3f get_measured_direction() const;
+		void reset();
+	};
+
+	// Linear correction from the directions reported by the tracker to the directions the user was actually
+	// looking at, fitted (least squares) over a raster of known targets.
+	class GazeCalibration
+	{
+	public:
+		GazeCalibration();
+
+		bool is_calibrated() const { return is_calibrated_; }
+		bool is_calibrating() const { return is_calibrating_; }
+
+		void start_calibration();
+		void stop_calibration();
+		bool reset_calibration();
+
+		// Persisted to get_file_path(), which must be set first.
+		void set_file_path(const std::string& file_path) { file_path_ = file_path; }
+		const std::string& get_file_path() const { return file_path_; }
+		bool load_calibration();
+		bool save_calibration() const;
+
+		XrVector3f apply_calibration(const XrVector3f& gaze_direction) const;
+
+		CalibrationPoint& get_raster_point() { return raster_[raster_index_]; }
+		int get_raster_index() const { return raster_index_; }
+
+		// Moves on to the next target, and solves the calibration after the last one.
+		void increment_raster();
+		GazeTargetPose get_calibration_cube() const;
+
+		// Row-major 3x3, identity until calibrated.
+		const float* get_matrix() const { return matrix_; }
+		bool set_matrix(const float matrix[9]);
+
+		int num_calibrated_ = 0;
+
+	private:
+		bool solve();
+
+		CalibrationPoint raster_[CALIBRATION_NUM_POINTS];
+		int raster_index_ = 0;
+
+		float matrix_[9];
+		bool is_calibrated_ = false;
+		bool is_calibrating_ = false;
+
+		std::string file_path_;
+	};
+
+	// Per-user folder calibration files are stored in.
+	std::string get_default_calibration_directory();
+}
+
+#endif // GAZE_CALIBRATION_H
+
@@ -0,0 +1,302 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "gaze_calibration_session.h"
+
+namespace BVR
+{
+
+namespace
+{
+	const uint32_t CALIBRATION_REQUEST_START = 1u << 30;
+	const uint32_t CALIBRATION_REQUEST_STOP = 1u << 31;
+	const uint32_t CALIBRATION_REQUEST_MASK = (1u << NUM_CALIBRATIONS) - 1;
+
+	const char* CALIBRATION_FILE_NAMES[NUM_CALIBRATIONS] = { "calibration_left.txt", "calibration_right.txt", "calibration_combined.txt" };
+}
+
+bool GazeCalibrationSampleQueue::push(const GazeCalibrationSample& sample)
+{
+	const uint64_t write_index = write_index_.load(std::memory_order_relaxed);
+
+	if(write_index - read_index_.load(std::memory_order_acquire) >= CALIBRATION_SESSION_QUEUE_CAPACITY)
+	{
+		return false;
+	}
+
+	samples_[write_index & (CALIBRATION_SESSION_QUEUE_CAPACITY - 1)] = sample;
+	write_index_.store(write_index + 1, std::memory_order_release);
+
+	return true;
+}
+
+bool GazeCalibrationSampleQueue::pop(GazeCalibrationSample& sample)
+{
+	const uint64_t read_index = read_index_.load(std::memory_order_relaxed);
+
+	if(read_index == write_index_.load(std::memory_order_acquire))
+	{
+		return false;
+	}
+
+	sample = samples_[read_index & (CALIBRATION_SESSION_QUEUE_CAPACITY - 1)];
+	read_index_.store(read_index + 1, std::memory_order_release);
+
+	return true;
+}
+
+void GazeCalibrationSampleQueue::clear()
+{
+	read_index_.store(write_index_.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+GazeCalibrationSession::GazeCalibrationSession()
+{
+	// Readers get the inactive target rather than nothing, and no results
+	publish_target(0);
+}
+
+GazeCalibrationSession::~GazeCalibrationSession()
+{
+	stop_thread();
+}
+
+void GazeCalibrationSession::set_directory(const std::string& directory)
+{
+	for(int index = 0; index < NUM_CALIBRATIONS; index++)
+	{
+		calibrations_[index].set_file_path(directory.empty() ? std::string() : directory + CALIBRATION_FILE_NAMES[index]);
+	}
+}
+
+void GazeCalibrationSession::start_thread()
+{
+	if(!is_running_.exchange(true))
+	{
+		thread_ = std::thread(&GazeCalibrationSession::run, this);
+	}
+}
+
+void GazeCalibrationSession::stop_thread()
+{
+	if(is_running_.exchange(false))
+	{
+		waiter_.wake();
+		thread_.join();
+	}
+}
+
+void GazeCalibrationSession::start(const bool per_eye_gazes, const bool combined_gaze)
+{
+	const uint32_t calibrations = (per_eye_gazes ? ((1u << LEFT_CALIBRATION_INDEX) | (1u << RIGHT_CALIBRATION_INDEX)) : 0) |
+		(combined_gaze ? (1u << COMBINED_CALIBRATION_INDEX) : 0);
+
+	request_.store(CALIBRATION_REQUEST_START | calibrations, std::memory_order_release);
+	waiter_.wake();
+}
+
+void GazeCalibrationSession::stop()
+{
+	request_.store(CALIBRATION_REQUEST_STOP, std::memory_order_release);
+	waiter_.wake();
+}
+
+void GazeCalibrationSession::run()
+{
+	while(is_running_.load(std::memory_order_relaxed))
+	{
+		const int64_t now_us = get_steady_time_us();
+		process(now_us);
+
+		// Asleep between sessions, start() and stop_thread() wake it up
+		waiter_.wait_until_us(now_us + (is_active() ? CALIBRATION_SESSION_INTERVAL_US : 1000000));
+	}
+}
+
+void GazeCalibrationSession::process(const int64_t now_us)
+{
+	const uint32_t request = request_.exchange(0, std::memory_order_acquire);
+
+	if(request & CALIBRATION_REQUEST_STOP)
+	{
+		end_session(now_us, false);
+	}
+	else if(request & CALIBRATION_REQUEST_START)
+	{
+		end_session(now_us, false);
+
+		// Anything queued so far was looking somewhere else
+		queue_.clear();
+
+		pending_mask_ = request & CALIBRATION_REQUEST_MASK;
+		working_results_.solved_mask_ = 0;
+		stats_.sessions_.fetch_add(1, std::memory_order_relaxed);
+
+		is_active_.store(pending_mask_ != 0, std::memory_order_relaxed);
+		begin_next_calibration(now_us);
+	}
+
+	GazeCalibrationSample sample;
+
+	while((calibration_index_ != INVALID_INDEX) && queue_.pop(sample))
+	{
+		if(sample.time_us_ < point_start_us_ + CALIBRATION_SETTLE_US)
+		{
+			stats_.settling_.fetch_add(1, std::memory_order_relaxed);
+			continue;
+		}
+
+		const XRGazeState& gaze = (calibration_index_ == COMBINED_CALIBRATION_INDEX) ? sample.gazes_.combined_gaze_ : sample.gazes_.per_eye_gazes_[calibration_index_];
+		GazeCalibration& calibration = calibrations_[calibration_index_];
+		CalibrationPoint& point = calibration.get_raster_point();
+
+		if(!gaze.is_valid_ || !point.add_sample(gaze.direction_))
+		{
+			continue;
+		}
+
+		stats_.samples_.fetch_add(1, std::memory_order_relaxed);
+
+		if(point.is_calibrated_)
+		{
+			calibration.num_calibrated_++;
+			next_point(sample.time_us_);
+		}
+	}
+
+	if((calibration_index_ != INVALID_INDEX) && (now_us - point_start_us_ >= CALIBRATION_POINT_TIMEOUT_US))
+	{
+		// Left uncalibrated, the fit only needs some of the points
+		stats_.skipped_points_.fetch_add(1, std::memory_order_relaxed);
+		next_point(now_us);
+	}
+
+	if(calibration_index_ == INVALID_INDEX)
+	{
+		queue_.clear();
+	}
+}
+
+void GazeCalibrationSession::begin_next_calibration(const int64_t now_us)
+{
+	if(pending_mask_ == 0)
+	{
+		end_session(now_us, true);
+		return;
+	}
+
+	calibration_index_ = 0;
+
+	while(!(pending_mask_ & (1u << calibration_index_)))
+	{
+		calibration_index_++;
+	}
+
+	GazeCalibration& calibration = calibrations_[calibration_index_];
+	calibration.reset_calibration();
+	calibration.start_calibration();
+
+	point_start_us_ = now_us;
+	publish_target(now_us);
+}
+
+void GazeCalibrationSession::next_point(const int64_t now_us)
+{
+	GazeCalibration& calibration = calibrations_[calibration_index_];
+	calibration.increment_raster();
+
+	if(calibration.is_calibrating())
+	{
+		point_start_us_ = now_us;
+		publish_target(now_us);
+		return;
+	}
+
+	// Past the last target, increment_raster() solved it
+	if(calibration.is_calibrated())
+	{
+		calibration.save_calibration();
+
+		memcpy(working_results_.matrices_[calibration_index_], calibration.get_matrix(), sizeof(working_results_.matrices_[calibration_index_]));
+		working_results_.solved_mask_ |= 1u << calibration_index_;
+	}
+
+	pending_mask_ &= ~(1u << calibration_index_);
+	begin_next_calibration(now_us);
+}
+
+void GazeCalibrationSession::end_session(const int64_t now_us, const bool is_finished)
+{
+	const bool was_active = (calibration_index_ != INVALID_INDEX) || is_finished;
+
+	if(calibration_index_ != INVALID_INDEX)
+	{
+		calibrations_[calibration_index_].stop_calibration();
+	}
+
+	calibration_index_ = INVALID_INDEX;
+	pending_mask_ = 0;
+	is_active_.store(false, std::memory_order_relaxed);
+
+	if(is_finished)
+	{
+		working_results_.sessions_++;
+		results_.write(working_results_);
+		finished_sessions_.store(working_results_.sessions_, std::memory_order_release);
+	}
+
+	if(was_active)
+	{
+		publish_target(now_us);
+	}
+}
+
+void GazeCalibrationSession::publish_target(const int64_t now_us)
+{
+	GazeCalibrationTarget target;
+	target.calibration_index_ = calibration_index_;
+	target.shown_time_us_ = now_us;
+
+	if(calibration_index_ != INVALID_INDEX)
+	{
+		const GazeCalibration& calibration = calibrations_[calibration_index_];
+		target.pose_ = calibration.get_calibration_cube();
+		target.raster_index_ = calibration.get_raster_index();
+	}
+
+	stats_.calibration_index_.store(target.calibration_index_, std::memory_order_relaxed);
+	stats_.raster_index_.store(target.raster_index_, std::memory_order_relaxed);
+
+	target_.write(target);
+}
+
+GazeTargetPose GazeCalibrationSession::get_calibration_cube() const
+{
+	GazeCalibrationTarget target;
+	return get_target(target) ? target.pose_ : GazeTargetPose();
+}
+
+} // BVR
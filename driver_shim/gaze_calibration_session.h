@@ -0,0 +1,206 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef GAZE_CALIBRATION_SESSION_H
+#define GAZE_CALIBRATION_SESSION_H
+
+#include "defines.h"
+#include "gaze_calibration.h"
+#include "gaze_pipeline.h"
+#include "gaze_poll_scheduler.h"
+#include "gaze_seqlock.h"
+#include "gaze_slot_pool.h"
+#include "psvr2_protocol.h"
+
+#include <atomic>
+#include <stdint.h>
+#include <string>
+#include <thread>
+
+#define CALIBRATION_SESSION_QUEUE_CAPACITY 256      // Samples, about two seconds at the server's rate. Power of two.
+#define CALIBRATION_SETTLE_US 400000                // Samples this soon after the target moved are ignored, the eyes are still on their way
+#define CALIBRATION_POINT_TIMEOUT_US 3000000        // A target that hasn't collected its samples by then is skipped
+#define CALIBRATION_SESSION_INTERVAL_US 10000       // How often the session thread wakes up during a session
+
+namespace BVR
+{
+	// One sample as the server sent it (before the pipeline), stamped with the update thread's steady clock.
+	struct GazeCalibrationSample
+	{
+		int64_t time_us_ = 0;
+		AllXRGazeStates gazes_;
+	};
+
+	// Lock-free ring from the update thread (the only producer) to the session thread (the only consumer).
+	// Never waits: when the consumer falls a whole ring behind, new samples are dropped.
+	class GazeCalibrationSampleQueue
+	{
+	public:
+		bool push(const GazeCalibrationSample& sample);
+		bool pop(GazeCalibrationSample& sample);
+
+		// Consumer only, drops everything queued so far.
+		void clear();
+
+	private:
+		alignas(GAZE_CACHE_LINE_SIZE) std::atomic<uint64_t> write_index_ = 0;
+		alignas(GAZE_CACHE_LINE_SIZE) std::atomic<uint64_t> read_index_ = 0;
+
+		GazeCalibrationSample samples_[CALIBRATION_SESSION_QUEUE_CAPACITY];
+	};
+
+	static_assert((CALIBRATION_SESSION_QUEUE_CAPACITY & (CALIBRATION_SESSION_QUEUE_CAPACITY - 1)) == 0, "CALIBRATION_SESSION_QUEUE_CAPACITY must be a power of two");
+
+	// Where the render side should draw the target, and which calibration it's for.
+	struct GazeCalibrationTarget
+	{
+		GazeTargetPose pose_;
+		int32_t calibration_index_ = INVALID_INDEX; // LEFT / RIGHT / COMBINED_CALIBRATION_INDEX, INVALID_INDEX outside sessions
+		int32_t raster_index_ = 0;
+		int64_t shown_time_us_ = 0;                 // When the target moved there
+	};
+
+	// What the last finished session solved. The update thread copies the matrices into the tracker.
+	struct GazeCalibrationResults
+	{
+		uint64_t sessions_ = 0;                     // Finished sessions, stopped ones don't count
+		uint32_t solved_mask_ = 0;                  // Bit per calibration index
+		float matrices_[NUM_CALIBRATIONS][9] = {};
+	};
+
+	// Each counter has a single writer, readable from anywhere.
+	struct GazeCalibrationSessionStats
+	{
+		std::atomic<int> calibration_index_ = INVALID_INDEX;
+		std::atomic<int> raster_index_ = 0;
+
+		std::atomic<uint64_t> sessions_ = 0;        // Started
+		std::atomic<uint64_t> samples_ = 0;         // Taken into a raster point
+		std::atomic<uint64_t> settling_ = 0;        // Ignored, too soon after the target moved
+		std::atomic<uint64_t> skipped_points_ = 0;  // Timed out before collecting their samples
+		std::atomic<uint64_t> dropped_ = 0;         // Queue full, written by the update thread
+
+		void reset()
+		{
+			sessions_.store(0, std::memory_order_relaxed);
+			samples_.store(0, std::memory_order_relaxed);
+			settling_.store(0, std::memory_order_relaxed);
+			skipped_points_.store(0, std::memory_order_relaxed);
+			dropped_.store(0, std::memory_order_relaxed);
+		}
+	};
+
+	// Runs calibrations away from the update and render threads. While a session is active the update thread
+	// queues the raw samples it receives, and that's all it does. The session thread takes them off the
+	// queue, moves the target on the wall clock (CALIBRATION_SETTLE_US, then CALIBRATION_SAMPLES_PER_POINT
+	// samples or CALIBRATION_POINT_TIMEOUT_US), solves and saves. The render side reads the target through a
+	// seqlock, the update thread picks up the solved matrices between polls.
+	//
+	// process() is the whole engine and takes the time explicitly, so it can be driven without the thread
+	// against a synthetic stream.
+	class GazeCalibrationSession
+	{
+	public:
+		GazeCalibrationSession();
+		~GazeCalibrationSession();
+
+		// Where the calibrations are saved, as calibration_left/right/combined.txt. Empty doesn't save.
+		// Set it before the session thread starts.
+		void set_directory(const std::string& directory);
+
+		// The session thread sleeps until a session starts. Owner thread only.
+		void start_thread();
+		void stop_thread();
+
+		// Any thread, takes effect on the next process(). Per eye calibrates left then right, combined comes last.
+		void start(const bool per_eye_gazes, const bool combined_gaze);
+		void stop();
+
+		bool is_active() const { return is_active_.load(std::memory_order_relaxed); }
+
+		// Update thread, for every new sample. A relaxed load outside sessions.
+		void add_sample(const int64_t time_us, const AllXRGazeStates& gazes)
+		{
+			if(is_active_.load(std::memory_order_relaxed))
+			{
+				GazeCalibrationSample sample;
+				sample.time_us_ = time_us;
+				sample.gazes_ = gazes;
+
+				if(!queue_.push(sample))
+				{
+					stats_.dropped_.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+		}
+
+		// Session thread (or whoever drives it instead): applies start / stop, takes the queued samples,
+		// moves the target.
+		void process(const int64_t now_us);
+
+		// Any thread, never waits. The default pose outside sessions.
+		GazeTargetPose get_calibration_cube() const;
+		bool get_target(GazeCalibrationTarget& target) const { return target_.read(target); }
+
+		// Any thread. Compare get_num_finished_sessions() with what was applied before reading the results.
+		uint64_t get_num_finished_sessions() const { return finished_sessions_.load(std::memory_order_acquire); }
+		bool get_results(GazeCalibrationResults& results) const { return results_.read(results); }
+
+		GazeCalibrationSessionStats& get_stats() { return stats_; }
+		const GazeCalibrationSessionStats& get_stats() const { return stats_; }
+
+	private:
+		void run();
+
+		void begin_next_calibration(const int64_t now_us);
+		void next_point(const int64_t now_us);
+		void end_session(const int64_t now_us, const bool is_finished);
+		void publish_target(const int64_t now_us);
+
+		std::atomic<uint32_t> request_ = 0;
+		std::atomic<bool> is_active_ = false;
+		std::atomic<uint64_t> finished_sessions_ = 0;
+
+		GazeCalibrationSampleQueue queue_;
+		GazeSeqlock<GazeCalibrationTarget> target_;
+		GazeSeqlock<GazeCalibrationResults> results_;
+
+		// Session thread only
+		GazeCalibration calibrations_[NUM_CALIBRATIONS];
+		uint32_t pending_mask_ = 0;
+		int calibration_index_ = INVALID_INDEX;
+		int64_t point_start_us_ = 0;
+		GazeCalibrationResults working_results_;
+
+		GazeCalibrationSessionStats stats_;
+
+		std::thread thread_;
+		std::atomic<bool> is_running_ = false;
+		GazePollWaiter waiter_;
+	};
+}
+
+#endif // GAZE_CALIBRATION_SESSION_H
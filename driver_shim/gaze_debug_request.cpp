@@ -0,0 +1,664 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "gaze_debug_request.h"
+#include "gaze_flight_recorder.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GAZE_DEBUG_REQUEST_MAX_LENGTH 256
+#define GAZE_DEBUG_REQUEST_MAX_TOKENS 8
+
+namespace BVR
+{
+
+namespace
+{
+	enum class GazeSettingType
+	{
+		BOOL_,
+		INT_,
+	};
+
+	struct GazeSettingInfo
+	{
+		const char* key_;
+		GazeSettingType type_;
+	};
+
+	// The keys ReloadShimSettings() reads, except the pipe name and replay file which aren't worth changing at runtime.
+	const GazeSettingInfo GAZE_SETTINGS[] =
+	{
+		{ "pollingRateMs", GazeSettingType::INT_ },
+		{ "idlePollingRateMs", GazeSettingType::INT_ },
+		{ "standbyPollingRateMs", GazeSettingType::INT_ },
+		{ "idleTimeoutMs", GazeSettingType::INT_ },
+		{ "adaptivePolling", GazeSettingType::BOOL_ },
+		{ "adaptivePollingGuardUs", GazeSettingType::INT_ },
+		{ "deduplicateSamples", GazeSettingType::BOOL_ },
+		{ "keepAliveIntervalMs", GazeSettingType::INT_ },
+		{ "telemetryEnabled", GazeSettingType::BOOL_ },
+		{ "gazeBroadcastEnabled", GazeSettingType::BOOL_ },
+		{ "eyeTrackingEnabled", GazeSettingType::BOOL_ },
+		{ "combinedGaze", GazeSettingType::BOOL_ },
+		{ "perEyeGazes", GazeSettingType::BOOL_ },
+		{ "applyCalibration", GazeSettingType::BOOL_ },
+		{ "adaptiveSmoothing", GazeSettingType::BOOL_ },
+		{ "medianFilter", GazeSettingType::BOOL_ },
+		{ "socialGazes", GazeSettingType::BOOL_ },
+		{ "updateThreadPriority", GazeSettingType::INT_ },
+		{ "updateThreadAffinityMask", GazeSettingType::INT_ },
+		{ "highResolutionTimer", GazeSettingType::BOOL_ },
+		{ "gazeSource", GazeSettingType::INT_ },
+	};
+
+	// Appends to a caller owned buffer, remembers if anything didn't fit instead of failing each call.
+	class GazeJsonWriter
+	{
+	public:
+		GazeJsonWriter(char* buffer, const uint32_t size) : buffer_(buffer), size_(size) {}
+
+		void append(const char* format, ...)
+		{
+			const size_t available = (length_ < size_) ? (size_ - length_) : 0;
+
+			va_list args;
+			va_start(args, format);
+			const int written = vsnprintf((available > 0) ? buffer_ + length_ : nullptr, available, format, args);
+			va_end(args);
+
+			if(written > 0)
+			{
+				length_ += (size_t)written;
+			}
+		}
+
+		void append_string(const char* text)
+		{
+			append("\"");
+
+			for(const char* character = text; *character != '\0'; character++)
+			{
+				if(*character == '"' || *character == '\\')
+				{
+					append("\\%c", *character);
+				}
+				else if((unsigned char)*character < 0x20)
+				{
+					append("\\u%04x", (unsigned int)(unsigned char)*character);
+				}
+				else
+				{
+					append("%c", *character);
+				}
+			}
+
+			append("\"");
+		}
+
+		void append_histogram(const char* name, const GazeLatencyHistogram& histogram)
+		{
+			append("\"%s\":{\"count\":%llu,\"mean\":%.1f,\"p50\":%lld,\"p90\":%lld,\"p99\":%lld,\"max\":%lld,\"buckets\":[",
+				name,
+				(unsigned long long)histogram.get_count(),
+				histogram.get_mean_us(),
+				(long long)histogram.get_percentile_us(50.0),
+				(long long)histogram.get_percentile_us(90.0),
+				(long long)histogram.get_percentile_us(99.0),
+				(long long)histogram.get_max_us());
+
+			// Trailing empty buckets are left out, bucket k holds values up to 2^k - 1 us
+			int num_buckets = GazeLatencyHistogram::NUM_BUCKETS;
+
+			while(num_buckets > 0 && histogram.get_bucket(num_buckets - 1) == 0)
+			{
+				num_buckets--;
+			}
+
+			for(int bucket = 0; bucket < num_buckets; bucket++)
+			{
+				append((bucket > 0) ? ",%llu" : "%llu", (unsigned long long)histogram.get_bucket(bucket));
+			}
+
+			append("]}");
+		}
+
+		bool has_overflowed() const { return length_ >= size_; }
+		size_t get_length() const { return length_; }
+
+	private:
+		char* buffer_;
+		size_t size_;
+		size_t length_ = 0;
+	};
+
+	// Splits the request in place on whitespace.
+	int tokenize(char* request, char* tokens[GAZE_DEBUG_REQUEST_MAX_TOKENS])
+	{
+		int num_tokens = 0;
+		char* cursor = request;
+
+		while(*cursor != '\0' && num_tokens < GAZE_DEBUG_REQUEST_MAX_TOKENS)
+		{
+			while(*cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r')
+			{
+				*cursor++ = '\0';
+			}
+
+			if(*cursor == '\0')
+			{
+				break;
+			}
+
+			tokens[num_tokens++] = cursor;
+
+			while(*cursor != '\0' && *cursor != ' ' && *cursor != '\t' && *cursor != '\n' && *cursor != '\r')
+			{
+				cursor++;
+			}
+		}
+
+		return num_tokens;
+	}
+
+	bool parse_bool(const char* text, bool& value)
+	{
+		if(strcmp(text, "true") == 0 || strcmp(text, "on") == 0 || strcmp(text, "1") == 0)
+		{
+			value = true;
+			return true;
+		}
+
+		if(strcmp(text, "false") == 0 || strcmp(text, "off") == 0 || strcmp(text, "0") == 0)
+		{
+			value = false;
+			return true;
+		}
+
+		return false;
+	}
+
+	bool parse_int(const char* text, int& value)
+	{
+		char* end = nullptr;
+		const long parsed = strtol(text, &end, 10);
+
+		if(end == text || *end != '\0' || parsed < -2147483647L || parsed > 2147483647L)
+		{
+			return false;
+		}
+
+		value = (int)parsed;
+		return true;
+	}
+
+	const GazeSettingInfo* find_setting(const char* key)
+	{
+		for(const GazeSettingInfo& setting : GAZE_SETTINGS)
+		{
+			if(strcmp(setting.key_, key) == 0)
+			{
+				return &setting;
+			}
+		}
+
+		return nullptr;
+	}
+
+	void write_settings(GazeJsonWriter& writer, const ShimConfig& config)
+	{
+		writer.append("\"settings\":{\"generation\":%llu,\"pollingRateMs\":%d,\"idlePollingRateMs\":%d,\"standbyPollingRateMs\":%d,"
+			"\"idleTimeoutMs\":%d,\"adaptivePolling\":%s,\"adaptivePollingGuardUs\":%d,\"deduplicateSamples\":%s,"
+			"\"keepAliveIntervalMs\":%d,\"telemetryEnabled\":%s,\"gazeBroadcastEnabled\":%s,\"eyeTrackingEnabled\":%s,\"combinedGaze\":%s,\"perEyeGazes\":%s,\"applyCalibration\":%s,"
+			"\"adaptiveSmoothing\":%s,\"medianFilter\":%s,\"socialGazes\":%s,\"updateThreadPriority\":%d,\"updateThreadAffinityMask\":%d,\"highResolutionTimer\":%s,\"gazeSource\":%d,\"serverPipeName\":",
+			(unsigned long long)config.generation_,
+			config.polling_rate_ms_,
+			config.idle_polling_rate_ms_,
+			config.standby_polling_rate_ms_,
+			config.idle_timeout_ms_,
+			config.adaptive_polling_ ? "true" : "false",
+			config.adaptive_polling_guard_us_,
+			config.deduplicate_samples_ ? "true" : "false",
+			config.keep_alive_interval_ms_,
+			config.telemetry_enabled_ ? "true" : "false",
+			config.broadcast_enabled_ ? "true" : "false",
+			config.eye_tracking_enabled_ ? "true" : "false",
+			config.combined_gaze_ ? "true" : "false",
+			config.per_eye_gazes_ ? "true" : "false",
+			config.apply_calibration_ ? "true" : "false",
+			config.adaptive_smoothing_ ? "true" : "false",
+			config.median_filter_ ? "true" : "false",
+			config.social_gazes_ ? "true" : "false",
+			config.update_thread_priority_,
+			config.update_thread_affinity_mask_,
+			config.high_resolution_timer_ ? "true" : "false",
+			config.gaze_source_);
+
+		writer.append_string(config.server_pipe_name_);
+		writer.append(",\"replayFile\":");
+		writer.append_string(config.replay_file_);
+		writer.append("}");
+	}
+
+	void write_stats(GazeJsonWriter& writer, const GazeDebugSources& sources)
+	{
+		writer.append("{\"ok\":true");
+
+		if(sources.loop_)
+		{
+			const GazeLoopStats& loop_stats = sources.loop_->get_loop_stats();
+			const GazeCadenceStats& cadence_stats = sources.loop_->get_scheduler().get_cadence_stats();
+
+			writer.append(",\"connection\":{\"connected\":%s,\"connects\":%llu,\"disconnects\":%llu,\"receive_failures\":%llu,"
+				"\"power_state\":\"%s\",\"applied_generation\":%llu,\"source\":\"%s\"}",
+				loop_stats.connected_.load(std::memory_order_relaxed) ? "true" : "false",
+				(unsigned long long)loop_stats.connects_.load(std::memory_order_relaxed),
+				(unsigned long long)loop_stats.disconnects_.load(std::memory_order_relaxed),
+				(unsigned long long)loop_stats.receive_failures_.load(std::memory_order_relaxed),
+				get_power_state_name((GazePowerState)loop_stats.power_state_.load(std::memory_order_relaxed)),
+				(unsigned long long)loop_stats.applied_generation_.load(std::memory_order_relaxed),
+				get_gaze_source_name((GazeSourceType)loop_stats.gaze_source_.load(std::memory_order_relaxed)));
+
+#if ENABLE_PSVR2_EYE_TRACKING
+			const GazePublishStats& publish_stats = sources.loop_->get_publish_stats();
+
+			writer.append(",\"samples\":{\"published\":%llu,\"deduplicated\":%llu,\"stale\":%llu,\"missed\":%llu}",
+				(unsigned long long)publish_stats.published_.load(std::memory_order_relaxed),
+				(unsigned long long)publish_stats.deduplicated_.load(std::memory_order_relaxed),
+				(unsigned long long)publish_stats.stale_.load(std::memory_order_relaxed),
+				(unsigned long long)publish_stats.missed_.load(std::memory_order_relaxed));
+
+			const GazeSanitizeStats& sanitize_stats = sources.loop_->get_sanitize_stats();
+
+			writer.append(",\"sanitize\":{\"non_finite\":%llu,\"renormalized\":%llu,\"too_fast\":%llu,\"spikes\":%llu}",
+				(unsigned long long)sanitize_stats.non_finite_.load(std::memory_order_relaxed),
+				(unsigned long long)sanitize_stats.renormalized_.load(std::memory_order_relaxed),
+				(unsigned long long)sanitize_stats.too_fast_.load(std::memory_order_relaxed),
+				(unsigned long long)sanitize_stats.spikes_.load(std::memory_order_relaxed));
+
+			const ResponseDecodeStats& decode_stats = sources.loop_->get_decode_stats();
+
+			writer.append(",\"decode\":{\"bad_size\":%llu,\"bad_type\":%llu,\"bad_bool\":%llu,\"unexpected_type\":%llu}",
+				(unsigned long long)decode_stats.bad_size_.load(std::memory_order_relaxed),
+				(unsigned long long)decode_stats.bad_type_.load(std::memory_order_relaxed),
+				(unsigned long long)decode_stats.bad_bool_.load(std::memory_order_relaxed),
+				(unsigned long long)decode_stats.unexpected_type_.load(std::memory_order_relaxed));
+
+			const GazeCalibrationSession& calibration_session = sources.loop_->get_calibration_session();
+			const GazeCalibrationSessionStats& calibration_stats = calibration_session.get_stats();
+			const int calibration_index = calibration_stats.calibration_index_.load(std::memory_order_relaxed);
+
+			writer.append(",\"calibration\":{\"active\":%s,\"calibrating\":\"%s\",\"point\":%d,\"sessions\":%llu,\"finished\":%llu,"
+				"\"samples\":%llu,\"settling\":%llu,\"skipped_points\":%llu,\"dropped\":%llu}",
+				calibration_session.is_active() ? "true" : "false",
+				(calibration_index == LEFT_CALIBRATION_INDEX) ? "left" : (calibration_index == RIGHT_CALIBRATION_INDEX) ? "right" :
+					(calibration_index == COMBINED_CALIBRATION_INDEX) ? "combined" : "none",
+				calibration_stats.raster_index_.load(std::memory_order_relaxed),
+				(unsigned long long)calibration_stats.sessions_.load(std::memory_order_relaxed),
+				(unsigned long long)calibration_session.get_num_finished_sessions(),
+				(unsigned long long)calibration_stats.samples_.load(std::memory_order_relaxed),
+				(unsigned long long)calibration_stats.settling_.load(std::memory_order_relaxed),
+				(unsigned long long)calibration_stats.skipped_points_.load(std::memory_order_relaxed),
+				(unsigned long long)calibration_stats.dropped_.load(std::memory_order_relaxed));
+#endif
+
+			writer.append(",\"polls\":{\"total\":%llu,\"empty\":%llu,\"locked\":%llu,\"lock_losses\":%llu,\"server_period_us\":%lld}",
+				(unsigned long long)cadence_stats.polls_.load(std::memory_order_relaxed),
+				(unsigned long long)cadence_stats.empty_polls_.load(std::memory_order_relaxed),
+				(unsigned long long)cadence_stats.locked_polls_.load(std::memory_order_relaxed),
+				(unsigned long long)cadence_stats.lock_losses_.load(std::memory_order_relaxed),
+				(long long)cadence_stats.period_us_.load(std::memory_order_relaxed));
+
+			const GazeQualityStats& quality_stats = sources.loop_->get_quality_stats();
+
+			writer.append(",\"quality\":{\"validity_ratio\":%.3f,\"sample_rate_hz\":%.1f,\"precision_rms_deg\":%.3f,\"dropouts\":%u,"
+				"\"longest_dropout_us\":%lld,\"current_dropout_us\":%lld,\"smoothing_alpha\":%.3f}",
+				quality_stats.validity_ratio_.load(std::memory_order_relaxed),
+				quality_stats.sample_rate_hz_.load(std::memory_order_relaxed),
+				quality_stats.precision_rms_deg_.load(std::memory_order_relaxed),
+				quality_stats.dropouts_.load(std::memory_order_relaxed),
+				(long long)quality_stats.longest_dropout_us_.load(std::memory_order_relaxed),
+				(long long)quality_stats.current_dropout_us_.load(std::memory_order_relaxed),
+				quality_stats.smoothing_alpha_.load(std::memory_order_relaxed));
+
+			writer.append(",");
+			writer.append_histogram("wakeup_lateness_us", loop_stats.wakeup_lateness_us_);
+			writer.append(",");
+			writer.append_histogram("poll_duration_us", loop_stats.poll_duration_us_);
+		}
+
+		if(sources.thread_stats_)
+		{
+			const GazeThreadStats& thread_stats = *sources.thread_stats_;
+
+			writer.append(",\"thread\":{\"priority\":\"%s\",\"affinity_mask\":%llu,\"high_resolution_timer\":%s,\"apply_failures\":%llu,"
+				"\"polls\":%llu,\"late_wakeups\":%llu,\"off_cpu_polls\":%llu,\"off_cpu_us\":%llu,\"involuntary_switches\":%llu}",
+				get_thread_priority_name((GazeThreadPriority)thread_stats.priority_.load(std::memory_order_relaxed)),
+				(unsigned long long)thread_stats.affinity_mask_.load(std::memory_order_relaxed),
+				thread_stats.high_resolution_timer_.load(std::memory_order_relaxed) ? "true" : "false",
+				(unsigned long long)thread_stats.apply_failures_.load(std::memory_order_relaxed),
+				(unsigned long long)thread_stats.polls_.load(std::memory_order_relaxed),
+				(unsigned long long)thread_stats.late_wakeups_.load(std::memory_order_relaxed),
+				(unsigned long long)thread_stats.off_cpu_polls_.load(std::memory_order_relaxed),
+				(unsigned long long)thread_stats.off_cpu_us_.load(std::memory_order_relaxed),
+				(unsigned long long)thread_stats.involuntary_switches_.load(std::memory_order_relaxed));
+		}
+
+		if(sources.config_store_)
+		{
+			writer.append(",");
+			write_settings(writer, sources.config_store_->get());
+		}
+
+		writer.append("}");
+	}
+
+	void write_error(GazeJsonWriter& writer, const char* error)
+	{
+		writer.append("{\"ok\":false,\"error\":");
+		writer.append_string(error);
+		writer.append("}");
+	}
+
+	void write_committed(GazeJsonWriter& writer, const GazeDebugSources& sources)
+	{
+		const uint64_t generation = sources.config_store_ ? sources.config_store_->get().generation_ : 0;
+		writer.append("{\"ok\":true,\"generation\":%llu}", (unsigned long long)generation);
+	}
+
+	void handle_set(GazeJsonWriter& writer, char** arguments, const int num_arguments, const GazeDebugSources& sources)
+	{
+		if(num_arguments != 2)
+		{
+			write_error(writer, "usage: set <key> <value>");
+			return;
+		}
+
+		const GazeSettingInfo* setting = find_setting(arguments[0]);
+
+		if(!setting)
+		{
+			write_error(writer, "unknown setting");
+			return;
+		}
+
+		bool written = false;
+
+		if(setting->type_ == GazeSettingType::BOOL_)
+		{
+			bool value = false;
+
+			if(!parse_bool(arguments[1], value))
+			{
+				write_error(writer, "expected true or false");
+				return;
+			}
+
+			written = sources.settings_writer_->write_bool(setting->key_, value);
+		}
+		else
+		{
+			int value = 0;
+
+			if(!parse_int(arguments[1], value))
+			{
+				write_error(writer, "expected an integer");
+				return;
+			}
+
+			written = sources.settings_writer_->write_int(setting->key_, value);
+		}
+
+		if(!written)
+		{
+			write_error(writer, "could not write the setting");
+			return;
+		}
+
+		sources.settings_writer_->commit();
+		write_committed(writer, sources);
+	}
+
+	void handle_calibrate(GazeJsonWriter& writer, char** arguments, const int num_arguments, const GazeDebugSources& sources)
+	{
+		const bool is_start = (num_arguments == 1) && (strcmp(arguments[0], "start") == 0);
+		const bool is_stop = (num_arguments == 1) && (strcmp(arguments[0], "stop") == 0);
+
+		if(!is_start && !is_stop)
+		{
+			write_error(writer, "usage: calibrate <start|stop>");
+			return;
+		}
+
+#if ENABLE_PSVR2_EYE_TRACKING
+		if(!sources.loop_)
+		{
+			write_error(writer, "no update loop");
+			return;
+		}
+
+		// Only queues the request, the session thread picks it up
+		GazeCalibrationSession& session = sources.loop_->get_calibration_session();
+
+		if(is_start)
+		{
+			const ShimConfig default_config;
+			const ShimConfig& config = sources.config_store_ ? sources.config_store_->get() : default_config;
+			session.start(config.per_eye_gazes_, config.combined_gaze_);
+		}
+		else
+		{
+			session.stop();
+		}
+
+		writer.append("{\"ok\":true}");
+#else
+		write_error(writer, "eye tracking isn't built in");
+#endif
+	}
+
+	void handle_mode(GazeJsonWriter& writer, char** arguments, const int num_arguments, const GazeDebugSources& sources)
+	{
+		bool combined_gaze = false;
+		bool per_eye_gazes = false;
+
+		if(num_arguments < 1 || num_arguments > 2)
+		{
+			write_error(writer, "usage: mode <combined|per_eye|both> [calibrated|raw]");
+			return;
+		}
+
+		if(strcmp(arguments[0], "combined") == 0)
+		{
+			combined_gaze = true;
+		}
+		else if(strcmp(arguments[0], "per_eye") == 0)
+		{
+			per_eye_gazes = true;
+		}
+		else if(strcmp(arguments[0], "both") == 0)
+		{
+			combined_gaze = true;
+			per_eye_gazes = true;
+		}
+		else
+		{
+			write_error(writer, "unknown mode");
+			return;
+		}
+
+		const bool has_calibration = (num_arguments == 2);
+		const bool apply_calibration = has_calibration && (strcmp(arguments[1], "calibrated") == 0);
+
+		if(has_calibration && !apply_calibration && strcmp(arguments[1], "raw") != 0)
+		{
+			write_error(writer, "expected calibrated or raw");
+			return;
+		}
+
+		GazeSettingsWriter& settings_writer = *sources.settings_writer_;
+		bool written = settings_writer.write_bool("combinedGaze", combined_gaze) && settings_writer.write_bool("perEyeGazes", per_eye_gazes);
+
+		if(written && has_calibration)
+		{
+			written = settings_writer.write_bool("applyCalibration", apply_calibration);
+		}
+
+		if(!written)
+		{
+			write_error(writer, "could not write the setting");
+			return;
+		}
+
+		settings_writer.commit();
+		write_committed(writer, sources);
+	}
+}
+
+bool handle_gaze_debug_request(const char* request, char* response, const uint32_t response_size, const GazeDebugSources& sources)
+{
+	if(!request)
+	{
+		return false;
+	}
+
+	const size_t prefix_length = strlen(GAZE_DEBUG_REQUEST_PREFIX);
+
+	if(strncmp(request, GAZE_DEBUG_REQUEST_PREFIX, prefix_length) != 0 ||
+		(request[prefix_length] != '\0' && request[prefix_length] != ' ' && request[prefix_length] != '\t'))
+	{
+		return false;
+	}
+
+	if(!response || response_size == 0)
+	{
+		return true;
+	}
+
+	char request_copy[GAZE_DEBUG_REQUEST_MAX_LENGTH];
+	snprintf(request_copy, sizeof(request_copy), "%s", request + prefix_length);
+
+	char* tokens[GAZE_DEBUG_REQUEST_MAX_TOKENS] = {};
+	const int num_tokens = tokenize(request_copy, tokens);
+	const char* command = (num_tokens > 0) ? tokens[0] : "stats";
+
+	GazeJsonWriter writer(response, response_size);
+
+	if(strcmp(command, "stats") == 0)
+	{
+		write_stats(writer, sources);
+	}
+	else if(strcmp(command, "reset_stats") == 0)
+	{
+		// Writers only ever add to these, zeroing them from here can at worst lose an increment in flight
+		if(sources.loop_)
+		{
+			sources.loop_->get_loop_stats().reset();
+			sources.loop_->get_scheduler().get_cadence_stats().reset();
+			sources.loop_->get_scheduler().get_stats().reset();
+#if ENABLE_PSVR2_EYE_TRACKING
+			sources.loop_->get_publish_stats().reset();
+			sources.loop_->get_sanitize_stats().reset();
+			sources.loop_->get_decode_stats().reset();
+			sources.loop_->get_calibration_session().get_stats().reset();
+#endif
+		}
+
+		if(sources.thread_stats_)
+		{
+			sources.thread_stats_->reset();
+		}
+
+		writer.append("{\"ok\":true}");
+	}
+	else if((strcmp(command, "set") == 0 || strcmp(command, "mode") == 0) && !sources.settings_writer_)
+	{
+		write_error(writer, "settings are read only");
+	}
+	else if(strcmp(command, "set") == 0)
+	{
+		handle_set(writer, tokens + 1, num_tokens - 1, sources);
+	}
+	else if(strcmp(command, "mode") == 0)
+	{
+		handle_mode(writer, tokens + 1, num_tokens - 1, sources);
+	}
+	else if(strcmp(command, "calibrate") == 0)
+	{
+		handle_calibrate(writer, tokens + 1, num_tokens - 1, sources);
+	}
+	else if(strcmp(command, "dump_flight") == 0)
+	{
+		if(!sources.flight_recorder_)
+		{
+			write_error(writer, "no flight recorder");
+		}
+		else if(!sources.flight_recorder_->dump(GazeFlightDumpReason::REQUEST_))
+		{
+			write_error(writer, "could not write the dump");
+		}
+		else
+		{
+			writer.append("{\"ok\":true,\"records\":%llu,\"dumps\":%llu}",
+				(unsigned long long)sources.flight_recorder_->get_num_recorded(), (unsigned long long)sources.flight_recorder_->get_num_dumps());
+		}
+	}
+	else if(strcmp(command, "help") == 0)
+	{
+		writer.append("{\"ok\":true,\"commands\":[\"stats\",\"reset_stats\",\"set <key> <value>\","
+			"\"mode <combined|per_eye|both> [calibrated|raw]\",\"calibrate <start|stop>\",\"dump_flight\",\"help\"],\"settings\":[");
+
+		for(const GazeSettingInfo& setting : GAZE_SETTINGS)
+		{
+			writer.append((&setting == GAZE_SETTINGS) ? "\"%s\"" : ",\"%s\"", setting.key_);
+		}
+
+		writer.append("]}");
+	}
+	else
+	{
+		write_error(writer, "unknown command, try help");
+	}
+
+	if(writer.has_overflowed())
+	{
+		// Half a JSON document is worse than none, say how much room it needed instead
+		GazeJsonWriter retry(response, response_size);
+		retry.append("{\"ok\":false,\"error\":\"response buffer too small\",\"needed\":%llu}", (unsigned long long)writer.get_length() + 1);
+
+		if(retry.has_overflowed())
+		{
+			response[0] = '\0';
+		}
+	}
+
+	return true;
+}
+
+} // BVR
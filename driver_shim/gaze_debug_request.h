@@ -0,0 +1,81 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef GAZE_DEBUG_REQUEST_H
+#define GAZE_DEBUG_REQUEST_H
+
+#include "defines.h"
+#include "gaze_update_loop.h"
+#include "shim_config.h"
+
+#include <stdint.h>
+
+// First word of every request the shim answers itself, anything else goes to the real driver.
+#define GAZE_DEBUG_REQUEST_PREFIX "psvr2_shim"
+
+namespace BVR
+{
+	class GazeFlightRecorder;
+
+	// Where "set" and "mode" requests write to. The driver persists them in its settings section and reloads,
+	// so a runtime change goes through exactly the same path as editing steamvr.vrsettings.
+	class GazeSettingsWriter
+	{
+	public:
+		virtual ~GazeSettingsWriter() {}
+
+		virtual bool write_bool(const char* key, const bool value) = 0;
+		virtual bool write_int(const char* key, const int value) = 0;
+
+		// Called once after a request's writes, makes them take effect.
+		virtual void commit() = 0;
+	};
+
+	// What a debug request can look at. Everything here is read through atomics (or the config store's
+	// snapshot pointer), so answering never waits for or pauses the update thread.
+	struct GazeDebugSources
+	{
+		GazeUpdateLoop* loop_ = nullptr;
+		const ShimConfigStore* config_store_ = nullptr;
+		GazeSettingsWriter* settings_writer_ = nullptr;  // Null makes the endpoint read only
+		const GazeFlightRecorder* flight_recorder_ = nullptr;
+		GazeThreadStats* thread_stats_ = nullptr;
+	};
+
+	// Answers DebugRequest()s starting with GAZE_DEBUG_REQUEST_PREFIX:
+	//   psvr2_shim stats                  counters, latency histograms, connection state and settings
+	//   psvr2_shim reset_stats            zeroes the counters and histograms
+	//   psvr2_shim set <key> <value>      changes one setting, same keys as the settings section
+	//   psvr2_shim mode <combined|per_eye|both> [calibrated|raw]
+	//   psvr2_shim calibrate <start|stop> calibrates the enabled gazes on the calibration session thread
+	//   psvr2_shim dump_flight            writes the flight recorder to flight_request.psfr
+	//   psvr2_shim help
+	// Responses are JSON. Returns false (and leaves the buffer alone) for requests meant for the real driver.
+	// Doesn't allocate.
+	bool handle_gaze_debug_request(const char* request, char* response, const uint32_t response_size, const GazeDebugSources& sources);
+}
+
+#endif // GAZE_DEBUG_REQUEST_H
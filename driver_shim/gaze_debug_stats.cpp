@@ -0,0 +1,118 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "gaze_debug_stats.h"
+
+namespace BVR
+{
+
+int GazeLatencyHistogram::get_bucket_index(const int64_t value_us)
+{
+	int bucket = 0;
+
+	for(int64_t remainder = value_us; (remainder > 0) && (bucket < NUM_BUCKETS - 1); remainder >>= 1)
+	{
+		bucket++;
+	}
+
+	return bucket;
+}
+
+int64_t GazeLatencyHistogram::get_bucket_upper_bound_us(const int bucket)
+{
+	return (bucket <= 0) ? 0 : ((int64_t)1 << bucket) - 1;
+}
+
+void GazeLatencyHistogram::add(const int64_t value_us)
+{
+	const int64_t clamped_us = (value_us > 0) ? value_us : 0;
+
+	buckets_[get_bucket_index(clamped_us)].fetch_add(1, std::memory_order_relaxed);
+	count_.fetch_add(1, std::memory_order_relaxed);
+	sum_us_.fetch_add((uint64_t)clamped_us, std::memory_order_relaxed);
+	last_us_.store(clamped_us, std::memory_order_relaxed);
+
+	// Single writer, no need for a compare-exchange loop
+	if(clamped_us > max_us_.load(std::memory_order_relaxed))
+	{
+		max_us_.store(clamped_us, std::memory_order_relaxed);
+	}
+}
+
+void GazeLatencyHistogram::reset()
+{
+	for(int bucket = 0; bucket < NUM_BUCKETS; bucket++)
+	{
+		buckets_[bucket].store(0, std::memory_order_relaxed);
+	}
+
+	count_.store(0, std::memory_order_relaxed);
+	sum_us_.store(0, std::memory_order_relaxed);
+	max_us_.store(0, std::memory_order_relaxed);
+	last_us_.store(0, std::memory_order_relaxed);
+}
+
+double GazeLatencyHistogram::get_mean_us() const
+{
+	const uint64_t count = get_count();
+	return (count > 0) ? (double)sum_us_.load(std::memory_order_relaxed) / (double)count : 0.0;
+}
+
+int64_t GazeLatencyHistogram::get_percentile_us(const double percentile) const
+{
+	// Sum the buckets rather than trusting count_, the writer may be between the two increments
+	uint64_t total = 0;
+
+	for(int bucket = 0; bucket < NUM_BUCKETS; bucket++)
+	{
+		total += get_bucket(bucket);
+	}
+
+	if(total == 0)
+	{
+		return 0;
+	}
+
+	const double rank = (percentile / 100.0) * (double)total;
+	uint64_t seen = 0;
+
+	for(int bucket = 0; bucket < NUM_BUCKETS; bucket++)
+	{
+		seen += get_bucket(bucket);
+
+		if((double)seen >= rank && seen > 0)
+		{
+			// The last bucket is open ended, and no percentile is above the largest value anyway
+			const int64_t upper_bound_us = get_bucket_upper_bound_us(bucket);
+			const int64_t max_us = get_max_us();
+			return ((bucket == NUM_BUCKETS - 1) || (max_us < upper_bound_us)) ? max_us : upper_bound_us;
+		}
+	}
+
+	return get_max_us();
+}
+
+} // BVR
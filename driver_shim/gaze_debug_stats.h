@@ -0,0 +1,101 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef GAZE_DEBUG_STATS_H
+#define GAZE_DEBUG_STATS_H
+
+#include "defines.h"
+
+#include <atomic>
+#include <stdint.h>
+
+#define GAZE_LATENCY_HISTOGRAM_BUCKETS 24
+
+namespace BVR
+{
+	// Power of two buckets in microseconds: bucket 0 holds 0 us, bucket k holds [2^(k-1), 2^k) us and the last
+	// one everything above. Coarse, but adding a value is a couple of relaxed increments, so the update thread
+	// can record every poll and another thread can read it at any time.
+	// Written by one thread only, readable from anywhere.
+	class GazeLatencyHistogram
+	{
+	public:
+		static const int NUM_BUCKETS = GAZE_LATENCY_HISTOGRAM_BUCKETS;
+
+		void add(const int64_t value_us);
+		void reset();
+
+		uint64_t get_count() const { return count_.load(std::memory_order_relaxed); }
+		uint64_t get_bucket(const int bucket) const { return buckets_[bucket].load(std::memory_order_relaxed); }
+		int64_t get_max_us() const { return max_us_.load(std::memory_order_relaxed); }
+		int64_t get_last_us() const { return last_us_.load(std::memory_order_relaxed); }
+
+		double get_mean_us() const;
+
+		// Upper bound of the bucket holding the given percentile (0..100), 0 when empty.
+		int64_t get_percentile_us(const double percentile) const;
+
+		static int get_bucket_index(const int64_t value_us);
+		static int64_t get_bucket_upper_bound_us(const int bucket);
+
+	private:
+		std::atomic<uint64_t> buckets_[NUM_BUCKETS] = {};
+		std::atomic<uint64_t> count_ = 0;
+		std::atomic<uint64_t> sum_us_ = 0;
+		std::atomic<int64_t> max_us_ = 0;
+		std::atomic<int64_t> last_us_ = 0;
+	};
+
+	// Connection and loop state the update thread mirrors into atomics for the debug endpoint.
+	// Written by the update thread only, readable from anywhere.
+	struct GazeLoopStats
+	{
+		std::atomic<bool> connected_ = false;
+		std::atomic<int> power_state_ = 0;                // GazePowerState
+		std::atomic<uint64_t> applied_generation_ = 0;    // ShimConfig generation the loop runs with
+		std::atomic<int> gaze_source_ = 0;                // GazeSourceType the tracker talks to
+
+		std::atomic<uint64_t> connects_ = 0;
+		std::atomic<uint64_t> disconnects_ = 0;
+		std::atomic<uint64_t> receive_failures_ = 0;      // Polls that got no answer while connected
+
+		GazeLatencyHistogram wakeup_lateness_us_;         // How late the update thread woke up for a poll
+		GazeLatencyHistogram poll_duration_us_;           // Poll, pipeline and publish
+
+		// Clears the counters, the state mirrors are left alone.
+		void reset()
+		{
+			connects_.store(0, std::memory_order_relaxed);
+			disconnects_.store(0, std::memory_order_relaxed);
+			receive_failures_.store(0, std::memory_order_relaxed);
+
+			wakeup_lateness_us_.reset();
+			poll_duration_us_.reset();
+		}
+	};
+}
+
+#endif // GAZE_DEBUG_STATS_H
@@ -0,0 +1,148 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "gaze_deduplicator.h"
+#include "psvr2_protocol.h"
+
+#include <string.h>
+
+namespace BVR
+{
+
+static const uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ull;
+static const uint64_t FNV_PRIME = 0x100000001b3ull;
+
+static inline uint64_t fnv1a_u32(uint64_t hash, const uint32_t value)
+{
+	for(int byte_index = 0; byte_index < 4; byte_index++)
+	{
+		hash ^= (value >> (byte_index * 8)) & 0xff;
+		hash *= FNV_PRIME;
+	}
+
+	return hash;
+}
+
+static inline uint64_t hash_gaze_state(uint64_t hash, const XRGazeState& gaze)
+{
+	uint32_t bits[3];
+	memcpy(&bits[0], &gaze.direction_.x, sizeof(uint32_t));
+	memcpy(&bits[1], &gaze.direction_.y, sizeof(uint32_t));
+	memcpy(&bits[2], &gaze.direction_.z, sizeof(uint32_t));
+
+	hash = fnv1a_u32(hash, bits[0]);
+	hash = fnv1a_u32(hash, bits[1]);
+	hash = fnv1a_u32(hash, bits[2]);
+	hash = fnv1a_u32(hash, gaze.is_valid_ ? 1 : 0);
+
+	return hash;
+}
+
+uint64_t hash_gaze_states(const AllXRGazeStates& gazes)
+{
+	uint64_t hash = FNV_OFFSET_BASIS;
+
+	hash = hash_gaze_state(hash, gazes.combined_gaze_);
+	hash = hash_gaze_state(hash, gazes.per_eye_gazes_[LEFT]);
+	hash = hash_gaze_state(hash, gazes.per_eye_gazes_[RIGHT]);
+
+	return hash;
+}
+
+GazeSampleVerdict GazeDeduplicator::classify(const AllXRGazeStates& gazes, const bool has_sequence_number, const uint64_t sequence_number)
+{
+	GazeSampleVerdict verdict = GazeSampleVerdict::NEW_;
+	uint64_t sample_delta = 1;
+
+	if(has_sequence_number)
+	{
+		if(has_last_sample_ && last_had_sequence_number_)
+		{
+			if(sequence_number == last_sequence_number_)
+			{
+				verdict = GazeSampleVerdict::DUPLICATE_;
+			}
+			else if(sequence_number < last_sequence_number_)
+			{
+				verdict = GazeSampleVerdict::STALE_;
+			}
+		}
+
+		if(verdict == GazeSampleVerdict::NEW_)
+		{
+			if(has_last_sample_ && last_had_sequence_number_)
+			{
+				sample_delta = sequence_number - last_sequence_number_;
+			}
+
+			last_sequence_number_ = sequence_number;
+		}
+	}
+	else
+	{
+		const uint64_t hash = hash_gaze_states(gazes);
+
+		if(has_last_sample_ && !last_had_sequence_number_ && (hash == last_hash_))
+		{
+			verdict = GazeSampleVerdict::DUPLICATE_;
+		}
+
+		last_hash_ = hash;
+	}
+
+	last_sample_delta_ = (verdict == GazeSampleVerdict::NEW_) ? sample_delta : 0;
+
+	if(verdict == GazeSampleVerdict::NEW_)
+	{
+		has_last_sample_ = true;
+		last_had_sequence_number_ = has_sequence_number;
+
+		if(sample_delta > 1)
+		{
+			stats_.missed_.fetch_add(sample_delta - 1, std::memory_order_relaxed);
+		}
+	}
+	else if(verdict == GazeSampleVerdict::DUPLICATE_)
+	{
+		stats_.deduplicated_.fetch_add(1, std::memory_order_relaxed);
+	}
+	else
+	{
+		stats_.stale_.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	return verdict;
+}
+
+void GazeDeduplicator::reset()
+{
+	has_last_sample_ = false;
+	last_had_sequence_number_ = false;
+	last_sequence_number_ = 0;
+	last_hash_ = 0;
+	last_sample_delta_ = 0;
+}
+
+} // BVR
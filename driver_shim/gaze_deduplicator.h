@@ -0,0 +1,93 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef GAZE_DEDUPLICATOR_H
+#define GAZE_DEDUPLICATOR_H
+
+#include "defines.h"
+
+#include <atomic>
+#include <stdint.h>
+
+namespace BVR
+{
+	struct AllXRGazeStates;
+
+	enum class GazeSampleVerdict
+	{
+		NEW_,        // Never seen before, should be published
+		DUPLICATE_,  // Same sample as last time, publishing it again is redundant
+		STALE_,      // Older than the last sample we saw (sequence number went backwards)
+	};
+
+	// Written by the update thread only, readable from anywhere.
+	struct GazePublishStats
+	{
+		std::atomic<uint64_t> published_ = 0;
+		std::atomic<uint64_t> deduplicated_ = 0;
+		std::atomic<uint64_t> stale_ = 0;
+		std::atomic<uint64_t> missed_ = 0; // Samples the server produced between two we saw (sequence numbers only)
+
+		void reset()
+		{
+			published_.store(0, std::memory_order_relaxed);
+			deduplicated_.store(0, std::memory_order_relaxed);
+			stale_.store(0, std::memory_order_relaxed);
+			missed_.store(0, std::memory_order_relaxed);
+		}
+	};
+
+	// Content hash of the fields we actually publish, so padding bytes coming off the wire don't matter.
+	uint64_t hash_gaze_states(const AllXRGazeStates& gazes);
+
+	// Detects repeated samples. Servers that stamp their responses are compared by sequence number,
+	// older servers fall back to comparing a content hash.
+	class GazeDeduplicator
+	{
+	public:
+		GazeSampleVerdict classify(const AllXRGazeStates& gazes, const bool has_sequence_number, const uint64_t sequence_number);
+
+		// Call whenever the upstream connection is (re)established, sequence numbers restart with the server.
+		void reset();
+
+		// How many samples the server produced since the previous new one (1 when it can't tell).
+		uint64_t get_last_sample_delta() const { return last_sample_delta_; }
+
+		GazePublishStats& get_stats() { return stats_; }
+		const GazePublishStats& get_stats() const { return stats_; }
+
+	private:
+		bool has_last_sample_ = false;
+		bool last_had_sequence_number_ = false;
+		uint64_t last_sequence_number_ = 0;
+		uint64_t last_hash_ = 0;
+		uint64_t last_sample_delta_ = 0;
+
+		GazePublishStats stats_;
+	};
+}
+
+#endif // GAZE_DEDUPLICATOR_H
+
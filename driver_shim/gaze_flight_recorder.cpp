@@ -0,0 +1,529 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "gaze_flight_recorder.h"
+#include "gaze_poll_scheduler.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <direct.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace BVR
+{
+
+namespace
+{
+	// Plain OS file calls, stdio may allocate or take locks a crashed process is holding.
+	class FlightDumpFile
+	{
+	public:
+		~FlightDumpFile() { close(); }
+
+#ifdef _WIN32
+		bool open(const char* path)
+		{
+			handle_ = CreateFileA(path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+			return handle_ != INVALID_HANDLE_VALUE;
+		}
+
+		bool write(const void* data, const size_t size)
+		{
+			DWORD written = 0;
+			return (size == 0) || (WriteFile(handle_, data, (DWORD)size, &written, NULL) && (written == size));
+		}
+
+		void close()
+		{
+			if(handle_ != INVALID_HANDLE_VALUE)
+			{
+				CloseHandle(handle_);
+				handle_ = INVALID_HANDLE_VALUE;
+			}
+		}
+
+	private:
+		HANDLE handle_ = INVALID_HANDLE_VALUE;
+#else
+		bool open(const char* path)
+		{
+			fd_ = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+			return fd_ >= 0;
+		}
+
+		bool write(const void* data, const size_t size)
+		{
+			const char* bytes = (const char*)data;
+			size_t remaining = size;
+
+			while(remaining > 0)
+			{
+				const ssize_t written = ::write(fd_, bytes, remaining);
+
+				if(written <= 0)
+				{
+					return false;
+				}
+
+				bytes += written;
+				remaining -= (size_t)written;
+			}
+
+			return true;
+		}
+
+		void close()
+		{
+			if(fd_ >= 0)
+			{
+				::close(fd_);
+				fd_ = -1;
+			}
+		}
+
+	private:
+		int fd_ = -1;
+#endif
+	};
+
+	const char* const DUMP_FILE_NAMES[(int)GazeFlightDumpReason::NUM_REASONS_] =
+	{
+		"flight_deactivate.psfr",
+		"flight_stalls.psfr",
+		"flight_crash.psfr",
+		"flight_request.psfr",
+	};
+}
+
+const char* get_flight_record_kind_name(const GazeFlightRecordKind kind)
+{
+	switch(kind)
+	{
+		case GazeFlightRecordKind::POLL_:
+			return "poll";
+		case GazeFlightRecordKind::CONNECTED_:
+			return "connected";
+		case GazeFlightRecordKind::DISCONNECTED_:
+			return "disconnected";
+		case GazeFlightRecordKind::RECEIVE_FAILURE_:
+			return "receive_failure";
+		case GazeFlightRecordKind::POWER_STATE_:
+			return "power_state";
+		case GazeFlightRecordKind::SETTINGS_:
+			return "settings";
+		case GazeFlightRecordKind::STALL_:
+			return "stall";
+		default:
+			return "unknown";
+	}
+}
+
+const char* get_flight_dump_reason_name(const GazeFlightDumpReason reason)
+{
+	switch(reason)
+	{
+		case GazeFlightDumpReason::DEACTIVATE_:
+			return "deactivate";
+		case GazeFlightDumpReason::STALLS_:
+			return "stalls";
+		case GazeFlightDumpReason::CRASH_:
+			return "crash";
+		case GazeFlightDumpReason::REQUEST_:
+			return "request";
+		default:
+			return "unknown";
+	}
+}
+
+void GazeFlightRecorder::set_dump_directory(const char* directory)
+{
+	if(!directory || !directory[0])
+	{
+		return;
+	}
+
+	// Fails harmlessly when it already exists
+#ifdef _WIN32
+	_mkdir(directory);
+#else
+	mkdir(directory, 0755);
+#endif
+
+	const size_t length = strlen(directory);
+	const bool has_separator = (directory[length - 1] == '/') || (directory[length - 1] == '\\');
+
+	for(int reason = 0; reason < (int)GazeFlightDumpReason::NUM_REASONS_; reason++)
+	{
+#ifdef _WIN32
+		const char* separator = has_separator ? "" : "\\";
+#else
+		const char* separator = has_separator ? "" : "/";
+#endif
+		snprintf(dump_paths_[reason], GAZE_FLIGHT_RECORDER_MAX_PATH, "%s%s%s", directory, separator, DUMP_FILE_NAMES[reason]);
+	}
+}
+
+void GazeFlightRecorder::record_event(const GazeFlightRecordKind kind, const int64_t time_us, const uint32_t value)
+{
+	const uint64_t index = write_index_.load(std::memory_order_relaxed);
+
+	GazeFlightRecord& record = records_[index & (GAZE_FLIGHT_RECORDER_CAPACITY - 1)];
+	record = GazeFlightRecord();
+	record.time_us_ = time_us;
+	record.kind_ = (uint16_t)kind;
+	record.value_ = value;
+
+	write_index_.store(index + 1, std::memory_order_release);
+}
+
+void GazeFlightRecorder::record(const GazeUpdateLoop& loop, const int64_t now_us)
+{
+	const GazeUpdate& update = loop.get_last_update();
+	const GazeLoopStats& loop_stats = loop.get_loop_stats();
+
+	// Events first, so they come before the poll that noticed them
+	const bool is_connected = loop_stats.connected_.load(std::memory_order_relaxed);
+
+	if(is_connected != was_connected_)
+	{
+		was_connected_ = is_connected;
+		record_event(is_connected ? GazeFlightRecordKind::CONNECTED_ : GazeFlightRecordKind::DISCONNECTED_, now_us);
+
+		// Silence while disconnected is not a stall
+		last_new_sample_time_us_ = now_us;
+	}
+
+	const uint64_t receive_failures = loop_stats.receive_failures_.load(std::memory_order_relaxed);
+
+	if(receive_failures > last_receive_failures_)
+	{
+		record_event(GazeFlightRecordKind::RECEIVE_FAILURE_, now_us, (uint32_t)(receive_failures - last_receive_failures_));
+	}
+
+	last_receive_failures_ = receive_failures;
+
+	const int power_state = loop_stats.power_state_.load(std::memory_order_relaxed);
+
+	if(power_state != last_power_state_)
+	{
+		last_power_state_ = power_state;
+		record_event(GazeFlightRecordKind::POWER_STATE_, now_us, (uint32_t)power_state);
+		last_new_sample_time_us_ = now_us;
+	}
+
+	const uint64_t applied_generation = loop_stats.applied_generation_.load(std::memory_order_relaxed);
+
+	if(applied_generation != last_applied_generation_)
+	{
+		last_applied_generation_ = applied_generation;
+		record_event(GazeFlightRecordKind::SETTINGS_, now_us, (uint32_t)applied_generation);
+	}
+
+	if(update.poll_time_us_ == last_poll_time_us_)
+	{
+		// No poll since last time
+		return;
+	}
+
+	last_poll_time_us_ = update.poll_time_us_;
+
+	const int64_t lateness_us = loop_stats.wakeup_lateness_us_.get_last_us();
+	const int64_t duration_us = loop_stats.poll_duration_us_.get_last_us();
+
+	const uint64_t index = write_index_.load(std::memory_order_relaxed);
+	GazeFlightRecord& record = records_[index & (GAZE_FLIGHT_RECORDER_CAPACITY - 1)];
+
+	record.time_us_ = update.poll_time_us_;
+	record.sequence_number_ = 0;
+	record.wakeup_lateness_us_ = (int32_t)((lateness_us < INT32_MAX) ? lateness_us : INT32_MAX);
+	record.poll_duration_us_ = (int32_t)((duration_us < INT32_MAX) ? duration_us : INT32_MAX);
+	record.new_samples_ = (uint32_t)update.new_samples_;
+	record.kind_ = (uint16_t)GazeFlightRecordKind::POLL_;
+	record.combined_gaze_[0] = update.combined_gaze_.x;
+	record.combined_gaze_[1] = update.combined_gaze_.y;
+	record.combined_gaze_[2] = update.combined_gaze_.z;
+	record.value_ = 0;
+
+	uint16_t flags = (uint16_t)(power_state << GAZE_FLIGHT_FLAG_POWER_STATE_SHIFT);
+	flags |= update.is_available_ ? GAZE_FLIGHT_FLAG_AVAILABLE : 0;
+	flags |= is_connected ? GAZE_FLIGHT_FLAG_CONNECTED : 0;
+
+	if(update.frame_)
+	{
+		flags |= update.frame_->per_eye_gazes_[LEFT].is_valid_ ? GAZE_FLIGHT_FLAG_LEFT_VALID : 0;
+		flags |= update.frame_->per_eye_gazes_[RIGHT].is_valid_ ? GAZE_FLIGHT_FLAG_RIGHT_VALID : 0;
+	}
+
+	record.flags_ = flags;
+
+	if(update.new_samples_ > 0 && update.slot_)
+	{
+		const GazeSlot& slot = *update.slot_;
+		record.sequence_number_ = slot.has_sequence_number_ ? slot.response_.sequence_number_ : 0;
+	}
+
+	write_index_.store(index + 1, std::memory_order_release);
+
+	if(update.new_samples_ > 0)
+	{
+		last_new_sample_time_us_ = update.poll_time_us_;
+	}
+
+	// A poll that took forever, or a server that went quiet while we're actively polling it
+	if(lateness_us > GAZE_FLIGHT_STALL_US || duration_us > GAZE_FLIGHT_STALL_US)
+	{
+		on_stall(now_us, (lateness_us > duration_us) ? lateness_us : duration_us);
+	}
+
+	const int64_t silence_us = now_us - last_new_sample_time_us_;
+	const bool is_silent = is_connected && (power_state == (int)GazePowerState::ACTIVE_) && (silence_us > GAZE_FLIGHT_STALL_US);
+
+	if(is_silent && !is_stalled_)
+	{
+		on_stall(now_us, silence_us);
+	}
+
+	is_stalled_ = is_silent;
+}
+
+void GazeFlightRecorder::on_stall(const int64_t now_us, const int64_t duration_us)
+{
+	record_event(GazeFlightRecordKind::STALL_, now_us, (uint32_t)((duration_us < UINT32_MAX) ? duration_us : UINT32_MAX));
+
+	// stall_times_us_ holds the last GAZE_FLIGHT_STALLS_BEFORE_DUMP stalls, the oldest at stalls_ % N
+	stall_times_us_[stalls_ % GAZE_FLIGHT_STALLS_BEFORE_DUMP] = now_us;
+	stalls_++;
+
+	const int64_t oldest_stall_us = stall_times_us_[stalls_ % GAZE_FLIGHT_STALLS_BEFORE_DUMP];
+	const bool is_repeated = (stalls_ >= GAZE_FLIGHT_STALLS_BEFORE_DUMP) && ((now_us - oldest_stall_us) <= GAZE_FLIGHT_STALL_WINDOW_US);
+
+	if(is_repeated && (!has_stall_dump_ || (now_us - last_stall_dump_us_) >= GAZE_FLIGHT_DUMP_INTERVAL_US))
+	{
+		has_stall_dump_ = true;
+		last_stall_dump_us_ = now_us;
+		is_stall_dump_pending_.store(true, std::memory_order_release);
+	}
+}
+
+bool GazeFlightRecorder::write_pending_dump()
+{
+	if(!is_stall_dump_pending_.exchange(false, std::memory_order_acquire))
+	{
+		return false;
+	}
+
+	// The update thread went on recording meanwhile, the stalls are still well within the ring
+	return dump(GazeFlightDumpReason::STALLS_);
+}
+
+bool GazeFlightRecorder::dump(const GazeFlightDumpReason reason) const
+{
+	return dump(reason, dump_paths_[(int)reason]);
+}
+
+bool GazeFlightRecorder::dump(const GazeFlightDumpReason reason, const char* path) const
+{
+	if(!path || !path[0])
+	{
+		return false;
+	}
+
+	const uint64_t total_records = write_index_.load(std::memory_order_acquire);
+	const uint64_t num_records = (total_records < GAZE_FLIGHT_RECORDER_CAPACITY) ? total_records : GAZE_FLIGHT_RECORDER_CAPACITY;
+
+	GazeFlightDumpHeader header = {};
+	header.magic_ = GAZE_FLIGHT_DUMP_MAGIC;
+	header.version_ = GAZE_FLIGHT_DUMP_VERSION;
+	header.record_size_ = sizeof(GazeFlightRecord);
+	header.reason_ = (uint32_t)reason;
+	header.num_records_ = (uint32_t)num_records;
+	header.dump_time_us_ = get_steady_time_us();
+	header.dump_unix_time_us_ = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	header.total_records_ = total_records;
+
+	// Oldest first: the tail of the ring up to its end, then the start
+	const uint64_t first_index = (total_records - num_records) & (GAZE_FLIGHT_RECORDER_CAPACITY - 1);
+	const uint64_t first_count = (num_records < GAZE_FLIGHT_RECORDER_CAPACITY - first_index) ? num_records : GAZE_FLIGHT_RECORDER_CAPACITY - first_index;
+
+	FlightDumpFile file;
+
+	const bool success = file.open(path) &&
+		file.write(&header, sizeof(header)) &&
+		file.write(&records_[first_index], (size_t)first_count * sizeof(GazeFlightRecord)) &&
+		file.write(&records_[0], (size_t)(num_records - first_count) * sizeof(GazeFlightRecord));
+
+	if(success)
+	{
+		dumps_.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	return success;
+}
+
+void GazeFlightRecorder::reset()
+{
+	write_index_.store(0, std::memory_order_relaxed);
+
+	last_poll_time_us_ = 0;
+	last_new_sample_time_us_ = 0;
+	was_connected_ = false;
+	last_power_state_ = 0;
+	last_receive_failures_ = 0;
+	last_applied_generation_ = 0;
+
+	is_stalled_ = false;
+	stalls_ = 0;
+	has_stall_dump_ = false;
+	last_stall_dump_us_ = 0;
+
+	is_stall_dump_pending_.store(false, std::memory_order_relaxed);
+}
+
+GazeFlightRecorder& get_flight_recorder()
+{
+	static GazeFlightRecorder recorder;
+	return recorder;
+}
+
+#ifdef _WIN32
+
+static LPTOP_LEVEL_EXCEPTION_FILTER g_previous_exception_filter = nullptr;
+static bool g_is_crash_handler_installed = false;
+
+static LONG WINAPI on_unhandled_exception(EXCEPTION_POINTERS* exception)
+{
+	get_flight_recorder().dump(GazeFlightDumpReason::CRASH_);
+
+	return g_previous_exception_filter ? g_previous_exception_filter(exception) : EXCEPTION_CONTINUE_SEARCH;
+}
+
+void install_flight_recorder_crash_handler()
+{
+	if(!g_is_crash_handler_installed)
+	{
+		g_previous_exception_filter = SetUnhandledExceptionFilter(on_unhandled_exception);
+		g_is_crash_handler_installed = true;
+	}
+}
+
+void uninstall_flight_recorder_crash_handler()
+{
+	if(!g_is_crash_handler_installed)
+	{
+		return;
+	}
+
+	// There's no way to look without setting, so put the previous one back and see what that replaced
+	const LPTOP_LEVEL_EXCEPTION_FILTER current_filter = SetUnhandledExceptionFilter(g_previous_exception_filter);
+
+	if(current_filter != on_unhandled_exception)
+	{
+		// Someone installed theirs on top of ours since and may chain to it: theirs stays, and so does ours
+		SetUnhandledExceptionFilter(current_filter);
+		return;
+	}
+
+	g_previous_exception_filter = nullptr;
+	g_is_crash_handler_installed = false;
+}
+
+#else
+
+static const int CRASH_SIGNALS[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT };
+static const int NUM_CRASH_SIGNALS = sizeof(CRASH_SIGNALS) / sizeof(CRASH_SIGNALS[0]);
+
+static struct sigaction g_previous_actions[NUM_CRASH_SIGNALS];
+static bool g_is_crash_handler_installed[NUM_CRASH_SIGNALS] = {};
+
+static void on_crash_signal(int signal_number)
+{
+	get_flight_recorder().dump(GazeFlightDumpReason::CRASH_);
+
+	// Put back whoever was there before (usually the default, which terminates) and let it run
+	for(int index = 0; index < NUM_CRASH_SIGNALS; index++)
+	{
+		if(CRASH_SIGNALS[index] == signal_number)
+		{
+			sigaction(signal_number, &g_previous_actions[index], nullptr);
+		}
+	}
+
+	raise(signal_number);
+}
+
+void install_flight_recorder_crash_handler()
+{
+	struct sigaction action = {};
+	action.sa_handler = on_crash_signal;
+	sigemptyset(&action.sa_mask);
+
+	// Per signal, one we couldn't uninstall is still ours and mustn't become its own previous handler
+	for(int index = 0; index < NUM_CRASH_SIGNALS; index++)
+	{
+		if(!g_is_crash_handler_installed[index])
+		{
+			sigaction(CRASH_SIGNALS[index], &action, &g_previous_actions[index]);
+			g_is_crash_handler_installed[index] = true;
+		}
+	}
+}
+
+void uninstall_flight_recorder_crash_handler()
+{
+	for(int index = 0; index < NUM_CRASH_SIGNALS; index++)
+	{
+		if(!g_is_crash_handler_installed[index])
+		{
+			continue;
+		}
+
+		struct sigaction current_action = {};
+		sigaction(CRASH_SIGNALS[index], nullptr, &current_action);
+
+		// Someone installed theirs on top of ours since and may chain to it: theirs stays, and so does ours
+		if(current_action.sa_handler != on_crash_signal)
+		{
+			continue;
+		}
+
+		sigaction(CRASH_SIGNALS[index], &g_previous_actions[index], nullptr);
+		g_is_crash_handler_installed[index] = false;
+	}
+}
+
+#endif
+
+} // BVR
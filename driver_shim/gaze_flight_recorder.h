@@ -0,0 +1,184 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef GAZE_FLIGHT_RECORDER_H
+#define GAZE_FLIGHT_RECORDER_H
+
+#include "defines.h"
+#include "gaze_update_loop.h"
+
+#include <atomic>
+#include <stdint.h>
+
+#define GAZE_FLIGHT_RECORDER_CAPACITY 8192          // Records, about half a minute of polls. Power of two.
+#define GAZE_FLIGHT_RECORDER_MAX_PATH 260
+
+#define GAZE_FLIGHT_DUMP_MAGIC 0x52465350           // "PSFR"
+#define GAZE_FLIGHT_DUMP_VERSION 1
+
+#define GAZE_FLIGHT_STALL_US 250000                 // No sample for this long while active, or a poll this late / slow
+#define GAZE_FLIGHT_STALL_WINDOW_US 10000000
+#define GAZE_FLIGHT_STALLS_BEFORE_DUMP 3            // Within GAZE_FLIGHT_STALL_WINDOW_US
+#define GAZE_FLIGHT_DUMP_INTERVAL_US 60000000       // At most one stall dump per minute
+
+// GazeFlightRecord::flags_
+#define GAZE_FLIGHT_FLAG_AVAILABLE (1 << 0)         // Combined gaze valid
+#define GAZE_FLIGHT_FLAG_LEFT_VALID (1 << 1)
+#define GAZE_FLIGHT_FLAG_RIGHT_VALID (1 << 2)
+#define GAZE_FLIGHT_FLAG_CONNECTED (1 << 3)
+#define GAZE_FLIGHT_FLAG_POWER_STATE_SHIFT 8        // GazePowerState in the upper byte
+
+namespace BVR
+{
+	enum class GazeFlightRecordKind : uint16_t
+	{
+		POLL_,             // One per poll: timings, and the sample if it was new
+		CONNECTED_,
+		DISCONNECTED_,
+		RECEIVE_FAILURE_,
+		POWER_STATE_,      // value_ is the new GazePowerState
+		SETTINGS_,         // value_ is the settings generation now in use
+		STALL_,            // value_ is how long, in microseconds
+		NUM_KINDS_
+	};
+
+	enum class GazeFlightDumpReason : uint32_t
+	{
+		DEACTIVATE_,
+		STALLS_,
+		CRASH_,
+		REQUEST_,          // DebugRequest
+		NUM_REASONS_
+	};
+
+	const char* get_flight_record_kind_name(const GazeFlightRecordKind kind);
+	const char* get_flight_dump_reason_name(const GazeFlightDumpReason reason);
+
+	// 48 bytes, the dump file is an array of these. Same layout rules as the shared memory blocks.
+	struct GazeFlightRecord
+	{
+		int64_t time_us_;                // Steady clock
+		uint64_t sequence_number_;       // POLL_ with a new sample: the server's, 0 without
+		int32_t wakeup_lateness_us_;     // POLL_
+		int32_t poll_duration_us_;       // POLL_
+		uint32_t new_samples_;           // POLL_
+		uint16_t kind_;                  // GazeFlightRecordKind
+		uint16_t flags_;                 // GAZE_FLIGHT_FLAG_*
+		float combined_gaze_[3];         // POLL_
+		uint32_t value_;                 // Events, see GazeFlightRecordKind
+	};
+
+	static_assert(sizeof(GazeFlightRecord) == 48, "the dump format depends on the record size");
+
+	// Start of a dump file, followed by num_records_ GazeFlightRecords, oldest first.
+	struct GazeFlightDumpHeader
+	{
+		uint32_t magic_;
+		uint16_t version_;
+		uint16_t record_size_;
+		uint32_t reason_;                // GazeFlightDumpReason
+		uint32_t num_records_;
+		int64_t dump_time_us_;           // Steady clock, same as the records
+		int64_t dump_unix_time_us_;      // Wall clock at the same moment, to place the records in time
+		uint64_t total_records_;         // Ever recorded, more than num_records_ once the ring wrapped
+	};
+
+	// The last GAZE_FLIGHT_RECORDER_CAPACITY polls and connection events, in memory, so there's something to
+	// look at when eye tracking froze and nobody had a trace running. Recording is a 48 byte store into a
+	// preallocated ring by the update thread. Dumps write a binary file (tools/gaze_flight_decoder turns it
+	// into CSV), on Deactivate, after repeated stalls, on request, and from the crash handler. The update
+	// thread never writes one itself, repeated stalls only flag a dump for write_pending_dump().
+	//
+	// The update thread is the only writer. A dump from another thread while it runs (crash, request) may
+	// catch the newest record half written, which is fine for what this is for.
+	class GazeFlightRecorder
+	{
+	public:
+		// Creates the directory and prepares the dump file paths up front, the crash handler can't allocate.
+		void set_dump_directory(const char* directory);
+
+		// Call after every run_once(), once its timings went into the loop stats. Records the poll if there
+		// was one, plus whatever changed since, and flags a dump on repeated stalls.
+		void record(const GazeUpdateLoop& loop, const int64_t now_us);
+
+		// Writes the stall dump record() flagged, if there is one. From any thread but the update thread (the
+		// driver's RunFrame), a 400 KB file write there would be a stall of its own.
+		bool write_pending_dump();
+		bool has_pending_dump() const { return is_stall_dump_pending_.load(std::memory_order_relaxed); }
+
+		void record_event(const GazeFlightRecordKind kind, const int64_t time_us, const uint32_t value = 0);
+
+		// Async signal safe (no allocation, no locks, raw file I/O). Returns false if there's no dump
+		// directory or the file couldn't be written.
+		bool dump(const GazeFlightDumpReason reason) const;
+		bool dump(const GazeFlightDumpReason reason, const char* path) const;
+
+		const char* get_dump_path(const GazeFlightDumpReason reason) const { return dump_paths_[(int)reason]; }
+
+		uint64_t get_num_recorded() const { return write_index_.load(std::memory_order_relaxed); }
+		uint64_t get_num_stalls() const { return stalls_; }
+		uint64_t get_num_dumps() const { return dumps_.load(std::memory_order_relaxed); }
+
+		void reset();
+
+	private:
+		void on_stall(const int64_t now_us, const int64_t duration_us);
+
+		GazeFlightRecord records_[GAZE_FLIGHT_RECORDER_CAPACITY] = {};
+		std::atomic<uint64_t> write_index_ = 0;
+
+		char dump_paths_[(int)GazeFlightDumpReason::NUM_REASONS_][GAZE_FLIGHT_RECORDER_MAX_PATH] = {};
+		mutable std::atomic<uint64_t> dumps_ = 0;
+
+		// Update thread state
+		int64_t last_poll_time_us_ = 0;
+		int64_t last_new_sample_time_us_ = 0;
+
+		bool was_connected_ = false;
+		int last_power_state_ = 0;
+		uint64_t last_receive_failures_ = 0;
+		uint64_t last_applied_generation_ = 0;
+
+		bool is_stalled_ = false;
+		uint64_t stalls_ = 0;
+		int64_t stall_times_us_[GAZE_FLIGHT_STALLS_BEFORE_DUMP] = {};
+		bool has_stall_dump_ = false;
+		int64_t last_stall_dump_us_ = 0;
+
+		std::atomic<bool> is_stall_dump_pending_ = false;
+	};
+
+	// The one the driver records into.
+	GazeFlightRecorder& get_flight_recorder();
+
+	// Dumps get_flight_recorder() on an unhandled exception (Windows) or a fatal signal (elsewhere), then
+	// hands over to whatever handler was there before. Uninstalling puts that one back only where ours is
+	// still the current handler, one installed on top since may chain to ours and keeps it.
+	void install_flight_recorder_crash_handler();
+	void uninstall_flight_recorder_crash_handler();
+}
+
+#endif // GAZE_FLIGHT_RECORDER_H
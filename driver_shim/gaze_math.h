@@ -0,0 +1,299 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef GAZE_MATH_H
+#define GAZE_MATH_H
+
+#include "psvr2_protocol.h"
+
+#include <math.h>
+
+// Small vector / quaternion library for the gaze core, so it doesn't need DirectXMath and builds anywhere.
+// XMVECTOR is only used where gazes are handed to OpenVR. Both backends perform the same operations in the
+// same order and give bit identical results, horizontal sums included.
+
+#ifndef GAZE_MATH_FORCE_SCALAR
+#define GAZE_MATH_FORCE_SCALAR 0
+#endif
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)) || defined(__SSE2__)
+#define GAZE_SIMD_X86 1
+#else
+#define GAZE_SIMD_X86 0
+#endif
+
+#if GAZE_SIMD_X86 && !GAZE_MATH_FORCE_SCALAR
+#define GAZE_MATH_SSE 1
+#include <emmintrin.h>
+#else
+#define GAZE_MATH_SSE 0
+#endif
+
+namespace BVR
+{
+	// x, y, z, w. Quaternions use the same type, (x, y, z) imaginary and w real, like DirectXMath.
+#if GAZE_MATH_SSE
+	typedef __m128 GazeVector;
+#else
+	struct alignas(16) GazeVector
+	{
+		float x;
+		float y;
+		float z;
+		float w;
+	};
+#endif
+
+	typedef GazeVector GazeQuaternion;
+
+#if GAZE_MATH_SSE
+
+	inline GazeVector gaze_vector_set(const float x, const float y, const float z, const float w) { return _mm_setr_ps(x, y, z, w); }
+	inline GazeVector gaze_vector_splat(const float value) { return _mm_set1_ps(value); }
+
+	inline float gaze_vector_get_x(const GazeVector v) { return _mm_cvtss_f32(v); }
+	inline float gaze_vector_get_y(const GazeVector v) { return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))); }
+	inline float gaze_vector_get_z(const GazeVector v) { return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))); }
+	inline float gaze_vector_get_w(const GazeVector v) { return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))); }
+
+	inline GazeVector gaze_vector_add(const GazeVector a, const GazeVector b) { return _mm_add_ps(a, b); }
+	inline GazeVector gaze_vector_subtract(const GazeVector a, const GazeVector b) { return _mm_sub_ps(a, b); }
+	inline GazeVector gaze_vector_multiply(const GazeVector a, const GazeVector b) { return _mm_mul_ps(a, b); }
+	inline GazeVector gaze_vector_divide(const GazeVector a, const GazeVector b) { return _mm_div_ps(a, b); }
+	inline GazeVector gaze_vector_scale(const GazeVector v, const float scale) { return _mm_mul_ps(v, _mm_set1_ps(scale)); }
+
+	// ((x + y) + z), left to right like the scalar code
+	inline float gaze_vector_sum3(const GazeVector v)
+	{
+		const __m128 y = _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1));
+		const __m128 z = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2));
+
+		return _mm_cvtss_f32(_mm_add_ss(_mm_add_ss(v, y), z));
+	}
+
+	inline float gaze_vector_sum4(const GazeVector v)
+	{
+		const __m128 w = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+
+		return _mm_cvtss_f32(_mm_add_ss(_mm_set_ss(gaze_vector_sum3(v)), w));
+	}
+
+	// (a.yzx * b.zxy - a.zxy * b.yzx), w is 0
+	inline GazeVector gaze_vector_cross3(const GazeVector a, const GazeVector b)
+	{
+		const __m128 a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+		const __m128 a_zxy = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2));
+		const __m128 b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+		const __m128 b_zxy = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 1, 0, 2));
+		const __m128 xyz_mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+
+		return _mm_and_ps(_mm_sub_ps(_mm_mul_ps(a_yzx, b_zxy), _mm_mul_ps(a_zxy, b_yzx)), xyz_mask);
+	}
+
+	inline bool gaze_vector_is_finite3(const GazeVector v)
+	{
+		// v - v is 0 for finite values only
+		return (_mm_movemask_ps(_mm_cmpeq_ps(_mm_sub_ps(v, v), _mm_setzero_ps())) & 0x7) == 0x7;
+	}
+
+	// Flips the sign of the selected lanes
+	inline GazeVector gaze_vector_negate_lanes(const GazeVector v, const bool x, const bool y, const bool z, const bool w)
+	{
+		const __m128 signs = _mm_castsi128_ps(_mm_setr_epi32(x ? (int)0x80000000 : 0, y ? (int)0x80000000 : 0, z ? (int)0x80000000 : 0, w ? (int)0x80000000 : 0));
+
+		return _mm_xor_ps(v, signs);
+	}
+
+	inline GazeVector gaze_vector_swizzle_wzyx(const GazeVector v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 1, 2, 3)); }
+	inline GazeVector gaze_vector_swizzle_zwxy(const GazeVector v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)); }
+	inline GazeVector gaze_vector_swizzle_yxwz(const GazeVector v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)); }
+	inline GazeVector gaze_vector_splat_x(const GazeVector v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)); }
+	inline GazeVector gaze_vector_splat_y(const GazeVector v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)); }
+	inline GazeVector gaze_vector_splat_z(const GazeVector v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)); }
+	inline GazeVector gaze_vector_splat_w(const GazeVector v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)); }
+
+#else
+
+	inline GazeVector gaze_vector_set(const float x, const float y, const float z, const float w) { return { x, y, z, w }; }
+	inline GazeVector gaze_vector_splat(const float value) { return { value, value, value, value }; }
+
+	inline float gaze_vector_get_x(const GazeVector v) { return v.x; }
+	inline float gaze_vector_get_y(const GazeVector v) { return v.y; }
+	inline float gaze_vector_get_z(const GazeVector v) { return v.z; }
+	inline float gaze_vector_get_w(const GazeVector v) { return v.w; }
+
+	inline GazeVector gaze_vector_add(const GazeVector a, const GazeVector b) { return { a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w }; }
+	inline GazeVector gaze_vector_subtract(const GazeVector a, const GazeVector b) { return { a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w }; }
+	inline GazeVector gaze_vector_multiply(const GazeVector a, const GazeVector b) { return { a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w }; }
+	inline GazeVector gaze_vector_divide(const GazeVector a, const GazeVector b) { return { a.x / b.x, a.y / b.y, a.z / b.z, a.w / b.w }; }
+	inline GazeVector gaze_vector_scale(const GazeVector v, const float scale) { return { v.x * scale, v.y * scale, v.z * scale, v.w * scale }; }
+
+	inline float gaze_vector_sum3(const GazeVector v) { return v.x + v.y + v.z; }
+	inline float gaze_vector_sum4(const GazeVector v) { return v.x + v.y + v.z + v.w; }
+
+	inline GazeVector gaze_vector_cross3(const GazeVector a, const GazeVector b)
+	{
+		return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x, 0.0f };
+	}
+
+	inline bool gaze_vector_is_finite3(const GazeVector v)
+	{
+		return isfinite(v.x) && isfinite(v.y) && isfinite(v.z);
+	}
+
+	inline GazeVector gaze_vector_negate_lanes(const GazeVector v, const bool x, const bool y, const bool z, const bool w)
+	{
+		return { x ? -v.x : v.x, y ? -v.y : v.y, z ? -v.z : v.z, w ? -v.w : v.w };
+	}
+
+	inline GazeVector gaze_vector_swizzle_wzyx(const GazeVector v) { return { v.w, v.z, v.y, v.x }; }
+	inline GazeVector gaze_vector_swizzle_zwxy(const GazeVector v) { return { v.z, v.w, v.x, v.y }; }
+	inline GazeVector gaze_vector_swizzle_yxwz(const GazeVector v) { return { v.y, v.x, v.w, v.z }; }
+	inline GazeVector gaze_vector_splat_x(const GazeVector v) { return gaze_vector_splat(v.x); }
+	inline GazeVector gaze_vector_splat_y(const GazeVector v) { return gaze_vector_splat(v.y); }
+	inline GazeVector gaze_vector_splat_z(const GazeVector v) { return gaze_vector_splat(v.z); }
+	inline GazeVector gaze_vector_splat_w(const GazeVector v) { return gaze_vector_splat(v.w); }
+
+#endif // GAZE_MATH_SSE
+
+	// Everything below is written once, on top of the backend.
+
+	inline GazeVector gaze_vector_zero() { return gaze_vector_splat(0.0f); }
+	inline GazeVector gaze_vector_forward() { return gaze_vector_set(0.0f, 0.0f, -1.0f, 0.0f); }
+
+	inline GazeVector gaze_vector_load(const XrVector3f& v, const float w = 0.0f) { return gaze_vector_set(v.x, v.y, v.z, w); }
+	inline XrVector3f gaze_vector_store(const GazeVector v) { return { gaze_vector_get_x(v), gaze_vector_get_y(v), gaze_vector_get_z(v) }; }
+
+	inline float gaze_vector_dot3(const GazeVector a, const GazeVector b) { return gaze_vector_sum3(gaze_vector_multiply(a, b)); }
+	inline float gaze_vector_dot4(const GazeVector a, const GazeVector b) { return gaze_vector_sum4(gaze_vector_multiply(a, b)); }
+	inline float gaze_vector_length3(const GazeVector v) { return sqrtf(gaze_vector_dot3(v, v)); }
+
+	// Zero length (or NaN) vectors point forward instead. w is scaled along.
+	inline GazeVector gaze_vector_normalize3(const GazeVector v)
+	{
+		const float length = gaze_vector_length3(v);
+
+		if(!(length > 0.0f))
+		{
+			return gaze_vector_forward();
+		}
+
+		return gaze_vector_divide(v, gaze_vector_splat(length));
+	}
+
+	// a + (b - a) * t
+	inline GazeVector gaze_vector_lerp(const GazeVector a, const GazeVector b, const float t)
+	{
+		return gaze_vector_add(a, gaze_vector_scale(gaze_vector_subtract(b, a), t));
+	}
+
+	// Row-major 3x3 times v, rows summed left to right.
+	inline GazeVector gaze_vector_transform3(const float matrix[9], const GazeVector v)
+	{
+		return gaze_vector_set(
+			gaze_vector_dot3(gaze_vector_set(matrix[0], matrix[1], matrix[2], 0.0f), v),
+			gaze_vector_dot3(gaze_vector_set(matrix[3], matrix[4], matrix[5], 0.0f), v),
+			gaze_vector_dot3(gaze_vector_set(matrix[6], matrix[7], matrix[8], 0.0f), v),
+			0.0f);
+	}
+
+	inline GazeQuaternion gaze_quaternion_identity() { return gaze_vector_set(0.0f, 0.0f, 0.0f, 1.0f); }
+	inline GazeQuaternion gaze_quaternion_conjugate(const GazeQuaternion q) { return gaze_vector_negate_lanes(q, true, true, true, false); }
+
+	inline GazeQuaternion gaze_quaternion_normalize(const GazeQuaternion q)
+	{
+		const float length = sqrtf(gaze_vector_dot4(q, q));
+
+		if(!(length > 0.0f))
+		{
+			return gaze_quaternion_identity();
+		}
+
+		return gaze_vector_divide(q, gaze_vector_splat(length));
+	}
+
+	// Axis must be unit length, angle in radians, counter clockwise looking down the axis.
+	inline GazeQuaternion gaze_quaternion_from_axis_angle(const GazeVector axis, const float angle)
+	{
+		const float half_angle = angle * 0.5f;
+		const float sine = sinf(half_angle);
+
+		return gaze_vector_set(gaze_vector_get_x(axis) * sine, gaze_vector_get_y(axis) * sine, gaze_vector_get_z(axis) * sine, cosf(half_angle));
+	}
+
+	// a * b, the rotation b followed by a. Four lane products summed in a fixed order.
+	inline GazeQuaternion gaze_quaternion_multiply(const GazeQuaternion a, const GazeQuaternion b)
+	{
+		// (a.w b.x + a.x b.w + a.y b.z - a.z b.y,
+		//  a.w b.y - a.x b.z + a.y b.w + a.z b.x,
+		//  a.w b.z + a.x b.y - a.y b.x + a.z b.w,
+		//  a.w b.w - a.x b.x - a.y b.y - a.z b.z)
+		GazeVector result = gaze_vector_multiply(gaze_vector_splat_w(a), b);
+		result = gaze_vector_add(result, gaze_vector_negate_lanes(gaze_vector_multiply(gaze_vector_splat_x(a), gaze_vector_swizzle_wzyx(b)), false, true, false, true));
+		result = gaze_vector_add(result, gaze_vector_negate_lanes(gaze_vector_multiply(gaze_vector_splat_y(a), gaze_vector_swizzle_zwxy(b)), false, false, true, true));
+		result = gaze_vector_add(result, gaze_vector_negate_lanes(gaze_vector_multiply(gaze_vector_splat_z(a), gaze_vector_swizzle_yxwz(b)), true, false, false, true));
+
+		return result;
+	}
+
+	// q v q*, as v + 2 w (q x v) + 2 q x (q x v)
+	inline GazeVector gaze_quaternion_rotate(const GazeQuaternion q, const GazeVector v)
+	{
+		const GazeVector t = gaze_vector_scale(gaze_vector_cross3(q, v), 2.0f);
+		const GazeVector rotated = gaze_vector_add(gaze_vector_add(v, gaze_vector_multiply(gaze_vector_splat_w(q), t)), gaze_vector_cross3(q, t));
+
+		return rotated;
+	}
+
+	// Yaw about +Y (positive looks left), then pitch about +X (positive looks up), in OpenVR's right handed
+	// space where forward is -Z.
+	inline GazeQuaternion gaze_quaternion_from_yaw_pitch(const float yaw, const float pitch)
+	{
+		const GazeQuaternion yaw_rotation = gaze_quaternion_from_axis_angle(gaze_vector_set(0.0f, 1.0f, 0.0f, 0.0f), yaw);
+		const GazeQuaternion pitch_rotation = gaze_quaternion_from_axis_angle(gaze_vector_set(1.0f, 0.0f, 0.0f, 0.0f), pitch);
+
+		return gaze_quaternion_multiply(yaw_rotation, pitch_rotation);
+	}
+
+	// Shortest rotation taking forward (-Z) onto the unit direction.
+	inline GazeQuaternion gaze_quaternion_from_forward(const GazeVector direction)
+	{
+		const GazeVector forward = gaze_vector_forward();
+		const float cosine = gaze_vector_dot3(forward, direction);
+
+		if(cosine < -0.999999f)
+		{
+			// Looking straight back, any perpendicular axis will do
+			return gaze_vector_set(0.0f, 1.0f, 0.0f, 0.0f);
+		}
+
+		const GazeVector axis = gaze_vector_cross3(forward, direction);
+
+		return gaze_quaternion_normalize(gaze_vector_set(gaze_vector_get_x(axis), gaze_vector_get_y(axis), gaze_vector_get_z(axis), 1.0f + cosine));
+	}
+}
+
+#endif // GAZE_MATH_H
@@ -0,0 +1,178 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef GAZE_PIPELINE_H
+#define GAZE_PIPELINE_H
+
+#include "defines.h"
+#include "gaze_calibration.h"
+#include "gaze_sanitizer.h"
+#include "psvr2_protocol.h"
+
+#include <stdint.h>
+
+#define LEFT_CALIBRATION_INDEX LEFT
+#define RIGHT_CALIBRATION_INDEX RIGHT
+#define COMBINED_CALIBRATION_INDEX (RIGHT + 1)
+#define NUM_CALIBRATIONS (COMBINED_CALIBRATION_INDEX + 1) // Indices LEFT = 0 / RIGHT = 1 / COMBINED = 2
+
+namespace BVR
+{
+	// What the pipeline hands to the publisher. Gazes whose stage isn't part of the pipeline stay invalid.
+	struct GazeFrame
+	{
+		XRGazeState combined_gaze_;
+		XRGazeState per_eye_gazes_[NUM_EYES];
+	};
+
+	struct GazePipelineContext
+	{
+		const GazeCalibration* calibrations_ = nullptr; // NUM_CALIBRATIONS of them
+		GazeSanitizer* sanitizer_ = nullptr;
+		uint64_t sample_delta_ = 1;                     // Server samples since the previous one the pipeline ran on
+	};
+
+	static_assert(NUM_CALIBRATIONS == GAZE_SANITIZER_TRACKS, "sanitizer tracks are indexed like the calibrations");
+
+	// Stages. Each one is a transform over the frame, composed at compile time by GazePipeline. Whatever
+	// state they need lives in the context.
+
+	struct CombinedGazeStage
+	{
+		static void process(const AllXRGazeStates& gazes, const GazePipelineContext&, GazeFrame& frame)
+		{
+			frame.combined_gaze_ = gazes.combined_gaze_;
+		}
+	};
+
+	struct PerEyeGazeStage
+	{
+		static void process(const AllXRGazeStates& gazes, const GazePipelineContext&, GazeFrame& frame)
+		{
+			frame.per_eye_gazes_[LEFT] = gazes.per_eye_gazes_[LEFT];
+			frame.per_eye_gazes_[RIGHT] = gazes.per_eye_gazes_[RIGHT];
+		}
+	};
+
+	// Gazes by calibration index.
+	template<int GazeIndex>
+	inline XRGazeState& get_frame_gaze(GazeFrame& frame)
+	{
+		if constexpr(GazeIndex == COMBINED_CALIBRATION_INDEX)
+		{
+			return frame.combined_gaze_;
+		}
+		else
+		{
+			return frame.per_eye_gazes_[GazeIndex];
+		}
+	}
+
+	// Right after the gaze is copied in, before anything does math on it.
+	template<int GazeIndex>
+	struct SanitizeStage
+	{
+		static void process(const AllXRGazeStates&, const GazePipelineContext& context, GazeFrame& frame)
+		{
+			XRGazeState& gaze = get_frame_gaze<GazeIndex>(frame);
+			gaze = context.sanitizer_->sanitize(GazeIndex, gaze, context.sample_delta_);
+		}
+	};
+
+	template<int CalibrationIndex>
+	struct CalibrationStage
+	{
+		static void process(const AllXRGazeStates&, const GazePipelineContext& context, GazeFrame& frame)
+		{
+			XRGazeState& gaze = get_frame_gaze<CalibrationIndex>(frame);
+			const GazeCalibration& calibration = context.calibrations_[CalibrationIndex];
+
+			if(gaze.is_valid_ && calibration.is_calibrated())
+			{
+				gaze.direction_ = calibration.apply_calibration(gaze.direction_);
+			}
+		}
+	};
+
+	template<typename... Stages>
+	struct GazePipeline
+	{
+		static void process(const AllXRGazeStates& gazes, const GazePipelineContext& context, GazeFrame& frame)
+		{
+			frame = GazeFrame();
+			(Stages::process(gazes, context, frame), ...);
+		}
+	};
+
+	// Every supported combination, instantiated up front. The update loop picks one when the settings change
+	// and then calls it without any per-feature branching.
+	const uint32_t GAZE_PIPELINE_COMBINED = 1 << 0;
+	const uint32_t GAZE_PIPELINE_PER_EYE = 1 << 1;
+	const uint32_t GAZE_PIPELINE_CALIBRATED = 1 << 2;
+
+	using GazePipelineFunction = void (*)(const AllXRGazeStates& gazes, const GazePipelineContext& context, GazeFrame& frame);
+
+	using SanitizeCombinedStage = SanitizeStage<COMBINED_CALIBRATION_INDEX>;
+	using SanitizeLeftStage = SanitizeStage<LEFT_CALIBRATION_INDEX>;
+	using SanitizeRightStage = SanitizeStage<RIGHT_CALIBRATION_INDEX>;
+
+	using CombinedGazePipeline = GazePipeline<CombinedGazeStage, SanitizeCombinedStage>;
+	using PerEyeGazePipeline = GazePipeline<PerEyeGazeStage, SanitizeLeftStage, SanitizeRightStage>;
+	using AllGazesPipeline = GazePipeline<CombinedGazeStage, PerEyeGazeStage, SanitizeCombinedStage, SanitizeLeftStage, SanitizeRightStage>;
+
+	using CalibratedCombinedGazePipeline = GazePipeline<CombinedGazeStage, SanitizeCombinedStage, CalibrationStage<COMBINED_CALIBRATION_INDEX>>;
+	using CalibratedPerEyeGazePipeline = GazePipeline<PerEyeGazeStage, SanitizeLeftStage, SanitizeRightStage,
+		CalibrationStage<LEFT_CALIBRATION_INDEX>, CalibrationStage<RIGHT_CALIBRATION_INDEX>>;
+	using CalibratedAllGazesPipeline = GazePipeline<CombinedGazeStage, PerEyeGazeStage, SanitizeCombinedStage, SanitizeLeftStage, SanitizeRightStage,
+		CalibrationStage<COMBINED_CALIBRATION_INDEX>, CalibrationStage<LEFT_CALIBRATION_INDEX>, CalibrationStage<RIGHT_CALIBRATION_INDEX>>;
+
+	// No gazes at all, used when neither combined nor per-eye gazes are wanted.
+	using EmptyGazePipeline = GazePipeline<>;
+
+	inline GazePipelineFunction select_gaze_pipeline(const uint32_t flags)
+	{
+		static const GazePipelineFunction pipelines[8] =
+		{
+			&EmptyGazePipeline::process,                // -
+			&CombinedGazePipeline::process,             // combined
+			&PerEyeGazePipeline::process,               // per-eye
+			&AllGazesPipeline::process,                 // combined + per-eye
+			&EmptyGazePipeline::process,                // calibrated
+			&CalibratedCombinedGazePipeline::process,   // calibrated + combined
+			&CalibratedPerEyeGazePipeline::process,     // calibrated + per-eye
+			&CalibratedAllGazesPipeline::process,       // calibrated + combined + per-eye
+		};
+
+		return pipelines[flags & 7];
+	}
+
+	inline uint32_t get_gaze_pipeline_flags(const bool combined, const bool per_eye, const bool calibrated)
+	{
+		return (combined ? GAZE_PIPELINE_COMBINED : 0u) | (per_eye ? GAZE_PIPELINE_PER_EYE : 0u) | (calibrated ? GAZE_PIPELINE_CALIBRATED : 0u);
+	}
+}
+
+#endif // GAZE_PIPELINE_H
+
@@ -0,0 +1,367 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "gaze_poll_scheduler.h"
+
+#include <math.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace BVR
+{
+
+const char* get_power_state_name(const GazePowerState state)
+{
+	switch(state)
+	{
+		case GazePowerState::ACTIVE_:
+			return "active";
+		case GazePowerState::IDLE_:
+			return "idle";
+		case GazePowerState::STANDBY_:
+			return "standby";
+		default:
+			return "unknown";
+	}
+}
+
+int64_t get_steady_time_us()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t get_thread_cpu_time_us()
+{
+#ifdef _WIN32
+	FILETIME creation_time, exit_time, kernel_time, user_time;
+
+	if(!GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time))
+	{
+		return 0;
+	}
+
+	// FILETIME is in 100ns units
+	const uint64_t kernel_100ns = ((uint64_t)kernel_time.dwHighDateTime << 32) | kernel_time.dwLowDateTime;
+	const uint64_t user_100ns = ((uint64_t)user_time.dwHighDateTime << 32) | user_time.dwLowDateTime;
+
+	return (int64_t)((kernel_100ns + user_100ns) / 10);
+#else
+	timespec cpu_time = {};
+
+	if(clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_time) != 0)
+	{
+		return 0;
+	}
+
+	return (int64_t)cpu_time.tv_sec * 1000000 + cpu_time.tv_nsec / 1000;
+#endif
+}
+
+// Samples per period measurement window, long enough to average out the poll quantization.
+static const uint64_t CADENCE_WINDOW_SAMPLES = 32;
+
+// Relative difference between two period measurements still considered consistent.
+static const double CADENCE_PERIOD_TOLERANCE = 0.05;
+
+// Consistent windows required before polls are scheduled from the estimate.
+static const int CADENCE_LOCK_WINDOWS = 2;
+
+// How much earlier than the last bracketed production time the next prediction is placed, as a fraction
+// of the period. Larger values follow drift faster but waste more polls arriving before the sample.
+// Starts coarse when the lock is acquired, the first anchor can be up to a whole poll interval late,
+// and halves with every poll that arrives too early until it settles at the fine value.
+static const double CADENCE_INITIAL_PROBE_FRACTION = 1.0 / 16.0;
+static const double CADENCE_PROBE_FRACTION = 1.0 / 256.0;
+
+// Server sample rates we are willing to lock on to (1 kHz down to 10 Hz).
+static const double CADENCE_MIN_PERIOD_US = 1000.0;
+static const double CADENCE_MAX_PERIOD_US = 100000.0;
+
+// Periods without a new sample before we consider the server stalled and fall back to fixed rate.
+static const double CADENCE_MAX_EMPTY_PERIODS = 4.0;
+
+void GazeCadenceEstimator::reset()
+{
+	*this = GazeCadenceEstimator();
+}
+
+void GazeCadenceEstimator::unlock()
+{
+	is_locked_ = false;
+	consistent_windows_ = 0;
+	has_anchor_ = false;
+}
+
+void GazeCadenceEstimator::on_poll(const int64_t now_us, const uint64_t new_samples)
+{
+	if(new_samples > 0)
+	{
+		last_sample_time_us_ = now_us;
+
+		// The scheduler backed off, this sample is bracketed by a whole poll interval again, like right
+		// after locking on
+		if(is_locked_ && (consecutive_empty_polls_ >= 2))
+		{
+			probe_fraction_ = CADENCE_INITIAL_PROBE_FRACTION;
+		}
+
+		consecutive_empty_polls_ = 0;
+
+		// Period, measured over a window of samples
+		if(!has_anchor_)
+		{
+			has_anchor_ = true;
+			anchor_time_us_ = now_us;
+			samples_since_anchor_ = 0;
+		}
+		else
+		{
+			samples_since_anchor_ += new_samples;
+
+			if(samples_since_anchor_ >= CADENCE_WINDOW_SAMPLES)
+			{
+				const double measured_period_us = (double)(now_us - anchor_time_us_) / (double)samples_since_anchor_;
+
+				if((period_us_ > 0.0) && (fabs(measured_period_us - period_us_) <= (CADENCE_PERIOD_TOLERANCE * period_us_)))
+				{
+					period_us_ += 0.25 * (measured_period_us - period_us_);
+					consistent_windows_++;
+				}
+				else
+				{
+					period_us_ = measured_period_us;
+					consistent_windows_ = 0;
+					is_locked_ = false;
+				}
+
+				const bool was_locked = is_locked_;
+				const bool is_plausible = (period_us_ >= CADENCE_MIN_PERIOD_US) && (period_us_ <= CADENCE_MAX_PERIOD_US);
+				is_locked_ = is_plausible && (consistent_windows_ >= CADENCE_LOCK_WINDOWS);
+
+				if(is_locked_ && !was_locked)
+				{
+					probe_fraction_ = CADENCE_INITIAL_PROBE_FRACTION;
+				}
+
+				anchor_time_us_ = now_us;
+				samples_since_anchor_ = 0;
+			}
+		}
+
+		// Phase: the newest sample was produced somewhere in (last poll, now]
+		if(is_locked_)
+		{
+			const double lower_bound_us = has_last_poll_ ? (double)last_poll_time_us_ : ((double)now_us - period_us_);
+			double produced_us = next_sample_time_us_ + (double)(new_samples - 1) * period_us_;
+
+			produced_us = (produced_us < lower_bound_us) ? lower_bound_us : (produced_us > (double)now_us) ? (double)now_us : produced_us;
+
+			next_sample_time_us_ = produced_us + period_us_ - (probe_fraction_ * period_us_);
+		}
+		else
+		{
+			next_sample_time_us_ = (double)now_us + period_us_;
+		}
+	}
+	else if(is_locked_)
+	{
+		consecutive_empty_polls_++;
+
+		if((double)(now_us - last_sample_time_us_) > (CADENCE_MAX_EMPTY_PERIODS * period_us_))
+		{
+			unlock();
+		}
+		else if((double)now_us >= next_sample_time_us_)
+		{
+			// We got ahead of the server, the sample is due any moment now
+			next_sample_time_us_ = (double)now_us;
+			probe_fraction_ = (probe_fraction_ * 0.5 > CADENCE_PROBE_FRACTION) ? (probe_fraction_ * 0.5) : CADENCE_PROBE_FRACTION;
+		}
+	}
+
+	has_last_poll_ = true;
+	last_poll_time_us_ = now_us;
+}
+
+void GazePollScheduler::start(const int64_t now_us)
+{
+	cadence_.reset();
+
+	state_ = GazePowerState::ACTIVE_;
+	next_poll_time_us_ = now_us + settings_.active_interval_us_;
+	last_valid_gaze_time_us_ = now_us;
+	accounted_wall_time_us_ = now_us;
+	accounted_cpu_time_us_ = get_thread_cpu_time_us();
+}
+
+int64_t GazePollScheduler::get_interval_us() const
+{
+	switch(state_)
+	{
+		case GazePowerState::IDLE_:
+			return settings_.idle_interval_us_;
+		case GazePowerState::STANDBY_:
+			return settings_.standby_interval_us_;
+		default:
+			return settings_.active_interval_us_;
+	}
+}
+
+void GazePollScheduler::on_poll(const int64_t now_us, const bool has_valid_gaze, const uint64_t new_samples)
+{
+	stats_.wakeups_[(int)state_].fetch_add(1, std::memory_order_relaxed);
+	cadence_stats_.polls_.fetch_add(1, std::memory_order_relaxed);
+
+	if(new_samples == 0)
+	{
+		cadence_stats_.empty_polls_.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	const bool was_locked = cadence_.is_locked();
+	cadence_.on_poll(now_us, new_samples);
+
+	if(was_locked && !cadence_.is_locked())
+	{
+		cadence_stats_.lock_losses_.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	cadence_stats_.period_us_.store(cadence_.is_locked() ? (int64_t)cadence_.get_period_us() : 0, std::memory_order_relaxed);
+
+	if(has_valid_gaze)
+	{
+		last_valid_gaze_time_us_ = now_us;
+
+		// Someone is looking through the lenses again, whatever state we were in
+		if(state_ != GazePowerState::ACTIVE_)
+		{
+			set_state(GazePowerState::ACTIVE_, now_us);
+		}
+	}
+	else if((state_ == GazePowerState::ACTIVE_) && ((now_us - last_valid_gaze_time_us_) >= settings_.idle_timeout_us_))
+	{
+		set_state(GazePowerState::IDLE_, now_us);
+	}
+
+	const uint32_t empty_polls = cadence_.get_consecutive_empty_polls();
+
+	if(settings_.adaptive_ && (state_ == GazePowerState::ACTIVE_) && cadence_.is_locked() && (empty_polls < 3))
+	{
+		cadence_stats_.locked_polls_.fetch_add(1, std::memory_order_relaxed);
+
+		if(empty_polls == 2)
+		{
+			// The retry came back empty too, the server is late rather than us early
+			next_poll_time_us_ = now_us + (int64_t)(0.5 * cadence_.get_period_us());
+			return;
+		}
+
+		// Just after the next expected sample, but always leave the server a little breathing room
+		const int64_t min_next_poll_time_us = now_us + settings_.adaptive_guard_us_;
+		next_poll_time_us_ = cadence_.get_next_sample_time_us() + settings_.adaptive_guard_us_;
+
+		if(next_poll_time_us_ < min_next_poll_time_us)
+		{
+			next_poll_time_us_ = min_next_poll_time_us;
+		}
+
+		return;
+	}
+
+	// Keep a fixed cadence relative to the previous deadline, but never try to catch up on missed polls
+	next_poll_time_us_ += get_interval_us();
+
+	if(next_poll_time_us_ <= now_us)
+	{
+		next_poll_time_us_ = now_us + get_interval_us();
+	}
+}
+
+void GazePollScheduler::enter_standby(const int64_t now_us)
+{
+	if(state_ != GazePowerState::STANDBY_)
+	{
+		set_state(GazePowerState::STANDBY_, now_us);
+		next_poll_time_us_ = now_us + get_interval_us();
+	}
+}
+
+void GazePollScheduler::leave_standby(const int64_t now_us)
+{
+	if(state_ != GazePowerState::ACTIVE_)
+	{
+		set_state(GazePowerState::ACTIVE_, now_us);
+
+		// Give the idle timeout a fresh start and poll right away
+		last_valid_gaze_time_us_ = now_us;
+		next_poll_time_us_ = now_us;
+	}
+}
+
+void GazePollScheduler::flush_stats(const int64_t now_us)
+{
+	const int64_t cpu_time_us = get_thread_cpu_time_us();
+
+	stats_.wall_time_us_[(int)state_].fetch_add((uint64_t)(now_us - accounted_wall_time_us_), std::memory_order_relaxed);
+	stats_.cpu_time_us_[(int)state_].fetch_add((uint64_t)(cpu_time_us - accounted_cpu_time_us_), std::memory_order_relaxed);
+
+	accounted_wall_time_us_ = now_us;
+	accounted_cpu_time_us_ = cpu_time_us;
+}
+
+void GazePollScheduler::set_state(const GazePowerState state, const int64_t now_us)
+{
+	flush_stats(now_us);
+
+	state_ = state;
+	stats_.transitions_.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool GazePollWaiter::wait_until_us(const int64_t deadline_us)
+{
+	const std::chrono::steady_clock::time_point deadline{std::chrono::microseconds(deadline_us)};
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	const bool woken = condition_.wait_until(lock, deadline, [this] { return woken_; });
+	woken_ = false;
+
+	return woken;
+}
+
+void GazePollWaiter::wake()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		woken_ = true;
+	}
+
+	condition_.notify_one();
+}
+
+} // BVR
@@ -0,0 +1,219 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef GAZE_POLL_SCHEDULER_H
+#define GAZE_POLL_SCHEDULER_H
+
+#include "defines.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdint.h>
+
+namespace BVR
+{
+	enum class GazePowerState
+	{
+		ACTIVE_,   // Polling at full rate
+		IDLE_,     // No valid gaze for a while (headset off the face, server not running...)
+		STANDBY_,  // vrserver put the HMD in standby
+		NUM_POWER_STATES_
+	};
+
+	const char* get_power_state_name(const GazePowerState state);
+
+	// Monotonic clocks used by the update loop, in microseconds.
+	int64_t get_steady_time_us();
+	int64_t get_thread_cpu_time_us();
+
+	// Written by the update thread only, readable from anywhere.
+	struct GazePowerStats
+	{
+		static const int NUM_STATES = (int)GazePowerState::NUM_POWER_STATES_;
+
+		std::atomic<uint64_t> wall_time_us_[NUM_STATES] = {};
+		std::atomic<uint64_t> cpu_time_us_[NUM_STATES] = {};
+		std::atomic<uint64_t> wakeups_[NUM_STATES] = {};
+		std::atomic<uint64_t> transitions_ = 0;
+
+		void reset()
+		{
+			for(int state = 0; state < NUM_STATES; state++)
+			{
+				wall_time_us_[state].store(0, std::memory_order_relaxed);
+				cpu_time_us_[state].store(0, std::memory_order_relaxed);
+				wakeups_[state].store(0, std::memory_order_relaxed);
+			}
+
+			transitions_.store(0, std::memory_order_relaxed);
+		}
+	};
+
+	struct GazePollSettings
+	{
+		int64_t active_interval_us_ = EYE_TRACKING_POLLING_RATE_MS * 1000;
+		int64_t idle_interval_us_ = EYE_TRACKING_IDLE_POLLING_RATE_MS * 1000;
+		int64_t standby_interval_us_ = EYE_TRACKING_STANDBY_POLLING_RATE_MS * 1000;
+		int64_t idle_timeout_us_ = EYE_TRACKING_IDLE_TIMEOUT_MS * 1000;
+
+		bool adaptive_ = ENABLE_ADAPTIVE_POLLING;
+		int64_t adaptive_guard_us_ = ADAPTIVE_POLLING_GUARD_US;
+	};
+
+	// Written by the update thread only, readable from anywhere.
+	struct GazeCadenceStats
+	{
+		std::atomic<uint64_t> polls_ = 0;
+		std::atomic<uint64_t> empty_polls_ = 0;    // Polls that brought no new sample, i.e. wasted round trips
+		std::atomic<uint64_t> locked_polls_ = 0;   // Polls scheduled from the cadence estimate
+		std::atomic<uint64_t> lock_losses_ = 0;
+		std::atomic<int64_t> period_us_ = 0;       // Current estimate of the server sample period, 0 if unknown
+
+		void reset()
+		{
+			polls_.store(0, std::memory_order_relaxed);
+			empty_polls_.store(0, std::memory_order_relaxed);
+			locked_polls_.store(0, std::memory_order_relaxed);
+			lock_losses_.store(0, std::memory_order_relaxed);
+		}
+	};
+
+	// Estimates the period and phase of the server's sample production from when new samples show up,
+	// so polls can be placed just after each expected sample.
+	//
+	// The period comes from long baselines (time between two arrivals divided by the number of samples the
+	// server produced in between), which averages out the poll quantization. The phase is tracked by
+	// bracketing: a new sample was produced somewhere between the previous poll and this one. The prediction
+	// is nudged slightly earlier every sample so it keeps probing that boundary and follows clock drift;
+	// an empty poll means we got ahead of the server and pushes the prediction back.
+	class GazeCadenceEstimator
+	{
+	public:
+		void reset();
+		void on_poll(const int64_t now_us, const uint64_t new_samples);
+
+		bool is_locked() const { return is_locked_; }
+		double get_period_us() const { return period_us_; }
+
+		// Predicted production time of the next sample, only meaningful while locked.
+		int64_t get_next_sample_time_us() const { return (int64_t)next_sample_time_us_; }
+
+		// Polls in a row that brought no new sample.
+		uint32_t get_consecutive_empty_polls() const { return consecutive_empty_polls_; }
+
+	private:
+		void unlock();
+
+		bool has_last_poll_ = false;
+		int64_t last_poll_time_us_ = 0;
+
+		bool has_anchor_ = false;
+		int64_t anchor_time_us_ = 0;
+		uint64_t samples_since_anchor_ = 0;
+
+		double period_us_ = 0.0;
+		int consistent_windows_ = 0;
+		bool is_locked_ = false;
+
+		double next_sample_time_us_ = 0.0;
+		int64_t last_sample_time_us_ = 0;
+		uint32_t consecutive_empty_polls_ = 0;
+		double probe_fraction_ = 0.0;
+	};
+
+	// Decides when the update thread should poll next. Full rate while gazes are flowing, a slow heartbeat
+	// once the server stopped reporting valid gazes for idle_timeout_us_ or the HMD entered standby,
+	// and back to full rate on the first valid gaze.
+	// While locked on to the server cadence, polls go just after each expected sample. One empty poll is
+	// retried right away, the sample is due any moment; a second one backs off to half a period, and from
+	// the third on the fixed interval takes over until the sample shows up, so a stalled server isn't
+	// polled every adaptive_guard_us_.
+	// All times are passed in explicitly so the same logic can be driven by a simulated clock.
+	class GazePollScheduler
+	{
+	public:
+		void start(const int64_t now_us);
+		void set_settings(const GazePollSettings& settings) { settings_ = settings; }
+		const GazePollSettings& get_settings() const { return settings_; }
+
+		// Report the outcome of the poll that was made at now_us. new_samples is how many samples the
+		// server produced since the previous new one, 0 when the poll returned a sample we already had.
+		void on_poll(const int64_t now_us, const bool has_valid_gaze, const uint64_t new_samples);
+
+		void enter_standby(const int64_t now_us);
+		void leave_standby(const int64_t now_us);
+
+		// Attributes the elapsed wall and CPU time to the current state, call before reading stats.
+		void flush_stats(const int64_t now_us);
+
+		GazePowerState get_state() const { return state_; }
+		int64_t get_next_poll_time_us() const { return next_poll_time_us_; }
+
+		GazePowerStats& get_stats() { return stats_; }
+		const GazePowerStats& get_stats() const { return stats_; }
+
+		GazeCadenceStats& get_cadence_stats() { return cadence_stats_; }
+		const GazeCadenceStats& get_cadence_stats() const { return cadence_stats_; }
+		const GazeCadenceEstimator& get_cadence_estimator() const { return cadence_; }
+
+	private:
+		void set_state(const GazePowerState state, const int64_t now_us);
+		int64_t get_interval_us() const;
+
+		GazePollSettings settings_;
+		GazePowerState state_ = GazePowerState::ACTIVE_;
+
+		int64_t next_poll_time_us_ = 0;
+		int64_t last_valid_gaze_time_us_ = 0;
+
+		int64_t accounted_wall_time_us_ = 0;
+		int64_t accounted_cpu_time_us_ = 0;
+
+		GazePowerStats stats_;
+
+		GazeCadenceEstimator cadence_;
+		GazeCadenceStats cadence_stats_;
+	};
+
+	// Sleeps the update thread until its next poll, but lets other threads cut the sleep short
+	// (deactivation, leaving standby).
+	class GazePollWaiter
+	{
+	public:
+		// Returns true if woken before the deadline.
+		bool wait_until_us(const int64_t deadline_us);
+		void wake();
+
+	private:
+		std::mutex mutex_;
+		std::condition_variable condition_;
+		bool woken_ = false;
+	};
+}
+
+#endif // GAZE_POLL_SCHEDULER_H
+
@@ -0,0 +1,191 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "gaze_quality.h"
+#include "gaze_math.h"
+
+#include <math.h>
+
+namespace BVR
+{
+
+static const int64_t BUCKET_US = GAZE_QUALITY_WINDOW_US / GAZE_QUALITY_BUCKETS;
+static const float DEGREES_PER_RADIAN = 57.2957795f;
+
+float get_gaze_angle_deg(const XrVector3f& a, const XrVector3f& b)
+{
+	const GazeVector va = gaze_vector_load(a);
+	const GazeVector vb = gaze_vector_load(b);
+
+	return atan2f(gaze_vector_length3(gaze_vector_cross3(va, vb)), gaze_vector_dot3(va, vb)) * DEGREES_PER_RADIAN;
+}
+
+void GazeQualityMonitor::advance(const int64_t time_us)
+{
+	const int64_t index = time_us / BUCKET_US;
+
+	if(!has_time_)
+	{
+		has_time_ = true;
+		first_time_us_ = time_us;
+		bucket_index_ = index;
+		return;
+	}
+
+	// Clear the buckets that slid out of the window, all of them after a long pause
+	const int64_t steps = index - bucket_index_;
+
+	for(int64_t step = 1; step <= steps && step <= GAZE_QUALITY_BUCKETS; step++)
+	{
+		buckets_[(bucket_index_ + step) % GAZE_QUALITY_BUCKETS] = Bucket();
+	}
+
+	bucket_index_ = (index > bucket_index_) ? index : bucket_index_;
+}
+
+void GazeQualityMonitor::add_sample(const int64_t time_us, const XRGazeState& gaze)
+{
+	advance(time_us);
+
+	Bucket& bucket = get_bucket();
+	bucket.samples_++;
+
+	if(!gaze.is_valid_)
+	{
+		if(!is_in_dropout_)
+		{
+			is_in_dropout_ = true;
+			dropout_start_us_ = has_valid_ ? last_valid_time_us_ : time_us;
+			bucket.dropouts_++;
+		}
+
+		was_valid_ = false;
+		return;
+	}
+
+	bucket.valid_++;
+
+	if(is_in_dropout_)
+	{
+		is_in_dropout_ = false;
+
+		const int64_t dropout_us = time_us - dropout_start_us_;
+		bucket.longest_dropout_us_ = (dropout_us > bucket.longest_dropout_us_) ? dropout_us : bucket.longest_dropout_us_;
+	}
+
+	if(was_valid_)
+	{
+		const float angle_deg = get_gaze_angle_deg(last_valid_direction_, gaze.direction_);
+
+		if(angle_deg < GAZE_QUALITY_SACCADE_DEG)
+		{
+			bucket.fixation_pairs_++;
+			bucket.squared_angles_deg_ += (double)angle_deg * angle_deg;
+		}
+	}
+
+	was_valid_ = true;
+	has_valid_ = true;
+	last_valid_time_us_ = time_us;
+	last_valid_direction_ = gaze.direction_;
+}
+
+void GazeQualityMonitor::update(const int64_t now_us)
+{
+	advance(now_us);
+
+	Bucket total;
+
+	for(const Bucket& bucket : buckets_)
+	{
+		total.samples_ += bucket.samples_;
+		total.valid_ += bucket.valid_;
+		total.dropouts_ += bucket.dropouts_;
+		total.fixation_pairs_ += bucket.fixation_pairs_;
+		total.squared_angles_deg_ += bucket.squared_angles_deg_;
+		total.longest_dropout_us_ = (bucket.longest_dropout_us_ > total.longest_dropout_us_) ? bucket.longest_dropout_us_ : total.longest_dropout_us_;
+	}
+
+	const int64_t current_dropout_us = is_in_dropout_ ? now_us - dropout_start_us_ : 0;
+	const int64_t longest_dropout_us = (current_dropout_us > total.longest_dropout_us_) ? current_dropout_us : total.longest_dropout_us_;
+
+	// The window is the current bucket and the ones before it, or less if we haven't been running that long
+	const int64_t window_start_us = (bucket_index_ - GAZE_QUALITY_BUCKETS + 1) * BUCKET_US;
+	const int64_t span_us = now_us - ((first_time_us_ > window_start_us) ? first_time_us_ : window_start_us);
+
+	has_precision_ = (total.fixation_pairs_ > 0);
+	precision_rms_deg_ = has_precision_ ? (float)sqrt(total.squared_angles_deg_ / total.fixation_pairs_) : 0.0f;
+
+	stats_.validity_ratio_.store((total.samples_ > 0) ? (float)total.valid_ / (float)total.samples_ : 0.0f, std::memory_order_relaxed);
+	stats_.sample_rate_hz_.store((span_us > 0) ? (float)total.samples_ * 1000000.0f / (float)span_us : 0.0f, std::memory_order_relaxed);
+	stats_.precision_rms_deg_.store(precision_rms_deg_, std::memory_order_relaxed);
+	stats_.dropouts_.store(total.dropouts_, std::memory_order_relaxed);
+	stats_.longest_dropout_us_.store(longest_dropout_us, std::memory_order_relaxed);
+	stats_.current_dropout_us_.store(current_dropout_us, std::memory_order_relaxed);
+}
+
+void GazeQualityMonitor::reset()
+{
+	for(Bucket& bucket : buckets_)
+	{
+		bucket = Bucket();
+	}
+
+	has_time_ = false;
+	was_valid_ = false;
+	has_valid_ = false;
+	is_in_dropout_ = false;
+	has_precision_ = false;
+	precision_rms_deg_ = 0.0f;
+}
+
+float GazeSmoother::get_alpha(const float precision_rms_deg)
+{
+	const float t = (precision_rms_deg - GAZE_SMOOTHING_GOOD_PRECISION_DEG) / (GAZE_SMOOTHING_POOR_PRECISION_DEG - GAZE_SMOOTHING_GOOD_PRECISION_DEG);
+
+	if(!(t > 0.0f))
+	{
+		return 1.0f;
+	}
+
+	return (t < 1.0f) ? 1.0f - t * (1.0f - GAZE_SMOOTHING_MIN_ALPHA) : GAZE_SMOOTHING_MIN_ALPHA;
+}
+
+XrVector3f GazeSmoother::apply(const XrVector3f& direction, const float alpha)
+{
+	// Nothing to blend with, smoothing is off, or a saccade: jump right to it
+	if(!has_direction_ || alpha >= 1.0f || get_gaze_angle_deg(direction_, direction) >= GAZE_QUALITY_SACCADE_DEG)
+	{
+		has_direction_ = true;
+		direction_ = direction;
+		return direction_;
+	}
+
+	direction_ = gaze_vector_store(gaze_vector_normalize3(gaze_vector_lerp(gaze_vector_load(direction_), gaze_vector_load(direction), alpha)));
+	return direction_;
+}
+
+} // BVR
@@ -0,0 +1,140 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef GAZE_QUALITY_H
+#define GAZE_QUALITY_H
+
+#include "defines.h"
+#include "psvr2_protocol.h"
+
+#include <atomic>
+#include <stdint.h>
+
+#define GAZE_QUALITY_WINDOW_US 2000000              // The metrics cover this much recent history
+#define GAZE_QUALITY_BUCKETS 8                      // The window slides in steps of GAZE_QUALITY_WINDOW_US / GAZE_QUALITY_BUCKETS
+#define GAZE_QUALITY_SACCADE_DEG 2.5f               // Consecutive samples further apart than this are a saccade, not noise
+
+#define GAZE_SMOOTHING_GOOD_PRECISION_DEG 0.2f      // Up to this RMS precision the gaze isn't smoothed at all
+#define GAZE_SMOOTHING_POOR_PRECISION_DEG 1.0f      // From this one on it's smoothed as much as it gets
+#define GAZE_SMOOTHING_MIN_ALPHA 0.15f              // Weight of a new sample at the strongest smoothing
+
+namespace BVR
+{
+	// Written by the update thread only, readable from anywhere. All over the last GAZE_QUALITY_WINDOW_US.
+	struct GazeQualityStats
+	{
+		std::atomic<float> validity_ratio_ = 0.0f;      // Share of the samples with a valid combined gaze
+		std::atomic<float> sample_rate_hz_ = 0.0f;      // Samples actually received per second, valid or not
+		std::atomic<float> precision_rms_deg_ = 0.0f;   // RMS sample to sample angle within fixations, 0 without any
+		std::atomic<float> smoothing_alpha_ = 1.0f;     // Weight adaptive smoothing gives a new sample, 1 is off
+		std::atomic<uint32_t> dropouts_ = 0;            // Runs of invalid samples that started
+		std::atomic<int64_t> longest_dropout_us_ = 0;   // Including one still going on
+		std::atomic<int64_t> current_dropout_us_ = 0;   // 0 while the gaze is valid
+	};
+
+	// Constant memory quality metrics over the stream of combined gazes: a ring of GAZE_QUALITY_BUCKETS
+	// partial sums, summed up on every update. Precision is the RMS of the angle between consecutive valid
+	// samples, counting only pairs closer than GAZE_QUALITY_SACCADE_DEG (so saccades don't count as noise).
+	// A fixed angle rather than a velocity, at 120 Hz and above the noise of a bad fit alone is faster than
+	// any usual fixation velocity threshold. A dropout lasts from the last valid sample to the next one.
+	class GazeQualityMonitor
+	{
+	public:
+		// Every sample the server sent, once, in order. time_us is when it came in.
+		void add_sample(const int64_t time_us, const XRGazeState& gaze);
+
+		// Every poll: slides the window and publishes the metrics.
+		void update(const int64_t now_us);
+
+		void reset();
+
+		// Update thread copies of what's in the stats.
+		bool has_precision() const { return has_precision_; }
+		float get_precision_rms_deg() const { return precision_rms_deg_; }
+
+		GazeQualityStats& get_stats() { return stats_; }
+		const GazeQualityStats& get_stats() const { return stats_; }
+
+	private:
+		struct Bucket
+		{
+			uint32_t samples_ = 0;
+			uint32_t valid_ = 0;
+			uint32_t dropouts_ = 0;
+			uint32_t fixation_pairs_ = 0;
+			double squared_angles_deg_ = 0.0;
+			int64_t longest_dropout_us_ = 0;  // Of the dropouts that ended in it
+		};
+
+		void advance(const int64_t time_us);
+		Bucket& get_bucket() { return buckets_[bucket_index_ % GAZE_QUALITY_BUCKETS]; }
+
+		Bucket buckets_[GAZE_QUALITY_BUCKETS];
+		int64_t bucket_index_ = 0;  // Time since the epoch in buckets
+		bool has_time_ = false;
+		int64_t first_time_us_ = 0;
+
+		bool was_valid_ = false;
+		bool has_valid_ = false;
+		int64_t last_valid_time_us_ = 0;
+		XrVector3f last_valid_direction_ = { 0.0f, 0.0f, -1.0f };
+
+		bool is_in_dropout_ = false;
+		int64_t dropout_start_us_ = 0;
+
+		bool has_precision_ = false;
+		float precision_rms_deg_ = 0.0f;
+
+		GazeQualityStats stats_;
+	};
+
+	// Exponential smoothing of one gaze direction. The weight of each new sample comes from the measured
+	// precision (get_alpha), so a precise tracker isn't smoothed at all and a noisy one more and more.
+	// A jump of more than GAZE_QUALITY_SACCADE_DEG passes through untouched, smoothing never drags behind a saccade.
+	class GazeSmoother
+	{
+	public:
+		static float get_alpha(const float precision_rms_deg);
+
+		// Every new valid sample.
+		XrVector3f apply(const XrVector3f& direction, const float alpha);
+
+		bool has_direction() const { return has_direction_; }
+		const XrVector3f& get_direction() const { return direction_; }
+
+		// Whenever the gaze was lost, so it doesn't blend across the gap.
+		void reset() { has_direction_ = false; }
+
+	private:
+		bool has_direction_ = false;
+		XrVector3f direction_ = { 0.0f, 0.0f, -1.0f };
+	};
+
+	// Angle between two directions, in degrees. Accurate down to tiny angles, unlike acos of the dot product.
+	float get_gaze_angle_deg(const XrVector3f& a, const XrVector3f& b);
+}
+
+#endif // GAZE_QUALITY_H
@@ -0,0 +1,332 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "gaze_reactor.h"
+#include "alloc_counter.h"
+#include "gaze_broadcast.h"
+#include "gaze_flight_recorder.h"
+#include "gaze_telemetry.h"
+#include "Tracing.h"
+
+#include <algorithm>
+#include <assert.h>
+
+namespace BVR
+{
+
+GazeReactor::GazeReactor(const ShimConfigStore& config_store)
+	: config_store_(config_store)
+{
+}
+
+GazeReactor::~GazeReactor()
+{
+	// Joining from here would block the loader lock on the reactor thread's exit
+	assert(!thread_.joinable());
+}
+
+int GazeReactor::attach(GazePublisher& publisher)
+{
+	std::lock_guard<std::mutex> activation_lock(activation_mutex_);
+
+	int num_attached = num_attached_.load(std::memory_order_relaxed);
+
+	{
+		std::lock_guard<std::mutex> lock(publishers_mutex_);
+
+		if(std::find(publishers_, publishers_ + num_attached, &publisher) != publishers_ + num_attached)
+		{
+			return num_attached;
+		}
+
+		if(num_attached == GAZE_REACTOR_MAX_PUBLISHERS)
+		{
+			return -1;
+		}
+
+		publishers_[num_attached++] = &publisher;
+		num_attached_.store(num_attached, std::memory_order_relaxed);
+	}
+
+	TraceLoggingWrite(TraceProvider, "GazeReactor_Attach", TLArg(num_attached, "Attached"));
+
+	if(num_attached == 1)
+	{
+		is_running_ = true;
+		thread_ = std::thread(&GazeReactor::run, this);
+
+#if ENABLE_PSVR2_EYE_TRACKING
+		// Calibration sessions run next to it, asleep until "psvr2_shim calibrate start"
+		loop_.get_calibration_session().start_thread();
+#endif
+	}
+
+	return num_attached;
+}
+
+int GazeReactor::detach(GazePublisher& publisher)
+{
+	std::lock_guard<std::mutex> activation_lock(activation_mutex_);
+
+	int num_attached = num_attached_.load(std::memory_order_relaxed);
+
+	{
+		std::lock_guard<std::mutex> lock(publishers_mutex_);
+
+		GazePublisher** const end = publishers_ + num_attached;
+		GazePublisher** const found = std::find(publishers_, end, &publisher);
+
+		if(found == end)
+		{
+			return num_attached;
+		}
+
+		// Order doesn't matter, the last one takes its place
+		*found = publishers_[--num_attached];
+		publishers_[num_attached] = nullptr;
+		num_attached_.store(num_attached, std::memory_order_relaxed);
+	}
+
+	TraceLoggingWrite(TraceProvider, "GazeReactor_Detach", TLArg(num_attached, "Attached"));
+
+	if(num_attached == 0)
+	{
+		stop_thread();
+	}
+
+	return num_attached;
+}
+
+void GazeReactor::stop()
+{
+	std::lock_guard<std::mutex> activation_lock(activation_mutex_);
+
+	{
+		std::lock_guard<std::mutex> lock(publishers_mutex_);
+
+		std::fill(publishers_, publishers_ + GAZE_REACTOR_MAX_PUBLISHERS, nullptr);
+		num_attached_.store(0, std::memory_order_relaxed);
+	}
+
+	TraceLoggingWrite(TraceProvider, "GazeReactor_Stop", TLArg(is_running(), "Running"));
+
+	stop_thread();
+}
+
+void GazeReactor::stop_thread()
+{
+#if ENABLE_PSVR2_EYE_TRACKING
+	loop_.get_calibration_session().stop_thread();
+#endif
+
+	if(is_running_.exchange(false))
+	{
+		waiter_.wake();
+		thread_.join();
+	}
+
+#if ENABLE_PSVR2_EYE_TRACKING
+	// Nobody to publish to, don't keep the server's connection busy
+	tracker_.disconnect();
+#endif
+}
+
+void GazeReactor::enter_standby()
+{
+	standby_requested_ = true;
+	waiter_.wake();
+}
+
+void GazeReactor::leave_standby()
+{
+	leave_standby_requested_ = true;
+	waiter_.wake();
+}
+
+void GazeReactor::publish(const GazeUpdate& update)
+{
+	// Uncontended unless a device is (de)activating right now
+	std::lock_guard<std::mutex> lock(publishers_mutex_);
+
+	const int num_attached = num_attached_.load(std::memory_order_relaxed);
+
+	for(int index = 0; index < num_attached; index++)
+	{
+		publishers_[index]->publish(update);
+	}
+}
+
+void GazeReactor::run()
+{
+	TraceLocalActivity(local);
+	TraceLoggingWriteStart(local, "GazeReactor_Thread");
+
+	if(host_)
+	{
+		host_->on_thread_start();
+	}
+
+	// Settings are swapped in by the driver, reading them is a single atomic load.
+	GazeUpdateLoop& loop = loop_;
+	GazePollScheduler& scheduler = loop.get_scheduler();
+	loop.start(config_store_.get(), get_steady_time_us());
+
+	// Live stats for overlays and monitoring tools, in shared memory so they don't go through vrserver.
+	GazeTelemetryWriter telemetry;
+
+	// Every new sample re-served to local consumers, so they can share this connection to the server.
+	GazeBroadcastWriter broadcast;
+
+#if ENABLE_ALLOCATION_COUNTING
+	uint64_t polls = 0;
+#endif
+
+	// How late each wakeup is and how long each poll takes, traced once a second rather than
+	// every iteration (TRACE_LEVEL_SUMMARY).
+	TraceSummaryDeclare(wakeup_lateness_us);
+	TraceSummaryDeclare(poll_duration_us);
+	TraceVerboseDeclare(sleep_sampler);
+
+	while(true)
+	{
+		const int64_t wake_up_us = loop.get_next_poll_time_us();
+
+		// Wait for the next time to update.
+		{
+			TraceVerboseActivity(sleep);
+			TraceVerboseStart(sleep_sampler, sleep, "GazeReactor_Thread_Sleep");
+
+			// The scheduler decides the refresh rate, the last detach and standby changes cut the wait short.
+			waiter_.wait_until_us(wake_up_us);
+
+			TraceVerboseStop(sleep, "GazeReactor_Thread_Sleep", TLArg(is_running_.load(), "Running"));
+
+			if(!is_running_)
+			{
+				break;
+			}
+		}
+
+		const int64_t now_us = get_steady_time_us();
+
+		if(standby_requested_.exchange(false))
+		{
+			loop.enter_standby(now_us);
+		}
+
+		if(leave_standby_requested_.exchange(false))
+		{
+			loop.leave_standby(now_us);
+		}
+
+		const GazePowerState previous_power_state = scheduler.get_state();
+
+#if ENABLE_ALLOCATION_COUNTING
+		const AllocationScope allocations;
+#endif
+
+		const ShimConfig& config = config_store_.get();
+
+		// Priority, affinity and timer resolution follow the settings, a no-op while they don't change
+		thread_policy_.apply(config.get_thread_settings());
+		thread_policy_.begin_poll();
+
+		if(host_)
+		{
+			host_->before_poll(loop, config, now_us);
+		}
+
+		loop.run_once(config, now_us, *this);
+
+		// Wakeups cut short by a standby change are early, not late
+		const int64_t lateness_us = now_us - wake_up_us;
+		const int64_t duration_us = get_steady_time_us() - now_us;
+
+		thread_policy_.end_poll(std::max<int64_t>(lateness_us, 0));
+
+		if(lateness_us >= 0)
+		{
+			loop.get_loop_stats().wakeup_lateness_us_.add(lateness_us);
+		}
+
+		loop.get_loop_stats().poll_duration_us_.add(duration_us);
+
+		telemetry.set_enabled(config.telemetry_enabled_, now_us);
+		telemetry.record(loop, now_us);
+
+		broadcast.set_enabled(config.broadcast_enabled_, now_us);
+		broadcast.record(loop);
+
+		if(flight_recorder_)
+		{
+			flight_recorder_->record(loop, now_us);
+		}
+
+		TraceSummaryAdd(wakeup_lateness_us, lateness_us);
+		TraceSummaryAdd(poll_duration_us, duration_us);
+		TraceSummaryFlush(local, "GazeReactor_Thread_WakeupLatenessUs", wakeup_lateness_us, now_us);
+		TraceSummaryFlush(local, "GazeReactor_Thread_PollDurationUs", poll_duration_us, now_us);
+
+#if ENABLE_ALLOCATION_COUNTING
+		if(++polls > ALLOCATION_COUNTING_WARMUP_POLLS && allocations.get_allocations() > 0)
+		{
+			steady_state_allocations_ += allocations.get_allocations();
+
+			TraceLoggingWriteTagged(local,
+				"GazeReactor_Thread_Allocations",
+				TLArg(allocations.get_allocations(), "Count"),
+				TLArg(allocations.get_bytes(), "Bytes"));
+		}
+#endif
+
+		if(scheduler.get_state() != previous_power_state)
+		{
+			TraceLoggingWriteTagged(local,
+				"GazeReactor_Thread_PowerState",
+				TLArg(get_power_state_name(scheduler.get_state()), "State"));
+		}
+	}
+
+	// MMCSS registrations and timer resolution requests belong to this thread, give them back here
+	thread_policy_.revert();
+
+	scheduler.flush_stats(get_steady_time_us());
+
+	if(host_)
+	{
+		host_->on_thread_stop(*this);
+	}
+
+	TraceLoggingWriteStop(local, "GazeReactor_Thread");
+}
+
+GazeReactor& get_gaze_reactor()
+{
+	static GazeReactor reactor(get_shim_config_store());
+	return reactor;
+}
+
+} // BVR
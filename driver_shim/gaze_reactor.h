@@ -0,0 +1,148 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef GAZE_REACTOR_H
+#define GAZE_REACTOR_H
+
+#include "defines.h"
+#include "gaze_poll_scheduler.h"
+#include "gaze_thread_policy.h"
+#include "gaze_update_loop.h"
+#include "shim_config.h"
+
+#if ENABLE_PSVR2_EYE_TRACKING
+#include "psvr2_eye_tracking.h"
+#endif
+
+#include <atomic>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+
+#define GAZE_REACTOR_MAX_PUBLISHERS 8  // Devices fed at once, more than vrserver ever registers
+
+namespace BVR
+{
+	class GazeFlightRecorder;
+	class GazeReactor;
+
+	// What only the driver can do around the reactor's polls (OpenVR properties, its log, naming the thread).
+	// Everything here is called on the reactor thread.
+	class GazeReactorHost
+	{
+	public:
+		virtual ~GazeReactorHost() {}
+
+		virtual void on_thread_start() {}
+		virtual void before_poll(GazeUpdateLoop& /*loop*/, const ShimConfig& /*config*/, const int64_t /*now_us*/) {}
+		virtual void on_thread_stop(GazeReactor& /*reactor*/) {}
+	};
+
+	// The driver's single update thread and upstream connection, shared by every shimmed device. Devices
+	// attach their publisher when they activate and detach it when they deactivate: the first attach starts
+	// the thread, the last detach stops it and closes the connection. Every poll goes out to all attached
+	// publishers, so a second HMD registration (a driver reload, the _orig DLL) is one more publisher rather
+	// than one more thread polling the server.
+	// The thread must be stopped before the reactor is destroyed: by the last detach(), or stop() from the
+	// driver's Cleanup. A static destructor runs under the loader lock on Windows, no place to join.
+	class GazeReactor : private GazePublisher
+	{
+	public:
+		explicit GazeReactor(const ShimConfigStore& config_store);
+		~GazeReactor();
+
+		// Set these before the first attach().
+		void set_host(GazeReactorHost* host) { host_ = host; }
+		void set_flight_recorder(GazeFlightRecorder* flight_recorder) { flight_recorder_ = flight_recorder; }
+
+		// Any thread. Return how many publishers are attached afterwards, attach() -1 when they're all taken.
+		// Attaching twice counts once. Once detach() returns, the publisher won't be called again.
+		int attach(GazePublisher& publisher);
+		int detach(GazePublisher& publisher);
+
+		// Any thread but the reactor's. Detaches every publisher and stops the thread, for devices that were
+		// never deactivated.
+		void stop();
+
+		int get_num_attached() const { return num_attached_.load(std::memory_order_relaxed); }
+		bool is_running() const { return is_running_.load(std::memory_order_relaxed); }
+
+		// Any thread, the reactor thread picks them up on its next wakeup.
+		void enter_standby();
+		void leave_standby();
+
+		// The loop's stats are readable from anywhere, the rest is the reactor thread's.
+		GazeUpdateLoop& get_loop() { return loop_; }
+		GazeThreadStats& get_thread_stats() { return thread_policy_.get_stats(); }
+
+#if ENABLE_PSVR2_EYE_TRACKING
+		const PSVR2EyeTracker& get_tracker() const { return tracker_; }
+#endif
+
+		// Heap allocations the reactor thread made past ALLOCATION_COUNTING_WARMUP_POLLS, 0 without counting.
+		uint64_t get_steady_state_allocations() const { return steady_state_allocations_; }
+
+	private:
+		void run();
+		void stop_thread();
+		void publish(const GazeUpdate& update) override;
+
+		const ShimConfigStore& config_store_;
+		GazeReactorHost* host_ = nullptr;
+		GazeFlightRecorder* flight_recorder_ = nullptr;
+
+#if ENABLE_PSVR2_EYE_TRACKING
+		PSVR2EyeTracker tracker_;
+		GazeUpdateLoop loop_{ tracker_, true };
+#else
+		GazeUpdateLoop loop_;
+#endif
+
+		// Serializes attach / detach, and with them starting and stopping the thread
+		std::mutex activation_mutex_;
+
+		// Held by the reactor thread while it fans a poll out, so detach() can't pull a publisher from under it
+		std::mutex publishers_mutex_;
+		GazePublisher* publishers_[GAZE_REACTOR_MAX_PUBLISHERS] = {};
+		std::atomic<int> num_attached_ = 0;
+
+		std::thread thread_;
+		std::atomic<bool> is_running_ = false;
+		GazePollWaiter waiter_;
+
+		// Only changed by the reactor thread, its stats are readable from anywhere.
+		GazeThreadPolicy thread_policy_;
+		std::atomic<bool> standby_requested_ = false;
+		std::atomic<bool> leave_standby_requested_ = false;
+
+		uint64_t steady_state_allocations_ = 0;
+	};
+
+	// The driver's, reading get_shim_config_store().
+	GazeReactor& get_gaze_reactor();
+}
+
+#endif // GAZE_REACTOR_H
@@ -0,0 +1,175 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "gaze_replay.h"
+#include "gaze_poll_scheduler.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+namespace BVR
+{
+
+bool read_flight_dump_samples(const char* path, std::vector<GazeFlightRecord>& samples)
+{
+	samples.clear();
+
+	FILE* file = fopen(path, "rb");
+
+	if(!file)
+	{
+		return false;
+	}
+
+	GazeFlightDumpHeader header = {};
+	const bool is_dump = (fread(&header, sizeof(header), 1, file) == 1) &&
+		(header.magic_ == GAZE_FLIGHT_DUMP_MAGIC) &&
+		(header.version_ == GAZE_FLIGHT_DUMP_VERSION) &&
+		(header.record_size_ == sizeof(GazeFlightRecord));
+
+	if(is_dump)
+	{
+		samples.reserve(header.num_records_);
+
+		GazeFlightRecord record;
+
+		// A crash can cut the file short, keep what made it
+		for(uint32_t index = 0; (index < header.num_records_) && (fread(&record, sizeof(record), 1, file) == 1); index++)
+		{
+			if((record.kind_ == (uint16_t)GazeFlightRecordKind::POLL_) && (record.new_samples_ > 0))
+			{
+				samples.push_back(record);
+			}
+		}
+	}
+
+	fclose(file);
+
+	return !samples.empty();
+}
+
+bool GazeReplayTransport::open(const char* endpoint)
+{
+	close();
+
+	if(!read_flight_dump_samples(endpoint, samples_))
+	{
+		return false;
+	}
+
+	const int64_t span_us = samples_.back().time_us_ - samples_.front().time_us_;
+	const int64_t interval_us = (samples_.size() > 1) ? span_us / (int64_t)(samples_.size() - 1) : 0;
+
+	duration_us_ = std::max<int64_t>(span_us + interval_us, 1);
+	open_time_us_ = get_steady_time_us();
+	is_open_ = true;
+
+	return true;
+}
+
+void GazeReplayTransport::close()
+{
+	is_open_ = false;
+	has_response_ = false;
+}
+
+void GazeReplayTransport::fill_response(const int64_t replay_time_us)
+{
+	const int64_t pass = replay_time_us / duration_us_;
+	const int64_t first_time_us = samples_.front().time_us_;
+	const int64_t time_us = first_time_us + (replay_time_us % duration_us_);
+
+	// The newest sample recorded at or before that point of the pass
+	const auto newer = std::upper_bound(samples_.begin(), samples_.end(), time_us,
+		[](const int64_t time, const GazeFlightRecord& record) { return time < record.time_us_; });
+
+	const size_t index = (size_t)std::max<ptrdiff_t>(newer - samples_.begin() - 1, 0);
+	const GazeFlightRecord& record = samples_[index];
+
+	response_ = SequencedResponse();
+	response_.type_ = GET_GAZES_OK_;
+	response_.sequence_number_ = (uint64_t)pass * samples_.size() + index + 1;
+
+	XRGazeState gaze;
+	gaze.direction_ = { record.combined_gaze_[0], record.combined_gaze_[1], record.combined_gaze_[2] };
+	gaze.is_valid_ = (record.flags_ & GAZE_FLIGHT_FLAG_AVAILABLE) != 0;
+	response_.gazes_.combined_gaze_ = gaze;
+
+	gaze.is_valid_ = (record.flags_ & GAZE_FLIGHT_FLAG_LEFT_VALID) != 0;
+	response_.gazes_.per_eye_gazes_[LEFT] = gaze;
+
+	gaze.is_valid_ = (record.flags_ & GAZE_FLIGHT_FLAG_RIGHT_VALID) != 0;
+	response_.gazes_.per_eye_gazes_[RIGHT] = gaze;
+}
+
+bool GazeReplayTransport::send(const void* data, const size_t size)
+{
+	if(!is_open_ || (size != sizeof(Request)))
+	{
+		return false;
+	}
+
+	Request request;
+	memcpy(&request, data, sizeof(request));
+
+	switch(request.type_)
+	{
+		case START_HANDSHAKE_:
+			response_ = SequencedResponse();
+			response_.type_ = HANDSHAKE_OK_;
+			break;
+
+		case GET_GAZES_:
+			fill_response((now_us_ >= 0) ? now_us_ : (get_steady_time_us() - open_time_us_));
+			break;
+
+		default:
+			response_ = SequencedResponse();
+			response_.type_ = ERROR_;
+			break;
+	}
+
+	has_response_ = true;
+
+	return true;
+}
+
+bool GazeReplayTransport::receive(void* data, const size_t capacity, size_t& size_read)
+{
+	if(!is_open_ || !has_response_)
+	{
+		return false;
+	}
+
+	memcpy(data, &response_, (sizeof(response_) < capacity) ? sizeof(response_) : capacity);
+	size_read = sizeof(response_);
+	has_response_ = false;
+
+	return true;
+}
+
+} // BVR
@@ -0,0 +1,82 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef GAZE_REPLAY_H
+#define GAZE_REPLAY_H
+
+#include "defines.h"
+#include "gaze_flight_recorder.h"
+#include "psvr2_protocol.h"
+#include "psvr2_transport.h"
+
+#include <stdint.h>
+#include <vector>
+
+namespace BVR
+{
+	// The POLL_ records of a flight recorder dump that brought a new sample, oldest first. False if the file
+	// isn't a dump of this version or holds no sample at all.
+	bool read_flight_dump_samples(const char* path, std::vector<GazeFlightRecord>& samples);
+
+	// Plays a flight recorder dump back the way a server would serve it. open() takes the dump's path (and
+	// reads it, the only allocation), GET_GAZES answers with the newest recorded sample as of the time since
+	// open(), at the recorded pace, and starts over at the end with the sequence numbers still counting up.
+	//
+	// Dumps hold the combined gaze as it was published, not what the server sent, so both eyes get that
+	// direction with the validity recorded for each.
+	class GazeReplayTransport final : public PSVR2Transport
+	{
+	public:
+		bool open(const char* endpoint) override;
+		void close() override;
+		bool is_open() const override { return is_open_; }
+
+		bool send(const void* data, const size_t size) override;
+		bool receive(void* data, const size_t capacity, size_t& size_read) override;
+
+		PSVR2ExchangeFunction get_exchange_function() const override { return &exchange_messages<GazeReplayTransport>; }
+
+		// Time since open() to replay at, instead of the steady clock. -1 goes back to the clock.
+		void set_now_us(const int64_t now_us) { now_us_ = now_us; }
+
+		size_t get_num_samples() const { return samples_.size(); }
+		int64_t get_duration_us() const { return duration_us_; }
+
+	private:
+		void fill_response(const int64_t replay_time_us);
+
+		std::vector<GazeFlightRecord> samples_;
+		int64_t duration_us_ = 0;   // One pass, including the usual interval back to the first sample
+
+		bool is_open_ = false;
+		bool has_response_ = false;
+		int64_t now_us_ = -1;
+		int64_t open_time_us_ = 0;
+		SequencedResponse response_;
+	};
+}
+
+#endif // GAZE_REPLAY_H
@@ -0,0 +1,150 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "gaze_sanitizer.h"
+#include "gaze_math.h"
+
+#include <math.h>
+
+namespace BVR
+{
+
+// Cosine of the largest angle the eye can turn through in n samples, so the velocity test is one dot product
+struct MaxAngleTable
+{
+	float min_cos_[GAZE_SANITIZE_MAX_SAMPLES_SINCE_VALID + 1];
+
+	MaxAngleTable()
+	{
+		const float max_radians_per_sample = (GAZE_SANITIZE_MAX_DEG_PER_S / GAZE_SANITIZE_SAMPLE_RATE_HZ) * 0.0174532925f;
+
+		for(int samples = 0; samples <= GAZE_SANITIZE_MAX_SAMPLES_SINCE_VALID; samples++)
+		{
+			const float radians = max_radians_per_sample * (float)samples;
+			min_cos_[samples] = (radians < 3.14159265f) ? cosf(radians) : -2.0f;
+		}
+	}
+};
+
+static const MaxAngleTable g_max_angle_table;
+static const float g_spike_min_cos = cosf(GAZE_SANITIZE_SPIKE_DEG * 0.0174532925f);
+
+// The update thread is the only writer, a plain load and store is enough and skips the locked add
+static inline void add_count(std::atomic<uint64_t>& counter, const bool is_counted)
+{
+	counter.store(counter.load(std::memory_order_relaxed) + is_counted, std::memory_order_relaxed);
+}
+
+static inline float median3(const float a, const float b, const float c)
+{
+	const float low = (a < b) ? a : b;
+	const float high = (a < b) ? b : a;
+
+	return (c < low) ? low : ((c > high) ? high : c);
+}
+
+XRGazeState GazeSanitizer::sanitize(const int track_index, const XRGazeState& gaze, const uint64_t sample_delta)
+{
+	Track& track = tracks_[track_index];
+
+	// NaN and Inf anywhere turn the length into NaN or Inf, which fails the range test too
+	const GazeVector direction = gaze_vector_load(gaze.direction_);
+	const float length = gaze_vector_length3(direction);
+	const bool is_finite = (length >= GAZE_SANITIZE_MIN_LENGTH) && (length <= GAZE_SANITIZE_MAX_LENGTH);
+	const GazeVector unit = is_finite ? gaze_vector_scale(direction, 1.0f / length) : gaze_vector_forward();
+
+	const bool is_claimed_valid = gaze.is_valid_;
+	const bool is_renormalized = is_claimed_valid && is_finite && (fabsf(length - 1.0f) > GAZE_SANITIZE_RENORMALIZE_TOLERANCE);
+	bool is_valid = is_claimed_valid && is_finite;
+
+	XRGazeState sanitized;
+	sanitized.direction_ = gaze_vector_store(unit);
+
+	// How far the eye could have gone since the last accepted gaze, blinks and missed samples included
+	const uint64_t samples = track.samples_since_last_ + ((sample_delta > 0) ? sample_delta : 1);
+	track.samples_since_last_ = (samples < GAZE_SANITIZE_MAX_SAMPLES_SINCE_VALID) ? samples : GAZE_SANITIZE_MAX_SAMPLES_SINCE_VALID;
+
+	const float min_cos = g_max_angle_table.min_cos_[track.samples_since_last_];
+	const bool is_too_fast = is_valid && track.has_last_ && (track.rejections_ < GAZE_SANITIZE_MAX_REJECTIONS) &&
+		(gaze_vector_dot3(gaze_vector_load(track.last_), unit) < min_cos);
+
+	is_valid = is_valid && !is_too_fast;
+	track.rejections_ = is_too_fast ? track.rejections_ + 1 : 0;
+
+	add_count(stats_.non_finite_, is_claimed_valid && !is_finite);
+	add_count(stats_.renormalized_, is_renormalized);
+	add_count(stats_.too_fast_, is_too_fast);
+
+	if(!is_valid)
+	{
+		// Don't let the median reach across the gap
+		track.history_count_ = 0;
+		sanitized.is_valid_ = false;
+		return sanitized;
+	}
+
+	track.has_last_ = true;
+	track.last_ = sanitized.direction_;
+	track.samples_since_last_ = 0;
+
+	track.history_[track.history_index_] = sanitized.direction_;
+	track.history_index_ = (track.history_index_ == 2) ? 0 : track.history_index_ + 1;
+	track.history_count_ += (track.history_count_ < 3);
+
+	sanitized.is_valid_ = true;
+
+	if(is_median_filter_enabled_ && track.history_count_ == 3)
+	{
+		const XrVector3f& a = track.history_[0];
+		const XrVector3f& b = track.history_[1];
+		const XrVector3f& c = track.history_[2];
+
+		const XrVector3f median = { median3(a.x, b.x, c.x), median3(a.y, b.y, c.y), median3(a.z, b.z, c.z) };
+		const bool is_changed = (median.x != sanitized.direction_.x) || (median.y != sanitized.direction_.y) || (median.z != sanitized.direction_.z);
+
+		if(is_changed)
+		{
+			// Per component medians of unit vectors are a little short
+			const GazeVector filtered = gaze_vector_normalize3(gaze_vector_load(median));
+
+			// The median of a moving eye trails it by a sample, only a newest gaze far off it was a spike
+			add_count(stats_.spikes_, gaze_vector_dot3(filtered, gaze_vector_load(sanitized.direction_)) < g_spike_min_cos);
+			sanitized.direction_ = gaze_vector_store(filtered);
+		}
+	}
+
+	return sanitized;
+}
+
+void GazeSanitizer::reset()
+{
+	for(Track& track : tracks_)
+	{
+		track = Track();
+	}
+}
+
+} // BVR
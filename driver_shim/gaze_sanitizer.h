@@ -0,0 +1,108 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef GAZE_SANITIZER_H
+#define GAZE_SANITIZER_H
+
+#include "defines.h"
+#include "psvr2_protocol.h"
+
+#include <atomic>
+#include <stdint.h>
+
+#define GAZE_SANITIZER_TRACKS 3                     // Left, right and combined, indexed like the calibrations
+
+#define GAZE_SANITIZE_MIN_LENGTH 0.5f               // Directions are meant to be unit length, anything outside
+#define GAZE_SANITIZE_MAX_LENGTH 2.0f               // this is garbage rather than rounding
+#define GAZE_SANITIZE_RENORMALIZE_TOLERANCE 0.001f  // Off by more than this counts as renormalized
+#define GAZE_SANITIZE_MAX_DEG_PER_S 1000.0f         // Faster than any saccade
+#define GAZE_SANITIZE_SAMPLE_RATE_HZ 120.0f         // Of the eye tracker, turns the velocity into an angle per sample
+#define GAZE_SANITIZE_MAX_REJECTIONS 2              // In a row, after that the eye really went there
+#define GAZE_SANITIZE_MAX_SAMPLES_SINCE_VALID 120   // Caps the allowed jump after a long blink
+#define GAZE_SANITIZE_SPIKE_DEG 2.0f                // The median filter moved a gaze this far, anything less is the eye moving
+
+namespace BVR
+{
+	// Written by the update thread only, readable from anywhere.
+	struct GazeSanitizeStats
+	{
+		std::atomic<uint64_t> non_finite_ = 0;      // Valid gazes with a NaN, Inf or wildly off length direction
+		std::atomic<uint64_t> renormalized_ = 0;    // Valid gazes that weren't quite unit length
+		std::atomic<uint64_t> too_fast_ = 0;        // Rejected for moving faster than an eye can
+		std::atomic<uint64_t> spikes_ = 0;          // Moved by the median filter by more than GAZE_SANITIZE_SPIKE_DEG
+
+		void reset()
+		{
+			non_finite_.store(0, std::memory_order_relaxed);
+			renormalized_.store(0, std::memory_order_relaxed);
+			too_fast_.store(0, std::memory_order_relaxed);
+			spikes_.store(0, std::memory_order_relaxed);
+		}
+	};
+
+	// Makes whatever the server sent safe to hand on: unit length finite directions, and invalid where it
+	// can't be. Gazes that moved further since the last accepted one than GAZE_SANITIZE_MAX_DEG_PER_S allows
+	// are marked invalid, and the optional median of 3 filter removes single sample spikes (at the cost of
+	// delaying real steps by a sample).
+	//
+	// Keeps per gaze history, so feed it every new sample once, in order. The pipeline does, through
+	// SanitizeStage.
+	class GazeSanitizer
+	{
+	public:
+		// sample_delta is the number of server samples since the previous call (1 without gaps).
+		XRGazeState sanitize(const int track_index, const XRGazeState& gaze, const uint64_t sample_delta);
+
+		void set_median_filter(const bool enabled) { is_median_filter_enabled_ = enabled; }
+		bool is_median_filter_enabled() const { return is_median_filter_enabled_; }
+
+		// Forgets the history, on reconnects and pipeline changes.
+		void reset();
+
+		GazeSanitizeStats& get_stats() { return stats_; }
+		const GazeSanitizeStats& get_stats() const { return stats_; }
+
+	private:
+		struct Track
+		{
+			bool has_last_ = false;
+			XrVector3f last_ = { 0.0f, 0.0f, -1.0f };      // Last accepted direction
+			uint64_t samples_since_last_ = 0;
+			int rejections_ = 0;
+
+			XrVector3f history_[3] = {};                    // Accepted directions for the median, ring
+			int history_count_ = 0;
+			int history_index_ = 0;
+		};
+
+		Track tracks_[GAZE_SANITIZER_TRACKS];
+		bool is_median_filter_enabled_ = false;
+
+		GazeSanitizeStats stats_;
+	};
+}
+
+#endif // GAZE_SANITIZER_H
@@ -0,0 +1,123 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef GAZE_SEQLOCK_H
+#define GAZE_SEQLOCK_H
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+namespace BVR
+{
+	// Single writer seqlock halves, on a sequence and a value stored wherever the caller needs them (the
+	// shared memory blocks have fixed layouts). The sequence is odd while the writer is in the middle of an
+	// update and even once it's done, 0 means never written. Readers copy the value out and retry if the
+	// sequence moved under them, they never block the writer. Works across processes as long as the
+	// sequence is lock free.
+
+	// next_sequence is the even value the write ends on, the odd one below it marks the update in progress.
+	template<typename Sequence, typename Value>
+	inline void write_gaze_seqlock(std::atomic<Sequence>& sequence, const Sequence next_sequence, Value& storage, const Value& value)
+	{
+		static_assert(std::is_trivially_copyable<Value>::value, "the value is copied byte for byte");
+
+		sequence.store(next_sequence - 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		memcpy(&storage, &value, sizeof(value));
+
+		sequence.store(next_sequence, std::memory_order_release);
+	}
+
+	// One attempt at the write that ended on expected_sequence, false if it isn't there or got overwritten.
+	template<typename Sequence, typename Value>
+	inline bool read_gaze_seqlock_at(const std::atomic<Sequence>& sequence, const Sequence expected_sequence, const Value& storage, Value& value)
+	{
+		if(sequence.load(std::memory_order_acquire) != expected_sequence)
+		{
+			return false;
+		}
+
+		memcpy(&value, &storage, sizeof(value));
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		return sequence.load(std::memory_order_relaxed) == expected_sequence;
+	}
+
+	// The latest write, false before the first one or if the writer kept getting in the way.
+	template<typename Sequence, typename Value>
+	inline bool read_gaze_seqlock(const std::atomic<Sequence>& sequence, const Value& storage, Value& value, const int max_retries)
+	{
+		for(int attempt = 0; attempt < max_retries; attempt++)
+		{
+			const Sequence sequence_before = sequence.load(std::memory_order_acquire);
+
+			if(sequence_before == 0)
+			{
+				return false;
+			}
+
+			if(sequence_before & 1)
+			{
+				continue;
+			}
+
+			memcpy(&value, &storage, sizeof(value));
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			if(sequence.load(std::memory_order_relaxed) == sequence_before)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	// The same around a trivially copyable value of its own, within a process.
+	template<typename Value>
+	class GazeSeqlock
+	{
+	public:
+		void write(const Value& value)
+		{
+			// Single writer, so a plain load is enough to know where the sequence is
+			write_gaze_seqlock(sequence_, sequence_.load(std::memory_order_relaxed) + 2, value_, value);
+		}
+
+		bool read(Value& value, const int max_retries = 64) const
+		{
+			return read_gaze_seqlock(sequence_, value_, value, max_retries);
+		}
+
+	private:
+		std::atomic<uint32_t> sequence_ = 0;
+		Value value_ = {};
+	};
+}
+
+#endif // GAZE_SEQLOCK_H
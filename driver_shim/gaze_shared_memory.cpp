@@ -0,0 +1,212 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "gaze_shared_memory.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace BVR
+{
+
+#ifdef _WIN32
+
+bool GazeSharedMemory::create(const char* name, const size_t size)
+{
+	close();
+
+	HANDLE mapping_handle = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)size, name);
+
+	if(!mapping_handle)
+	{
+		return false;
+	}
+
+	void* data = MapViewOfFile(mapping_handle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+
+	if(!data)
+	{
+		CloseHandle(mapping_handle);
+		return false;
+	}
+
+	mapping_handle_ = mapping_handle;
+	data_ = data;
+	size_ = size;
+
+	return true;
+}
+
+bool GazeSharedMemory::open(const char* name, const size_t min_size)
+{
+	close();
+
+	HANDLE mapping_handle = OpenFileMappingA(FILE_MAP_READ, FALSE, name);
+
+	if(!mapping_handle)
+	{
+		return false;
+	}
+
+	void* data = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+
+	MEMORY_BASIC_INFORMATION info = {};
+
+	if(!data || !VirtualQuery(data, &info, sizeof(info)) || (info.RegionSize < min_size))
+	{
+		if(data)
+		{
+			UnmapViewOfFile(data);
+		}
+
+		CloseHandle(mapping_handle);
+		return false;
+	}
+
+	mapping_handle_ = mapping_handle;
+	data_ = data;
+	size_ = info.RegionSize;
+
+	return true;
+}
+
+void GazeSharedMemory::close()
+{
+	if(data_)
+	{
+		UnmapViewOfFile(data_);
+		data_ = nullptr;
+	}
+
+	if(mapping_handle_)
+	{
+		CloseHandle((HANDLE)mapping_handle_);
+		mapping_handle_ = nullptr;
+	}
+
+	size_ = 0;
+}
+
+#else
+
+bool GazeSharedMemory::create(const char* name, const size_t size)
+{
+	close();
+
+	const int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+
+	if(fd < 0)
+	{
+		return false;
+	}
+
+	if(ftruncate(fd, (off_t)size) != 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+	void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+
+	if(data == MAP_FAILED)
+	{
+		return false;
+	}
+
+	data_ = data;
+	size_ = size;
+	is_owner_ = true;
+	strncpy(name_, name, GAZE_SHARED_MEMORY_MAX_NAME - 1);
+
+	return true;
+}
+
+bool GazeSharedMemory::open(const char* name, const size_t min_size)
+{
+	close();
+
+	const int fd = shm_open(name, O_RDONLY, 0);
+
+	if(fd < 0)
+	{
+		return false;
+	}
+
+	struct stat status = {};
+
+	if(fstat(fd, &status) != 0 || (size_t)status.st_size < min_size)
+	{
+		::close(fd);
+		return false;
+	}
+
+	void* data = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+
+	if(data == MAP_FAILED)
+	{
+		return false;
+	}
+
+	data_ = data;
+	size_ = (size_t)status.st_size;
+	is_owner_ = false;
+
+	return true;
+}
+
+void GazeSharedMemory::close()
+{
+	if(data_)
+	{
+		munmap(data_, size_);
+		data_ = nullptr;
+	}
+
+	if(is_owner_)
+	{
+		// Readers keep their mapping, new ones won't find the name anymore
+		shm_unlink(name_);
+		is_owner_ = false;
+	}
+
+	size_ = 0;
+}
+
+#endif
+
+} // BVR
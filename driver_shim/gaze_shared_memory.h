@@ -0,0 +1,73 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef GAZE_SHARED_MEMORY_H
+#define GAZE_SHARED_MEMORY_H
+
+#include <stddef.h>
+
+#define GAZE_SHARED_MEMORY_MAX_NAME 128
+
+namespace BVR
+{
+	// A named block of memory other processes on the machine can map: a pagefile backed file mapping on
+	// Windows, shm_open() elsewhere. The creator writes, readers map it read only.
+	class GazeSharedMemory
+	{
+	public:
+		GazeSharedMemory() {}
+		~GazeSharedMemory() { close(); }
+
+		GazeSharedMemory(const GazeSharedMemory&) = delete;
+		GazeSharedMemory& operator=(const GazeSharedMemory&) = delete;
+
+		// Creates (or takes over a stale) block of at least size bytes, zero filled when new. The name is
+		// removed again on close() where the platform keeps names alive without a handle (POSIX).
+		bool create(const char* name, const size_t size);
+
+		// Maps an existing block read only. Fails if it is smaller than min_size.
+		bool open(const char* name, const size_t min_size);
+
+		void close();
+
+		bool is_open() const { return data_ != nullptr; }
+		void* get_data() const { return data_; }
+		size_t get_size() const { return size_; }
+
+	private:
+		void* data_ = nullptr;
+		size_t size_ = 0;
+
+#ifdef _WIN32
+		void* mapping_handle_ = nullptr;
+#else
+		bool is_owner_ = false;
+		char name_[GAZE_SHARED_MEMORY_MAX_NAME] = {};
+#endif
+	};
+}
+
+#endif // GAZE_SHARED_MEMORY_H
@@ -0,0 +1,98 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef GAZE_SLOT_POOL_H
+#define GAZE_SLOT_POOL_H
+
+#include "gaze_pipeline.h"
+#include "psvr2_protocol.h"
+
+#include <stdint.h>
+
+#define GAZE_SLOT_POOL_SIZE 2                       // The newest sample, and the next one being received
+#define GAZE_SLOT_INVALID 0xFFFFFFFFu
+#define GAZE_CACHE_LINE_SIZE 64
+
+namespace BVR
+{
+	// One received sample and everything derived from it. The transport reads straight into response_,
+	// the pipeline reads it in place and writes frame_ next to it, and the publisher reads both in place.
+	struct alignas(GAZE_CACHE_LINE_SIZE) GazeSlot
+	{
+		SequencedResponse response_;
+		GazeFrame frame_;
+		bool has_sequence_number_ = false;
+	};
+
+	// Fixed set of preallocated slots for the tracker: it receives into a free one, so a failed or duplicate
+	// answer leaves the newest sample alone, and releases whichever of the two it doesn't keep.
+	//
+	// Single threaded: the free list is plain integers, so acquire, release and every read of a slot must
+	// happen on the thread that polls the tracker (the update thread in the driver). Slots aren't frozen
+	// either, the tracker reruns the pipeline on its current slot in place when the gaze settings change and
+	// reuses it after the next new sample. Copy the frame to keep a sample or hand it to another thread.
+	class GazeSlotPool
+	{
+	public:
+		GazeSlotPool()
+		{
+			for(uint32_t index = 0; index < GAZE_SLOT_POOL_SIZE; index++)
+			{
+				free_slots_[index] = GAZE_SLOT_POOL_SIZE - 1 - index;
+			}
+
+			num_free_slots_ = GAZE_SLOT_POOL_SIZE;
+		}
+
+		// GAZE_SLOT_INVALID when every slot is held.
+		uint32_t acquire()
+		{
+			if(num_free_slots_ == 0)
+			{
+				return GAZE_SLOT_INVALID;
+			}
+
+			return free_slots_[--num_free_slots_];
+		}
+
+		void release(const uint32_t index)
+		{
+			free_slots_[num_free_slots_++] = index;
+		}
+
+		GazeSlot& get(const uint32_t index) { return slots_[index]; }
+		const GazeSlot& get(const uint32_t index) const { return slots_[index]; }
+
+		uint32_t get_num_free_slots() const { return num_free_slots_; }
+
+	private:
+		GazeSlot slots_[GAZE_SLOT_POOL_SIZE];
+		uint32_t free_slots_[GAZE_SLOT_POOL_SIZE];
+		uint32_t num_free_slots_ = 0;
+	};
+}
+
+#endif // GAZE_SLOT_POOL_H
@@ -0,0 +1,134 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "gaze_source.h"
+#include "gaze_calibration.h"
+#include "gaze_replay.h"
+#include "psvr2_server_simulator.h"
+#include "shim_config.h"
+
+namespace BVR
+{
+
+namespace
+{
+	std::unique_ptr<PSVR2Transport> create_simulated_transport()
+	{
+		PSVR2ServerSimulatorSettings settings;
+		settings.synthesize_eye_movements_ = true;
+
+		return std::unique_ptr<PSVR2Transport>(new PSVR2SimulatedTransport(settings));
+	}
+
+	std::unique_ptr<PSVR2Transport> create_replay_transport()
+	{
+		return std::unique_ptr<PSVR2Transport>(new GazeReplayTransport());
+	}
+
+	struct GazeSourceInfo
+	{
+		GazeSourceType type_;
+		std::unique_ptr<PSVR2Transport> (*create_transport_)();
+	};
+
+	// Sources compiled into this build. The first one is the fallback.
+	const GazeSourceInfo GAZE_SOURCES[] =
+	{
+		{ GazeSourceType::PSVR2_, &create_default_transport },
+#if SUPPORT_SIMULATED_EYE_TRACKING
+		{ GazeSourceType::SIMULATED_, &create_simulated_transport },
+#endif
+#if SUPPORT_GAZE_REPLAY
+		{ GazeSourceType::REPLAY_, &create_replay_transport },
+#endif
+	};
+
+	const GazeSourceInfo* find_gaze_source(const GazeSourceType type)
+	{
+		for(const GazeSourceInfo& source : GAZE_SOURCES)
+		{
+			if(source.type_ == type)
+			{
+				return &source;
+			}
+		}
+
+		return nullptr;
+	}
+
+	bool is_absolute_path(const char* path)
+	{
+#ifdef _WIN32
+		return (path[0] == '\\') || (path[0] == '/') || ((path[0] != '\0') && (path[1] == ':'));
+#else
+		return path[0] == '/';
+#endif
+	}
+}
+
+const char* get_gaze_source_name(const GazeSourceType type)
+{
+	switch(type)
+	{
+		case GazeSourceType::PSVR2_:
+			return "psvr2";
+		case GazeSourceType::SIMULATED_:
+			return "simulated";
+		case GazeSourceType::REPLAY_:
+			return "replay";
+		default:
+			return "unknown";
+	}
+}
+
+bool is_gaze_source_supported(const GazeSourceType type)
+{
+	return find_gaze_source(type) != nullptr;
+}
+
+std::unique_ptr<PSVR2Transport> create_gaze_source_transport(const GazeSourceType type)
+{
+	const GazeSourceInfo* source = find_gaze_source(type);
+
+	return (source ? source : &GAZE_SOURCES[0])->create_transport_();
+}
+
+std::string get_gaze_source_endpoint(const GazeSourceType type, const ShimConfig& config)
+{
+	switch(is_gaze_source_supported(type) ? type : GazeSourceType::PSVR2_)
+	{
+		case GazeSourceType::SIMULATED_:
+			return std::string();
+
+		case GazeSourceType::REPLAY_:
+			return is_absolute_path(config.replay_file_) ? std::string(config.replay_file_) : get_default_calibration_directory() + config.replay_file_;
+
+		default:
+			return std::string(config.server_pipe_name_);
+	}
+}
+
+} // BVR
@@ -0,0 +1,64 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef GAZE_SOURCE_H
+#define GAZE_SOURCE_H
+
+#include "defines.h"
+#include "psvr2_transport.h"
+
+#include <memory>
+#include <string>
+
+namespace BVR
+{
+	struct ShimConfig;
+
+	// Where gazes come from, the gazeSource setting. Every source speaks the PSVR2 protocol through its own
+	// transport, so they all share the tracker's decoding, deduplication, sanitization and calibration.
+	enum class GazeSourceType
+	{
+		PSVR2_,       // The PSVR2 server, over the named pipe (a unix domain socket elsewhere)
+		SIMULATED_,   // A PSVR2ServerSimulator synthesizing eye movements in process
+		REPLAY_,      // A flight recorder dump played back at its recorded pace
+		NUM_SOURCES_,
+	};
+
+	const char* get_gaze_source_name(const GazeSourceType type);
+
+	// Whether the source was compiled in (SUPPORT_* in defines.h).
+	bool is_gaze_source_supported(const GazeSourceType type);
+
+	// A new transport for the source, the PSVR2 server's for sources that weren't compiled in. Its
+	// get_exchange_function() is bound to its own type, the tracker calls nothing virtual per poll.
+	std::unique_ptr<PSVR2Transport> create_gaze_source_transport(const GazeSourceType type);
+
+	// What the source's transport opens: the server pipe, or the dump file for REPLAY_ (relative to the
+	// calibration directory unless absolute). Nothing for SIMULATED_.
+	std::string get_gaze_source_endpoint(const GazeSourceType type, const ShimConfig& config);
+}
+
+#endif // GAZE_SOURCE_H
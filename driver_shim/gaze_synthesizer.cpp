@@ -0,0 +1,369 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "gaze_synthesizer.h"
+
+#include <math.h>
+
+namespace BVR
+{
+
+static const float SYNTHESIZER_DEG_TO_RAD = 0.0174532925f;
+static const float SYNTHESIZER_RAD_TO_DEG = 57.2957795f;
+static const uint64_t SYNTHESIZER_NEVER = ~0ull;
+
+static inline uint64_t xorshift64star(uint64_t& state)
+{
+	state ^= state >> 12;
+	state ^= state << 25;
+	state ^= state >> 27;
+	return state * 0x2545f4914f6cdd1dull;
+}
+
+static inline float clamp_deg(const float value, const float limit)
+{
+	return (value < -limit) ? -limit : ((value > limit) ? limit : value);
+}
+
+// Minimum jerk position profile, 0 to 1 over tau from 0 to 1
+static inline float get_min_jerk(const float tau)
+{
+	return tau * tau * tau * (10.0f + tau * (-15.0f + tau * 6.0f));
+}
+
+static inline XrVector3f get_direction(const float yaw_deg, const float pitch_deg)
+{
+	const float yaw = yaw_deg * SYNTHESIZER_DEG_TO_RAD;
+	const float pitch = pitch_deg * SYNTHESIZER_DEG_TO_RAD;
+	const float cos_pitch = cosf(pitch);
+
+	return { sinf(yaw) * cos_pitch, sinf(pitch), -cosf(yaw) * cos_pitch };
+}
+
+const char* get_gaze_movement_name(const GazeMovement movement)
+{
+	switch(movement)
+	{
+	case GazeMovement::FIXATION_:
+		return "fixation";
+	case GazeMovement::MICROSACCADE_:
+		return "microsaccade";
+	case GazeMovement::SACCADE_:
+		return "saccade";
+	case GazeMovement::PURSUIT_:
+		return "pursuit";
+	case GazeMovement::BLINK_:
+		return "blink";
+	case GazeMovement::TRACKING_LOSS_:
+		return "tracking_loss";
+	default:
+		return "unknown";
+	}
+}
+
+GazeSynthesizer::GazeSynthesizer()
+{
+	reset(GazeSynthesizerSettings());
+}
+
+GazeSynthesizer::GazeSynthesizer(const GazeSynthesizerSettings& settings)
+{
+	reset(settings);
+}
+
+void GazeSynthesizer::reset(const GazeSynthesizerSettings& settings)
+{
+	settings_ = settings;
+	samples_per_ms_ = settings_.sample_rate_hz_ * 1e-3;
+	rng_state_ = settings_.seed_ ? settings_.seed_ : 1;
+	sample_index_ = 0;
+
+	yaw_deg_ = 0.0f;
+	pitch_deg_ = 0.0f;
+	vergence_deg_ = get_vergence_deg(next_uniform(settings_.min_fixation_distance_m_, settings_.max_fixation_distance_m_));
+
+	start_fixation(0);
+
+	next_blink_ = next_event_after(0, settings_.blink_rate_);
+	blink_end_ = 0;
+	next_tracking_loss_ = next_event_after(0, settings_.tracking_loss_rate_);
+	tracking_loss_end_ = 0;
+	lost_eye_ = INVALID_INDEX;
+}
+
+float GazeSynthesizer::next_uniform()
+{
+	// 24 bits, exactly representable
+	return (float)(xorshift64star(rng_state_) >> 40) * (1.0f / 16777216.0f);
+}
+
+float GazeSynthesizer::next_uniform(const float low, const float high)
+{
+	return low + (high - low) * next_uniform();
+}
+
+float GazeSynthesizer::next_noise()
+{
+	// Sum of four uniforms scaled to unit variance, close enough to gaussian for sensor noise and a lot
+	// cheaper than Box-Muller
+	const float sum = next_uniform() + next_uniform() + next_uniform() + next_uniform();
+	return (sum - 2.0f) * 1.7320508f;
+}
+
+uint64_t GazeSynthesizer::next_duration_samples(const float min_ms, const float max_ms)
+{
+	const double samples = (double)next_uniform(min_ms, max_ms) * samples_per_ms_;
+	return (samples < 1.0) ? 1 : (uint64_t)llround(samples);
+}
+
+uint64_t GazeSynthesizer::next_event_after(const uint64_t index, const float rate)
+{
+	if(!(rate > 0.0f))
+	{
+		return SYNTHESIZER_NEVER;
+	}
+
+	// Poisson process, exponentially distributed intervals
+	const double seconds = -log(1.0 - (double)next_uniform()) / (double)rate;
+	const double samples = seconds * settings_.sample_rate_hz_;
+
+	return index + 1 + (uint64_t)samples;
+}
+
+float GazeSynthesizer::get_vergence_deg(const float distance_m) const
+{
+	return 2.0f * atanf(0.5f * settings_.ipd_meters_ / distance_m) * SYNTHESIZER_RAD_TO_DEG;
+}
+
+void GazeSynthesizer::start_fixation(const uint64_t index)
+{
+	movement_ = GazeMovement::FIXATION_;
+	fixation_end_ = index + next_duration_samples(settings_.fixation_min_ms_, settings_.fixation_max_ms_);
+	movement_end_ = fixation_end_;
+
+	fixation_yaw_deg_ = yaw_deg_;
+	fixation_pitch_deg_ = pitch_deg_;
+
+	next_microsaccade_ = next_event_after(index, settings_.microsaccade_rate_);
+}
+
+void GazeSynthesizer::start_after_fixation(const uint64_t index)
+{
+	if(next_uniform() < settings_.pursuit_share_)
+	{
+		start_pursuit(index);
+		return;
+	}
+
+	// Log uniform amplitudes, small saccades are a lot more common than large ones
+	const float amplitude = settings_.saccade_min_deg_ * powf(settings_.saccade_max_deg_ / settings_.saccade_min_deg_, next_uniform());
+	const float angle = next_uniform(0.0f, 6.2831853f);
+
+	const float target_yaw = clamp_deg(yaw_deg_ + amplitude * cosf(angle), settings_.field_yaw_deg_);
+	const float target_pitch = clamp_deg(pitch_deg_ + amplitude * sinf(angle), settings_.field_pitch_deg_);
+
+	// Uniform in diopters, like the distances things are usually looked at from
+	const float min_diopters = 1.0f / settings_.max_fixation_distance_m_;
+	const float max_diopters = 1.0f / settings_.min_fixation_distance_m_;
+	const float target_vergence = get_vergence_deg(1.0f / next_uniform(min_diopters, max_diopters));
+
+	start_saccade(index, target_yaw, target_pitch, target_vergence, GazeMovement::SACCADE_);
+}
+
+void GazeSynthesizer::start_saccade(const uint64_t index, const float target_yaw_deg, const float target_pitch_deg, const float target_vergence_deg, const GazeMovement movement)
+{
+	const float delta_yaw = target_yaw_deg - yaw_deg_;
+	const float delta_pitch = target_pitch_deg - pitch_deg_;
+	const float amplitude = sqrtf(delta_yaw * delta_yaw + delta_pitch * delta_pitch);
+
+	// Main sequence
+	const double duration_ms = 21.0 + 2.2 * (double)amplitude;
+	const uint64_t duration = (uint64_t)llround(duration_ms * samples_per_ms_);
+
+	movement_ = movement;
+	movement_start_ = index;
+	movement_end_ = index + ((duration > 0) ? duration : 1);
+
+	start_yaw_deg_ = yaw_deg_;
+	start_pitch_deg_ = pitch_deg_;
+	start_vergence_deg_ = vergence_deg_;
+	target_yaw_deg_ = target_yaw_deg;
+	target_pitch_deg_ = target_pitch_deg;
+	target_vergence_deg_ = target_vergence_deg;
+}
+
+void GazeSynthesizer::start_pursuit(const uint64_t index)
+{
+	const float speed = next_uniform(0.2f, 1.0f) * settings_.pursuit_max_deg_per_s_;
+	const float angle = next_uniform(0.0f, 6.2831853f);
+	const float step = speed / (float)settings_.sample_rate_hz_;
+
+	movement_ = GazeMovement::PURSUIT_;
+	movement_start_ = index;
+	movement_end_ = index + next_duration_samples(settings_.pursuit_min_ms_, settings_.pursuit_max_ms_);
+
+	pursuit_yaw_step_ = step * cosf(angle);
+	pursuit_pitch_step_ = step * sinf(angle);
+}
+
+void GazeSynthesizer::update_position(const uint64_t index)
+{
+	switch(movement_)
+	{
+	case GazeMovement::SACCADE_:
+	case GazeMovement::MICROSACCADE_:
+	{
+		// Reaches the target on the last sample
+		const float tau = (float)(index - movement_start_ + 1) / (float)(movement_end_ - movement_start_);
+		const float progress = get_min_jerk(tau);
+
+		yaw_deg_ = start_yaw_deg_ + (target_yaw_deg_ - start_yaw_deg_) * progress;
+		pitch_deg_ = start_pitch_deg_ + (target_pitch_deg_ - start_pitch_deg_) * progress;
+		vergence_deg_ = start_vergence_deg_ + (target_vergence_deg_ - start_vergence_deg_) * progress;
+		break;
+	}
+	case GazeMovement::PURSUIT_:
+	{
+		yaw_deg_ += pursuit_yaw_step_;
+		pitch_deg_ += pursuit_pitch_step_;
+
+		// Bounce off the edges of the field
+		if(fabsf(yaw_deg_) > settings_.field_yaw_deg_)
+		{
+			yaw_deg_ = clamp_deg(yaw_deg_, settings_.field_yaw_deg_);
+			pursuit_yaw_step_ = -pursuit_yaw_step_;
+		}
+
+		if(fabsf(pitch_deg_) > settings_.field_pitch_deg_)
+		{
+			pitch_deg_ = clamp_deg(pitch_deg_, settings_.field_pitch_deg_);
+			pursuit_pitch_step_ = -pursuit_pitch_step_;
+		}
+		break;
+	}
+	default:
+		yaw_deg_ = clamp_deg(yaw_deg_ + next_noise() * settings_.drift_deg_, settings_.field_yaw_deg_);
+		pitch_deg_ = clamp_deg(pitch_deg_ + next_noise() * settings_.drift_deg_, settings_.field_pitch_deg_);
+		break;
+	}
+}
+
+GazeMovement GazeSynthesizer::next(AllXRGazeStates& gazes)
+{
+	const uint64_t index = sample_index_;
+
+	if(index >= movement_end_)
+	{
+		if(movement_ == GazeMovement::MICROSACCADE_ && (index < fixation_end_))
+		{
+			movement_ = GazeMovement::FIXATION_;
+			movement_end_ = fixation_end_;
+		}
+		else if(movement_ == GazeMovement::FIXATION_ || movement_ == GazeMovement::MICROSACCADE_)
+		{
+			start_after_fixation(index);
+		}
+		else
+		{
+			start_fixation(index);
+		}
+	}
+
+	if((movement_ == GazeMovement::FIXATION_) && (index >= next_microsaccade_))
+	{
+		// Corrects the drift, back to somewhere near the fixation point
+		const float reach = 0.5f * settings_.microsaccade_max_deg_;
+		const float target_yaw = fixation_yaw_deg_ + next_uniform(-reach, reach);
+		const float target_pitch = fixation_pitch_deg_ + next_uniform(-reach, reach);
+
+		start_saccade(index, target_yaw, target_pitch, vergence_deg_, GazeMovement::MICROSACCADE_);
+		next_microsaccade_ = next_event_after(index, settings_.microsaccade_rate_);
+	}
+
+	update_position(index);
+
+	// Blinks and tracking loss hide the eyes, they keep moving underneath
+	if(index >= next_blink_)
+	{
+		blink_end_ = index + next_duration_samples(settings_.blink_min_ms_, settings_.blink_max_ms_);
+		next_blink_ = next_event_after(blink_end_, settings_.blink_rate_);
+	}
+
+	if(index >= next_tracking_loss_)
+	{
+		tracking_loss_end_ = index + next_duration_samples(settings_.tracking_loss_min_ms_, settings_.tracking_loss_max_ms_);
+		next_tracking_loss_ = next_event_after(tracking_loss_end_, settings_.tracking_loss_rate_);
+
+		const float which = next_uniform();
+		lost_eye_ = (which < 0.25f) ? LEFT : ((which < 0.5f) ? RIGHT : INVALID_INDEX);
+	}
+
+	const bool is_blinking = index < blink_end_;
+	const bool is_lost = index < tracking_loss_end_;
+	const bool is_left_valid = !is_blinking && !(is_lost && (lost_eye_ != RIGHT));
+	const bool is_right_valid = !is_blinking && !(is_lost && (lost_eye_ != LEFT));
+
+	const float left_noise_yaw = next_noise() * settings_.noise_deg_;
+	const float left_noise_pitch = next_noise() * settings_.noise_deg_;
+	const float right_noise_yaw = next_noise() * settings_.noise_deg_;
+	const float right_noise_pitch = next_noise() * settings_.noise_deg_;
+
+	// The left eye turns right to converge in front, and the other way around
+	const float half_vergence = 0.5f * vergence_deg_;
+
+	gazes.per_eye_gazes_[LEFT].direction_ = get_direction(yaw_deg_ + half_vergence + left_noise_yaw, pitch_deg_ + left_noise_pitch);
+	gazes.per_eye_gazes_[LEFT].is_valid_ = is_left_valid;
+
+	gazes.per_eye_gazes_[RIGHT].direction_ = get_direction(yaw_deg_ - half_vergence + right_noise_yaw, pitch_deg_ + right_noise_pitch);
+	gazes.per_eye_gazes_[RIGHT].is_valid_ = is_right_valid;
+
+	gazes.combined_gaze_.direction_ = get_direction(yaw_deg_ + 0.5f * (left_noise_yaw + right_noise_yaw), pitch_deg_ + 0.5f * (left_noise_pitch + right_noise_pitch));
+	gazes.combined_gaze_.is_valid_ = is_left_valid || is_right_valid;
+
+	sample_index_++;
+
+	if(is_blinking)
+	{
+		return GazeMovement::BLINK_;
+	}
+
+	return is_lost ? GazeMovement::TRACKING_LOSS_ : movement_;
+}
+
+void GazeSynthesizer::generate(AllXRGazeStates* gazes, GazeMovement* movements, const size_t count)
+{
+	for(size_t index = 0; index < count; index++)
+	{
+		const GazeMovement movement = next(gazes[index]);
+
+		if(movements)
+		{
+			movements[index] = movement;
+		}
+	}
+}
+
+} // BVR
@@ -0,0 +1,167 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef GAZE_SYNTHESIZER_H
+#define GAZE_SYNTHESIZER_H
+
+#include "defines.h"
+#include "psvr2_protocol.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace BVR
+{
+	// What the eyes were doing for a synthesized sample, the ground truth for classifiers.
+	enum class GazeMovement : uint8_t
+	{
+		FIXATION_,
+		MICROSACCADE_,
+		SACCADE_,
+		PURSUIT_,
+		BLINK_,
+		TRACKING_LOSS_,  // One or both eyes lost, the other one may still be valid
+	};
+
+	const char* get_gaze_movement_name(const GazeMovement movement);
+
+	// Rates are per second, durations in milliseconds, angles in degrees. The defaults are typical adult
+	// values from the eye movement literature, tracking loss aside.
+	struct GazeSynthesizerSettings
+	{
+		uint64_t seed_ = 1;
+		double sample_rate_hz_ = 120.0;
+
+		float field_yaw_deg_ = 30.0f;           // Gazes stay within +-this horizontally
+		float field_pitch_deg_ = 20.0f;         // and vertically
+
+		float fixation_min_ms_ = 150.0f;
+		float fixation_max_ms_ = 600.0f;
+		float microsaccade_rate_ = 1.5f;        // During fixations
+		float microsaccade_max_deg_ = 0.5f;
+
+		float saccade_min_deg_ = 2.0f;
+		float saccade_max_deg_ = 30.0f;
+
+		float pursuit_share_ = 0.15f;           // Share of the fixation ends followed by pursuit instead of a saccade
+		float pursuit_min_ms_ = 400.0f;
+		float pursuit_max_ms_ = 2000.0f;
+		float pursuit_max_deg_per_s_ = 30.0f;
+
+		float blink_rate_ = 0.25f;
+		float blink_min_ms_ = 100.0f;
+		float blink_max_ms_ = 300.0f;
+
+		float tracking_loss_rate_ = 0.02f;
+		float tracking_loss_min_ms_ = 200.0f;
+		float tracking_loss_max_ms_ = 2000.0f;
+
+		float drift_deg_ = 0.005f;              // Random walk per sample during fixations, microsaccades pull it back
+		float noise_deg_ = 0.03f;               // Per eye, per axis, roughly gaussian
+		float ipd_meters_ = 0.063f;             // Per eye gazes converge on a point
+		float min_fixation_distance_m_ = 0.5f;
+		float max_fixation_distance_m_ = 5.0f;
+	};
+
+	// Deterministic synthetic eye movements: fixations with drift, noise and microsaccades, saccades along
+	// the main sequence (duration = 21 ms + 2.2 ms per degree, minimum jerk profile), smooth pursuit,
+	// blinks and tracking loss, with the per eye gazes verging on a point at a random distance. The same
+	// seed and settings always give the same stream.
+	//
+	// Cheap enough for offline sweeps over millions of samples: no allocations and a handful of sinf /
+	// cosf per sample.
+	class GazeSynthesizer
+	{
+	public:
+		GazeSynthesizer();
+		explicit GazeSynthesizer(const GazeSynthesizerSettings& settings);
+
+		void reset(const GazeSynthesizerSettings& settings);
+
+		// The next sample, one sample period after the previous one.
+		GazeMovement next(AllXRGazeStates& gazes);
+
+		// count samples in one go, movements may be null.
+		void generate(AllXRGazeStates* gazes, GazeMovement* movements, const size_t count);
+
+		uint64_t get_sample_index() const { return sample_index_; }
+		const GazeSynthesizerSettings& get_settings() const { return settings_; }
+
+	private:
+		float next_uniform();
+		float next_uniform(const float low, const float high);
+		float next_noise();
+		uint64_t next_duration_samples(const float min_ms, const float max_ms);
+		uint64_t next_event_after(const uint64_t index, const float rate);
+
+		void start_fixation(const uint64_t index);
+		void start_after_fixation(const uint64_t index);
+		void start_saccade(const uint64_t index, const float target_yaw_deg, const float target_pitch_deg, const float target_vergence_deg, const GazeMovement movement);
+		void start_pursuit(const uint64_t index);
+		void update_position(const uint64_t index);
+		float get_vergence_deg(const float distance_m) const;
+
+		GazeSynthesizerSettings settings_;
+		double samples_per_ms_ = 0.0;
+		uint64_t rng_state_ = 1;
+		uint64_t sample_index_ = 0;
+
+		// Where the eyes point, the cyclopean direction plus the angle between the two eyes
+		float yaw_deg_ = 0.0f;
+		float pitch_deg_ = 0.0f;
+		float vergence_deg_ = 0.0f;
+
+		GazeMovement movement_ = GazeMovement::FIXATION_;
+		uint64_t movement_end_ = 0;            // Sample index the current movement ends at
+		uint64_t fixation_end_ = 0;            // A microsaccade interrupts a fixation without ending it
+
+		// Where the current fixation is, microsaccades return to it
+		float fixation_yaw_deg_ = 0.0f;
+		float fixation_pitch_deg_ = 0.0f;
+
+		// Saccades and microsaccades, interpolated from start to target
+		float start_yaw_deg_ = 0.0f;
+		float start_pitch_deg_ = 0.0f;
+		float start_vergence_deg_ = 0.0f;
+		float target_yaw_deg_ = 0.0f;
+		float target_pitch_deg_ = 0.0f;
+		float target_vergence_deg_ = 0.0f;
+		uint64_t movement_start_ = 0;
+
+		// Pursuit, in degrees per sample
+		float pursuit_yaw_step_ = 0.0f;
+		float pursuit_pitch_step_ = 0.0f;
+
+		uint64_t next_microsaccade_ = 0;
+		uint64_t next_blink_ = 0;
+		uint64_t blink_end_ = 0;
+		uint64_t next_tracking_loss_ = 0;
+		uint64_t tracking_loss_end_ = 0;
+		int lost_eye_ = INVALID_INDEX;          // INVALID_INDEX for both
+	};
+}
+
+#endif // GAZE_SYNTHESIZER_H
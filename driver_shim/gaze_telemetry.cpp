@@ -0,0 +1,216 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "gaze_telemetry.h"
+#include "gaze_seqlock.h"
+
+namespace BVR
+{
+
+void write_gaze_telemetry(GazeTelemetryBlock& block, const GazeTelemetrySnapshot& snapshot)
+{
+	// Single writer, so a plain load is enough to know where the sequence is
+	write_gaze_seqlock(block.sequence_, block.sequence_.load(std::memory_order_relaxed) + 2, block.snapshot_, snapshot);
+}
+
+bool read_gaze_telemetry(const GazeTelemetryBlock& block, GazeTelemetrySnapshot& snapshot, const int max_retries)
+{
+	return read_gaze_seqlock(block.sequence_, block.snapshot_, snapshot, max_retries);
+}
+
+void GazeTelemetryWriter::set_enabled(const bool enabled, const int64_t now_us, const char* name)
+{
+	if(!enabled)
+	{
+		close();
+		has_open_attempt_ = false;
+		return;
+	}
+
+	if(is_open() || (has_open_attempt_ && (now_us - last_open_attempt_us_) < GAZE_TELEMETRY_OPEN_RETRY_US))
+	{
+		return;
+	}
+
+	has_open_attempt_ = true;
+	last_open_attempt_us_ = now_us;
+	open(name);
+}
+
+bool GazeTelemetryWriter::open(const char* name)
+{
+	close();
+
+	if(!memory_.create(name, sizeof(GazeTelemetryBlock)))
+	{
+		return false;
+	}
+
+	// May be a stale block left behind by a crash, start over. Readers holding on to it see the sequence
+	// restart and simply read the fresh snapshot.
+	block_ = (GazeTelemetryBlock*)memory_.get_data();
+	block_->sequence_.store(0, std::memory_order_relaxed);
+	block_->size_ = sizeof(GazeTelemetryBlock);
+	block_->version_ = GAZE_TELEMETRY_VERSION;
+	block_->magic_ = GAZE_TELEMETRY_MAGIC;
+
+	snapshot_ = {};
+	has_poll_ = false;
+	write_gaze_telemetry(*block_, snapshot_);
+
+	return true;
+}
+
+void GazeTelemetryWriter::close()
+{
+	memory_.close();
+	block_ = nullptr;
+}
+
+void GazeTelemetryWriter::record(const GazeUpdateLoop& loop, const int64_t now_us)
+{
+	const GazeUpdate& update = loop.get_last_update();
+
+	if(!block_ || (has_poll_ && (update.poll_time_us_ == last_poll_time_us_)))
+	{
+		return;
+	}
+
+	has_poll_ = true;
+	last_poll_time_us_ = update.poll_time_us_;
+
+	GazeTelemetrySnapshot& snapshot = snapshot_;
+	snapshot.update_count_++;
+	snapshot.poll_time_us_ = update.poll_time_us_;
+
+	if(update.new_samples_ > 0)
+	{
+		last_new_sample_time_us_ = update.poll_time_us_;
+
+		const float is_valid = update.is_available_ ? 1.0f : 0.0f;
+		snapshot.validity_ratio_ += (is_valid - snapshot.validity_ratio_) * GAZE_TELEMETRY_VALIDITY_SMOOTHING;
+	}
+
+	// Against the estimated production time once the server cadence is known, the arrival time until then
+	const GazeCadenceEstimator& cadence = loop.get_scheduler().get_cadence_estimator();
+	const int64_t sample_time_us = cadence.is_locked() ? cadence.get_next_sample_time_us() - (int64_t)cadence.get_period_us() : last_new_sample_time_us_;
+	snapshot.sample_age_us_ = (now_us > sample_time_us) ? now_us - sample_time_us : 0;
+
+	snapshot.combined_gaze_[0] = update.combined_gaze_.x;
+	snapshot.combined_gaze_[1] = update.combined_gaze_.y;
+	snapshot.combined_gaze_[2] = update.combined_gaze_.z;
+	snapshot.combined_gaze_valid_ = update.is_available_;
+
+	snapshot.social_gazes_ = update.ipd_meters_ > 0.0f;
+	snapshot.ipd_meters_ = update.ipd_meters_;
+
+	for(int eye = 0; eye < NUM_EYES; eye++)
+	{
+		const XRGazeState gaze = snapshot.social_gazes_ ? update.social_gazes_[eye].gaze_ : (update.frame_ ? update.frame_->per_eye_gazes_[eye] : XRGazeState());
+		snapshot.per_eye_gazes_[eye][0] = gaze.direction_.x;
+		snapshot.per_eye_gazes_[eye][1] = gaze.direction_.y;
+		snapshot.per_eye_gazes_[eye][2] = gaze.direction_.z;
+		snapshot.per_eye_gazes_valid_[eye] = gaze.is_valid_;
+
+		const XrVector3f& origin = update.social_gazes_[eye].origin_;
+		snapshot.eye_origins_[eye][0] = origin.x;
+		snapshot.eye_origins_[eye][1] = origin.y;
+		snapshot.eye_origins_[eye][2] = origin.z;
+	}
+
+	const GazeLoopStats& loop_stats = loop.get_loop_stats();
+	const GazeLatencyHistogram& lateness = loop_stats.wakeup_lateness_us_;
+	const GazeLatencyHistogram& duration = loop_stats.poll_duration_us_;
+
+	snapshot.wakeup_lateness_us_ = lateness.get_last_us();
+	snapshot.wakeup_lateness_p50_us_ = lateness.get_percentile_us(50.0);
+	snapshot.wakeup_lateness_p99_us_ = lateness.get_percentile_us(99.0);
+	snapshot.poll_duration_p99_us_ = duration.get_percentile_us(99.0);
+
+	for(int bucket = 0; bucket < GAZE_LATENCY_HISTOGRAM_BUCKETS; bucket++)
+	{
+		snapshot.wakeup_lateness_buckets_[bucket] = lateness.get_bucket(bucket);
+		snapshot.poll_duration_buckets_[bucket] = duration.get_bucket(bucket);
+	}
+
+	const uint64_t connects = loop_stats.connects_.load(std::memory_order_relaxed);
+	snapshot.connected_ = loop_stats.connected_.load(std::memory_order_relaxed);
+	snapshot.connects_ = connects;
+	snapshot.reconnects_ = (connects > 1) ? connects - 1 : 0;
+	snapshot.power_state_ = (uint32_t)loop_stats.power_state_.load(std::memory_order_relaxed);
+
+	const GazeQualityStats& quality_stats = loop.get_quality_stats();
+	snapshot.quality_dropouts_ = quality_stats.dropouts_.load(std::memory_order_relaxed);
+	snapshot.quality_longest_dropout_us_ = quality_stats.longest_dropout_us_.load(std::memory_order_relaxed);
+	snapshot.quality_validity_ratio_ = quality_stats.validity_ratio_.load(std::memory_order_relaxed);
+	snapshot.quality_sample_rate_hz_ = quality_stats.sample_rate_hz_.load(std::memory_order_relaxed);
+	snapshot.quality_precision_rms_deg_ = quality_stats.precision_rms_deg_.load(std::memory_order_relaxed);
+	snapshot.smoothing_alpha_ = quality_stats.smoothing_alpha_.load(std::memory_order_relaxed);
+
+#if ENABLE_PSVR2_EYE_TRACKING
+	const GazePublishStats& publish_stats = loop.get_publish_stats();
+	snapshot.published_ = publish_stats.published_.load(std::memory_order_relaxed);
+	snapshot.deduplicated_ = publish_stats.deduplicated_.load(std::memory_order_relaxed);
+	snapshot.stale_ = publish_stats.stale_.load(std::memory_order_relaxed);
+	snapshot.missed_ = publish_stats.missed_.load(std::memory_order_relaxed);
+#endif
+
+	write_gaze_telemetry(*block_, snapshot);
+}
+
+bool GazeTelemetryReader::open(const char* name)
+{
+	close();
+
+	if(!memory_.open(name, sizeof(GazeTelemetryBlock)))
+	{
+		return false;
+	}
+
+	const GazeTelemetryBlock* block = (const GazeTelemetryBlock*)memory_.get_data();
+
+	if(block->magic_ != GAZE_TELEMETRY_MAGIC || block->version_ != GAZE_TELEMETRY_VERSION || block->size_ < sizeof(GazeTelemetryBlock))
+	{
+		memory_.close();
+		return false;
+	}
+
+	block_ = block;
+	return true;
+}
+
+void GazeTelemetryReader::close()
+{
+	memory_.close();
+	block_ = nullptr;
+}
+
+bool GazeTelemetryReader::read(GazeTelemetrySnapshot& snapshot) const
+{
+	return block_ && read_gaze_telemetry(*block_, snapshot);
+}
+
+} // BVR
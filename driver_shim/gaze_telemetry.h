@@ -0,0 +1,169 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef GAZE_TELEMETRY_H
+#define GAZE_TELEMETRY_H
+
+#include "defines.h"
+#include "gaze_debug_stats.h"
+#include "gaze_shared_memory.h"
+#include "gaze_update_loop.h"
+#include "psvr2_protocol.h"
+
+#include <atomic>
+#include <stdint.h>
+
+#ifdef _WIN32
+#define GAZE_TELEMETRY_SHM_NAME "Local\\PSVR2GazeTelemetry"
+#else
+#define GAZE_TELEMETRY_SHM_NAME "/psvr2_gaze_telemetry"
+#endif
+
+#define GAZE_TELEMETRY_MAGIC 0x54475350 // "PSGT"
+#define GAZE_TELEMETRY_VERSION 1        // Bumped on any change a version 1 reader would misread
+
+#define GAZE_TELEMETRY_VALIDITY_SMOOTHING 0.02f // Per new sample, so roughly the last 50 samples
+#define GAZE_TELEMETRY_OPEN_RETRY_US 1000000
+#define GAZE_TELEMETRY_READ_RETRIES 64
+
+namespace BVR
+{
+	// One consistent view of the update loop, as external tools see it. The layout is the contract with
+	// them: fixed width fields, 8 byte ones first, no implicit padding. New fields only ever go at the end
+	// (readers check GazeTelemetryBlock::size_), anything else bumps GAZE_TELEMETRY_VERSION.
+	struct GazeTelemetrySnapshot
+	{
+		uint64_t update_count_;          // Polls recorded since the block was created
+		int64_t poll_time_us_;           // Writer's steady clock, only meaningful as a difference
+		int64_t sample_age_us_;          // Since the newest sample was produced (estimated) or came in
+		int64_t wakeup_lateness_us_;     // Of the latest poll
+		int64_t wakeup_lateness_p50_us_;
+		int64_t wakeup_lateness_p99_us_;
+		int64_t poll_duration_p99_us_;
+
+		uint64_t connects_;
+		uint64_t reconnects_;
+		uint64_t published_;
+		uint64_t deduplicated_;
+		uint64_t stale_;
+		uint64_t missed_;
+
+		// Same power of two buckets as GazeLatencyHistogram
+		uint64_t wakeup_lateness_buckets_[GAZE_LATENCY_HISTOGRAM_BUCKETS];
+		uint64_t poll_duration_buckets_[GAZE_LATENCY_HISTOGRAM_BUCKETS];
+
+		float combined_gaze_[3];
+		float per_eye_gazes_[NUM_EYES][3];
+		float validity_ratio_;           // Share of recent new samples with a valid combined gaze
+
+		uint32_t combined_gaze_valid_;
+		uint32_t per_eye_gazes_valid_[NUM_EYES];
+		uint32_t connected_;
+		uint32_t power_state_;           // GazePowerState
+
+		// Over the last GAZE_QUALITY_WINDOW_US, see GazeQualityStats
+		uint32_t quality_dropouts_;
+		int64_t quality_longest_dropout_us_;
+		float quality_validity_ratio_;
+		float quality_sample_rate_hz_;
+		float quality_precision_rms_deg_;
+		float smoothing_alpha_;
+
+		// Social gazes (socialGazes setting): per_eye_gazes_ start at these origins, in head space (meters,
+		// x to the right). Both eyes and the combined gaze always come from the same sample.
+		float eye_origins_[NUM_EYES][3];
+		float ipd_meters_;
+		uint32_t social_gazes_;          // 1 while the setting is on
+	};
+
+	// What sits at the start of the shared memory. sequence_ is a seqlock around snapshot_ (gaze_seqlock.h):
+	// odd while the writer is in the middle of an update, bumped by two per update. Readers copy the snapshot
+	// out and retry if the sequence moved under them.
+	struct GazeTelemetryBlock
+	{
+		uint32_t magic_;
+		uint32_t version_;
+		uint32_t size_;                  // sizeof(GazeTelemetryBlock) of the writer
+		std::atomic<uint32_t> sequence_;
+
+		GazeTelemetrySnapshot snapshot_;
+	};
+
+	static_assert(std::atomic<uint32_t>::is_always_lock_free, "the seqlock must work across processes");
+	static_assert(sizeof(GazeTelemetrySnapshot) % 8 == 0, "keep the snapshot free of tail padding");
+
+	// Seqlock halves, usable on any block (the bench runs them on plain memory).
+	void write_gaze_telemetry(GazeTelemetryBlock& block, const GazeTelemetrySnapshot& snapshot);
+
+	// False if the writer kept getting in the way for max_retries attempts, or never wrote anything.
+	bool read_gaze_telemetry(const GazeTelemetryBlock& block, GazeTelemetrySnapshot& snapshot, const int max_retries = GAZE_TELEMETRY_READ_RETRIES);
+
+	// Fills the telemetry block from the update thread. Everything it reads is either the loop's own state
+	// or atomics, and all the work is a few hundred bytes of copying per poll.
+	class GazeTelemetryWriter
+	{
+	public:
+		// Follows the telemetryEnabled setting, retrying a failed open once every GAZE_TELEMETRY_OPEN_RETRY_US.
+		void set_enabled(const bool enabled, const int64_t now_us, const char* name = GAZE_TELEMETRY_SHM_NAME);
+
+		bool open(const char* name = GAZE_TELEMETRY_SHM_NAME);
+		void close();
+		bool is_open() const { return block_ != nullptr; }
+
+		// Call after every run_once(), records nothing unless the loop actually polled.
+		void record(const GazeUpdateLoop& loop, const int64_t now_us);
+
+	private:
+		GazeSharedMemory memory_;
+		GazeTelemetryBlock* block_ = nullptr;
+		GazeTelemetrySnapshot snapshot_ = {};
+
+		int64_t last_open_attempt_us_ = 0;
+		bool has_open_attempt_ = false;
+
+		int64_t last_poll_time_us_ = 0;
+		int64_t last_new_sample_time_us_ = 0;
+		bool has_poll_ = false;
+	};
+
+	// Maps a writer's block read only, for monitoring tools.
+	class GazeTelemetryReader
+	{
+	public:
+		// Fails if there's no block or it was written by an incompatible version.
+		bool open(const char* name = GAZE_TELEMETRY_SHM_NAME);
+		void close();
+		bool is_open() const { return block_ != nullptr; }
+
+		bool read(GazeTelemetrySnapshot& snapshot) const;
+
+	private:
+		GazeSharedMemory memory_;
+		const GazeTelemetryBlock* block_ = nullptr;
+	};
+}
+
+#endif // GAZE_TELEMETRY_H
@@ -0,0 +1,479 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "gaze_thread_policy.h"
+#include "gaze_poll_scheduler.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <avrt.h>
+#include <intrin.h>
+#include <mmsystem.h>
+#pragma comment(lib, "avrt.lib")
+#pragma comment(lib, "winmm.lib")
+#else
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+#include <string.h>
+
+namespace BVR
+{
+
+#ifndef _WIN32
+static inline int64_t get_clock_ns(const clockid_t clock)
+{
+	timespec time = {};
+	clock_gettime(clock, &time);
+
+	return (int64_t)time.tv_sec * 1000000000 + time.tv_nsec;
+}
+#endif
+
+const char* get_thread_priority_name(const GazeThreadPriority priority)
+{
+	switch(priority)
+	{
+	case GazeThreadPriority::DEFAULT_:
+		return "default";
+	case GazeThreadPriority::RAISED_:
+		return "raised";
+	case GazeThreadPriority::GAMES_:
+		return "games";
+	case GazeThreadPriority::PRO_AUDIO_:
+		return "pro_audio";
+	default:
+		return "unknown";
+	}
+}
+
+GazeThreadPolicy::~GazeThreadPolicy()
+{
+	revert();
+}
+
+void GazeThreadPolicy::apply(const GazeThreadSettings& settings)
+{
+	if(settings == settings_)
+	{
+		return;
+	}
+
+	settings_ = settings;
+
+	// Each part is put back before the new one goes in, so the previous values saved are always the
+	// thread's own
+	const bool priority_ok = apply_priority(settings.priority_);
+	const bool affinity_ok = apply_affinity(settings.affinity_mask_);
+	const bool timer_ok = apply_timer_resolution(settings.high_resolution_timer_);
+
+	stats_.apply_failures_.fetch_add((!priority_ok) + (!affinity_ok) + (!timer_ok), std::memory_order_relaxed);
+	stats_.priority_.store((int)applied_priority_, std::memory_order_relaxed);
+	stats_.affinity_mask_.store(applied_affinity_mask_, std::memory_order_relaxed);
+	stats_.high_resolution_timer_.store(applied_high_resolution_timer_, std::memory_order_relaxed);
+}
+
+void GazeThreadPolicy::revert()
+{
+	revert_priority();
+	revert_affinity();
+	revert_timer_resolution();
+
+	settings_ = GazeThreadSettings();
+
+	stats_.priority_.store((int)GazeThreadPriority::DEFAULT_, std::memory_order_relaxed);
+	stats_.affinity_mask_.store(0, std::memory_order_relaxed);
+	stats_.high_resolution_timer_.store(false, std::memory_order_relaxed);
+}
+
+void GazeThreadPolicy::end_poll(const int64_t wakeup_lateness_us)
+{
+	int64_t off_cpu_us = 0;
+	int64_t involuntary_switches = 0;
+
+#ifdef _WIN32
+	ULONG64 thread_cycles = 0;
+	QueryThreadCycleTime(GetCurrentThread(), &thread_cycles);
+
+	const uint64_t cycles = __rdtsc() - poll_start_cycles_;
+	const uint64_t run_cycles = thread_cycles - poll_start_thread_cycles_;
+
+	// Both count TSC cycles, the ratio says how much of the poll the thread actually ran
+	if(cycles > run_cycles)
+	{
+		const int64_t duration_us = get_steady_time_us() - poll_start_us_;
+		off_cpu_us = (int64_t)((double)duration_us * (double)(cycles - run_cycles) / (double)cycles);
+	}
+#else
+	const int64_t duration_ns = get_clock_ns(CLOCK_MONOTONIC) - poll_start_ns_;
+	const int64_t cpu_ns = get_clock_ns(CLOCK_THREAD_CPUTIME_ID) - poll_start_cpu_ns_;
+	off_cpu_us = (duration_ns > cpu_ns) ? (duration_ns - cpu_ns) / 1000 : 0;
+
+#ifdef __linux__
+	rusage usage = {};
+
+	if(getrusage(RUSAGE_THREAD, &usage) == 0)
+	{
+		involuntary_switches = (int64_t)usage.ru_nivcsw - poll_start_involuntary_switches_;
+	}
+#endif
+#endif
+
+	const bool is_late = wakeup_lateness_us > GAZE_THREAD_LATE_WAKEUP_US;
+	const bool is_off_cpu = off_cpu_us > GAZE_THREAD_OFF_CPU_US;
+
+	stats_.polls_.fetch_add(1, std::memory_order_relaxed);
+
+	if(is_late || is_off_cpu || (involuntary_switches > 0))
+	{
+		stats_.late_wakeups_.fetch_add(is_late, std::memory_order_relaxed);
+		stats_.off_cpu_polls_.fetch_add(is_off_cpu, std::memory_order_relaxed);
+		stats_.off_cpu_us_.fetch_add(is_off_cpu ? (uint64_t)off_cpu_us : 0, std::memory_order_relaxed);
+		stats_.involuntary_switches_.fetch_add((involuntary_switches > 0) ? (uint64_t)involuntary_switches : 0, std::memory_order_relaxed);
+	}
+}
+
+#ifdef _WIN32
+
+void GazeThreadPolicy::begin_poll()
+{
+	ULONG64 thread_cycles = 0;
+	QueryThreadCycleTime(GetCurrentThread(), &thread_cycles);
+
+	poll_start_us_ = get_steady_time_us();
+	poll_start_thread_cycles_ = thread_cycles;
+	poll_start_cycles_ = __rdtsc();
+}
+
+bool GazeThreadPolicy::apply_priority(const GazeThreadPriority priority)
+{
+	revert_priority();
+
+	if(priority == GazeThreadPriority::DEFAULT_)
+	{
+		return true;
+	}
+
+	if(priority == GazeThreadPriority::RAISED_)
+	{
+		previous_priority_ = GetThreadPriority(GetCurrentThread());
+
+		if(!SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST))
+		{
+			return false;
+		}
+
+		applied_priority_ = priority;
+		return true;
+	}
+
+	// MMCSS boosts the thread into the realtime range for as long as it's registered, without needing
+	// the process to run at realtime priority
+	DWORD task_index = 0;
+	const HANDLE handle = AvSetMmThreadCharacteristicsW((priority == GazeThreadPriority::PRO_AUDIO_) ? L"Pro Audio" : L"Games", &task_index);
+
+	if(!handle)
+	{
+		return false;
+	}
+
+	AvSetMmThreadPriority(handle, AVRT_PRIORITY_HIGH);
+
+	mmcss_handle_ = handle;
+	applied_priority_ = priority;
+
+	return true;
+}
+
+void GazeThreadPolicy::revert_priority()
+{
+	if(mmcss_handle_)
+	{
+		AvRevertMmThreadCharacteristics(mmcss_handle_);
+		mmcss_handle_ = nullptr;
+	}
+	else if(applied_priority_ == GazeThreadPriority::RAISED_)
+	{
+		SetThreadPriority(GetCurrentThread(), previous_priority_);
+	}
+
+	applied_priority_ = GazeThreadPriority::DEFAULT_;
+}
+
+bool GazeThreadPolicy::apply_affinity(const uint64_t affinity_mask)
+{
+	revert_affinity();
+
+	if(affinity_mask == 0)
+	{
+		return true;
+	}
+
+	const DWORD_PTR previous_mask = SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)affinity_mask);
+
+	if(previous_mask == 0)
+	{
+		return false;
+	}
+
+	previous_affinity_mask_ = previous_mask;
+	applied_affinity_mask_ = affinity_mask;
+
+	return true;
+}
+
+void GazeThreadPolicy::revert_affinity()
+{
+	if(applied_affinity_mask_ != 0)
+	{
+		SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)previous_affinity_mask_);
+		applied_affinity_mask_ = 0;
+	}
+}
+
+bool GazeThreadPolicy::apply_timer_resolution(const bool enabled)
+{
+	revert_timer_resolution();
+
+	if(!enabled)
+	{
+		return true;
+	}
+
+	// Process wide and reference counted, every begin needs its end
+	if(timeBeginPeriod(1) != TIMERR_NOERROR)
+	{
+		return false;
+	}
+
+	applied_high_resolution_timer_ = true;
+	return true;
+}
+
+void GazeThreadPolicy::revert_timer_resolution()
+{
+	if(applied_high_resolution_timer_)
+	{
+		timeEndPeriod(1);
+		applied_high_resolution_timer_ = false;
+	}
+}
+
+#else
+
+void GazeThreadPolicy::begin_poll()
+{
+#ifdef __linux__
+	rusage usage = {};
+	poll_start_involuntary_switches_ = (getrusage(RUSAGE_THREAD, &usage) == 0) ? (int64_t)usage.ru_nivcsw : 0;
+#endif
+
+	poll_start_cpu_ns_ = get_clock_ns(CLOCK_THREAD_CPUTIME_ID);
+	poll_start_ns_ = get_clock_ns(CLOCK_MONOTONIC);
+}
+
+bool GazeThreadPolicy::apply_priority(const GazeThreadPriority priority)
+{
+	revert_priority();
+
+	if(priority == GazeThreadPriority::DEFAULT_)
+	{
+		return true;
+	}
+
+	if(priority == GazeThreadPriority::RAISED_)
+	{
+#ifdef __linux__
+		// Nice values are per thread on Linux, lowering one needs CAP_SYS_NICE (or RLIMIT_NICE)
+		const pid_t thread_id = (pid_t)syscall(SYS_gettid);
+
+		errno = 0;
+		const int previous_nice = getpriority(PRIO_PROCESS, (id_t)thread_id);
+
+		if(errno != 0 || setpriority(PRIO_PROCESS, (id_t)thread_id, GAZE_THREAD_RAISED_NICE) != 0)
+		{
+			return false;
+		}
+
+		previous_nice_ = previous_nice;
+		applied_priority_ = priority;
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	sched_param previous_param = {};
+
+	if(pthread_getschedparam(pthread_self(), &previous_policy_, &previous_param) != 0)
+	{
+		return false;
+	}
+
+	sched_param param = {};
+	param.sched_priority = (priority == GazeThreadPriority::PRO_AUDIO_) ? GAZE_THREAD_FIFO_PRIORITY_PRO_AUDIO : GAZE_THREAD_FIFO_PRIORITY_GAMES;
+
+	// Needs CAP_SYS_NICE or an RLIMIT_RTPRIO allowance, refused otherwise
+	if(pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0)
+	{
+		return false;
+	}
+
+	previous_fifo_priority_ = previous_param.sched_priority;
+	applied_priority_ = priority;
+
+	return true;
+}
+
+void GazeThreadPolicy::revert_priority()
+{
+	if(applied_priority_ == GazeThreadPriority::RAISED_)
+	{
+#ifdef __linux__
+		setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), previous_nice_);
+#endif
+	}
+	else if(applied_priority_ != GazeThreadPriority::DEFAULT_)
+	{
+		sched_param param = {};
+		param.sched_priority = previous_fifo_priority_;
+		pthread_setschedparam(pthread_self(), previous_policy_, &param);
+	}
+
+	applied_priority_ = GazeThreadPriority::DEFAULT_;
+}
+
+bool GazeThreadPolicy::apply_affinity(const uint64_t affinity_mask)
+{
+	revert_affinity();
+
+	if(affinity_mask == 0)
+	{
+		return true;
+	}
+
+#ifdef __linux__
+	static_assert(sizeof(cpu_set_t) <= sizeof(previous_affinity_), "previous_affinity_ must hold a cpu_set_t");
+
+	cpu_set_t previous = {};
+
+	if(pthread_getaffinity_np(pthread_self(), sizeof(previous), &previous) != 0)
+	{
+		return false;
+	}
+
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+
+	for(int cpu = 0; cpu < 64; cpu++)
+	{
+		if(affinity_mask & (1ull << cpu))
+		{
+			CPU_SET(cpu, &cpus);
+		}
+	}
+
+	if(pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0)
+	{
+		return false;
+	}
+
+	memcpy(previous_affinity_, &previous, sizeof(previous));
+	applied_affinity_mask_ = affinity_mask;
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+void GazeThreadPolicy::revert_affinity()
+{
+#ifdef __linux__
+	if(applied_affinity_mask_ != 0)
+	{
+		cpu_set_t previous;
+		memcpy(&previous, previous_affinity_, sizeof(previous));
+		pthread_setaffinity_np(pthread_self(), sizeof(previous), &previous);
+	}
+#endif
+
+	applied_affinity_mask_ = 0;
+}
+
+bool GazeThreadPolicy::apply_timer_resolution(const bool enabled)
+{
+	revert_timer_resolution();
+
+	if(!enabled)
+	{
+		return true;
+	}
+
+#ifdef __linux__
+	// Timers are already precise here, what delays a wakeup is the slack the kernel may add to coalesce
+	// them (50 us by default)
+	const int previous_slack_ns = prctl(PR_GET_TIMERSLACK, 0, 0, 0, 0);
+
+	if(previous_slack_ns < 0 || prctl(PR_SET_TIMERSLACK, 1000, 0, 0, 0) != 0)
+	{
+		return false;
+	}
+
+	previous_timer_slack_ns_ = (unsigned long)previous_slack_ns;
+	applied_high_resolution_timer_ = true;
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+void GazeThreadPolicy::revert_timer_resolution()
+{
+#ifdef __linux__
+	if(applied_high_resolution_timer_)
+	{
+		prctl(PR_SET_TIMERSLACK, previous_timer_slack_ns_, 0, 0, 0);
+	}
+#endif
+
+	applied_high_resolution_timer_ = false;
+}
+
+#endif
+
+} // BVR
@@ -0,0 +1,157 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef GAZE_THREAD_POLICY_H
+#define GAZE_THREAD_POLICY_H
+
+#include "defines.h"
+
+#include <atomic>
+#include <stdint.h>
+
+#define GAZE_THREAD_LATE_WAKEUP_US 1000        // Wakeups later than this count as late
+#define GAZE_THREAD_OFF_CPU_US 200             // Polls that spent longer than this off the CPU are counted
+#define GAZE_THREAD_FIFO_PRIORITY_GAMES 10     // SCHED_FIFO priorities standing in for the MMCSS task classes
+#define GAZE_THREAD_FIFO_PRIORITY_PRO_AUDIO 40
+#define GAZE_THREAD_RAISED_NICE -10            // Per thread nice value for RAISED_ outside Windows
+
+namespace BVR
+{
+	enum class GazeThreadPriority
+	{
+		DEFAULT_,     // Left as created
+		RAISED_,      // THREAD_PRIORITY_HIGHEST on Windows, nice GAZE_THREAD_RAISED_NICE elsewhere
+		GAMES_,       // MMCSS "Games" task class on Windows, SCHED_FIFO elsewhere
+		PRO_AUDIO_,   // MMCSS "Pro Audio" task class on Windows, a higher SCHED_FIFO priority elsewhere
+		NUM_PRIORITIES_,
+	};
+
+	const char* get_thread_priority_name(const GazeThreadPriority priority);
+
+	struct GazeThreadSettings
+	{
+		GazeThreadPriority priority_ = GazeThreadPriority::DEFAULT_;
+		uint64_t affinity_mask_ = 0;            // CPUs the thread may run on, 0 to leave it alone
+		bool high_resolution_timer_ = false;    // 1 ms timer resolution on Windows, 1 us timer slack on Linux
+
+		bool operator==(const GazeThreadSettings& other) const
+		{
+			return (priority_ == other.priority_) && (affinity_mask_ == other.affinity_mask_) && (high_resolution_timer_ == other.high_resolution_timer_);
+		}
+
+		bool operator!=(const GazeThreadSettings& other) const { return !(*this == other); }
+	};
+
+	// Written by the thread the policy applies to, readable from anywhere.
+	struct GazeThreadStats
+	{
+		// What is actually in effect, which isn't what was asked for when the OS refused
+		std::atomic<int> priority_ = 0;                 // GazeThreadPriority
+		std::atomic<uint64_t> affinity_mask_ = 0;
+		std::atomic<bool> high_resolution_timer_ = false;
+		std::atomic<uint64_t> apply_failures_ = 0;
+
+		std::atomic<uint64_t> polls_ = 0;
+		std::atomic<uint64_t> late_wakeups_ = 0;        // Woke up more than GAZE_THREAD_LATE_WAKEUP_US late
+		std::atomic<uint64_t> off_cpu_polls_ = 0;       // Off the CPU for more than GAZE_THREAD_OFF_CPU_US mid poll
+		std::atomic<uint64_t> off_cpu_us_ = 0;          // Total time those polls were off the CPU
+		std::atomic<uint64_t> involuntary_switches_ = 0; // Preemptions while polling, Linux only
+
+		// Clears the counters, what is in effect is left alone.
+		void reset()
+		{
+			apply_failures_.store(0, std::memory_order_relaxed);
+			polls_.store(0, std::memory_order_relaxed);
+			late_wakeups_.store(0, std::memory_order_relaxed);
+			off_cpu_polls_.store(0, std::memory_order_relaxed);
+			off_cpu_us_.store(0, std::memory_order_relaxed);
+			involuntary_switches_.store(0, std::memory_order_relaxed);
+		}
+	};
+
+	// Scheduling policy of the calling thread: priority class, CPU affinity and timer resolution. apply() and
+	// revert() must be called from the thread itself (MMCSS registrations and Linux per thread settings
+	// belong to it); apply() is cheap when nothing changed, so it can be called with every config snapshot.
+	// Everything changed is put back by revert(), including on destruction.
+	//
+	// begin_poll() / end_poll() bracket a poll and tell how much of it the thread spent off the CPU: wall time
+	// against the thread's own CPU time (QueryThreadCycleTime against the TSC on Windows, where
+	// GetThreadTimes only ticks every 15.6 ms). That's preemption, or waiting on a server slower to answer
+	// than the usual few microseconds round trip. Linux also counts the involuntary context switches, which
+	// are preemptions only.
+	class GazeThreadPolicy
+	{
+	public:
+		~GazeThreadPolicy();
+
+		void apply(const GazeThreadSettings& settings);
+		void revert();
+
+		const GazeThreadSettings& get_settings() const { return settings_; }
+
+		void begin_poll();
+		void end_poll(const int64_t wakeup_lateness_us);
+
+		GazeThreadStats& get_stats() { return stats_; }
+		const GazeThreadStats& get_stats() const { return stats_; }
+
+	private:
+		bool apply_priority(const GazeThreadPriority priority);
+		void revert_priority();
+		bool apply_affinity(const uint64_t affinity_mask);
+		void revert_affinity();
+		bool apply_timer_resolution(const bool enabled);
+		void revert_timer_resolution();
+
+		GazeThreadSettings settings_;
+		GazeThreadStats stats_;
+
+		// What to put back
+		GazeThreadPriority applied_priority_ = GazeThreadPriority::DEFAULT_;
+		uint64_t applied_affinity_mask_ = 0;
+		bool applied_high_resolution_timer_ = false;
+
+#ifdef _WIN32
+		void* mmcss_handle_ = nullptr;
+		int previous_priority_ = 0;
+		uint64_t previous_affinity_mask_ = 0;
+		int64_t poll_start_us_ = 0;
+		uint64_t poll_start_cycles_ = 0;
+		uint64_t poll_start_thread_cycles_ = 0;
+#else
+		int previous_nice_ = 0;
+		int previous_policy_ = 0;
+		int previous_fifo_priority_ = 0;
+		uint64_t previous_affinity_[16] = {};  // A whole cpu_set_t, machines can have more than 64 CPUs
+		unsigned long previous_timer_slack_ns_ = 0;
+		int64_t poll_start_ns_ = 0;
+		int64_t poll_start_cpu_ns_ = 0;
+		int64_t poll_start_involuntary_switches_ = 0;
+#endif
+	};
+}
+
+#endif // GAZE_THREAD_POLICY_H
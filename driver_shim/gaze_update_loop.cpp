@@ -0,0 +1,314 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "gaze_update_loop.h"
+#include "Tracing.h"
+
+#include <string.h>
+#include <string>
+
+namespace BVR
+{
+
+void GazeUpdateLoop::start(const ShimConfig& config, const int64_t now_us)
+{
+	scheduler_.set_settings(config.get_poll_settings());
+	scheduler_.start(now_us);
+
+	applied_config_generation_ = ~0ull;
+	publish_sampler_ = TraceSampler(TRACE_VERBOSE_SAMPLE_INTERVAL);
+	has_published_ = false;
+	last_published_available_ = false;
+	last_publish_time_us_ = 0;
+
+	quality_.reset();
+	smoother_.reset();
+
+#if ENABLE_PSVR2_EYE_TRACKING
+	consecutive_receive_failures_ = 0;
+#endif
+
+	update_power_state();
+}
+
+void GazeUpdateLoop::enter_standby(const int64_t now_us)
+{
+	scheduler_.enter_standby(now_us);
+	update_power_state();
+}
+
+void GazeUpdateLoop::leave_standby(const int64_t now_us)
+{
+	scheduler_.leave_standby(now_us);
+	update_power_state();
+}
+
+void GazeUpdateLoop::update_power_state()
+{
+	loop_stats_.power_state_.store((int)scheduler_.get_state(), std::memory_order_relaxed);
+}
+
+#if ENABLE_PSVR2_EYE_TRACKING
+void GazeUpdateLoop::apply_calibration_results()
+{
+	GazeCalibrationResults results;
+
+	// The session thread is between two writes, try again next poll
+	if(!calibration_session_.get_results(results))
+	{
+		return;
+	}
+
+	applied_calibration_sessions_ = results.sessions_;
+
+	for(int index = 0; index < NUM_CALIBRATIONS; index++)
+	{
+		if(results.solved_mask_ & (1u << index))
+		{
+			tracker_.set_calibration_matrix(index, results.matrices_[index]);
+		}
+	}
+
+	calibrations_loaded_ = true;
+
+	TraceLoggingWrite(TraceProvider,
+		"GazeUpdateLoop_CalibrationApplied",
+		TLArg(results.sessions_, "Sessions"),
+		TLArg(results.solved_mask_, "SolvedMask"));
+}
+#endif
+
+void GazeUpdateLoop::apply_config(const ShimConfig& config)
+{
+	TraceLoggingWrite(TraceProvider,
+		"GazeUpdateLoop_ApplyConfig",
+		TLArg(config.generation_, "Generation"),
+		TLArg(config.eye_tracking_enabled_, "EyeTrackingEnabled"),
+		TLArg(config.combined_gaze_, "CombinedGaze"),
+		TLArg(config.per_eye_gazes_, "PerEyeGazes"));
+
+	scheduler_.set_settings(config.get_poll_settings());
+
+#if ENABLE_PSVR2_EYE_TRACKING
+	GazeSourceType source = (GazeSourceType)config.gaze_source_;
+
+	if(!follows_gaze_source_ || !is_gaze_source_supported(source))
+	{
+		source = GazeSourceType::PSVR2_;
+	}
+
+	if(source != applied_gaze_source_)
+	{
+		// Picked once here, the polls then run through the new transport's statically bound exchange
+		applied_gaze_source_ = source;
+		tracker_.set_transport(create_gaze_source_transport(source));
+
+		loop_stats_.gaze_source_.store((int)source, std::memory_order_relaxed);
+	}
+
+	const std::string endpoint = get_gaze_source_endpoint(source, config);
+
+	if(strcmp(tracker_.get_server_pipe_name(), endpoint.c_str()) != 0)
+	{
+		// Reconnects on the next poll
+		tracker_.set_server_pipe_name(endpoint.c_str());
+		tracker_.disconnect();
+	}
+
+	if(!config.eye_tracking_enabled_)
+	{
+		tracker_.disconnect();
+	}
+
+	// Social gazes are the per eye gazes of the same pipeline pass, no second fetch
+	const bool per_eye_gazes = config.per_eye_gazes_ || config.social_gazes_;
+
+	const uint32_t pipeline_flags = get_gaze_pipeline_flags(config.combined_gaze_, per_eye_gazes, config.apply_calibration_);
+	const bool gazes_changed = ((pipeline_flags ^ tracker_.get_pipeline_flags()) & (GAZE_PIPELINE_COMBINED | GAZE_PIPELINE_PER_EYE)) != 0;
+
+	// Only swaps the pipeline function, the per-sample path stays branch free. Settings that don't touch
+	// the pipeline leave it alone, switching would reset the sanitizer mid stream.
+	tracker_.set_pipeline_flags(pipeline_flags);
+	tracker_.set_median_filter(config.median_filter_);
+
+	if(config.apply_calibration_ && (gazes_changed || !calibrations_loaded_))
+	{
+		calibrations_loaded_ = tracker_.load_calibrations();
+	}
+#endif
+}
+
+bool GazeUpdateLoop::run_once(const ShimConfig& config, const int64_t now_us, GazePublisher& publisher)
+{
+	if(config.generation_ != applied_config_generation_)
+	{
+		applied_config_generation_ = config.generation_;
+		apply_config(config);
+
+		loop_stats_.applied_generation_.store(config.generation_, std::memory_order_relaxed);
+	}
+
+	if(now_us < scheduler_.get_next_poll_time_us())
+	{
+		return false;
+	}
+
+	update_.poll_time_us_ = now_us;
+	update_.combined_gaze_ = { 0.0f, 0.0f, -1.0f };
+
+#if ENABLE_PSVR2_EYE_TRACKING
+	if(calibration_session_.get_num_finished_sessions() != applied_calibration_sessions_)
+	{
+		apply_calibration_results();
+	}
+
+	if(config.eye_tracking_enabled_ && !tracker_.is_connected())
+	{
+		tracker_.connect();
+	}
+
+	XrVector3f combined_gaze;
+	const bool is_polled = config.eye_tracking_enabled_ && tracker_.is_connected();
+	const bool is_received = is_polled && tracker_.update_gazes();
+	const bool is_available = is_received && tracker_.get_combined_gaze(combined_gaze);
+
+	// Someone is looking as long as any gaze is valid, the combined one may be turned off
+	const bool has_valid_gaze = is_received && tracker_.has_valid_gaze();
+
+	if(is_polled && !is_received)
+	{
+		loop_stats_.receive_failures_.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// Only silence counts towards a lost server, a rejected answer still came from a live one
+	if(is_polled && tracker_.has_transport_failed())
+	{
+		if(++consecutive_receive_failures_ >= GAZE_MAX_RECEIVE_FAILURES)
+		{
+			TraceLoggingWrite(TraceProvider,
+				"GazeUpdateLoop_ServerLost",
+				TLArg(consecutive_receive_failures_, "ReceiveFailures"));
+
+			tracker_.disconnect();
+			consecutive_receive_failures_ = 0;
+		}
+	}
+	else if(is_polled)
+	{
+		consecutive_receive_failures_ = 0;
+	}
+
+	if(tracker_.is_connected() != loop_stats_.connected_.load(std::memory_order_relaxed))
+	{
+		loop_stats_.connected_.store(tracker_.is_connected(), std::memory_order_relaxed);
+		(tracker_.is_connected() ? loop_stats_.connects_ : loop_stats_.disconnects_).fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// Counted on every answer, a blink or a per eye only pipeline is still a sample the server produced
+	const uint64_t new_samples = is_received ? tracker_.get_new_sample_count() : 0;
+
+	// Measured on what the server sends, before calibration, invalid samples included
+	if(is_received && tracker_.is_new_sample())
+	{
+		quality_.add_sample(now_us, tracker_.get_raw_gazes().combined_gaze_);
+		calibration_session_.add_sample(now_us, tracker_.get_raw_gazes());
+	}
+
+	quality_.update(now_us);
+
+	const float smoothing_alpha = config.adaptive_smoothing_ ? GazeSmoother::get_alpha(quality_.get_precision_rms_deg()) : 1.0f;
+	quality_.get_stats().smoothing_alpha_.store(smoothing_alpha, std::memory_order_relaxed);
+
+	if(!is_available)
+	{
+		smoother_.reset();
+	}
+	else if(new_samples > 0 || !smoother_.has_direction())
+	{
+		update_.combined_gaze_ = smoother_.apply(combined_gaze, smoothing_alpha);
+	}
+	else
+	{
+		// Same sample as last poll, don't smooth it twice
+		update_.combined_gaze_ = smoother_.get_direction();
+	}
+	update_.frame_ = &tracker_.get_gaze_frame();
+	update_.slot_ = (tracker_.get_current_slot() != GAZE_SLOT_INVALID) ? &tracker_.get_slot_pool().get(tracker_.get_current_slot()) : nullptr;
+
+	const float ipd_meters = (tracker_.get_ipd_meters() > 0.0f) ? tracker_.get_ipd_meters() : GAZE_DEFAULT_IPD_METERS;
+	const bool has_social_gazes = config.social_gazes_ && is_received;
+	update_.ipd_meters_ = config.social_gazes_ ? ipd_meters : 0.0f;
+
+	for(int eye = 0; eye < NUM_EYES; eye++)
+	{
+		GazeSocialGaze& social_gaze = update_.social_gazes_[eye];
+		social_gaze.origin_ = { ((eye == LEFT) ? -0.5f : 0.5f) * update_.ipd_meters_, 0.0f, 0.0f };
+		social_gaze.gaze_ = has_social_gazes ? update_.frame_->per_eye_gazes_[eye] : XRGazeState();
+	}
+#else
+	const bool is_available = true;
+	const bool has_valid_gaze = true;
+	const uint64_t new_samples = 1;
+#endif
+
+	// is_available is the combined gaze only, for the OpenVR flag
+	scheduler_.on_poll(now_us, has_valid_gaze, new_samples);
+	update_power_state();
+
+	update_.is_available_ = is_available;
+	update_.new_samples_ = new_samples;
+
+	// Only publish when there is something new to say: a fresh sample, a change in availability,
+	// or the keep-alive interval elapsed.
+	const bool is_new_sample = new_samples > 0;
+	const bool availability_changed = !has_published_ || (is_available != last_published_available_);
+	const bool keep_alive_due = (now_us - last_publish_time_us_) >= ((int64_t)config.keep_alive_interval_ms_ * 1000);
+
+	if(config.deduplicate_samples_ && !is_new_sample && !availability_changed && !keep_alive_due)
+	{
+		return false;
+	}
+
+	has_published_ = true;
+	last_published_available_ = is_available;
+	last_publish_time_us_ = now_us;
+
+	publisher.publish(update_);
+
+	TraceVerboseWrite(publish_sampler_,
+		"GazeUpdateLoop_Publish",
+		TLArg(now_us, "PollTimeUs"),
+		TLArg(is_available, "Available"),
+		TLArg(new_samples, "NewSamples"));
+
+#if ENABLE_PSVR2_EYE_TRACKING
+	tracker_.get_publish_stats().published_.fetch_add(1, std::memory_order_relaxed);
+#endif
+
+	return true;
+}
+
+} // BVR
@@ -0,0 +1,179 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef GAZE_UPDATE_LOOP_H
+#define GAZE_UPDATE_LOOP_H
+
+#include "defines.h"
+#include "gaze_calibration_session.h"
+#include "gaze_debug_stats.h"
+#include "gaze_pipeline.h"
+#include "gaze_poll_scheduler.h"
+#include "gaze_quality.h"
+#include "gaze_slot_pool.h"
+#include "gaze_source.h"
+#include "psvr2_protocol.h"
+#include "shim_config.h"
+#include "trace_ring.h"
+
+#if ENABLE_PSVR2_EYE_TRACKING
+#include "psvr2_eye_tracking.h"
+#endif
+
+#include <stdint.h>
+
+namespace BVR
+{
+	// One eye's gaze the way avatars want it: from the eye, in head space (meters, x to the right).
+	struct GazeSocialGaze
+	{
+		XrVector3f origin_ = { 0.0f, 0.0f, 0.0f };
+		XRGazeState gaze_;
+	};
+
+	// What one poll produced, handed to the publisher.
+	struct GazeUpdate
+	{
+		int64_t poll_time_us_ = 0;
+		bool is_available_ = false;
+		XrVector3f combined_gaze_ = { 0.0f, 0.0f, -1.0f };
+		uint64_t new_samples_ = 0;
+		const GazeFrame* frame_ = nullptr; // Every gaze the pipeline produced, null without eye tracking
+
+		// With the socialGazes setting, both eyes of the same sample as the combined gaze, their origins half
+		// the IPD either side of the center. Invalid otherwise, or when the poll got no answer.
+		GazeSocialGaze social_gazes_[NUM_EYES];
+		float ipd_meters_ = 0.0f;
+
+		// Slot the frame lives in, with the raw response and its sequence number, null before the first
+		// sample. The tracker reuses it on a later poll: read it while publishing, copy what you keep.
+		const GazeSlot* slot_ = nullptr;
+	};
+
+	// Where gazes end up: vrserver in the driver, a recorder in the tools.
+	class GazePublisher
+	{
+	public:
+		virtual ~GazePublisher() {}
+
+		virtual void publish(const GazeUpdate& update) = 0;
+	};
+
+	// The body of the driver's update thread, without the thread, the waiting or anything OpenVR:
+	// applies settings, polls the tracker when the scheduler says so, and publishes what's worth publishing.
+	class GazeUpdateLoop
+	{
+	public:
+#if ENABLE_PSVR2_EYE_TRACKING
+		// With follows_gaze_source, the gazeSource setting swaps the tracker's transport (gaze_source.h).
+		// Without, the tracker keeps the one it was built with and only the pipe name is applied.
+		explicit GazeUpdateLoop(PSVR2EyeTracker& tracker, const bool follows_gaze_source = false)
+			: tracker_(tracker)
+			, follows_gaze_source_(follows_gaze_source)
+		{
+			calibration_session_.set_directory(get_default_calibration_directory());
+		}
+#endif
+
+		void start(const ShimConfig& config, const int64_t now_us);
+
+		// One pass, call it whenever get_next_poll_time_us() is reached (or earlier, it then only picks up
+		// settings). Returns true if the publisher was called.
+		bool run_once(const ShimConfig& config, const int64_t now_us, GazePublisher& publisher);
+
+		void enter_standby(const int64_t now_us);
+		void leave_standby(const int64_t now_us);
+
+#if ENABLE_PSVR2_EYE_TRACKING
+		// The headset's IPD, for the social gazes' origins. 0 (unknown) falls back to GAZE_DEFAULT_IPD_METERS.
+		void set_ipd_meters(const float ipd_meters) { tracker_.set_ipd_meters(ipd_meters); }
+
+		// Fed with every new sample while a session is active, its solved matrices are applied between polls.
+		// Its thread is the owner's to start.
+		GazeCalibrationSession& get_calibration_session() { return calibration_session_; }
+		const GazeCalibrationSession& get_calibration_session() const { return calibration_session_; }
+#endif
+
+		int64_t get_next_poll_time_us() const { return scheduler_.get_next_poll_time_us(); }
+
+		// What the latest poll produced, whether or not it was published. Update thread only.
+		const GazeUpdate& get_last_update() const { return update_; }
+
+		GazePollScheduler& get_scheduler() { return scheduler_; }
+		const GazePollScheduler& get_scheduler() const { return scheduler_; }
+
+		// Safe to read (and reset) from any thread while the loop runs.
+		GazeLoopStats& get_loop_stats() { return loop_stats_; }
+		const GazeLoopStats& get_loop_stats() const { return loop_stats_; }
+		const GazeQualityStats& get_quality_stats() const { return quality_.get_stats(); }
+
+#if ENABLE_PSVR2_EYE_TRACKING
+		GazePublishStats& get_publish_stats() { return tracker_.get_publish_stats(); }
+		const GazePublishStats& get_publish_stats() const { return tracker_.get_publish_stats(); }
+
+		GazeSanitizeStats& get_sanitize_stats() { return tracker_.get_sanitize_stats(); }
+		const GazeSanitizeStats& get_sanitize_stats() const { return tracker_.get_sanitize_stats(); }
+
+		ResponseDecodeStats& get_decode_stats() { return tracker_.get_decode_stats(); }
+		const ResponseDecodeStats& get_decode_stats() const { return tracker_.get_decode_stats(); }
+#endif
+
+	private:
+		void apply_config(const ShimConfig& config);
+		void update_power_state();
+
+#if ENABLE_PSVR2_EYE_TRACKING
+		void apply_calibration_results();
+
+		PSVR2EyeTracker& tracker_;
+		bool calibrations_loaded_ = false;
+		uint32_t consecutive_receive_failures_ = 0;
+
+		GazeCalibrationSession calibration_session_;
+		uint64_t applied_calibration_sessions_ = 0;
+
+		const bool follows_gaze_source_ = false;
+		GazeSourceType applied_gaze_source_ = GazeSourceType::PSVR2_;   // Trackers start on the server's transport
+#endif
+
+		GazePollScheduler scheduler_;
+		uint64_t applied_config_generation_ = ~0ull;
+
+		bool has_published_ = false;
+		bool last_published_available_ = false;
+		int64_t last_publish_time_us_ = 0;
+
+		GazeUpdate update_;
+		GazeLoopStats loop_stats_;
+
+		GazeQualityMonitor quality_;
+		GazeSmoother smoother_;
+
+		TraceSampler publish_sampler_{ 1 };
+	};
+}
+
+#endif // GAZE_UPDATE_LOOP_H
@@ -24,7 +24,6 @@
 
 #define WIN32_LEAN_AND_MEAN // Exclude rarely-used stuff from Windows headers
 #include <windows.h>
-#include <DirectXMath.h>
 #include <TraceLoggingActivity.h>
 #include <TraceLoggingProvider.h>
 
@@ -0,0 +1,102 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "psvr2_decode.h"
+
+#include <stddef.h>
+#include <string.h>
+
+namespace BVR
+{
+
+static const size_t GAZE_VALID_OFFSETS[] =
+{
+	offsetof(Response, gazes_) + offsetof(AllXRGazeStates, combined_gaze_) + offsetof(XRGazeState, is_valid_),
+	offsetof(Response, gazes_) + offsetof(AllXRGazeStates, per_eye_gazes_) + offsetof(XRGazeState, is_valid_),
+	offsetof(Response, gazes_) + offsetof(AllXRGazeStates, per_eye_gazes_) + sizeof(XRGazeState) + offsetof(XRGazeState, is_valid_),
+};
+
+static_assert(NUM_EYES == 2, "GAZE_VALID_OFFSETS lists the per eye gazes by hand");
+static_assert(sizeof(ResponseType) == sizeof(uint32_t), "The server sends the response type as 32 bits");
+
+void ResponseDecodeStats::count(const ResponseDecodeResult result)
+{
+	switch(result)
+	{
+	case ResponseDecodeResult::BAD_SIZE_:
+		bad_size_.fetch_add(1, std::memory_order_relaxed);
+		break;
+	case ResponseDecodeResult::BAD_TYPE_:
+		bad_type_.fetch_add(1, std::memory_order_relaxed);
+		break;
+	case ResponseDecodeResult::BAD_BOOL_:
+		bad_bool_.fetch_add(1, std::memory_order_relaxed);
+		break;
+	case ResponseDecodeResult::UNEXPECTED_TYPE_:
+		unexpected_type_.fetch_add(1, std::memory_order_relaxed);
+		break;
+	default:
+		break;
+	}
+}
+
+ResponseDecodeResult decode_response(const SequencedResponse& response, const size_t message_size, const ResponseType expected_type, bool& has_sequence_number)
+{
+	// Legacy servers send a bare Response, newer ones append a sequence number
+	if((message_size != sizeof(Response)) && (message_size != sizeof(SequencedResponse)))
+	{
+		return ResponseDecodeResult::BAD_SIZE_;
+	}
+
+	// Only ever look at the object representation until everything checks out
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&response);
+
+	uint32_t type = 0;
+	memcpy(&type, bytes + offsetof(Response, type_), sizeof(type));
+
+	if(type > (uint32_t)GET_GAZES_OK_)
+	{
+		return ResponseDecodeResult::BAD_TYPE_;
+	}
+
+	for(const size_t offset : GAZE_VALID_OFFSETS)
+	{
+		if(bytes[offset] > 1)
+		{
+			return ResponseDecodeResult::BAD_BOOL_;
+		}
+	}
+
+	if(type != (uint32_t)expected_type)
+	{
+		return ResponseDecodeResult::UNEXPECTED_TYPE_;
+	}
+
+	has_sequence_number = (message_size == sizeof(SequencedResponse));
+	return ResponseDecodeResult::OK_;
+}
+
+} // BVR
@@ -0,0 +1,78 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef PSVR2_DECODE_H
+#define PSVR2_DECODE_H
+
+#include "psvr2_protocol.h"
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace BVR
+{
+	enum class ResponseDecodeResult
+	{
+		OK_,
+		BAD_SIZE_,        // Neither a Response nor a SequencedResponse, truncated ones included
+		BAD_TYPE_,        // Not one of the ResponseType values
+		BAD_BOOL_,        // An is_valid_ byte that is neither 0 nor 1
+		UNEXPECTED_TYPE_, // Well formed, but not the answer to what we asked (ERROR_ included)
+	};
+
+	// Written by the update thread only, readable from anywhere.
+	struct ResponseDecodeStats
+	{
+		std::atomic<uint64_t> bad_size_ = 0;
+		std::atomic<uint64_t> bad_type_ = 0;
+		std::atomic<uint64_t> bad_bool_ = 0;
+		std::atomic<uint64_t> unexpected_type_ = 0;
+
+		uint64_t get_malformed() const
+		{
+			return bad_size_.load(std::memory_order_relaxed) + bad_type_.load(std::memory_order_relaxed) + bad_bool_.load(std::memory_order_relaxed);
+		}
+
+		void count(const ResponseDecodeResult result);
+
+		void reset()
+		{
+			bad_size_.store(0, std::memory_order_relaxed);
+			bad_type_.store(0, std::memory_order_relaxed);
+			bad_bool_.store(0, std::memory_order_relaxed);
+			unexpected_type_.store(0, std::memory_order_relaxed);
+		}
+	};
+
+	// Checks a message that was received as raw bytes into response, before anything reads its enum or
+	// bool fields. A server of another version (or a broken one) can send any bit pattern there, and
+	// loading a bool that isn't 0 or 1 is undefined behaviour. message_size is the size of the whole
+	// message, which is larger than sizeof(response) when it was truncated.
+	ResponseDecodeResult decode_response(const SequencedResponse& response, const size_t message_size, const ResponseType expected_type, bool& has_sequence_number);
+}
+
+#endif // PSVR2_DECODE_H
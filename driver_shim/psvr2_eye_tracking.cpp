@@ -26,13 +26,14 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
-#include "pch.h"
 #include "defines.h"
 
 #if ENABLE_PSVR2_EYE_TRACKING
 
 #include "psvr2_eye_tracking.h"
 
+#include <string.h>
+
 namespace BVR 
 {
 
@@ -42,52 +43,88 @@ template<typename T> static inline T bvr_clamp(T v, T mn, T mx)
 }
 
 PSVR2EyeTracker::PSVR2EyeTracker()
+	: PSVR2EyeTracker(create_default_transport())
 {
 }
 
-bool PSVR2EyeTracker::connect()
+PSVR2EyeTracker::PSVR2EyeTracker(std::unique_ptr<PSVR2Transport> transport)
+	: transport_(std::move(transport))
+	, exchange_(transport_->get_exchange_function())
 {
-	if(!is_connected_)
+	const std::string calibration_directory = get_default_calibration_directory();
+
+	if(!calibration_directory.empty())
 	{
-		// Connect to pipe job
-		while(true)
-		{
-			LPTSTR named_pipe_name = (LPTSTR)TEXT(PSVR2_SERVER_NAMED_PIPE_NAME);
-			named_pipe_handle_ = CreateFile(named_pipe_name, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
-
-			if(named_pipe_handle_ != INVALID_HANDLE_VALUE)
-			{
-				break;
-			}
-
-			if(GetLastError() != ERROR_PIPE_BUSY)
-			{
-				return false;
-			}
-
-			if(!WaitNamedPipe(named_pipe_name, PSVR2_SERVER_CONNECT_WAIT_TIME))
-			{
-				return false;
-			}
-		}
+		calibrations_[LEFT_CALIBRATION_INDEX].set_file_path(calibration_directory + "calibration_left.txt");
+		calibrations_[RIGHT_CALIBRATION_INDEX].set_file_path(calibration_directory + "calibration_right.txt");
+		calibrations_[COMBINED_CALIBRATION_INDEX].set_file_path(calibration_directory + "calibration_combined.txt");
+	}
+
+	select_pipeline(get_gaze_pipeline_flags(ENABLE_PSVR2_EYE_TRACKING_COMBINED_GAZE, ENABLE_PSVR2_EYE_TRACKING_PER_EYE_GAZES, false));
+}
+
+void PSVR2EyeTracker::select_pipeline(const uint32_t flags)
+{
+	pipeline_flags_ = flags;
+	pipeline_ = select_gaze_pipeline(flags);
+
+	// Keep the frame consistent with the new settings without waiting for the next sample. That sample went
+	// through the sanitizer already, it mustn't count twice.
+	sanitizer_.reset();
+	run_pipeline();
+}
+
+void PSVR2EyeTracker::run_pipeline()
+{
+	if(current_slot_ == GAZE_SLOT_INVALID)
+	{
+		return;
+	}
+
+	GazeSlot& slot = slots_.get(current_slot_);
+	const GazePipelineContext context = { calibrations_, &sanitizer_, deduplicator_.get_last_sample_delta() };
+	pipeline_(slot.response_.gazes_, context, slot.frame_);
+}
 
-		DWORD mode = PIPE_READMODE_MESSAGE;
+void PSVR2EyeTracker::set_gazes_enabled(const bool combined_gaze, const bool per_eye_gazes)
+{
+	set_pipeline_flags(get_gaze_pipeline_flags(combined_gaze, per_eye_gazes, is_applying_calibration()));
+}
+
+void PSVR2EyeTracker::set_pipeline_flags(const uint32_t flags)
+{
+	if(flags != pipeline_flags_)
+	{
+		select_pipeline(flags);
+	}
+}
 
-		if(!SetNamedPipeHandleState(named_pipe_handle_, &mode, 0, 0))
+bool PSVR2EyeTracker::connect()
+{
+	if(!is_connected_)
+	{
+		if(!transport_->open(server_pipe_name_.c_str()))
 		{
 			return false;
 		}
 
-		Response handshake_response;
-		const bool handshake_ok = send_and_receive(Request(START_HANDSHAKE_), handshake_response);
+		SequencedResponse handshake_response;
+		bool has_sequence_number = false;
+		const bool handshake_ok = send_and_receive(Request(START_HANDSHAKE_), HANDSHAKE_OK_, handshake_response, has_sequence_number);
 
-		if(!handshake_ok || (handshake_response.type_ != ResponseType::HANDSHAKE_OK_))
+		if(!handshake_ok)
 		{
+			transport_->close();
 			return false;
 		}
 
 		is_connected_ = handshake_ok;
 
+		// A (re)started server restarts its sequence numbers too
+		deduplicator_.reset();
+		sanitizer_.reset();
+		last_sample_verdict_ = GazeSampleVerdict::DUPLICATE_;
+
 #if ENABLE_PSVR2_EYE_TRACKING_AUTOMATICALLY
 		set_enabled(is_connected_);
 #endif
@@ -101,49 +138,37 @@ void PSVR2EyeTracker::disconnect()
 {
 	if(is_connected_)
 	{
-		if(named_pipe_handle_ != INVALID_HANDLE_VALUE)
-		{
-			CloseHandle(named_pipe_handle_);
-			named_pipe_handle_ = INVALID_HANDLE_VALUE;
-		}
-
+		transport_->close();
 		is_connected_ = false;
 	}
 }
 
-bool PSVR2EyeTracker::send_and_receive(const Request& request, Response& response) const
+void PSVR2EyeTracker::set_transport(std::unique_ptr<PSVR2Transport> transport)
 {
-	const bool request_ok = send_request(request);
-	const bool response_ok = request_ok && receive_request(response);
-
-	return response_ok;
-}
+	disconnect();
 
-bool PSVR2EyeTracker::send_request(const Request& request) const
-{
-	DWORD write_size = 0;
-	const BOOL write_ok = WriteFile(named_pipe_handle_, &request, sizeof(request), &write_size, 0);
-	return write_ok;
+	transport_ = std::move(transport);
+	exchange_ = transport_->get_exchange_function();
 }
 
-bool PSVR2EyeTracker::receive_request(Response& response) const
+bool PSVR2EyeTracker::send_and_receive(const Request& request, const ResponseType expected_type, SequencedResponse& response, bool& has_sequence_number)
 {
-	DWORD read_size = 0;
+	size_t read_size = 0;
 
-	const BOOL success = ReadFile(named_pipe_handle_, &response, sizeof(response), &read_size, 0);
-
-	if(!success)
+	// The transport's own exchange, no virtual call per message
+	if(!exchange_(*transport_, &request, sizeof(request), &response, sizeof(response), read_size))
 	{
-		const DWORD lastError = GetLastError();
-
-		if(lastError != ERROR_MORE_DATA)
-		{
-			return false;
-		}
+		has_transport_failed_ = true;
+		return false;
 	}
 
-	if(read_size != sizeof(response))
+	// A malformed message is dropped like a failed receive, the transport is message oriented so the
+	// next one starts clean and the connection stays up
+	const ResponseDecodeResult result = decode_response(response, read_size, expected_type, has_sequence_number);
+
+	if(result != ResponseDecodeResult::OK_)
 	{
+		decode_stats_.count(result);
 		return false;
 	}
 
@@ -153,36 +178,55 @@ bool PSVR2EyeTracker::receive_request(Response& response) const
 
 bool PSVR2EyeTracker::update_gazes()
 {
+	last_sample_verdict_ = GazeSampleVerdict::DUPLICATE_;
+	has_transport_failed_ = false;
+
 	if(!is_connected_)
 	{
 		return false;
 	}
 
-	AllXRGazeStates xr_gaze_states = {};
-	Response gaze_response;
+	const uint32_t slot_index = slots_.acquire();
 
-	const bool gazes_ok = send_and_receive(Request(GET_GAZES_), gaze_response);
-
-	if (gazes_ok)
+	if(slot_index == GAZE_SLOT_INVALID)
 	{
-		memcpy(&xr_gaze_states, &gaze_response.gazes_, sizeof(xr_gaze_states));
+		// Only if a slot leaked, the tracker never holds more than two
+		return false;
+	}
 
-#if ENABLE_PSVR2_EYE_TRACKING_COMBINED_GAZE
-		combined_gaze_ = xr_gaze_states.combined_gaze_;
-#endif
+	GazeSlot& slot = slots_.get(slot_index);
+	bool has_sequence_number = false;
 
-#if ENABLE_PSVR2_EYE_TRACKING_PER_EYE_GAZES
-		per_eye_gazes_[LEFT] = xr_gaze_states.per_eye_gazes_[LEFT];
-		per_eye_gazes_[RIGHT] = xr_gaze_states.per_eye_gazes_[RIGHT];
-#endif
+	const bool gazes_ok = send_and_receive(Request(GET_GAZES_), GET_GAZES_OK_, slot.response_, has_sequence_number);
 
+	if (!gazes_ok)
+	{
+		slots_.release(slot_index);
+		return false;
+	}
+
+	has_sequence_numbers_ = has_sequence_number;
+	slot.has_sequence_number_ = has_sequence_number;
+	last_sample_verdict_ = deduplicator_.classify(slot.response_.gazes_, has_sequence_number, slot.response_.sequence_number_);
+
+	if(last_sample_verdict_ != GazeSampleVerdict::NEW_)
+	{
+		// The current slot already holds this sample (or a newer one)
+		slots_.release(slot_index);
 		return true;
 	}
 
-    return false;
+	if(current_slot_ != GAZE_SLOT_INVALID)
+	{
+		slots_.release(current_slot_);
+	}
+
+	current_slot_ = slot_index;
+	run_pipeline();
+
+	return true;
 }
 
-#if ENABLE_PSVR2_EYE_TRACKING_COMBINED_GAZE
 bool PSVR2EyeTracker::is_combined_gaze_available() const
 {
 	if(!is_connected() || !is_enabled())
@@ -190,12 +234,9 @@ bool PSVR2EyeTracker::is_combined_gaze_available() const
 		return false;
 	}
 
-	return combined_gaze_.is_valid_;
+	return get_gaze_frame().combined_gaze_.is_valid_;
 }
-#endif
-
 
-#if ENABLE_PSVR2_EYE_TRACKING_PER_EYE_GAZES
 bool PSVR2EyeTracker::is_gaze_available(const int eye) const
 {
 	if(!is_connected() || !is_enabled())
@@ -203,130 +244,67 @@ bool PSVR2EyeTracker::is_gaze_available(const int eye) const
 		return false;
 	}
 
-	return per_eye_gazes_[eye].is_valid_;
+	return get_gaze_frame().per_eye_gazes_[eye].is_valid_;
 }
-#endif
 
-#if ENABLE_PSVR2_EYE_TRACKING_COMBINED_GAZE
-bool PSVR2EyeTracker::get_combined_gaze(XrVector3f& combined_gaze_direction, const bool should_apply_gaze)
+bool PSVR2EyeTracker::get_combined_gaze(XrVector3f& combined_gaze_direction) const
 {
-	(void)should_apply_gaze;
+	const GazeFrame& frame = get_gaze_frame();
 
-    if (combined_gaze_.is_valid_)
+    if (frame.combined_gaze_.is_valid_)
     {
-#if ENABLE_GAZE_CALIBRATION
-		if(apply_calibration_ && calibrations_[2].is_calibrated())
-		{
-			combined_gaze_direction = calibrations_[2].apply_calibration(combined_gaze_.direction_);
-			return true;
-		}
-#endif
-
-		combined_gaze_direction = combined_gaze_.direction_;
+		combined_gaze_direction = frame.combined_gaze_.direction_;
 		return true;
 	}
 
     return false;
 }
-#endif // ENABLE_PSVR2_EYE_TRACKING_COMBINED_GAZE
 
-#if ENABLE_PSVR2_EYE_TRACKING_PER_EYE_GAZES
-bool PSVR2EyeTracker::get_per_eye_gaze(const int eye, XrVector3f& per_eye_gaze_direction, const bool should_apply_gaze)
+bool PSVR2EyeTracker::get_per_eye_gaze(const int eye, XrVector3f& per_eye_gaze_direction) const
 {
-#if AUTO_CALIBRATE
-	if(calibrations_[eye].is_calibrating() && (increment_countdown_ > 0))
-	{
-		increment_countdown_--;
-
-		if(increment_countdown_ == 0)
-		{
-			increment_raster();
-		}
-	}
-#endif
+	const GazeFrame& frame = get_gaze_frame();
 
-	if(per_eye_gazes_[eye].is_valid_)
+	if(frame.per_eye_gazes_[eye].is_valid_)
 	{
-#if ENABLE_GAZE_CALIBRATION
-		if (calibrations_[eye].is_calibrating())
-		{
-			CalibrationPoint& point = calibrations_[eye].get_raster_point();
-
-			if (point.is_calibrated_)
-			{
-#if AUTO_INCREMENT_ON_CALIBRATION_DONE
-				increment_raster();
-#endif
-			}
-			else if (should_apply_gaze)
-			{
-				const bool sample_ok = point.add_sample(per_eye_gazes_[eye].direction_);
-
-				if (sample_ok)
-				{
-					if(point.is_calibrated_)
-					{
-						calibrations_[eye].num_calibrated_++;
-					}
-
-					increment_countdown_ = AUTO_INCREMENT_COUNTDOWN;
-				}
-			}
-		}
-
-		if (apply_calibration_ && calibrations_[eye].is_calibrated())
-		{
-			per_eye_gaze_direction = calibrations_[eye].apply_calibration(per_eye_gazes_[eye].direction_);
-			return true;
-		}
-#else
-		(void)should_apply_gaze;
-#endif
-		
-		per_eye_gaze_direction = per_eye_gazes_[eye].direction_;
+		per_eye_gaze_direction = frame.per_eye_gazes_[eye].direction_;
 		return true;
 	}
 
     return false;
 }
-#endif // ENABLE_PSVR2_EYE_TRACKING_PER_EYE_GAZES
 
-#if ENABLE_GAZE_CALIBRATION
 void PSVR2EyeTracker::set_apply_calibration(const bool enabled)
 {
-	apply_calibration_ = enabled;
+	const uint32_t flags = enabled ? (pipeline_flags_ | GAZE_PIPELINE_CALIBRATED) : (pipeline_flags_ & ~GAZE_PIPELINE_CALIBRATED);
+	set_pipeline_flags(flags);
 }
 
 void PSVR2EyeTracker::toggle_apply_calibration()
 {
-	apply_calibration_ = !apply_calibration_;
+	set_apply_calibration(!is_applying_calibration());
 }
 
 void PSVR2EyeTracker::reset_calibrations()
 {
-#if ENABLE_PSVR2_EYE_TRACKING_PER_EYE_GAZES
-	calibrating_eye_index_ = INVALID_INDEX;
 	calibrations_[LEFT_CALIBRATION_INDEX].reset_calibration();
 	calibrations_[RIGHT_CALIBRATION_INDEX].reset_calibration();
-#endif
-
-#if ENABLE_PSVR2_EYE_TRACKING_COMBINED_GAZE
 	calibrations_[COMBINED_CALIBRATION_INDEX].reset_calibration();
-#endif
 }
 
 bool PSVR2EyeTracker::load_calibrations()
 {
 	bool success = true;
 
-#if ENABLE_PSVR2_EYE_TRACKING_PER_EYE_GAZES
-	success &= calibrations_[LEFT_CALIBRATION_INDEX].load_calibration();
-	success &= calibrations_[RIGHT_CALIBRATION_INDEX].load_calibration();
-#endif
+	if(is_per_eye_gazes_enabled())
+	{
+		success &= calibrations_[LEFT_CALIBRATION_INDEX].load_calibration();
+		success &= calibrations_[RIGHT_CALIBRATION_INDEX].load_calibration();
+	}
 
-#if ENABLE_PSVR2_EYE_TRACKING_COMBINED_GAZE
-	success &= calibrations_[COMBINED_CALIBRATION_INDEX].reset_calibration();
-#endif
+	if(is_combined_gaze_enabled())
+	{
+		success &= calibrations_[COMBINED_CALIBRATION_INDEX].load_calibration();
+	}
 
 	return success;
 }
@@ -335,131 +313,48 @@ bool PSVR2EyeTracker::save_calibrations()
 {
 	bool success = true;
 
-#if ENABLE_PSVR2_EYE_TRACKING_PER_EYE_GAZES
-	success &= calibrations_[LEFT_CALIBRATION_INDEX].save_calibration();
-	success &= calibrations_[RIGHT_CALIBRATION_INDEX].save_calibration();
-#endif
-
-#if ENABLE_PSVR2_EYE_TRACKING_COMBINED_GAZE
-	success &= calibrations_[COMBINED_CALIBRATION_INDEX].save_calibration();
-#endif
-
-	return success;
-}
-
-bool PSVR2EyeTracker::is_calibrating() const
-{
-#if ENABLE_PSVR2_EYE_TRACKING_PER_EYE_GAZES
-	if (is_eye_calibrating(LEFT) || is_eye_calibrating(RIGHT))
+	if(is_per_eye_gazes_enabled())
 	{
-		return true;
+		success &= calibrations_[LEFT_CALIBRATION_INDEX].save_calibration();
+		success &= calibrations_[RIGHT_CALIBRATION_INDEX].save_calibration();
 	}
-#endif
 
-#if ENABLE_PSVR2_EYE_TRACKING_COMBINED_GAZE
-	if(is_combined_calibrating())
+	if(is_combined_gaze_enabled())
 	{
-		return true;
+		success &= calibrations_[COMBINED_CALIBRATION_INDEX].save_calibration();
 	}
-#endif
 
-	return false;
+	return success;
 }
 
 bool PSVR2EyeTracker::is_fully_calibrated() const
 {
 	bool calibrated = true;
 
-#if ENABLE_PSVR2_EYE_TRACKING_PER_EYE_GAZES
-	calibrated &= is_eye_calibrated(LEFT);
-	calibrated &= is_eye_calibrated(RIGHT);
-#endif
-
-#if ENABLE_PSVR2_EYE_TRACKING_COMBINED_GAZE
-	calibrated &= is_combined_calibrated();
-#endif
-
-	return calibrated;
-}
-
-void PSVR2EyeTracker::start_calibrating()
-{
-	if (is_fully_calibrated() || is_calibrating())
+	if(is_per_eye_gazes_enabled())
 	{
-		return;
+		calibrated &= is_eye_calibrated(LEFT);
+		calibrated &= is_eye_calibrated(RIGHT);
 	}
 
-#if ENABLE_PSVR2_EYE_TRACKING_PER_EYE_GAZES
-	if (!is_eye_calibrated(LEFT))
+	if(is_combined_gaze_enabled())
 	{
-		start_eye_calibration(LEFT);
-		return;
-	}
-	else if(is_eye_calibrated(LEFT) && !is_eye_calibrated(RIGHT))
-	{
-		start_eye_calibration(RIGHT);
-		return;
+		calibrated &= is_combined_calibrated();
 	}
-#endif
 
-#if ENABLE_PSVR2_EYE_TRACKING_COMBINED_GAZE
-	if(!is_combined_calibrated())
-	{
-		start_combined_calibration();
-		return;
-	}
-#endif
-}
-
-void PSVR2EyeTracker::stop_calibrating()
-{
-
-}
-
-void PSVR2EyeTracker::increment_raster()
-{
-#if ENABLE_PSVR2_EYE_TRACKING_PER_EYE_GAZES
-	if(calibrating_eye_index_ != INVALID_INDEX)
-	{
-		if(calibrations_[calibrating_eye_index_].is_calibrating())
-		{
-			return calibrations_[calibrating_eye_index_].increment_raster();
-		}
-	}
-#endif
-
-#if ENABLE_PSVR2_EYE_TRACKING_COMBINED_GAZE
-	if(calibrations_[COMBINED_CALIBRATION_INDEX].is_calibrating())
-	{
-		return calibrations_[COMBINED_CALIBRATION_INDEX].increment_raster();
-	}
-#endif
+	return calibrated;
 }
 
-GLMPose PSVR2EyeTracker::get_calibration_cube() const
+bool PSVR2EyeTracker::set_calibration_matrix(const int calibration_index, const float matrix[9])
 {
-#if ENABLE_PSVR2_EYE_TRACKING_PER_EYE_GAZES
-	if(calibrating_eye_index_ != INVALID_INDEX)
-	{
-		if(calibrations_[calibrating_eye_index_].is_calibrating())
-		{
-			return calibrations_[calibrating_eye_index_].get_calibration_cube();
-		}
-	}
-#endif
-
-#if ENABLE_PSVR2_EYE_TRACKING_COMBINED_GAZE
-	if(calibrations_[COMBINED_CALIBRATION_INDEX].is_calibrating())
+	if((calibration_index < 0) || (calibration_index >= NUM_CALIBRATIONS))
 	{
-		return calibrations_[COMBINED_CALIBRATION_INDEX].get_calibration_cube();
+		return false;
 	}
-#endif
 
-	return {};
+	return calibrations_[calibration_index].set_matrix(matrix);
 }
 
-#endif
-
 } // BVH
 
 
@@ -33,77 +33,28 @@
 
 #if ENABLE_PSVR2_EYE_TRACKING
 
+#include <memory>
 #include <stdint.h>
+#include <string>
 
-#define PSVR2_SERVER_NAMED_PIPE_NAME "\\\\.\\pipe\\PlaystationVR2ServerPipe"
-#define PSVR2_SERVER_CONNECT_WAIT_TIME 5000
-
-#if ENABLE_GAZE_CALIBRATION
+#include "psvr2_protocol.h"
+#include "psvr2_decode.h"
+#include "gaze_deduplicator.h"
 #include "gaze_calibration.h"
-
-#define LEFT_CALIBRATION_INDEX LEFT
-#define RIGHT_CALIBRATION_INDEX RIGHT
-#define COMBINED_CALIBRATION_INDEX RIGHT + 1
-#define NUM_CALIBRATIONS (COMBINED_CALIBRATION_INDEX+1) // Indices LEFT = 0 / RIGHT = 1 / COMBINED = 2
-#endif
+#include "gaze_pipeline.h"
+#include "gaze_slot_pool.h"
+#include "psvr2_transport.h"
 
 namespace BVR 
 {
-	// No OpenXR dependency in this repo -- yet
-	struct XrVector3f
-	{
-		float    x;
-		float    y;
-		float    z;
-	};
-
-	struct XRGazeState
-	{
-		XrVector3f direction_ = { 0.0f, 0.0f, -1.0f };
-		bool is_valid_ = false;
-	};
-
-	struct AllXRGazeStates
-	{
-		XRGazeState combined_gaze_;
-		XRGazeState per_eye_gazes_[BVR::NUM_EYES];
-	};
-
-	enum RequestType
-	{
-		UNKNOWN_,
-		START_HANDSHAKE_,
-		GET_GAZES_,
-	};
-
-	enum ResponseType
-	{
-		ERROR_,
-		HANDSHAKE_OK_,
-		GET_GAZES_OK_,
-	};
-
-	struct Request
-	{
-		RequestType type_;
-		Request() : type_(RequestType::UNKNOWN_) {}
-		Request(RequestType type) : type_(type) {}
-	};
-
-	struct Response
-	{
-		ResponseType type_;
-		AllXRGazeStates gazes_;
-
-		Response() : type_(ResponseType::ERROR_), gazes_{} {}
-		Response(ResponseType type) : type_(type), gazes_{} {}
-	};
-
     class PSVR2EyeTracker
     {
     public:
         PSVR2EyeTracker();
 
+		// Talks to the server over the given transport instead of the platform's default IPC.
+		explicit PSVR2EyeTracker(std::unique_ptr<PSVR2Transport> transport);
+
         bool connect();
         void disconnect();
         bool update_gazes();
@@ -116,6 +67,20 @@ namespace BVR
 			is_enabled_ = is_connected_ && enabled;
 		}
 
+		// Disconnects and talks through the given transport from the next connect() on, see gaze_source.h.
+		void set_transport(std::unique_ptr<PSVR2Transport> transport);
+
+		// What the transport opens on the next connect(): the server pipe, or a dump file when replaying.
+		void set_server_pipe_name(const char* pipe_name)
+		{
+			server_pipe_name_ = pipe_name;
+		}
+
+		const char* get_server_pipe_name() const
+		{
+			return server_pipe_name_.c_str();
+		}
+
 		float get_ipd_meters() const
 		{
 			return ipd_meters_;
@@ -126,107 +91,108 @@ namespace BVR
 			ipd_meters_ = ipd_meters;
 		}
 
-#if ENABLE_PSVR2_EYE_TRACKING_COMBINED_GAZE
-        bool is_combined_gaze_available() const;
-        bool get_combined_gaze(XrVector3f& combined_gaze_direction, const bool should_apply_gaze);
-
-#if ENABLE_GAZE_CALIBRATION
-		bool is_combined_calibrated() const 
+		// Whether the last successful update_gazes() returned a sample we haven't seen before.
+		bool is_new_sample() const
 		{
-			return calibrations_[COMBINED_CALIBRATION_INDEX].is_calibrated();
+			return last_sample_verdict_ == GazeSampleVerdict::NEW_;
 		}
 
-		bool is_combined_calibrating() const
+		// Number of server samples since the previous new one, 0 if the last update brought nothing new.
+		uint64_t get_new_sample_count() const
 		{
-			return calibrations_[COMBINED_CALIBRATION_INDEX].is_calibrating();
+			return is_new_sample() ? deduplicator_.get_last_sample_delta() : 0;
 		}
 
-		void start_combined_calibration()
+		bool has_sequence_numbers() const
 		{
-			calibrations_[COMBINED_CALIBRATION_INDEX].start_calibration();
+			return has_sequence_numbers_;
 		}
 
-		void stop_combined_calibration()
+		// Whether the last update_gazes() got no answer at all: the transport failed or timed out. A rejected
+		// answer or running out of slots doesn't count, the server is still there.
+		bool has_transport_failed() const
 		{
-			calibrations_[COMBINED_CALIBRATION_INDEX].stop_calibration();
+			return has_transport_failed_;
 		}
-#endif
 
-#endif // ENABLE_PSVR2_EYE_TRACKING_COMBINED_GAZE
-        
-#if ENABLE_PSVR2_EYE_TRACKING_PER_EYE_GAZES
-        bool is_gaze_available(const int eye) const;
-        bool get_per_eye_gaze(const int eye, XrVector3f& per_eye_gaze_direction, const bool should_apply_gaze);
+		GazePublishStats& get_publish_stats() { return deduplicator_.get_stats(); }
+		const GazePublishStats& get_publish_stats() const { return deduplicator_.get_stats(); }
 
-#if ENABLE_GAZE_CALIBRATION
-		bool is_eye_calibrated(const int eye) const
+		// Responses rejected before their gazes were looked at.
+		ResponseDecodeStats& get_decode_stats() { return decode_stats_; }
+		const ResponseDecodeStats& get_decode_stats() const { return decode_stats_; }
+
+		GazeSanitizeStats& get_sanitize_stats() { return sanitizer_.get_stats(); }
+		const GazeSanitizeStats& get_sanitize_stats() const { return sanitizer_.get_stats(); }
+
+		// Median of 3 spike filter in the sanitize stage, see GazeSanitizer.
+		void set_median_filter(const bool enabled) { sanitizer_.set_median_filter(enabled); }
+
+		// Chooses which gazes update_gazes() produces. Resolved to one of the precompiled pipelines here,
+		// so call it when the settings change rather than per sample.
+		void set_gazes_enabled(const bool combined_gaze, const bool per_eye_gazes);
+
+		// All of the pipeline's settings at once, see get_gaze_pipeline_flags(). Switching forgets the
+		// sanitizer's history, so flags that are already in use change nothing.
+		void set_pipeline_flags(const uint32_t flags);
+		uint32_t get_pipeline_flags() const { return pipeline_flags_; }
+
+		bool is_combined_gaze_enabled() const { return (pipeline_flags_ & GAZE_PIPELINE_COMBINED) != 0; }
+		bool is_per_eye_gazes_enabled() const { return (pipeline_flags_ & GAZE_PIPELINE_PER_EYE) != 0; }
+
+		// Output of the pipeline for the newest sample.
+		const GazeFrame& get_gaze_frame() const
 		{
-			return calibrations_[eye].is_calibrated();
+			return (current_slot_ != GAZE_SLOT_INVALID) ? slots_.get(current_slot_).frame_ : empty_frame_;
 		}
 
-		bool is_eye_calibrating(const int eye) const
+		// Whether the newest frame holds any valid gaze, combined or per eye, whichever the pipeline produces.
+		bool has_valid_gaze() const
 		{
-			if(is_eye_calibrated(eye))
-			{
-				return false;
-			}
-
-			return (calibrating_eye_index_ == eye);
+			const GazeFrame& frame = get_gaze_frame();
+			return frame.combined_gaze_.is_valid_ || frame.per_eye_gazes_[LEFT].is_valid_ || frame.per_eye_gazes_[RIGHT].is_valid_;
 		}
 
-		int get_calibrating_eye_index() const
+		// The newest sample as the server sent it, before the pipeline.
+		const AllXRGazeStates& get_raw_gazes() const
 		{
-			return calibrating_eye_index_;
+			return (current_slot_ != GAZE_SLOT_INVALID) ? slots_.get(current_slot_).response_.gazes_ : empty_gazes_;
 		}
 
-		void start_eye_calibration(const int eye)
+		// Slot holding the newest sample, GAZE_SLOT_INVALID before the first one. Reused once another new
+		// sample comes in, see GazeSlotPool.
+		uint32_t get_current_slot() const { return current_slot_; }
+		const GazeSlotPool& get_slot_pool() const { return slots_; }
+
+		// Reading a gaze does no calibration work, sessions run on their own thread (GazeCalibrationSession).
+        bool is_combined_gaze_available() const;
+        bool get_combined_gaze(XrVector3f& combined_gaze_direction) const;
+
+		bool is_combined_calibrated() const 
 		{
-			if((calibrating_eye_index_ != INVALID_INDEX) && (calibrating_eye_index_ != eye))
-			{
-				stop_eye_calibration();
-			}
-
-			if(!is_eye_calibrated(eye))
-			{
-				calibrations_[eye].start_calibration();
-				calibrating_eye_index_ = eye;
-			}
-			else
-			{
-				calibrating_eye_index_ = INVALID_INDEX;
-			}
+			return calibrations_[COMBINED_CALIBRATION_INDEX].is_calibrated();
 		}
 
-		void stop_eye_calibration()
+        bool is_gaze_available(const int eye) const;
+        bool get_per_eye_gaze(const int eye, XrVector3f& per_eye_gaze_direction) const;
+
+		bool is_eye_calibrated(const int eye) const
 		{
-			if (calibrating_eye_index_ != INVALID_INDEX)
-			{
-				calibrations_[calibrating_eye_index_].stop_calibration();
-			}
-			calibrating_eye_index_ = INVALID_INDEX;
+			return calibrations_[eye].is_calibrated();
 		}
-#endif
-
-#endif // ENABLE_PSVR2_EYE_TRACKING_PER_EYE_GAZES
 
-#if ENABLE_GAZE_CALIBRATION
 		void set_apply_calibration(const bool enabled);
 		void toggle_apply_calibration();
+		bool is_applying_calibration() const { return (pipeline_flags_ & GAZE_PIPELINE_CALIBRATED) != 0; }
+
 		void reset_calibrations();
 		bool load_calibrations();
 		bool save_calibrations();
 
-		bool is_calibrating() const;
 		bool is_fully_calibrated() const;
 
-		void start_calibrating();
-		void stop_calibrating();
-
-		void increment_raster();
-		GLMPose get_calibration_cube() const;
-#endif
-
-		int increment_countdown_ = 0;
+		// A matrix solved by a calibration session, applied from the next sample on.
+		bool set_calibration_matrix(const int calibration_index, const float matrix[9]);
 
     private:
         bool is_connected_ = false;
@@ -234,25 +200,35 @@ namespace BVR
 
 		float ipd_meters_ = 0.0f;// 0.067f;
 
-#if ENABLE_PSVR2_EYE_TRACKING_COMBINED_GAZE
-		XRGazeState combined_gaze_;
-#endif
+		// Samples are received straight into a slot and only kept when new, so a repeated sample costs
+		// neither a copy nor a pipeline run.
+		GazeSlotPool slots_;
+		uint32_t current_slot_ = GAZE_SLOT_INVALID;
+		const GazeFrame empty_frame_ = {};
+		const AllXRGazeStates empty_gazes_ = {};
+
+		void run_pipeline();
+
+		void select_pipeline(const uint32_t flags);
 
-#if ENABLE_PSVR2_EYE_TRACKING_PER_EYE_GAZES
-		XRGazeState per_eye_gazes_[NUM_EYES];
-#endif
+		uint32_t pipeline_flags_ = 0;
+		GazePipelineFunction pipeline_ = nullptr;
 
-#if ENABLE_GAZE_CALIBRATION
 		GazeCalibration calibrations_[NUM_CALIBRATIONS];
-		int calibrating_eye_index_ = INVALID_INDEX;
-		bool apply_calibration_ = false;
-#endif
 
-		bool send_and_receive(const Request& request, Response& response) const;
-		bool send_request(const Request& request) const;
-		bool receive_request(Response& response) const;
+		GazeDeduplicator deduplicator_;
+		GazeSanitizer sanitizer_;
+		GazeSampleVerdict last_sample_verdict_ = GazeSampleVerdict::DUPLICATE_;
+		bool has_sequence_numbers_ = false;
+		bool has_transport_failed_ = false;
+
+		ResponseDecodeStats decode_stats_;
+
+		bool send_and_receive(const Request& request, const ResponseType expected_type, SequencedResponse& response, bool& has_sequence_number);
 
-		HANDLE named_pipe_handle_ = INVALID_HANDLE_VALUE;
+		std::unique_ptr<PSVR2Transport> transport_;
+		PSVR2ExchangeFunction exchange_ = nullptr;   // Bound to the transport's type when it's set
+		std::string server_pipe_name_ = PSVR2_SERVER_NAMED_PIPE_NAME;
 
     };
 }
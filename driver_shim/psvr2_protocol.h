@@ -0,0 +1,116 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PSVR2_PROTOCOL_H
+#define PSVR2_PROTOCOL_H
+
+#include "defines.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+#define PSVR2_SERVER_NAMED_PIPE_NAME "\\\\.\\pipe\\PlaystationVR2ServerPipe"
+#else
+#define PSVR2_SERVER_NAMED_PIPE_NAME "/tmp/PlaystationVR2ServerPipe" // Unix domain socket
+#endif
+
+// Wire format shared with the PSVR2 server. Everything in here is sent as raw bytes over IPC,
+// so keep it POD and don't reorder fields.
+
+namespace BVR 
+{
+	// No OpenXR dependency in this repo -- yet
+	struct XrVector3f
+	{
+		float    x;
+		float    y;
+		float    z;
+	};
+
+	struct XRGazeState
+	{
+		XrVector3f direction_ = { 0.0f, 0.0f, -1.0f };
+		bool is_valid_ = false;
+	};
+
+	struct AllXRGazeStates
+	{
+		XRGazeState combined_gaze_;
+		XRGazeState per_eye_gazes_[BVR::NUM_EYES];
+	};
+
+	enum RequestType
+	{
+		UNKNOWN_,
+		START_HANDSHAKE_,
+		GET_GAZES_,
+	};
+
+	enum ResponseType
+	{
+		ERROR_,
+		HANDSHAKE_OK_,
+		GET_GAZES_OK_,
+	};
+
+	struct Request
+	{
+		RequestType type_;
+		Request() : type_(RequestType::UNKNOWN_) {}
+		Request(RequestType type) : type_(type) {}
+	};
+
+	struct Response
+	{
+		ResponseType type_;
+		AllXRGazeStates gazes_;
+
+		Response() : type_(ResponseType::ERROR_), gazes_{} {}
+		Response(ResponseType type) : type_(type), gazes_{} {}
+	};
+
+	// Newer servers append a per-sample sequence number to GET_GAZES_OK_ responses, so clients can
+	// tell a fresh sample from a repeated one. Legacy servers send a bare Response, which is still accepted.
+	// On the wire: the 52 bytes of a Response, 4 reserved bytes (zero) so the sequence number is 8 byte
+	// aligned, then the sequence number at offset 56, 64 bytes in all. Spelled out rather than derived from
+	// Response, so the padding is a field and the layout can be checked.
+	struct SequencedResponse
+	{
+		ResponseType type_ = ResponseType::ERROR_;
+		AllXRGazeStates gazes_ = {};
+		uint32_t reserved_ = 0;
+		uint64_t sequence_number_ = 0;
+	};
+
+	static_assert(sizeof(Response) == 52, "Response is 52 bytes on the wire");
+	static_assert((offsetof(SequencedResponse, type_) == offsetof(Response, type_)) && (offsetof(SequencedResponse, gazes_) == offsetof(Response, gazes_)),
+		"A SequencedResponse starts with a Response");
+	static_assert(offsetof(SequencedResponse, reserved_) == sizeof(Response), "The reserved bytes follow the Response");
+	static_assert(offsetof(SequencedResponse, sequence_number_) == 56, "The sequence number is at offset 56 on the wire");
+	static_assert(sizeof(SequencedResponse) == 64, "SequencedResponse is 64 bytes on the wire");
+}
+
+#endif // PSVR2_PROTOCOL_H
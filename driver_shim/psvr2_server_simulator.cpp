@@ -0,0 +1,203 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "psvr2_server_simulator.h"
+#include "gaze_poll_scheduler.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace BVR
+{
+
+static const double SIMULATOR_PI = 3.14159265358979323846;
+
+static inline uint64_t xorshift64star(uint64_t& state)
+{
+	state ^= state >> 12;
+	state ^= state << 25;
+	state ^= state >> 27;
+	return state * 0x2545f4914f6cdd1dull;
+}
+
+PSVR2ServerSimulator::PSVR2ServerSimulator()
+{
+	reset(PSVR2ServerSimulatorSettings());
+}
+
+PSVR2ServerSimulator::PSVR2ServerSimulator(const PSVR2ServerSimulatorSettings& settings)
+{
+	reset(settings);
+}
+
+void PSVR2ServerSimulator::reset(const PSVR2ServerSimulatorSettings& settings)
+{
+	settings_ = settings;
+	period_us_ = 1e6 / settings_.sample_rate_hz_;
+
+	rng_state_ = settings_.seed_ ? settings_.seed_ : 1;
+	next_sample_index_ = 0;
+	next_sample_time_us_ = get_production_time_us(0);
+
+	latest_sample_time_us_ = 0;
+	latest_sequence_number_ = 0;
+	latest_gazes_ = {};
+
+	GazeSynthesizerSettings synthesizer_settings = settings_.synthesizer_;
+	synthesizer_settings.sample_rate_hz_ = settings_.sample_rate_hz_;
+	synthesizer_.reset(synthesizer_settings);
+}
+
+int64_t PSVR2ServerSimulator::get_production_time_us(const uint64_t sample_index)
+{
+	int64_t jitter_us = 0;
+
+	if(settings_.jitter_us_ > 0)
+	{
+		jitter_us = (int64_t)(xorshift64star(rng_state_) % (uint64_t)settings_.jitter_us_);
+	}
+
+	return settings_.phase_us_ + (int64_t)llround((double)sample_index * period_us_) + jitter_us;
+}
+
+void PSVR2ServerSimulator::advance(const int64_t now_us)
+{
+	while(next_sample_time_us_ <= now_us)
+	{
+		latest_sample_time_us_ = next_sample_time_us_;
+		latest_sequence_number_ = next_sample_index_ + 1;
+
+		if(settings_.synthesize_eye_movements_)
+		{
+			synthesizer_.next(latest_gazes_);
+		}
+		else
+		{
+			// Slow Lissajous sweep, enough to make every sample distinct
+			const double t = (double)latest_sample_time_us_ * 1e-6;
+			const float yaw = (float)(0.3 * sin(2.0 * SIMULATOR_PI * 0.25 * t));
+			const float pitch = (float)(0.2 * sin(2.0 * SIMULATOR_PI * 0.4 * t));
+
+			XRGazeState gaze;
+			gaze.direction_ = { sinf(yaw) * cosf(pitch), sinf(pitch), -cosf(yaw) * cosf(pitch) };
+			gaze.is_valid_ = true;
+
+			latest_gazes_.combined_gaze_ = gaze;
+			latest_gazes_.per_eye_gazes_[LEFT] = gaze;
+			latest_gazes_.per_eye_gazes_[RIGHT] = gaze;
+		}
+
+		next_sample_index_++;
+		next_sample_time_us_ = get_production_time_us(next_sample_index_);
+	}
+}
+
+void PSVR2ServerSimulator::handle_request(const int64_t now_us, const Request& request, SequencedResponse& response)
+{
+	advance(now_us);
+
+	response = SequencedResponse();
+
+	switch(request.type_)
+	{
+		case START_HANDSHAKE_:
+			response.type_ = HANDSHAKE_OK_;
+			break;
+
+		case GET_GAZES_:
+			response.type_ = GET_GAZES_OK_;
+			response.gazes_ = latest_gazes_;
+			response.sequence_number_ = settings_.send_sequence_numbers_ ? latest_sequence_number_ : 0;
+			break;
+
+		default:
+			response.type_ = ERROR_;
+			break;
+	}
+}
+
+PSVR2SimulatedTransport::PSVR2SimulatedTransport(const PSVR2ServerSimulatorSettings& settings)
+	: owned_simulator_(new PSVR2ServerSimulator(settings))
+	, simulator_(*owned_simulator_)
+{
+}
+
+bool PSVR2SimulatedTransport::open(const char* endpoint)
+{
+	(void)endpoint;
+
+	is_open_ = true;
+	has_response_ = false;
+
+	if(owned_simulator_)
+	{
+		simulator_.reset(simulator_.get_settings());
+		open_time_us_ = get_steady_time_us();
+	}
+
+	return true;
+}
+
+void PSVR2SimulatedTransport::close()
+{
+	is_open_ = false;
+	has_response_ = false;
+}
+
+bool PSVR2SimulatedTransport::send(const void* data, const size_t size)
+{
+	if(!is_open_ || (size != sizeof(Request)))
+	{
+		return false;
+	}
+
+	Request request;
+	memcpy(&request, data, sizeof(request));
+
+	const int64_t now_us = (now_us_ >= 0) ? now_us_ : (get_steady_time_us() - open_time_us_);
+	simulator_.handle_request(now_us, request, response_);
+	has_response_ = true;
+
+	return true;
+}
+
+bool PSVR2SimulatedTransport::receive(void* data, const size_t capacity, size_t& size_read)
+{
+	if(!is_open_ || !has_response_)
+	{
+		return false;
+	}
+
+	// Same wire size a real server of that generation would have sent
+	const size_t response_size = simulator_.get_settings().send_sequence_numbers_ ? sizeof(SequencedResponse) : sizeof(Response);
+
+	memcpy(data, &response_, (response_size < capacity) ? response_size : capacity);
+	size_read = response_size;
+	has_response_ = false;
+
+	return true;
+}
+
+} // BVR
@@ -0,0 +1,125 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PSVR2_SERVER_SIMULATOR_H
+#define PSVR2_SERVER_SIMULATOR_H
+
+#include "gaze_synthesizer.h"
+#include "psvr2_protocol.h"
+#include "psvr2_transport.h"
+
+#include <memory>
+#include <stdint.h>
+
+namespace BVR
+{
+	struct PSVR2ServerSimulatorSettings
+	{
+		double sample_rate_hz_ = 120.0;
+		int64_t phase_us_ = 0;
+		int64_t jitter_us_ = 0;              // Each sample is produced up to this much late, uniformly distributed
+		bool send_sequence_numbers_ = true;  // false behaves like a legacy server
+		uint64_t seed_ = 1;
+
+		// Realistic eye movements from a GazeSynthesizer instead of a slow sweep. Its sample rate follows
+		// sample_rate_hz_, one synthesized sample per produced sample.
+		bool synthesize_eye_movements_ = false;
+		GazeSynthesizerSettings synthesizer_;
+	};
+
+	// In-process stand-in for the PSVR2 server, driven by an explicit clock. Produces samples at a fixed
+	// cadence and answers requests exactly like the real server would have at that point in time, which
+	// makes polling strategies comparable offline and deterministically.
+	class PSVR2ServerSimulator
+	{
+	public:
+		PSVR2ServerSimulator();
+		explicit PSVR2ServerSimulator(const PSVR2ServerSimulatorSettings& settings);
+
+		void reset(const PSVR2ServerSimulatorSettings& settings);
+
+		// Advances the server to now_us and fills the response to the given request.
+		void handle_request(const int64_t now_us, const Request& request, SequencedResponse& response);
+
+		// Production time and sequence number of the newest sample as of the last handled request.
+		int64_t get_latest_sample_time_us() const { return latest_sample_time_us_; }
+		uint64_t get_latest_sequence_number() const { return latest_sequence_number_; }
+
+		const PSVR2ServerSimulatorSettings& get_settings() const { return settings_; }
+
+	private:
+		void advance(const int64_t now_us);
+		int64_t get_production_time_us(const uint64_t sample_index);
+
+		PSVR2ServerSimulatorSettings settings_;
+		double period_us_ = 0.0;
+
+		uint64_t rng_state_ = 0;
+		uint64_t next_sample_index_ = 0;
+		int64_t next_sample_time_us_ = 0;
+
+		int64_t latest_sample_time_us_ = 0;
+		uint64_t latest_sequence_number_ = 0;
+		AllXRGazeStates latest_gazes_ = {};
+
+		GazeSynthesizer synthesizer_;
+	};
+
+	// Transport answering from a simulator in the same process, so the whole tracker can run without a
+	// server. Uses the steady clock unless a time was set explicitly.
+	class PSVR2SimulatedTransport final : public PSVR2Transport
+	{
+	public:
+		explicit PSVR2SimulatedTransport(PSVR2ServerSimulator& simulator) : simulator_(simulator) {}
+
+		// Owns its simulator and restarts it on every open(), with the steady clock counting from there, the
+		// way a server launched on connect would behave.
+		explicit PSVR2SimulatedTransport(const PSVR2ServerSimulatorSettings& settings);
+
+		bool open(const char* endpoint) override;
+		void close() override;
+		bool is_open() const override { return is_open_; }
+
+		bool send(const void* data, const size_t size) override;
+		bool receive(void* data, const size_t capacity, size_t& size_read) override;
+
+		PSVR2ExchangeFunction get_exchange_function() const override { return &exchange_messages<PSVR2SimulatedTransport>; }
+
+		void set_now_us(const int64_t now_us) { now_us_ = now_us; }
+		void use_steady_clock() { now_us_ = -1; }
+
+	private:
+		std::unique_ptr<PSVR2ServerSimulator> owned_simulator_;
+		PSVR2ServerSimulator& simulator_;
+		bool is_open_ = false;
+		bool has_response_ = false;
+		int64_t now_us_ = -1;
+		int64_t open_time_us_ = 0;   // Steady clock origin of an owned simulator
+		SequencedResponse response_;
+	};
+}
+
+#endif // PSVR2_SERVER_SIMULATOR_H
+
@@ -0,0 +1,391 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "psvr2_transport.h"
+#include "defines.h"
+
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#define PSVR2_SERVER_CONNECT_WAIT_TIME 5000
+
+namespace BVR
+{
+
+#ifdef _WIN32
+
+class NamedPipeTransport final : public PSVR2Transport
+{
+public:
+	~NamedPipeTransport() override
+	{
+		close();
+	}
+
+	bool open(const char* endpoint) override
+	{
+		close();
+
+		while(true)
+		{
+			named_pipe_handle_ = CreateFileA(endpoint, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, NULL);
+
+			if(named_pipe_handle_ != INVALID_HANDLE_VALUE)
+			{
+				break;
+			}
+
+			if(GetLastError() != ERROR_PIPE_BUSY)
+			{
+				return false;
+			}
+
+			if(!WaitNamedPipeA(endpoint, PSVR2_SERVER_CONNECT_WAIT_TIME))
+			{
+				return false;
+			}
+		}
+
+		DWORD mode = PIPE_READMODE_MESSAGE;
+
+		if(!SetNamedPipeHandleState(named_pipe_handle_, &mode, 0, 0))
+		{
+			close();
+			return false;
+		}
+
+		// Overlapped I/O so a hung server can't keep the update loop waiting forever
+		io_event_ = CreateEventA(NULL, TRUE, FALSE, NULL);
+
+		if(io_event_ == NULL)
+		{
+			close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void close() override
+	{
+		if(named_pipe_handle_ != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(named_pipe_handle_);
+			named_pipe_handle_ = INVALID_HANDLE_VALUE;
+		}
+
+		if(io_event_ != NULL)
+		{
+			CloseHandle(io_event_);
+			io_event_ = NULL;
+		}
+
+		has_timed_out_ = false;
+	}
+
+	bool is_open() const override
+	{
+		return named_pipe_handle_ != INVALID_HANDLE_VALUE;
+	}
+
+	bool send(const void* data, const size_t size) override
+	{
+		if(has_timed_out_)
+		{
+			discard_late_answers();
+		}
+
+		OVERLAPPED overlapped = {};
+		overlapped.hEvent = io_event_;
+
+		DWORD write_size = 0;
+		bool has_more = false;
+
+		return finish_io(WriteFile(named_pipe_handle_, data, (DWORD)size, NULL, &overlapped), overlapped, write_size, has_more) && (write_size == size);
+	}
+
+	bool receive(void* data, const size_t capacity, size_t& size_read) override
+	{
+		DWORD read_size = 0;
+		bool has_more = false;
+
+		if(!read(data, (DWORD)capacity, read_size, has_more))
+		{
+			return false;
+		}
+
+		size_read = read_size;
+
+		// The rest of an oversized message would otherwise come back as the answer to the next request
+		while(has_more)
+		{
+			char discard[64];
+
+			if(!read(discard, sizeof(discard), read_size, has_more))
+			{
+				return false;
+			}
+
+			size_read += read_size;
+		}
+
+		return true;
+	}
+
+	PSVR2ExchangeFunction get_exchange_function() const override
+	{
+		return &exchange_messages<NamedPipeTransport>;
+	}
+
+private:
+	bool read(void* data, const DWORD capacity, DWORD& read_size, bool& has_more)
+	{
+		OVERLAPPED overlapped = {};
+		overlapped.hEvent = io_event_;
+
+		return finish_io(ReadFile(named_pipe_handle_, data, capacity, NULL, &overlapped), overlapped, read_size, has_more);
+	}
+
+	// Waits for an overlapped ReadFile / WriteFile for up to PSVR2_SERVER_RECEIVE_TIMEOUT_MS and cancels it
+	// after that. has_more is the ERROR_MORE_DATA of a message that didn't fit.
+	bool finish_io(const BOOL is_started, OVERLAPPED& overlapped, DWORD& size, bool& has_more)
+	{
+		size = 0;
+		has_more = false;
+
+		if(!is_started && (GetLastError() != ERROR_IO_PENDING) && (GetLastError() != ERROR_MORE_DATA))
+		{
+			return false;
+		}
+
+		if(WaitForSingleObject(io_event_, PSVR2_SERVER_RECEIVE_TIMEOUT_MS) != WAIT_OBJECT_0)
+		{
+			// The OVERLAPPED lives on our stack, so the cancellation has to be through before we return
+			CancelIoEx(named_pipe_handle_, &overlapped);
+			GetOverlappedResult(named_pipe_handle_, &overlapped, &size, TRUE);
+			has_timed_out_ = true;
+			return false;
+		}
+
+		if(!GetOverlappedResult(named_pipe_handle_, &overlapped, &size, FALSE))
+		{
+			if(GetLastError() != ERROR_MORE_DATA)
+			{
+				return false;
+			}
+
+			has_more = true;
+		}
+
+		return true;
+	}
+
+	// A server that answers after we gave up would have its answer read as the one to the next request.
+	// Whatever arrived meanwhile goes, an answer still on its way can't be told apart.
+	void discard_late_answers()
+	{
+		has_timed_out_ = false;
+
+		DWORD available = 0;
+
+		while(PeekNamedPipe(named_pipe_handle_, NULL, 0, NULL, &available, NULL) && (available > 0))
+		{
+			char discard[64];
+			DWORD read_size = 0;
+			bool has_more = false;
+
+			if(!read(discard, sizeof(discard), read_size, has_more))
+			{
+				return;
+			}
+		}
+	}
+
+	HANDLE named_pipe_handle_ = INVALID_HANDLE_VALUE;
+	HANDLE io_event_ = NULL;
+	bool has_timed_out_ = false;
+};
+
+std::unique_ptr<PSVR2Transport> create_default_transport()
+{
+	return std::unique_ptr<PSVR2Transport>(new NamedPipeTransport());
+}
+
+#else
+
+class UnixSocketTransport final : public PSVR2Transport
+{
+public:
+	~UnixSocketTransport() override
+	{
+		close();
+	}
+
+	bool open(const char* endpoint) override
+	{
+		close();
+
+		sockaddr_un address = {};
+		address.sun_family = AF_UNIX;
+
+		if(strlen(endpoint) >= sizeof(address.sun_path))
+		{
+			return false;
+		}
+
+		strcpy(address.sun_path, endpoint);
+
+		socket_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+
+		if(socket_ < 0)
+		{
+			return false;
+		}
+
+		if(connect(socket_, (const sockaddr*)&address, sizeof(address)) != 0)
+		{
+			close();
+			return false;
+		}
+
+		// A hung server would otherwise keep the update loop waiting in recvmsg() forever
+		const timeval timeout = { PSVR2_SERVER_RECEIVE_TIMEOUT_MS / 1000, (PSVR2_SERVER_RECEIVE_TIMEOUT_MS % 1000) * 1000 };
+
+		if((setsockopt(socket_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) != 0) ||
+			(setsockopt(socket_, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) != 0))
+		{
+			close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void close() override
+	{
+		if(socket_ >= 0)
+		{
+			::close(socket_);
+			socket_ = -1;
+		}
+
+		has_timed_out_ = false;
+	}
+
+	bool is_open() const override
+	{
+		return socket_ >= 0;
+	}
+
+	bool send(const void* data, const size_t size) override
+	{
+		if(has_timed_out_)
+		{
+			discard_late_answers();
+		}
+
+		ssize_t written = -1;
+
+		do
+		{
+			written = ::send(socket_, data, size, MSG_NOSIGNAL);
+		}
+		while((written < 0) && (errno == EINTR));
+
+		return written == (ssize_t)size;
+	}
+
+	bool receive(void* data, const size_t capacity, size_t& size_read) override
+	{
+		iovec buffer = { data, capacity };
+
+		msghdr message = {};
+		message.msg_iov = &buffer;
+		message.msg_iovlen = 1;
+
+		ssize_t read_size = -1;
+
+		do
+		{
+			read_size = recvmsg(socket_, &message, 0);
+		}
+		while((read_size < 0) && (errno == EINTR));
+
+		// 0 is an orderly shutdown from the server, not an empty message
+		if(read_size <= 0)
+		{
+			has_timed_out_ = (read_size < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK));
+			return false;
+		}
+
+		// The socket already dropped the rest, all we learn is that it didn't fit
+		const bool is_truncated = (message.msg_flags & MSG_TRUNC) != 0;
+		size_read = is_truncated ? (capacity + 1) : (size_t)read_size;
+
+		return true;
+	}
+
+	PSVR2ExchangeFunction get_exchange_function() const override
+	{
+		return &exchange_messages<UnixSocketTransport>;
+	}
+
+private:
+	// A server that answers after we gave up would have its answer read as the one to the next request.
+	// Whatever arrived meanwhile goes, an answer still on its way can't be told apart.
+	void discard_late_answers()
+	{
+		has_timed_out_ = false;
+
+		char discard[64];
+
+		while(recv(socket_, discard, sizeof(discard), MSG_DONTWAIT) > 0)
+		{
+		}
+	}
+
+	int socket_ = -1;
+	bool has_timed_out_ = false;
+};
+
+std::unique_ptr<PSVR2Transport> create_default_transport()
+{
+	return std::unique_ptr<PSVR2Transport>(new UnixSocketTransport());
+}
+
+#endif
+
+} // BVR
@@ -0,0 +1,75 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef PSVR2_TRANSPORT_H
+#define PSVR2_TRANSPORT_H
+
+#include <memory>
+#include <stddef.h>
+
+namespace BVR
+{
+	class PSVR2Transport;
+
+	// One request out and its response back in.
+	typedef bool (*PSVR2ExchangeFunction)(PSVR2Transport& transport, const void* request, const size_t request_size, void* response, const size_t capacity, size_t& size_read);
+
+	// The exchange compiled against one transport type. With a final Transport, send() and receive() bind
+	// statically, so each poll costs one indirect call instead of a virtual call per message.
+	template<typename Transport>
+	bool exchange_messages(PSVR2Transport& transport, const void* request, const size_t request_size, void* response, const size_t capacity, size_t& size_read)
+	{
+		Transport& concrete = static_cast<Transport&>(transport);
+		return concrete.send(request, request_size) && concrete.receive(response, capacity, size_read);
+	}
+
+	// Message oriented channel to the PSVR2 server. One send() is one message, one receive() returns
+	// exactly one message, so the protocol structs can go over it as raw bytes.
+	class PSVR2Transport
+	{
+	public:
+		virtual ~PSVR2Transport() {}
+
+		virtual bool open(const char* endpoint) = 0;
+		virtual void close() = 0;
+		virtual bool is_open() const = 0;
+
+		virtual bool send(const void* data, const size_t size) = 0;
+
+		// Messages larger than capacity are truncated and the rest is discarded, size_read is then larger
+		// than capacity so they can't pass for a message that fit.
+		virtual bool receive(void* data, const size_t capacity, size_t& size_read) = 0;
+
+		// Looked up once when the transport is picked. Final transports return exchange_messages<Self>, the
+		// default goes through the virtual calls.
+		virtual PSVR2ExchangeFunction get_exchange_function() const { return &exchange_messages<PSVR2Transport>; }
+	};
+
+	// The named pipe on Windows, a SOCK_SEQPACKET unix domain socket elsewhere.
+	std::unique_ptr<PSVR2Transport> create_default_transport();
+}
+
+#endif // PSVR2_TRANSPORT_H
@@ -0,0 +1,157 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "shim_config.h"
+
+#include <string.h>
+
+namespace BVR
+{
+
+template<typename T> static inline T config_clamp(T v, T mn, T mx)
+{
+	return (v < mn) ? mn : (v > mx) ? mx : v;
+}
+
+GazePollSettings ShimConfig::get_poll_settings() const
+{
+	GazePollSettings settings;
+
+	settings.active_interval_us_ = (int64_t)polling_rate_ms_ * 1000;
+	settings.idle_interval_us_ = (int64_t)idle_polling_rate_ms_ * 1000;
+	settings.standby_interval_us_ = (int64_t)standby_polling_rate_ms_ * 1000;
+	settings.idle_timeout_us_ = (int64_t)idle_timeout_ms_ * 1000;
+	settings.adaptive_ = adaptive_polling_;
+	settings.adaptive_guard_us_ = adaptive_polling_guard_us_;
+
+	return settings;
+}
+
+GazeThreadSettings ShimConfig::get_thread_settings() const
+{
+	GazeThreadSettings settings;
+
+	settings.priority_ = (GazeThreadPriority)update_thread_priority_;
+	settings.affinity_mask_ = (uint32_t)update_thread_affinity_mask_;
+	settings.high_resolution_timer_ = high_resolution_timer_;
+
+	return settings;
+}
+
+bool ShimConfig::has_same_settings(const ShimConfig& other) const
+{
+	return (polling_rate_ms_ == other.polling_rate_ms_) &&
+		(idle_polling_rate_ms_ == other.idle_polling_rate_ms_) &&
+		(standby_polling_rate_ms_ == other.standby_polling_rate_ms_) &&
+		(idle_timeout_ms_ == other.idle_timeout_ms_) &&
+		(adaptive_polling_ == other.adaptive_polling_) &&
+		(adaptive_polling_guard_us_ == other.adaptive_polling_guard_us_) &&
+		(deduplicate_samples_ == other.deduplicate_samples_) &&
+		(keep_alive_interval_ms_ == other.keep_alive_interval_ms_) &&
+		(telemetry_enabled_ == other.telemetry_enabled_) &&
+		(broadcast_enabled_ == other.broadcast_enabled_) &&
+		(eye_tracking_enabled_ == other.eye_tracking_enabled_) &&
+		(combined_gaze_ == other.combined_gaze_) &&
+		(per_eye_gazes_ == other.per_eye_gazes_) &&
+		(apply_calibration_ == other.apply_calibration_) &&
+		(adaptive_smoothing_ == other.adaptive_smoothing_) &&
+		(median_filter_ == other.median_filter_) &&
+		(social_gazes_ == other.social_gazes_) &&
+		(update_thread_priority_ == other.update_thread_priority_) &&
+		(update_thread_affinity_mask_ == other.update_thread_affinity_mask_) &&
+		(high_resolution_timer_ == other.high_resolution_timer_) &&
+		(gaze_source_ == other.gaze_source_) &&
+		(strcmp(server_pipe_name_, other.server_pipe_name_) == 0) &&
+		(strcmp(replay_file_, other.replay_file_) == 0);
+}
+
+void ShimConfig::set_server_pipe_name(const char* pipe_name)
+{
+	strncpy(server_pipe_name_, pipe_name, SHIM_CONFIG_MAX_STRING - 1);
+	server_pipe_name_[SHIM_CONFIG_MAX_STRING - 1] = '\0';
+}
+
+void ShimConfig::set_replay_file(const char* replay_file)
+{
+	strncpy(replay_file_, replay_file, SHIM_CONFIG_MAX_STRING - 1);
+	replay_file_[SHIM_CONFIG_MAX_STRING - 1] = '\0';
+}
+
+void ShimConfig::sanitize()
+{
+	// Values straight from a user-edited file, keep them in a range the update thread can live with
+	polling_rate_ms_ = config_clamp(polling_rate_ms_, 1, 100);
+	idle_polling_rate_ms_ = config_clamp(idle_polling_rate_ms_, polling_rate_ms_, 10000);
+	standby_polling_rate_ms_ = config_clamp(standby_polling_rate_ms_, polling_rate_ms_, 10000);
+	idle_timeout_ms_ = config_clamp(idle_timeout_ms_, 0, 600000);
+	adaptive_polling_guard_us_ = config_clamp(adaptive_polling_guard_us_, 0, 10000);
+	keep_alive_interval_ms_ = config_clamp(keep_alive_interval_ms_, 0, 10000);
+	update_thread_priority_ = config_clamp(update_thread_priority_, 0, (int)GazeThreadPriority::NUM_PRIORITIES_ - 1);
+	gaze_source_ = config_clamp(gaze_source_, 0, (int)GazeSourceType::NUM_SOURCES_ - 1);
+
+	if(server_pipe_name_[0] == '\0')
+	{
+		set_server_pipe_name(PSVR2_SERVER_NAMED_PIPE_NAME);
+	}
+
+	if(replay_file_[0] == '\0')
+	{
+		set_replay_file(GAZE_REPLAY_FILE);
+	}
+}
+
+ShimConfigStore::ShimConfigStore()
+{
+	snapshots_.emplace_back(new ShimConfig());
+	current_.store(snapshots_.back().get(), std::memory_order_release);
+}
+
+bool ShimConfigStore::publish(const ShimConfig& config)
+{
+	std::lock_guard<std::mutex> lock(writer_mutex_);
+
+	const ShimConfig* current = current_.load(std::memory_order_relaxed);
+
+	if(current->has_same_settings(config))
+	{
+		return false;
+	}
+
+	ShimConfig* snapshot = new ShimConfig(config);
+	snapshot->generation_ = current->generation_ + 1;
+	snapshots_.emplace_back(snapshot);
+
+	current_.store(snapshot, std::memory_order_release);
+
+	return true;
+}
+
+ShimConfigStore& get_shim_config_store()
+{
+	static ShimConfigStore store;
+	return store;
+}
+
+} // BVR
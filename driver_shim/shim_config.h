@@ -0,0 +1,126 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SHIM_CONFIG_H
+#define SHIM_CONFIG_H
+
+#include "defines.h"
+#include "gaze_poll_scheduler.h"
+#include "gaze_source.h"
+#include "gaze_thread_policy.h"
+#include "psvr2_protocol.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+
+#define SHIM_SETTINGS_SECTION "driver_psvr2_shim"
+#define SHIM_CONFIG_MAX_STRING 128
+
+namespace BVR
+{
+	// Runtime tunables, read from the driver's section in default.vrsettings / steamvr.vrsettings.
+	// The compile-time defines only provide the defaults now.
+	struct ShimConfig
+	{
+		// Polling
+		int polling_rate_ms_ = EYE_TRACKING_POLLING_RATE_MS;
+		int idle_polling_rate_ms_ = EYE_TRACKING_IDLE_POLLING_RATE_MS;
+		int standby_polling_rate_ms_ = EYE_TRACKING_STANDBY_POLLING_RATE_MS;
+		int idle_timeout_ms_ = EYE_TRACKING_IDLE_TIMEOUT_MS;
+		bool adaptive_polling_ = ENABLE_ADAPTIVE_POLLING;
+		int adaptive_polling_guard_us_ = ADAPTIVE_POLLING_GUARD_US;
+
+		// Publishing
+		bool deduplicate_samples_ = ENABLE_GAZE_DEDUPLICATION;
+		int keep_alive_interval_ms_ = GAZE_KEEPALIVE_INTERVAL_MS;
+		bool telemetry_enabled_ = ENABLE_GAZE_TELEMETRY;
+		bool broadcast_enabled_ = ENABLE_GAZE_BROADCAST;
+
+		// Gazes
+		bool eye_tracking_enabled_ = ENABLE_PSVR2_EYE_TRACKING_AUTOMATICALLY;
+		bool combined_gaze_ = ENABLE_PSVR2_EYE_TRACKING_COMBINED_GAZE;
+		bool per_eye_gazes_ = ENABLE_PSVR2_EYE_TRACKING_PER_EYE_GAZES;
+		bool apply_calibration_ = ENABLE_GAZE_CALIBRATION;
+		bool adaptive_smoothing_ = ENABLE_ADAPTIVE_SMOOTHING;
+		bool median_filter_ = ENABLE_GAZE_MEDIAN_FILTER;
+		bool social_gazes_ = ENABLE_PSVR2_SOCIAL_GAZES;
+
+		// Update thread scheduling
+		int update_thread_priority_ = UPDATE_THREAD_PRIORITY;
+		int update_thread_affinity_mask_ = UPDATE_THREAD_AFFINITY_MASK;
+		bool high_resolution_timer_ = ENABLE_HIGH_RESOLUTION_TIMER;
+
+		// Transport
+		int gaze_source_ = GAZE_SOURCE;
+		char server_pipe_name_[SHIM_CONFIG_MAX_STRING] = PSVR2_SERVER_NAMED_PIPE_NAME;
+		char replay_file_[SHIM_CONFIG_MAX_STRING] = GAZE_REPLAY_FILE;
+
+		// Bumped by ShimConfigStore on every publish, lets readers cheaply notice a change.
+		uint64_t generation_ = 0;
+
+		GazePollSettings get_poll_settings() const;
+		GazeThreadSettings get_thread_settings() const;
+
+		// Compares every setting, ignoring the generation.
+		bool has_same_settings(const ShimConfig& other) const;
+
+		void set_server_pipe_name(const char* pipe_name);
+		void set_replay_file(const char* replay_file);
+		void sanitize();
+	};
+
+	// Holds the current configuration as an immutable snapshot behind an atomic pointer. Readers (the update
+	// thread) only do an acquire load, never a lock. Writers build a new snapshot and swap it in.
+	//
+	// Snapshots are kept alive until the store is destroyed since a reader may still be looking at any of
+	// them. They are only created when a setting actually changes, so this stays tiny in practice.
+	class ShimConfigStore
+	{
+	public:
+		ShimConfigStore();
+
+		const ShimConfig& get() const
+		{
+			return *current_.load(std::memory_order_acquire);
+		}
+
+		// Returns false (and keeps the current snapshot) when nothing changed.
+		bool publish(const ShimConfig& config);
+
+	private:
+		std::atomic<const ShimConfig*> current_;
+
+		std::mutex writer_mutex_;
+		std::vector<std::unique_ptr<const ShimConfig>> snapshots_;
+	};
+
+	ShimConfigStore& get_shim_config_store();
+}
+
+#endif // SHIM_CONFIG_H
+
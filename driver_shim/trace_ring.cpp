@@ -0,0 +1,170 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "trace_ring.h"
+
+#include <chrono>
+#include <inttypes.h>
+#include <stdio.h>
+
+namespace BVR
+{
+
+static std::atomic<uint32_t> g_next_thread_id = 1;
+static std::atomic<uint64_t> g_next_activity_id = 1;
+
+static const char* get_kind_name(const TraceEventKind kind)
+{
+	switch(kind)
+	{
+		case TraceEventKind::START_:
+			return "start";
+		case TraceEventKind::STOP_:
+			return "stop";
+		case TraceEventKind::TAGGED_:
+			return "tagged";
+		default:
+			return "event";
+	}
+}
+
+static void write_arg(FILE* file, const TraceArg& arg)
+{
+	fprintf(file, ",%s,", arg.name_);
+
+	switch(arg.type_)
+	{
+		case TraceArgType::INT_:
+			fprintf(file, "%" PRId64, arg.int_);
+			break;
+		case TraceArgType::UINT_:
+		case TraceArgType::BOOL_:
+			fprintf(file, "%" PRIu64, arg.uint_);
+			break;
+		case TraceArgType::FLOAT_:
+			fprintf(file, "%.9g", arg.float_);
+			break;
+		case TraceArgType::TEXT_:
+			fprintf(file, "\"%s\"", arg.text_);
+			break;
+		case TraceArgType::POINTER_:
+			fprintf(file, "0x%" PRIx64, arg.uint_);
+			break;
+		default:
+			break;
+	}
+}
+
+int64_t TraceRing::get_time_us()
+{
+	return (int64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t TraceRing::get_thread_id()
+{
+	static thread_local const uint32_t thread_id = g_next_thread_id.fetch_add(1, std::memory_order_relaxed);
+	return thread_id;
+}
+
+bool TraceRing::dump(const char* path) const
+{
+	FILE* file = fopen(path, "w");
+
+	if(!file)
+	{
+		return false;
+	}
+
+	fprintf(file, "time_us,thread,activity,kind,event,args\n");
+
+	const uint64_t head = head_.load(std::memory_order_acquire);
+	const uint64_t first = (head > TRACE_RING_CAPACITY) ? head - TRACE_RING_CAPACITY : 0;
+
+	for(uint64_t index = first; index < head; index++)
+	{
+		const TraceRecord& record = records_[index & (TRACE_RING_CAPACITY - 1)];
+		const uint64_t expected_sequence = 2 * index + 2;
+
+		if(record.sequence_.load(std::memory_order_acquire) != expected_sequence)
+		{
+			continue; // Still being written, or already overwritten
+		}
+
+		const int64_t time_us = record.time_us_;
+		const uint64_t activity_id = record.activity_id_;
+		const char* name = record.name_;
+		const uint32_t thread_id = record.thread_id_;
+		const TraceEventKind kind = record.kind_;
+		const uint8_t num_args = record.num_args_;
+		TraceArg args[TRACE_RING_MAX_ARGS];
+
+		for(uint8_t arg_index = 0; arg_index < num_args && arg_index < TRACE_RING_MAX_ARGS; arg_index++)
+		{
+			args[arg_index] = record.args_[arg_index];
+		}
+
+		// Same check as a seqlock reader, a writer may have lapped us while copying
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		if(record.sequence_.load(std::memory_order_relaxed) != expected_sequence)
+		{
+			continue;
+		}
+
+		fprintf(file, "%" PRId64 ",%u,%" PRIu64 ",%s,%s", time_us, thread_id, activity_id, get_kind_name(kind), name);
+
+		for(uint8_t arg_index = 0; arg_index < num_args && arg_index < TRACE_RING_MAX_ARGS; arg_index++)
+		{
+			write_arg(file, args[arg_index]);
+		}
+
+		fprintf(file, "\n");
+	}
+
+	return fclose(file) == 0;
+}
+
+void TraceRing::reset()
+{
+	for(TraceRecord& record : records_)
+	{
+		record.sequence_.store(0, std::memory_order_relaxed);
+	}
+
+	head_.store(0, std::memory_order_release);
+}
+
+TraceRing& get_trace_ring()
+{
+	static TraceRing ring;
+	return ring;
+}
+
+TraceActivity::TraceActivity() : id_(g_next_activity_id.fetch_add(1, std::memory_order_relaxed))
+{
+}
+
+} // BVR
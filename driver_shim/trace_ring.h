@@ -0,0 +1,289 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef TRACE_RING_H
+#define TRACE_RING_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+#define TRACE_RING_CAPACITY 4096    // Records kept, the oldest are overwritten. Must be a power of two.
+#define TRACE_RING_MAX_ARGS 4       // Further arguments are dropped
+#define TRACE_RING_TEXT_SIZE 24     // String arguments are copied and truncated to this (terminator included)
+
+namespace BVR
+{
+	enum class TraceEventKind : uint8_t
+	{
+		EVENT_,
+		START_,
+		STOP_,
+		TAGGED_,
+	};
+
+	enum class TraceArgType : uint8_t
+	{
+		NONE_,
+		INT_,
+		UINT_,
+		FLOAT_,
+		BOOL_,
+		TEXT_,
+		POINTER_,
+	};
+
+	struct TraceArg
+	{
+		const char* name_ = ""; // Always a string literal
+		TraceArgType type_ = TraceArgType::NONE_;
+
+		union
+		{
+			int64_t int_;
+			uint64_t uint_;
+			double float_;
+		};
+
+		char text_[TRACE_RING_TEXT_SIZE];
+
+		TraceArg() : int_(0) { text_[0] = 0; }
+	};
+
+	template<typename Type>
+	inline TraceArg make_trace_arg(const Type& value, const char* name = "")
+	{
+		TraceArg arg;
+		arg.name_ = name;
+
+		if constexpr(std::is_same<Type, bool>::value)
+		{
+			arg.type_ = TraceArgType::BOOL_;
+			arg.uint_ = value ? 1 : 0;
+		}
+		else if constexpr(std::is_enum<Type>::value)
+		{
+			arg.type_ = TraceArgType::INT_;
+			arg.int_ = (int64_t)value;
+		}
+		else if constexpr(std::is_integral<Type>::value && std::is_signed<Type>::value)
+		{
+			arg.type_ = TraceArgType::INT_;
+			arg.int_ = (int64_t)value;
+		}
+		else if constexpr(std::is_integral<Type>::value)
+		{
+			arg.type_ = TraceArgType::UINT_;
+			arg.uint_ = (uint64_t)value;
+		}
+		else if constexpr(std::is_floating_point<Type>::value)
+		{
+			arg.type_ = TraceArgType::FLOAT_;
+			arg.float_ = (double)value;
+		}
+		else
+		{
+			// Anything else must be a C string, a pointer that may be null or a char array that can't be
+			arg.type_ = TraceArgType::TEXT_;
+
+			if constexpr(std::is_pointer<Type>::value)
+			{
+				strncpy(arg.text_, value ? (const char*)value : "", TRACE_RING_TEXT_SIZE - 1);
+			}
+			else
+			{
+				strncpy(arg.text_, value, TRACE_RING_TEXT_SIZE - 1);
+			}
+
+			arg.text_[TRACE_RING_TEXT_SIZE - 1] = 0;
+		}
+
+		return arg;
+	}
+
+	inline TraceArg make_trace_pointer_arg(const void* pointer, const char* name = "")
+	{
+		TraceArg arg;
+		arg.name_ = name;
+		arg.type_ = TraceArgType::POINTER_;
+		arg.uint_ = (uint64_t)(uintptr_t)pointer;
+
+		return arg;
+	}
+
+	struct TraceRecord
+	{
+		// Odd while being written, 2 * (index + 1) once complete. Lets the dump skip torn records.
+		std::atomic<uint64_t> sequence_ = 0;
+
+		int64_t time_us_ = 0;
+		uint64_t activity_id_ = 0;
+		const char* name_ = "";
+		uint32_t thread_id_ = 0;
+		TraceEventKind kind_ = TraceEventKind::EVENT_;
+		uint8_t num_args_ = 0;
+		TraceArg args_[TRACE_RING_MAX_ARGS];
+	};
+
+	// In-memory trace sink for builds without ETW. Writers from any thread claim a slot with a single atomic
+	// increment and never wait, old records are overwritten. dump() writes whatever is complete as CSV.
+	class TraceRing
+	{
+	public:
+		template<typename... Args>
+		void write(const TraceEventKind kind, const uint64_t activity_id, const char* name, const Args&... args)
+		{
+			const uint64_t index = head_.fetch_add(1, std::memory_order_relaxed);
+			TraceRecord& record = records_[index & (TRACE_RING_CAPACITY - 1)];
+
+			record.sequence_.store(2 * index + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+
+			record.time_us_ = get_time_us();
+			record.activity_id_ = activity_id;
+			record.name_ = name;
+			record.thread_id_ = get_thread_id();
+			record.kind_ = kind;
+			record.num_args_ = 0;
+
+			(append_arg(record, args), ...);
+
+			record.sequence_.store(2 * index + 2, std::memory_order_release);
+		}
+
+		// Records written so far, including the ones since overwritten.
+		uint64_t get_num_written() const { return head_.load(std::memory_order_relaxed); }
+
+		// Oldest first. Safe while writers are running, records they're in the middle of are skipped.
+		bool dump(const char* path) const;
+
+		void reset();
+
+	private:
+		static void append_arg(TraceRecord& record, const TraceArg& arg)
+		{
+			if(record.num_args_ < TRACE_RING_MAX_ARGS)
+			{
+				record.args_[record.num_args_++] = arg;
+			}
+		}
+
+		static int64_t get_time_us();
+		static uint32_t get_thread_id();
+
+		std::atomic<uint64_t> head_ = 0;
+		TraceRecord records_[TRACE_RING_CAPACITY];
+	};
+
+	TraceRing& get_trace_ring();
+
+	// Stand-in for TraceLoggingActivity, ties start / stop records together.
+	class TraceActivity
+	{
+	public:
+		TraceActivity();
+
+		uint64_t get_id() const { return id_; }
+
+	private:
+		uint64_t id_;
+	};
+
+	// Summary of a value sampled every iteration (a sleep, a poll), traced once per interval instead of
+	// once per sample.
+	struct TraceAggregate
+	{
+		uint64_t count_ = 0;
+		int64_t sum_ = 0;
+		int64_t min_ = 0;
+		int64_t max_ = 0;
+
+		void add(const int64_t value)
+		{
+			min_ = (count_ == 0 || value < min_) ? value : min_;
+			max_ = (count_ == 0 || value > max_) ? value : max_;
+			sum_ += value;
+			count_++;
+		}
+
+		int64_t get_mean() const { return count_ ? sum_ / (int64_t)count_ : 0; }
+
+		void reset() { *this = TraceAggregate(); }
+	};
+
+	// Lets one in every interval calls through.
+	class TraceSampler
+	{
+	public:
+		explicit TraceSampler(const uint32_t interval) : interval_(interval ? interval : 1) {}
+
+		bool should_sample()
+		{
+			if(++calls_ >= interval_)
+			{
+				calls_ = 0;
+				return true;
+			}
+
+			return false;
+		}
+
+	private:
+		uint32_t interval_;
+		uint32_t calls_ = 0;
+	};
+
+	// True once per interval_us, for flushing aggregates.
+	class TraceInterval
+	{
+	public:
+		explicit TraceInterval(const int64_t interval_us) : interval_us_(interval_us) {}
+
+		bool is_due(const int64_t now_us)
+		{
+			if(last_us_ == 0)
+			{
+				last_us_ = now_us;
+			}
+
+			if((now_us - last_us_) >= interval_us_)
+			{
+				last_us_ = now_us;
+				return true;
+			}
+
+			return false;
+		}
+
+	private:
+		int64_t interval_us_;
+		int64_t last_us_ = 0;
+	};
+}
+
+#endif // TRACE_RING_H
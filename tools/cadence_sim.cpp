@@ -0,0 +1,209 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Compares the fixed-rate and adaptive polling strategies of GazePollScheduler against the in-process
+// server simulator, on a virtual clock. Prints one line per scenario and strategy:
+//
+//   polls/s       round trips to the server per second
+//   empty         share of polls that returned a sample we already had (wasted round trips)
+//   age           time between the server producing a sample and us picking it up (mean / p99)
+//   skipped       samples the server produced that we never saw
+//
+// The first second is excluded from the numbers, it is spent locking on to the server cadence.
+// The stall scenarios freeze the server for a while every second, it keeps answering with the sample it
+// had: the adaptive strategy must not poll it any harder than the fixed one meanwhile.
+//
+// Built by the top level CMakeLists.txt, along with the gaze core it links against.
+
+#include "gaze_deduplicator.h"
+#include "gaze_poll_scheduler.h"
+#include "psvr2_server_simulator.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <vector>
+
+using namespace BVR;
+
+struct Scenario
+{
+	const char* name_;
+	double sample_rate_hz_;
+	int64_t production_jitter_us_;
+	int64_t wakeup_jitter_us_;  // How late the OS wakes us up, uniformly distributed
+	bool send_sequence_numbers_;
+	int64_t stall_interval_us_;  // The server stops producing for stall_duration_us_ every interval, 0 for never
+	int64_t stall_duration_us_;
+};
+
+struct Result
+{
+	double polls_per_second_ = 0.0;
+	double empty_ratio_ = 0.0;
+	double mean_age_us_ = 0.0;
+	double p99_age_us_ = 0.0;
+	uint64_t skipped_samples_ = 0;
+	uint64_t produced_samples_ = 0;
+};
+
+static Result run(const Scenario& scenario, const bool adaptive, const int64_t warmup_us, const int64_t duration_us)
+{
+	PSVR2ServerSimulatorSettings server_settings;
+	server_settings.sample_rate_hz_ = scenario.sample_rate_hz_;
+	server_settings.phase_us_ = 1234;
+	server_settings.jitter_us_ = scenario.production_jitter_us_;
+	server_settings.send_sequence_numbers_ = scenario.send_sequence_numbers_;
+
+	PSVR2ServerSimulator server(server_settings);
+	GazeDeduplicator deduplicator;
+
+	GazePollSettings poll_settings;
+	poll_settings.adaptive_ = adaptive;
+
+	GazePollScheduler scheduler;
+	scheduler.set_settings(poll_settings);
+	scheduler.start(0);
+
+	uint64_t rng_state = 0x9e3779b97f4a7c15ull;
+	std::vector<int64_t> ages_us;
+	uint64_t polls = 0;
+	uint64_t empty_polls = 0;
+	uint64_t first_sequence_number = 0;
+	uint64_t last_sequence_number = 0;
+	uint64_t seen_samples = 0;
+	SequencedResponse response;
+
+	while(true)
+	{
+		int64_t now_us = scheduler.get_next_poll_time_us();
+
+		if(scenario.wakeup_jitter_us_ > 0)
+		{
+			rng_state ^= rng_state >> 12;
+			rng_state ^= rng_state << 25;
+			rng_state ^= rng_state >> 27;
+			now_us += (int64_t)((rng_state * 0x2545f4914f6cdd1dull) % (uint64_t)scenario.wakeup_jitter_us_);
+		}
+
+		if(now_us >= (warmup_us + duration_us))
+		{
+			break;
+		}
+
+		const bool is_stalled = (scenario.stall_interval_us_ > 0) && ((now_us % scenario.stall_interval_us_) < scenario.stall_duration_us_);
+
+		// A stalled server answers with the last sample it had
+		if(!is_stalled)
+		{
+			server.handle_request(now_us, Request(GET_GAZES_), response);
+		}
+
+		const GazeSampleVerdict verdict = deduplicator.classify(response.gazes_, scenario.send_sequence_numbers_, response.sequence_number_);
+		const uint64_t new_samples = (verdict == GazeSampleVerdict::NEW_) ? deduplicator.get_last_sample_delta() : 0;
+
+		if(now_us < warmup_us)
+		{
+			first_sequence_number = server.get_latest_sequence_number();
+		}
+		else
+		{
+			polls++;
+
+			if(new_samples > 0)
+			{
+				ages_us.push_back(now_us - server.get_latest_sample_time_us());
+				seen_samples++;
+			}
+			else
+			{
+				empty_polls++;
+			}
+
+			last_sequence_number = server.get_latest_sequence_number();
+		}
+
+		scheduler.on_poll(now_us, response.gazes_.combined_gaze_.is_valid_, new_samples);
+	}
+
+	Result result;
+	result.polls_per_second_ = (double)polls * 1e6 / (double)duration_us;
+	result.empty_ratio_ = polls ? ((double)empty_polls / (double)polls) : 0.0;
+	result.produced_samples_ = last_sequence_number - first_sequence_number;
+	result.skipped_samples_ = result.produced_samples_ - std::min(result.produced_samples_, seen_samples);
+
+	if(!ages_us.empty())
+	{
+		double sum_us = 0.0;
+
+		for(const int64_t age_us : ages_us)
+		{
+			sum_us += (double)age_us;
+		}
+
+		std::sort(ages_us.begin(), ages_us.end());
+		result.mean_age_us_ = sum_us / (double)ages_us.size();
+		result.p99_age_us_ = (double)ages_us[(ages_us.size() * 99) / 100];
+	}
+
+	return result;
+}
+
+int main()
+{
+	const Scenario scenarios[] =
+	{
+		{ "120 Hz",                      120.0,   0,   0, true,        0,      0 },
+		{ "120 Hz, jittery",             120.0, 500, 500, true,        0,      0 },
+		{ "120 Hz, jittery, legacy",     120.0, 500, 500, false,       0,      0 },
+		{ "90 Hz, jittery",               90.0, 500, 500, true,        0,      0 },
+		{ "240 Hz, jittery",             240.0, 200, 500, true,        0,      0 },
+		{ "120 Hz, 20 ms stalls",        120.0, 500, 500, true,  1000000,  20000 },
+		{ "120 Hz, 200 ms stalls",       120.0, 500, 500, true,  1000000, 200000 },
+	};
+
+	const int64_t warmup_us = 1000000;
+	const int64_t duration_us = 60 * 1000000ll;
+
+	printf("%-26s %-9s %9s %7s %10s %10s %9s\n", "scenario", "polling", "polls/s", "empty", "age mean", "age p99", "skipped");
+
+	for(const Scenario& scenario : scenarios)
+	{
+		for(int adaptive = 0; adaptive < 2; adaptive++)
+		{
+			const Result result = run(scenario, adaptive != 0, warmup_us, duration_us);
+
+			printf("%-26s %-9s %9.1f %6.1f%% %8.0fus %8.0fus %9llu\n",
+				scenario.name_,
+				adaptive ? "adaptive" : "fixed",
+				result.polls_per_second_,
+				100.0 * result.empty_ratio_,
+				result.mean_age_us_,
+				result.p99_age_us_,
+				(unsigned long long)result.skipped_samples_);
+		}
+	}
+
+	return 0;
+}
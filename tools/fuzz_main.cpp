@@ -0,0 +1,95 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// Runs a libFuzzer style harness without libFuzzer, for compilers that don't have -fsanitize=fuzzer and
+// for AFL (afl-clang-fast / afl-g++ build this as a plain program that reads the input from a file).
+//
+// usage: fuzz_xxx FILE...   (or the input on stdin when no files are given)
+//
+// Every file is run through LLVMFuzzerTestOneInput once, a crash or abort is the failure.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+static bool read_input(FILE* file, std::vector<uint8_t>& input)
+{
+	input.clear();
+
+	uint8_t buffer[4096];
+	size_t read_size = 0;
+
+	while((read_size = fread(buffer, 1, sizeof(buffer), file)) > 0)
+	{
+		input.insert(input.end(), buffer, buffer + read_size);
+	}
+
+	return ferror(file) == 0;
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<uint8_t> input;
+
+	if(argc < 2)
+	{
+		if(!read_input(stdin, input))
+		{
+			return 1;
+		}
+
+		LLVMFuzzerTestOneInput(input.data(), input.size());
+		return 0;
+	}
+
+	for(int index = 1; index < argc; index++)
+	{
+		FILE* file = fopen(argv[index], "rb");
+
+		if(!file)
+		{
+			fprintf(stderr, "can't open %s\n", argv[index]);
+			return 1;
+		}
+
+		const bool read_ok = read_input(file, input);
+		fclose(file);
+
+		if(!read_ok)
+		{
+			fprintf(stderr, "can't read %s\n", argv[index]);
+			return 1;
+		}
+
+		LLVMFuzzerTestOneInput(input.data(), input.size());
+	}
+
+	printf("%d inputs ok\n", argc - 1);
+	return 0;
+}
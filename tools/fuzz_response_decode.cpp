@@ -0,0 +1,78 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// Fuzzes decode_response() (psvr2_decode.h) with arbitrary messages. The first input byte picks the
+// response type we asked for, the rest is the message exactly as it would have come off the wire.
+// Anything the decoder accepts must be safe to read as a Response, which UBSan's bool and enum checks
+// catch if it isn't.
+
+#include "psvr2_decode.h"
+#include "gaze_deduplicator.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace BVR;
+
+#define FUZZ_CHECK(condition) do { if(!(condition)) { fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #condition); abort(); } } while(0)
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+	if(size < 1)
+	{
+		return 0;
+	}
+
+	const ResponseType expected_type = (ResponseType)(data[0] % 3);
+	const uint8_t* message = data + 1;
+	const size_t message_size = size - 1;
+
+	// Received the way the tracker does it, straight into the struct and truncated to its size
+	SequencedResponse response;
+	memcpy((void*)&response, message, (message_size < sizeof(response)) ? message_size : sizeof(response));
+
+	bool has_sequence_number = false;
+	const ResponseDecodeResult result = decode_response(response, message_size, expected_type, has_sequence_number);
+
+	if(result != ResponseDecodeResult::OK_)
+	{
+		ResponseDecodeStats stats;
+		stats.count(result);
+		FUZZ_CHECK((stats.get_malformed() + stats.unexpected_type_.load()) == 1);
+		return 0;
+	}
+
+	FUZZ_CHECK((message_size == sizeof(Response)) || (message_size == sizeof(SequencedResponse)));
+	FUZZ_CHECK(has_sequence_number == (message_size == sizeof(SequencedResponse)));
+	FUZZ_CHECK(response.type_ == expected_type);
+
+	// Reads every bool the decoder vouched for
+	volatile uint64_t hash = hash_gaze_states(response.gazes_);
+	(void)hash;
+
+	return 0;
+}
@@ -0,0 +1,250 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// Fuzzes PSVR2EyeTracker's connection and update_gazes() state transitions. The input is a script:
+// each byte picks an operation (connect, update, disconnect, settings changes, gaze reads), and the
+// transport answers every request with bytes taken from the same input -- a receive failure, a well
+// formed Response or SequencedResponse with arbitrary gazes, or a raw message of any size.
+//
+// After every step the tracker must hold exactly the slot of its newest sample, and every gaze it reports
+// as valid must be finite and unit length.
+
+#include "psvr2_eye_tracking.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace BVR;
+
+#define FUZZ_CHECK(condition) do { if(!(condition)) { fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #condition); abort(); } } while(0)
+
+#define FUZZ_MAX_STEPS 4096
+
+struct FuzzInput
+{
+	const uint8_t* data_ = nullptr;
+	size_t size_ = 0;
+	size_t position_ = 0;
+
+	bool is_empty() const { return position_ >= size_; }
+
+	// Zeros once the input runs out
+	uint8_t next_byte()
+	{
+		return is_empty() ? 0 : data_[position_++];
+	}
+
+	void next_bytes(void* destination, const size_t size)
+	{
+		uint8_t* bytes = (uint8_t*)destination;
+
+		for(size_t index = 0; index < size; index++)
+		{
+			bytes[index] = next_byte();
+		}
+	}
+};
+
+class FuzzTransport : public PSVR2Transport
+{
+public:
+	explicit FuzzTransport(FuzzInput& input) : input_(input) {}
+
+	bool open(const char* endpoint) override
+	{
+		is_open_ = (input_.next_byte() & 1) == 0;
+		return is_open_;
+	}
+
+	void close() override { is_open_ = false; }
+	bool is_open() const override { return is_open_; }
+
+	bool send(const void* data, const size_t size) override
+	{
+		return is_open_;
+	}
+
+	bool receive(void* data, const size_t capacity, size_t& size_read) override
+	{
+		if(!is_open_)
+		{
+			return false;
+		}
+
+		switch(input_.next_byte() % 4)
+		{
+		case 1:
+			return receive_well_formed(data, capacity, sizeof(SequencedResponse), size_read);
+		case 2:
+			return receive_well_formed(data, capacity, sizeof(Response), size_read);
+		case 3:
+			return receive_raw(data, capacity, size_read);
+		default:
+			return false;
+		}
+	}
+
+private:
+	// Valid enum and bools, so the fuzzer reaches the states behind a successful decode easily
+	bool receive_well_formed(void* data, const size_t capacity, const size_t message_size, size_t& size_read)
+	{
+		SequencedResponse response;
+		input_.next_bytes(&response.sequence_number_, sizeof(response.sequence_number_));
+
+		response.type_ = (ResponseType)(input_.next_byte() % 3);
+
+		XRGazeState* gazes[] = { &response.gazes_.combined_gaze_, &response.gazes_.per_eye_gazes_[LEFT], &response.gazes_.per_eye_gazes_[RIGHT] };
+
+		for(XRGazeState* gaze : gazes)
+		{
+			input_.next_bytes(&gaze->direction_, sizeof(gaze->direction_));
+			gaze->is_valid_ = (input_.next_byte() & 1) != 0;
+		}
+
+		memcpy(data, &response, (message_size < capacity) ? message_size : capacity);
+		size_read = message_size;
+
+		return true;
+	}
+
+	bool receive_raw(void* data, const size_t capacity, size_t& size_read)
+	{
+		const size_t message_size = input_.next_byte();
+
+		if(message_size == 0)
+		{
+			return false;
+		}
+
+		uint8_t message[256];
+		input_.next_bytes(message, message_size);
+
+		memcpy(data, message, (message_size < capacity) ? message_size : capacity);
+		size_read = (message_size <= capacity) ? message_size : (capacity + 1);
+
+		return true;
+	}
+
+	FuzzInput& input_;
+	bool is_open_ = false;
+};
+
+static void check_gaze(const XRGazeState& gaze)
+{
+	if(!gaze.is_valid_)
+	{
+		return;
+	}
+
+	const XrVector3f& direction = gaze.direction_;
+	const float length = sqrtf(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+
+	FUZZ_CHECK(isfinite(length));
+	FUZZ_CHECK(fabsf(length - 1.0f) < 0.001f);
+}
+
+static void check_tracker(const PSVR2EyeTracker& tracker)
+{
+	// Every slot is either free or the tracker's newest sample, never leaked
+	uint32_t num_held = 0;
+
+	if(tracker.get_current_slot() != GAZE_SLOT_INVALID)
+	{
+		FUZZ_CHECK(tracker.get_current_slot() < GAZE_SLOT_POOL_SIZE);
+		num_held++;
+	}
+
+	FUZZ_CHECK(tracker.get_slot_pool().get_num_free_slots() + num_held == GAZE_SLOT_POOL_SIZE);
+
+	// Calibration maps gazes through the fitted correction, only the raw pipeline promises unit vectors
+	if(!tracker.is_applying_calibration())
+	{
+		const GazeFrame& frame = tracker.get_gaze_frame();
+		check_gaze(frame.combined_gaze_);
+		check_gaze(frame.per_eye_gazes_[LEFT]);
+		check_gaze(frame.per_eye_gazes_[RIGHT]);
+	}
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+	FuzzInput input;
+	input.data_ = data;
+	input.size_ = size;
+
+	PSVR2EyeTracker tracker{ std::unique_ptr<PSVR2Transport>(new FuzzTransport(input)) };
+
+	for(int step = 0; (step < FUZZ_MAX_STEPS) && !input.is_empty(); step++)
+	{
+		const uint8_t operation = input.next_byte();
+
+		switch(operation % 8)
+		{
+		case 0:
+			tracker.connect();
+			break;
+		case 1:
+		{
+			const bool was_connected = tracker.is_connected();
+			const bool is_updated = tracker.update_gazes();
+
+			FUZZ_CHECK(was_connected || !is_updated);
+			FUZZ_CHECK(is_updated || !tracker.is_new_sample());
+			break;
+		}
+		case 2:
+			tracker.disconnect();
+			FUZZ_CHECK(!tracker.is_connected());
+			break;
+		case 3:
+			tracker.set_gazes_enabled((operation & 0x10) != 0, (operation & 0x20) != 0);
+			break;
+		case 4:
+			tracker.set_apply_calibration((operation & 0x10) != 0);
+			break;
+		case 5:
+			tracker.set_median_filter((operation & 0x10) != 0);
+			break;
+		case 6:
+		{
+			XrVector3f direction;
+			tracker.get_combined_gaze(direction);
+			tracker.get_per_eye_gaze(LEFT, direction);
+			tracker.get_per_eye_gaze(RIGHT, direction);
+			break;
+		}
+		default:
+			tracker.set_pipeline_flags((operation >> 4) & 7);
+			break;
+		}
+
+		check_tracker(tracker);
+	}
+
+	return 0;
+}
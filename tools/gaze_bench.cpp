@@ -0,0 +1,1504 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// Benchmarks of the eye tracking hot path, run against the in-process server simulator so they need
+// neither a headset nor SteamVR. Micro benchmarks time one operation at a time, the macro benchmark runs
+// the real update loop on the real clock and measures how old samples are when they get published.
+//
+// Columns:
+//
+//   ns/op         mean time per operation, timed over the whole run
+//   p50/p99/p99.9 per operation latency, from a second run timing every operation on its own (includes the
+//                 cost of reading the clock, see the timer_overhead line)
+//   allocs/op     heap allocations per operation on the benchmark thread
+//
+// publish_latency_realtime is the macro benchmark: there an operation is one publish, and the latency
+// columns are the age of each new sample when it was published.
+//
+// usage: gaze_bench [--iterations N] [--duration SECONDS] [--filter SUBSTRING] [--json FILE] [--trace FILE]
+//                   [--telemetry NAME] [--broadcast NAME]
+//
+// --json writes the same numbers as a JSON document, for tracking them across commits. --trace dumps the
+// trace ring (see Tracing.h) at the end. --telemetry publishes the realtime loop's telemetry block under
+// NAME (GAZE_TELEMETRY_SHM_NAME is what gaze_telemetry_reader looks for by default), --broadcast re-serves
+// its samples through a broadcast ring (GAZE_BROADCAST_SHM_NAME for gaze_telemetry_reader --broadcast 1).
+//
+// Only measures: whether the measured code is right, and stays off the heap, is up to the tests in tools/tests.
+
+#include "alloc_counter.h"
+#include "gaze_batch.h"
+#include "gaze_broadcast.h"
+#include "gaze_calibration.h"
+#include "gaze_calibration_session.h"
+#include "gaze_debug_request.h"
+#include "gaze_debug_stats.h"
+#include "gaze_deduplicator.h"
+#include "gaze_flight_recorder.h"
+#include "gaze_math.h"
+#include "gaze_pipeline.h"
+#include "gaze_poll_scheduler.h"
+#include "gaze_quality.h"
+#include "gaze_reactor.h"
+#include "gaze_replay.h"
+#include "gaze_sanitizer.h"
+#include "gaze_source.h"
+#include "gaze_synthesizer.h"
+#include "gaze_telemetry.h"
+#include "gaze_thread_policy.h"
+#include "gaze_update_loop.h"
+#include "loopback_server.h"
+#include "psvr2_eye_tracking.h"
+#include "psvr2_server_simulator.h"
+#include "Tracing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace BVR;
+
+#define BENCH_DEFAULT_ITERATIONS 200000
+#define BENCH_DEFAULT_DURATION_SECONDS 2.0
+#define BENCH_NUM_SAMPLES 1024 // Distinct gaze samples cycled through, so nothing is constant-folded
+#define BENCH_BATCH_SIZE 64    // Gazes per operation of the batch kernels
+
+struct BenchResult
+{
+	std::string name_;
+	uint64_t ops_ = 0;
+	double ns_per_op_ = 0.0;
+	double p50_ns_ = 0.0;
+	double p99_ns_ = 0.0;
+	double p999_ns_ = 0.0;
+	double allocs_per_op_ = 0.0;
+};
+
+struct BenchOptions
+{
+	int iterations_ = BENCH_DEFAULT_ITERATIONS;
+	double duration_seconds_ = BENCH_DEFAULT_DURATION_SECONDS;
+	const char* filter_ = nullptr;
+	const char* json_path_ = nullptr;
+	const char* trace_path_ = nullptr;
+	const char* telemetry_name_ = nullptr;
+	const char* broadcast_name_ = nullptr;
+};
+
+// Keeps results alive without the compiler proving they're unused.
+static volatile float g_sink = 0.0f;
+
+static BenchOptions g_options;
+static std::vector<BenchResult> g_results;
+
+static bool is_selected(const char* name)
+{
+	return !g_options.filter_ || strstr(name, g_options.filter_);
+}
+
+static int64_t get_time_ns()
+{
+	return (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Sorts in place.
+static double get_percentile(std::vector<int64_t>& values, const size_t count, const double percentile)
+{
+	if(count == 0)
+	{
+		return 0.0;
+	}
+
+	std::sort(values.begin(), values.begin() + count);
+
+	const size_t index = std::min(count - 1, (size_t)(percentile / 100.0 * (double)count));
+	return (double)values[index];
+}
+
+static void report(const BenchResult& result)
+{
+	printf("%-34s %9.1f ns/op %9.0f p50 %9.0f p99 %9.0f p99.9 %7.2f allocs/op %10llu ops\n",
+		result.name_.c_str(), result.ns_per_op_, result.p50_ns_, result.p99_ns_, result.p999_ns_,
+		result.allocs_per_op_, (unsigned long long)result.ops_);
+
+	g_results.push_back(result);
+}
+
+template<typename Function>
+static void run_bench(const char* name, Function function)
+{
+	if(!is_selected(name))
+	{
+		return;
+	}
+
+	const int iterations = g_options.iterations_;
+
+	// Allocated up front, the timed loops must not allocate on our behalf
+	std::vector<int64_t> latencies_ns(iterations);
+
+	// Warm up caches and branch predictors first. The index keeps counting up across all passes,
+	// benchmarks feeding it as a sequence number rely on that.
+	const int warmup_iterations = iterations / 10;
+	int index = 0;
+
+	for(; index < warmup_iterations; index++)
+	{
+		function(index);
+	}
+
+	// Throughput, and allocations
+	const AllocationScope allocations;
+	const int64_t start_ns = get_time_ns();
+
+	for(int iteration = 0; iteration < iterations; iteration++, index++)
+	{
+		function(index);
+	}
+
+	const int64_t end_ns = get_time_ns();
+	const uint64_t allocation_count = allocations.get_allocations();
+
+	// Latency distribution
+	for(int iteration = 0; iteration < iterations; iteration++, index++)
+	{
+		const int64_t op_start_ns = get_time_ns();
+		function(index);
+		latencies_ns[iteration] = get_time_ns() - op_start_ns;
+	}
+
+	BenchResult result;
+	result.name_ = name;
+	result.ops_ = iterations;
+	result.ns_per_op_ = (double)(end_ns - start_ns) / iterations;
+	result.p50_ns_ = get_percentile(latencies_ns, iterations, 50.0);
+	result.p99_ns_ = get_percentile(latencies_ns, iterations, 99.0);
+	result.p999_ns_ = get_percentile(latencies_ns, iterations, 99.9);
+	result.allocs_per_op_ = (double)allocation_count / iterations;
+
+	report(result);
+}
+
+static std::vector<AllXRGazeStates> make_samples()
+{
+	std::vector<AllXRGazeStates> samples(BENCH_NUM_SAMPLES);
+
+	for(int index = 0; index < BENCH_NUM_SAMPLES; index++)
+	{
+		const float angle = (float)index * 0.01f;
+
+		AllXRGazeStates& sample = samples[index];
+		sample.combined_gaze_.direction_ = { sinf(angle) * 0.2f, cosf(angle) * 0.1f, -1.0f };
+		sample.combined_gaze_.is_valid_ = (index % 61) != 0; // The occasional blink
+		sample.per_eye_gazes_[LEFT] = sample.combined_gaze_;
+		sample.per_eye_gazes_[RIGHT] = sample.combined_gaze_;
+		sample.per_eye_gazes_[LEFT].direction_.x -= 0.03f;
+		sample.per_eye_gazes_[RIGHT].direction_.x += 0.03f;
+	}
+
+	return samples;
+}
+
+static void bench_timer()
+{
+	run_bench("timer_overhead", [](const int index)
+	{
+		g_sink = g_sink + (float)index;
+	});
+}
+
+static void bench_tracker_simulated()
+{
+	// A 1 kHz poll of a 120 Hz server, on a virtual clock
+	PSVR2ServerSimulatorSettings settings;
+	settings.sample_rate_hz_ = 120.0;
+	PSVR2ServerSimulator simulator(settings);
+
+	PSVR2SimulatedTransport* transport = new PSVR2SimulatedTransport(simulator);
+	PSVR2EyeTracker tracker{ std::unique_ptr<PSVR2Transport>(transport) };
+
+	int64_t now_us = 0;
+	transport->set_now_us(now_us);
+
+	if(!tracker.connect())
+	{
+		fprintf(stderr, "tracker_update_simulated: handshake with the simulator failed\n");
+		return;
+	}
+
+	run_bench("tracker_update_simulated", [&](const int)
+	{
+		now_us += 1000;
+		transport->set_now_us(now_us);
+
+		XrVector3f gaze;
+
+		if(tracker.update_gazes() && tracker.get_combined_gaze(gaze))
+		{
+			g_sink = g_sink + gaze.x;
+		}
+	});
+}
+
+static void bench_tracker_ipc()
+{
+#ifdef _WIN32
+	const char* name = "tracker_update_named_pipe";
+#else
+	const char* name = "tracker_update_unix_socket";
+#endif
+
+	if(!is_selected(name))
+	{
+		return;
+	}
+
+	// Round trips through the kernel to a server thread, with the server producing samples much faster
+	// than we poll so most requests return something new
+	PSVR2ServerSimulatorSettings settings;
+	settings.sample_rate_hz_ = 100000.0;
+	PSVR2ServerSimulator simulator(settings);
+
+	const std::string endpoint = get_loopback_endpoint_name();
+	LoopbackServer server;
+
+	if(!server.start(endpoint.c_str(), simulator))
+	{
+		fprintf(stderr, "%s: couldn't start the loopback server\n", name);
+		return;
+	}
+
+	PSVR2EyeTracker tracker;
+	tracker.set_server_pipe_name(endpoint.c_str());
+
+	if(!tracker.connect())
+	{
+		fprintf(stderr, "%s: couldn't connect to the loopback server\n", name);
+		server.stop();
+		return;
+	}
+
+	run_bench(name, [&](const int)
+	{
+		tracker.update_gazes();
+	});
+
+	tracker.disconnect();
+	server.stop();
+}
+
+static void bench_pipelines(const std::vector<AllXRGazeStates>& samples)
+{
+	static const char* names[8] =
+	{
+		"pipeline_empty", "pipeline_combined", "pipeline_per_eye", "pipeline_all",
+		"pipeline_calibrated_empty", "pipeline_calibrated_combined", "pipeline_calibrated_per_eye", "pipeline_calibrated_all",
+	};
+
+	GazeCalibration calibrations[NUM_CALIBRATIONS];
+	const float matrix[9] = { 1.02f, 0.01f, 0.0f, -0.01f, 0.98f, 0.02f, 0.0f, 0.0f, 1.0f };
+
+	for(GazeCalibration& calibration : calibrations)
+	{
+		calibration.set_matrix(matrix);
+	}
+
+	GazeSanitizer sanitizer;
+	const GazePipelineContext context = { calibrations, &sanitizer };
+
+	for(uint32_t flags = 0; flags < 8; flags++)
+	{
+		const GazePipelineFunction pipeline = select_gaze_pipeline(flags);
+		GazeFrame frame;
+
+		run_bench(names[flags], [&](const int index)
+		{
+			pipeline(samples[index % BENCH_NUM_SAMPLES], context, frame);
+			g_sink = g_sink + frame.combined_gaze_.direction_.x + frame.per_eye_gazes_[LEFT].direction_.x;
+		});
+	}
+}
+
+static void bench_deduplicator(const std::vector<AllXRGazeStates>& samples)
+{
+	GazeDeduplicator sequenced;
+
+	run_bench("dedup_sequence_number", [&](const int index)
+	{
+		// Every sample shows up twice, like a 2x oversampling poll
+		g_sink = g_sink + (float)(sequenced.classify(samples[(index / 2) % BENCH_NUM_SAMPLES], true, (uint64_t)(index / 2) + 1) == GazeSampleVerdict::NEW_);
+	});
+
+	GazeDeduplicator hashed;
+
+	run_bench("dedup_content_hash", [&](const int index)
+	{
+		g_sink = g_sink + (float)(hashed.classify(samples[(index / 2) % BENCH_NUM_SAMPLES], false, 0) == GazeSampleVerdict::NEW_);
+	});
+}
+
+static void bench_calibration(const std::vector<AllXRGazeStates>& samples)
+{
+	GazeCalibration calibration;
+	const float matrix[9] = { 1.02f, 0.01f, 0.0f, -0.01f, 0.98f, 0.02f, 0.0f, 0.0f, 1.0f };
+	calibration.set_matrix(matrix);
+
+	run_bench("calibration_apply", [&](const int index)
+	{
+		const XrVector3f corrected = calibration.apply_calibration(samples[index % BENCH_NUM_SAMPLES].combined_gaze_.direction_);
+		g_sink = g_sink + corrected.x;
+	});
+}
+
+static void bench_tracing()
+{
+#if TRACE_LEVEL >= TRACE_LEVEL_LIFECYCLE
+	TraceLocalActivity(local);
+
+	run_bench("trace_ring_write", [&](const int index)
+	{
+		TraceLoggingWriteTagged(local, "GazeBench_Event", TLArg(index, "Index"), TLArg("text", "Text"));
+	});
+#endif
+
+#if TRACE_LEVEL >= TRACE_LEVEL_SUMMARY
+	TraceSummaryDeclare(summary);
+	int64_t now_us = 0;
+
+	run_bench("trace_summary_add", [&](const int index)
+	{
+		now_us += 1000;
+		TraceSummaryAdd(summary, index & 0xff);
+		TraceSummaryFlush(local, "GazeBench_Summary", summary, now_us);
+	});
+#endif
+}
+
+static void bench_math(const std::vector<AllXRGazeStates>& samples)
+{
+	const GazeQuaternion rotation = gaze_quaternion_from_yaw_pitch(0.1f, -0.05f);
+
+	run_bench("math_quaternion_rotate", [&](const int index)
+	{
+		const GazeVector rotated = gaze_quaternion_rotate(rotation, gaze_vector_load(samples[index % BENCH_NUM_SAMPLES].combined_gaze_.direction_));
+		g_sink = g_sink + gaze_vector_get_x(rotated);
+	});
+}
+
+static void bench_batch(const std::vector<AllXRGazeStates>& samples)
+{
+	const float matrix[9] = { 1.02f, 0.01f, 0.0f, -0.01f, 0.98f, 0.02f, 0.0f, 0.0f, 1.0f };
+
+	GazeBatch source_left;
+	GazeBatch source_right;
+
+	for(const AllXRGazeStates& sample : samples)
+	{
+		source_left.push_back(sample.per_eye_gazes_[LEFT]);
+		source_right.push_back(sample.per_eye_gazes_[RIGHT]);
+	}
+
+	// The angle is measured between normalized gazes
+	GazeBatch normalized_right = source_right;
+	gaze_batch_reject_invalid(normalized_right, GazeSimdBackend::SCALAR_);
+	gaze_batch_normalize(normalized_right, GazeSimdBackend::SCALAR_);
+
+	std::vector<float> radians(BENCH_BATCH_SIZE);
+
+	const GazeSimdBackend backends[] = { GazeSimdBackend::SCALAR_, GazeSimdBackend::SSE_, GazeSimdBackend::AVX2_ };
+
+	for(const GazeSimdBackend backend : backends)
+	{
+		if(!is_gaze_simd_backend_supported(backend))
+		{
+			continue;
+		}
+
+		const std::string suffix = get_gaze_simd_backend_name(backend);
+		const std::string reject_name = "batch_reject_invalid_" + suffix;
+		const std::string normalize_name = "batch_normalize_" + suffix;
+		const std::string calibration_name = "batch_apply_calibration_" + suffix;
+		const std::string distance_name = "batch_angular_distance_" + suffix;
+
+		// Throughput, one operation is one batch of BENCH_BATCH_SIZE gazes. The in place kernels start from a
+		// fresh copy every time, calibrating the same gazes over and over would end up in denormals.
+		GazeBatch input_left = source_left;
+		GazeBatch work_right = normalized_right;
+		input_left.resize(BENCH_BATCH_SIZE);
+		work_right.resize(BENCH_BATCH_SIZE);
+
+		GazeBatch work_left = input_left;
+
+		run_bench(reject_name.c_str(), [&](const int)
+		{
+			work_left = input_left;
+			gaze_batch_reject_invalid(work_left, backend);
+			g_sink = g_sink + work_left.x()[0];
+		});
+
+		run_bench(normalize_name.c_str(), [&](const int)
+		{
+			work_left = input_left;
+			gaze_batch_normalize(work_left, backend);
+			g_sink = g_sink + work_left.x()[0];
+		});
+
+		run_bench(calibration_name.c_str(), [&](const int)
+		{
+			work_left = input_left;
+			gaze_batch_apply_calibration(matrix, work_left, backend);
+			g_sink = g_sink + work_left.x()[0];
+		});
+
+		work_left = input_left;
+		gaze_batch_normalize(work_left, backend);
+
+		run_bench(distance_name.c_str(), [&](const int)
+		{
+			gaze_batch_angular_distance(work_left, work_right, radians.data(), backend);
+			g_sink = g_sink + radians[0];
+		});
+	}
+}
+
+// Publishes into a preallocated log, so recording doesn't disturb what's being measured.
+class RecordingPublisher : public GazePublisher
+{
+public:
+	RecordingPublisher(PSVR2ServerSimulator& simulator, const size_t capacity) : simulator_(simulator), sample_ages_ns_(capacity) {}
+
+	void publish(const GazeUpdate& update) override
+	{
+		if((update.new_samples_ > 0) && (count_ < sample_ages_ns_.size()))
+		{
+			const int64_t age_ns = get_time_ns() - simulator_.get_latest_sample_time_us() * 1000;
+			sample_ages_ns_[count_++] = age_ns;
+		}
+	}
+
+	PSVR2ServerSimulator& simulator_;
+	std::vector<int64_t> sample_ages_ns_;
+	size_t count_ = 0;
+};
+
+// Publishes nowhere, for loops whose cost is measured without what's done with the gazes.
+class NullPublisher : public GazePublisher
+{
+public:
+	void publish(const GazeUpdate&) override {}
+};
+
+// Takes what the debug endpoint asks to change and drops it.
+class NullSettingsWriter : public GazeSettingsWriter
+{
+public:
+	bool write_bool(const char*, const bool) override { return true; }
+	bool write_int(const char*, const int) override { return true; }
+	void commit() override {}
+};
+
+static void bench_debug_request()
+{
+	if(is_selected("latency_histogram_add"))
+	{
+		GazeLatencyHistogram histogram;
+
+		run_bench("latency_histogram_add", [&](const int index)
+		{
+			histogram.add(index & 0xfff);
+		});
+	}
+
+	const char* name = "debug_request_stats";
+
+	if(!is_selected(name))
+	{
+		return;
+	}
+
+	PSVR2ServerSimulatorSettings settings;
+	settings.sample_rate_hz_ = 120.0;
+	PSVR2ServerSimulator simulator(settings);
+
+	PSVR2SimulatedTransport* transport = new PSVR2SimulatedTransport(simulator);
+	PSVR2EyeTracker tracker{ std::unique_ptr<PSVR2Transport>(transport) };
+	GazeUpdateLoop loop(tracker);
+	NullPublisher publisher;
+
+	ShimConfigStore config_store;
+	ShimConfig config = config_store.get();
+	config.adaptive_polling_ = false;
+	config.polling_rate_ms_ = 1;
+	config_store.publish(config);
+
+	int64_t now_us = 0;
+	transport->set_now_us(now_us);
+	loop.start(config_store.get(), now_us);
+
+	for(int poll = 0; poll < 1000; poll++)
+	{
+		now_us += 1000;
+		transport->set_now_us(now_us);
+		loop.run_once(config_store.get(), now_us, publisher);
+		loop.get_loop_stats().poll_duration_us_.add(poll % 50);
+	}
+
+	NullSettingsWriter settings_writer;
+	GazeDebugSources sources;
+	sources.loop_ = &loop;
+	sources.config_store_ = &config_store;
+	sources.settings_writer_ = &settings_writer;
+
+	char response[4096];
+
+	run_bench(name, [&](const int)
+	{
+		handle_gaze_debug_request(GAZE_DEBUG_REQUEST_PREFIX " stats", response, sizeof(response), sources);
+		g_sink = g_sink + (float)response[0];
+	});
+}
+
+#ifdef _WIN32
+#define BENCH_TELEMETRY_SHM_NAME "Local\\PSVR2GazeBenchTelemetry"
+#else
+#define BENCH_TELEMETRY_SHM_NAME "/psvr2_gaze_bench_telemetry"
+#endif
+
+static void bench_telemetry()
+{
+	// The seqlock with a reader hammering it from another thread, the writer pays for the shared cache lines
+	if(is_selected("telemetry_seqlock_write"))
+	{
+		GazeTelemetryBlock* block = new GazeTelemetryBlock();
+		GazeTelemetrySnapshot snapshot = {};
+
+		std::atomic<bool> is_reading = true;
+
+		std::thread reader([&]()
+		{
+			GazeTelemetrySnapshot copy;
+
+			while(is_reading.load(std::memory_order_relaxed))
+			{
+				read_gaze_telemetry(*block, copy);
+			}
+		});
+
+		run_bench("telemetry_seqlock_write", [&](const int index)
+		{
+			snapshot.update_count_ = (uint64_t)index + 1;
+			snapshot.published_ = (uint64_t)index + 1;
+			write_gaze_telemetry(*block, snapshot);
+		});
+
+		is_reading = false;
+		reader.join();
+
+		delete block;
+	}
+
+	// The writer the driver runs, through real shared memory, fed by the update loop on a virtual clock
+	const char* name = "telemetry_record";
+
+	if(!is_selected(name))
+	{
+		return;
+	}
+
+	PSVR2ServerSimulatorSettings settings;
+	settings.sample_rate_hz_ = 120.0;
+	PSVR2ServerSimulator simulator(settings);
+
+	PSVR2SimulatedTransport* transport = new PSVR2SimulatedTransport(simulator);
+	PSVR2EyeTracker tracker{ std::unique_ptr<PSVR2Transport>(transport) };
+	GazeUpdateLoop loop(tracker);
+	NullPublisher publisher;
+
+	ShimConfig config;
+	config.adaptive_polling_ = false;
+	config.polling_rate_ms_ = 1;
+
+	GazeTelemetryWriter telemetry;
+
+	if(!telemetry.open(BENCH_TELEMETRY_SHM_NAME))
+	{
+		fprintf(stderr, "%s: couldn't create the telemetry block\n", name);
+		return;
+	}
+
+	int64_t now_us = 0;
+	transport->set_now_us(now_us);
+	loop.start(config, now_us);
+
+	run_bench(name, [&](const int)
+	{
+		now_us += 1000;
+		transport->set_now_us(now_us);
+		loop.run_once(config, now_us, publisher);
+		loop.get_loop_stats().wakeup_lateness_us_.add(now_us & 0x3f);
+		telemetry.record(loop, now_us);
+	});
+
+	telemetry.close();
+}
+
+#ifdef _WIN32
+#define BENCH_BROADCAST_SHM_NAME "Local\\PSVR2GazeBenchBroadcast"
+#else
+#define BENCH_BROADCAST_SHM_NAME "/psvr2_gaze_bench_broadcast"
+#endif
+
+static void bench_broadcast()
+{
+	// The ring with a consumer draining it from another thread
+	if(is_selected("broadcast_write"))
+	{
+		GazeBroadcastBlock* block = new GazeBroadcastBlock();
+		GazeBroadcastSample sample = {};
+
+		GazeBroadcastReader reader;
+		reader.attach(*block);
+
+		std::atomic<bool> is_reading = true;
+
+		std::thread consumer([&]()
+		{
+			GazeBroadcastSample copy;
+
+			while(is_reading.load(std::memory_order_relaxed))
+			{
+				while(reader.read(copy))
+				{
+				}
+			}
+		});
+
+		run_bench("broadcast_write", [&](const int index)
+		{
+			sample.sequence_number_ = (uint64_t)index + 1;
+			sample.new_samples_ = 1;
+			sample.poll_time_us_ = index + 1;
+			write_gaze_broadcast(*block, sample);
+		});
+
+		is_reading = false;
+		consumer.join();
+
+		delete block;
+	}
+
+	// Through real shared memory, fed by the update loop on a virtual clock, with a consumer keeping up
+	const char* name = "broadcast_record";
+
+	if(!is_selected(name))
+	{
+		return;
+	}
+
+	PSVR2ServerSimulatorSettings settings;
+	settings.sample_rate_hz_ = 120.0;
+	PSVR2ServerSimulator simulator(settings);
+
+	PSVR2SimulatedTransport* transport = new PSVR2SimulatedTransport(simulator);
+	PSVR2EyeTracker tracker{ std::unique_ptr<PSVR2Transport>(transport) };
+	GazeUpdateLoop loop(tracker);
+	NullPublisher publisher;
+
+	ShimConfig config;
+	config.adaptive_polling_ = false;
+	config.polling_rate_ms_ = 1;
+
+	GazeBroadcastWriter broadcast;
+	GazeBroadcastReader reader;
+
+	if(!broadcast.open(BENCH_BROADCAST_SHM_NAME) || !reader.open(BENCH_BROADCAST_SHM_NAME))
+	{
+		fprintf(stderr, "%s: couldn't create the broadcast ring\n", name);
+		return;
+	}
+
+	int64_t now_us = 0;
+	transport->set_now_us(now_us);
+	loop.start(config, now_us);
+
+	GazeBroadcastSample sample;
+
+	run_bench(name, [&](const int)
+	{
+		now_us += 1000;
+		transport->set_now_us(now_us);
+		loop.run_once(config, now_us, publisher);
+		broadcast.record(loop);
+
+		while(reader.read(sample))
+		{
+			g_sink = g_sink + (float)sample.new_samples_;
+		}
+	});
+
+	broadcast.close();
+}
+
+static void bench_flight_recorder()
+{
+	// The bare cost of a record, what every poll pays
+	if(is_selected("flight_record_event"))
+	{
+		GazeFlightRecorder* recorder = new GazeFlightRecorder();
+
+		run_bench("flight_record_event", [&](const int index)
+		{
+			recorder->record_event(GazeFlightRecordKind::SETTINGS_, index, (uint32_t)index);
+		});
+
+		delete recorder;
+	}
+
+	// Fed by the update loop on a virtual clock, like the driver does after every pass
+	const char* name = "flight_record";
+
+	if(!is_selected(name))
+	{
+		return;
+	}
+
+	PSVR2ServerSimulatorSettings settings;
+	settings.sample_rate_hz_ = 120.0;
+	PSVR2ServerSimulator simulator(settings);
+
+	PSVR2SimulatedTransport* transport = new PSVR2SimulatedTransport(simulator);
+	PSVR2EyeTracker tracker{ std::unique_ptr<PSVR2Transport>(transport) };
+	GazeUpdateLoop loop(tracker);
+	NullPublisher publisher;
+
+	ShimConfig config;
+	config.adaptive_polling_ = false;
+	config.polling_rate_ms_ = 1;
+
+	GazeFlightRecorder* recorder = new GazeFlightRecorder();
+
+	int64_t now_us = 0;
+	transport->set_now_us(now_us);
+	loop.start(config, now_us);
+
+	run_bench(name, [&](const int)
+	{
+		now_us += 1000;
+		transport->set_now_us(now_us);
+		loop.run_once(config, now_us, publisher);
+		loop.get_loop_stats().poll_duration_us_.add(now_us & 0x3f);
+		recorder->record(loop, now_us);
+	});
+
+	delete recorder;
+}
+
+// A 120 Hz stream with a known quality: fixations jittering by exactly BENCH_QUALITY_JITTER_DEG from one
+// sample to the next, a 10 degree saccade every BENCH_QUALITY_PERIOD samples and a dropout of
+// BENCH_QUALITY_DROPOUT samples in each period.
+#define BENCH_QUALITY_INTERVAL_US 8333
+#define BENCH_QUALITY_PERIOD 240
+#define BENCH_QUALITY_DROPOUT_START 100
+#define BENCH_QUALITY_DROPOUT 12
+#define BENCH_QUALITY_JITTER_DEG 0.5f
+
+static XRGazeState make_quality_sample(const int index)
+{
+	const float degrees_to_radians = 0.0174532925f;
+	const int period = index / BENCH_QUALITY_PERIOD;
+	const int position = index % BENCH_QUALITY_PERIOD;
+
+	const float yaw_deg = (float)((period % 3) * 10) + (((index & 1) != 0) ? 0.5f : -0.5f) * BENCH_QUALITY_JITTER_DEG;
+
+	XRGazeState gaze;
+	gaze.direction_ = gaze_vector_store(gaze_quaternion_rotate(gaze_quaternion_from_yaw_pitch(yaw_deg * degrees_to_radians, 0.0f), gaze_vector_forward()));
+	gaze.is_valid_ = (position < BENCH_QUALITY_DROPOUT_START) || (position >= BENCH_QUALITY_DROPOUT_START + BENCH_QUALITY_DROPOUT);
+
+	return gaze;
+}
+
+static void bench_quality()
+{
+	if(is_selected("quality_monitor"))
+	{
+		GazeQualityMonitor monitor;
+
+		run_bench("quality_monitor", [&](const int index)
+		{
+			const int64_t time_us = (int64_t)index * BENCH_QUALITY_INTERVAL_US;
+			monitor.add_sample(time_us, make_quality_sample(index));
+			monitor.update(time_us);
+		});
+	}
+
+	// At its strongest, the smoother resets on every dropout like the update loop does
+	if(is_selected("adaptive_smoothing"))
+	{
+		GazeSmoother smoother;
+
+		run_bench("adaptive_smoothing", [&](const int index)
+		{
+			const XRGazeState gaze = make_quality_sample(index);
+
+			if(!gaze.is_valid_)
+			{
+				smoother.reset();
+				return;
+			}
+
+			const XrVector3f smoothed = smoother.apply(gaze.direction_, GAZE_SMOOTHING_MIN_ALPHA);
+			g_sink = g_sink + smoothed.x;
+		});
+	}
+}
+
+// Deterministic and allocation free, for generating inputs inside timed loops.
+struct BenchRandom
+{
+	uint64_t state_ = 0x9e3779b97f4a7c15ull;
+
+	uint32_t next()
+	{
+		state_ ^= state_ << 13;
+		state_ ^= state_ >> 7;
+		state_ ^= state_ << 17;
+		return (uint32_t)(state_ >> 32);
+	}
+
+	// [0, 1)
+	float next_float() { return (float)(next() >> 8) / 16777216.0f; }
+};
+
+// What a misbehaving server might send: mostly a slowly wandering gaze, sometimes a little off unit length,
+// and now and then NaN, Inf, zero, huge, or a jump no eye could make.
+static XRGazeState make_hostile_gaze(BenchRandom& random, XrVector3f& wander)
+{
+	wander.x += (random.next_float() - 0.5f) * 0.01f;
+	wander.y += (random.next_float() - 0.5f) * 0.01f;
+	wander.x = std::max(-0.5f, std::min(0.5f, wander.x));
+	wander.y = std::max(-0.5f, std::min(0.5f, wander.y));
+
+	XRGazeState gaze;
+	gaze.direction_ = gaze_vector_store(gaze_vector_normalize3(gaze_vector_set(wander.x, wander.y, -1.0f, 0.0f)));
+	gaze.is_valid_ = (random.next() % 16) != 0;
+
+	const uint32_t kind = random.next() % 64;
+	const float infinity = std::numeric_limits<float>::infinity();
+
+	switch(kind)
+	{
+		case 0: gaze.direction_.x = std::numeric_limits<float>::quiet_NaN(); break;
+		case 1: gaze.direction_.y = infinity; break;
+		case 2: gaze.direction_.z = -infinity; break;
+		case 3: gaze.direction_ = { 0.0f, 0.0f, 0.0f }; break;
+		case 4: gaze.direction_ = { 1.0e30f, 1.0e30f, 1.0e30f }; break;
+		case 5: gaze.direction_ = { -gaze.direction_.x, -gaze.direction_.y, -gaze.direction_.z }; break; // Backwards
+		case 6: gaze.direction_ = { 1.0f, 0.0f, 0.0f }; break;                                        // 90 degrees off
+		default:
+		{
+			if(kind < 24)
+			{
+				// Not quite unit length
+				const float scale = 0.7f + random.next_float() * 0.8f;
+				gaze.direction_ = { gaze.direction_.x * scale, gaze.direction_.y * scale, gaze.direction_.z * scale };
+			}
+			break;
+		}
+	}
+
+	return gaze;
+}
+
+static void bench_sanitizer()
+{
+	const char* name = "sanitize";
+
+	if(!is_selected(name))
+	{
+		return;
+	}
+
+	// Cost per gaze, over a precomputed hostile stream
+	std::vector<XRGazeState> inputs(BENCH_NUM_SAMPLES);
+	BenchRandom random;
+	XrVector3f wander = { 0.0f, 0.0f, -1.0f };
+
+	for(XRGazeState& input : inputs)
+	{
+		input = make_hostile_gaze(random, wander);
+	}
+
+	GazeSanitizer sanitizer;
+	sanitizer.set_median_filter(true);
+
+	run_bench(name, [&](const int index)
+	{
+		const XRGazeState output = sanitizer.sanitize(COMBINED_CALIBRATION_INDEX, inputs[index % BENCH_NUM_SAMPLES], 1);
+		g_sink = g_sink + output.direction_.x;
+	});
+}
+
+static void bench_synthesizer()
+{
+	const char* name = "synthesize";
+
+	if(!is_selected(name))
+	{
+		return;
+	}
+
+	GazeSynthesizer synthesizer;
+
+	run_bench(name, [&](const int)
+	{
+		AllXRGazeStates gazes;
+		synthesizer.next(gazes);
+		g_sink = g_sink + gazes.combined_gaze_.direction_.x;
+	});
+}
+
+static void bench_thread_policy()
+{
+	const char* name = "thread_policy";
+
+	if(!is_selected(name))
+	{
+		return;
+	}
+
+	// On a thread of its own, like the update thread it brackets the polls of
+	std::thread worker([&]()
+	{
+		GazeThreadPolicy policy;
+
+		// Bracketing a poll costs a few clock reads, every poll pays it
+		run_bench(name, [&](const int)
+		{
+			policy.begin_poll();
+			policy.end_poll(0);
+		});
+	});
+
+	worker.join();
+}
+
+#ifdef _WIN32
+#define BENCH_FLIGHT_DIRECTORY_PARENT getenv("TEMP")
+#define BENCH_FLIGHT_SEPARATOR "\\"
+#else
+#define BENCH_FLIGHT_DIRECTORY_PARENT "/tmp"
+#define BENCH_FLIGHT_SEPARATOR "/"
+#endif
+
+static void bench_gaze_sources()
+{
+	const char* name = "gaze_source_replay_poll";
+
+	if(!is_selected(name))
+	{
+		return;
+	}
+
+	// Something to replay: a few seconds of the simulator on a virtual clock, kept by the flight recorder
+	const char* parent = BENCH_FLIGHT_DIRECTORY_PARENT;
+	const std::string directory = std::string(parent ? parent : ".") + BENCH_FLIGHT_SEPARATOR + "psvr2_gaze_bench_flight";
+	const std::string path = directory + BENCH_FLIGHT_SEPARATOR + "source.psfr";
+
+	{
+		PSVR2ServerSimulatorSettings settings;
+		settings.sample_rate_hz_ = 120.0;
+		PSVR2ServerSimulator simulator(settings);
+
+		PSVR2SimulatedTransport* transport = new PSVR2SimulatedTransport(simulator);
+		PSVR2EyeTracker tracker{ std::unique_ptr<PSVR2Transport>(transport) };
+		GazeUpdateLoop loop(tracker);
+		NullPublisher publisher;
+
+		ShimConfig config;
+		config.adaptive_polling_ = false;
+		config.polling_rate_ms_ = 1;
+
+		GazeFlightRecorder* recorder = new GazeFlightRecorder();
+		recorder->set_dump_directory(directory.c_str());
+
+		int64_t now_us = 0;
+		transport->set_now_us(now_us);
+		loop.start(config, now_us);
+
+		for(int poll = 0; poll < 4000; poll++)
+		{
+			now_us += 1000;
+			transport->set_now_us(now_us);
+			loop.run_once(config, now_us, publisher);
+			recorder->record(loop, now_us);
+		}
+
+		const bool is_dumped = recorder->dump(GazeFlightDumpReason::REQUEST_, path.c_str());
+		delete recorder;
+
+		if(!is_dumped)
+		{
+			fprintf(stderr, "%s: couldn't record a replay\n", name);
+			return;
+		}
+	}
+
+	// What a poll costs on the replay source, through the tracker
+	GazeReplayTransport* replay = new GazeReplayTransport();
+	PSVR2EyeTracker replay_tracker{ std::unique_ptr<PSVR2Transport>(replay) };
+	replay_tracker.set_server_pipe_name(path.c_str());
+	replay->set_now_us(0);
+
+	if(replay_tracker.connect())
+	{
+		run_bench(name, [&](const int index)
+		{
+			replay->set_now_us((int64_t)index * 1000);
+			replay_tracker.update_gazes();
+			g_sink = g_sink + replay_tracker.get_gaze_frame().combined_gaze_.direction_.x;
+		});
+	}
+	else
+	{
+		fprintf(stderr, "%s: tracker couldn't open the replay\n", name);
+	}
+
+	remove(path.c_str());
+}
+
+#ifdef _WIN32
+#define BENCH_SOCIAL_SHM_NAME "Local\\PSVR2GazeBenchSocial"
+#else
+#define BENCH_SOCIAL_SHM_NAME "/psvr2_gaze_bench_social"
+#endif
+
+static void bench_social_gazes()
+{
+	const char* name = "social_gazes";
+
+	if(!is_selected(name))
+	{
+		return;
+	}
+
+	// A pass of the loop with social gazes on and the telemetry that carries them
+	PSVR2ServerSimulatorSettings settings;
+	settings.sample_rate_hz_ = 120.0;
+	settings.synthesize_eye_movements_ = true;
+	PSVR2ServerSimulator simulator(settings);
+
+	PSVR2SimulatedTransport* transport = new PSVR2SimulatedTransport(simulator);
+	PSVR2EyeTracker tracker{ std::unique_ptr<PSVR2Transport>(transport) };
+	GazeUpdateLoop loop(tracker);
+	NullPublisher publisher;
+
+	ShimConfig config;
+	config.adaptive_polling_ = false;
+	config.polling_rate_ms_ = 1;
+	config.per_eye_gazes_ = false;
+	config.social_gazes_ = true;
+
+	GazeTelemetryWriter telemetry;
+
+	if(!telemetry.open(BENCH_SOCIAL_SHM_NAME))
+	{
+		fprintf(stderr, "%s: couldn't create the telemetry block\n", name);
+		return;
+	}
+
+	int64_t now_us = 0;
+	transport->set_now_us(now_us);
+	loop.start(config, now_us);
+	loop.set_ipd_meters(0.07f);
+
+	run_bench(name, [&](const int)
+	{
+		now_us += 1000;
+		transport->set_now_us(now_us);
+		loop.run_once(config, now_us, publisher);
+		telemetry.record(loop, now_us);
+	});
+
+	telemetry.close();
+}
+
+static void bench_calibration_session()
+{
+	const char* name = "calibration_session_add_sample";
+
+	if(!is_selected(name))
+	{
+		return;
+	}
+
+	// What the update thread pays per new sample during a session, the session thread draining every 64
+	GazeCalibrationSession session;
+	session.start(false, true);
+	session.process(0);
+
+	AllXRGazeStates gazes;
+	gazes.combined_gaze_.direction_ = { 0.0f, 0.0f, -1.0f };
+	gazes.combined_gaze_.is_valid_ = true;
+
+	run_bench(name, [&](const int index)
+	{
+		session.add_sample(index, gazes);
+
+		if((index & 63) == 63)
+		{
+			session.process(index);
+		}
+	});
+}
+
+static void bench_gaze_reactor()
+{
+	const char* name = "gaze_reactor_attach";
+
+	if(!is_selected(name))
+	{
+		return;
+	}
+
+	// The simulated source on a fixed 1 ms cadence, nothing leaving the process
+	ShimConfigStore config_store;
+	{
+		ShimConfig config;
+		config.gaze_source_ = (int)GazeSourceType::SIMULATED_;
+		config.adaptive_polling_ = false;
+		config.polling_rate_ms_ = 1;
+		config.telemetry_enabled_ = false;
+		config.broadcast_enabled_ = false;
+		config.generation_++;
+		config_store.publish(config);
+	}
+
+	GazeReactor reactor(config_store);
+	NullPublisher running;
+	NullPublisher activating;
+
+	// What a device activating next to a running reactor costs, the reactor thread polling meanwhile
+	reactor.attach(running);
+
+	run_bench(name, [&](const int)
+	{
+		reactor.attach(activating);
+		reactor.detach(activating);
+	});
+
+	reactor.detach(running);
+}
+
+static void bench_update_loop()
+{
+	// The loop on a virtual clock: one run_once per millisecond of simulated time
+	if(is_selected("update_loop_virtual_clock"))
+	{
+		PSVR2ServerSimulatorSettings settings;
+		settings.sample_rate_hz_ = 120.0;
+		PSVR2ServerSimulator simulator(settings);
+
+		PSVR2SimulatedTransport* transport = new PSVR2SimulatedTransport(simulator);
+		PSVR2EyeTracker tracker{ std::unique_ptr<PSVR2Transport>(transport) };
+		GazeUpdateLoop loop(tracker);
+		NullPublisher publisher;
+
+		ShimConfig config;
+		config.adaptive_polling_ = false;
+		config.polling_rate_ms_ = 1;
+
+		int64_t now_us = 0;
+		transport->set_now_us(now_us);
+		loop.start(config, now_us);
+
+		run_bench("update_loop_virtual_clock", [&](const int)
+		{
+			now_us += 1000;
+			transport->set_now_us(now_us);
+			loop.run_once(config, now_us, publisher);
+		});
+	}
+
+	// The same over real IPC. The first pass applies the settings and connects, which may allocate, the
+	// warmup takes care of it.
+#ifdef _WIN32
+	const char* ipc_name = "update_loop_named_pipe";
+#else
+	const char* ipc_name = "update_loop_unix_socket";
+#endif
+
+	if(is_selected(ipc_name))
+	{
+		PSVR2ServerSimulatorSettings settings;
+		settings.sample_rate_hz_ = 100000.0;
+		PSVR2ServerSimulator simulator(settings);
+
+		const std::string endpoint = get_loopback_endpoint_name();
+		LoopbackServer server;
+
+		if(!server.start(endpoint.c_str(), simulator))
+		{
+			fprintf(stderr, "%s: couldn't start the loopback server\n", ipc_name);
+			return;
+		}
+
+		PSVR2EyeTracker tracker;
+		GazeUpdateLoop loop(tracker);
+		NullPublisher publisher;
+
+		ShimConfig config;
+		config.adaptive_polling_ = false;
+		config.set_server_pipe_name(endpoint.c_str());
+
+		int64_t now_us = 0;
+		loop.start(config, now_us);
+
+		run_bench(ipc_name, [&](const int)
+		{
+			now_us += 5000;
+			loop.run_once(config, now_us, publisher);
+		});
+
+		tracker.disconnect();
+		server.stop();
+	}
+
+	// The real thing: the loop waiting on the real clock for a 120 Hz server, adaptive polling on.
+	// Reports how old each new sample is by the time it reaches the publisher.
+	const char* name = "publish_latency_realtime";
+
+	if(!is_selected(name))
+	{
+		return;
+	}
+
+	PSVR2ServerSimulatorSettings settings;
+	settings.sample_rate_hz_ = 120.0;
+	settings.phase_us_ = get_steady_time_us() % 8333;
+	PSVR2ServerSimulator simulator(settings);
+
+	PSVR2EyeTracker tracker{ std::unique_ptr<PSVR2Transport>(new PSVR2SimulatedTransport(simulator)) };
+	GazeUpdateLoop loop(tracker);
+	GazePollWaiter waiter;
+
+	const double duration_seconds = g_options.duration_seconds_;
+	RecordingPublisher publisher(simulator, (size_t)(duration_seconds * settings.sample_rate_hz_ * 2) + 16);
+
+	const ShimConfig config;
+	const int64_t start_us = get_steady_time_us();
+	const int64_t warmup_end_us = start_us + 1000000; // Lock on to the cadence first
+	const int64_t end_us = warmup_end_us + (int64_t)(duration_seconds * 1e6);
+
+	loop.start(config, start_us);
+
+	GazeTelemetryWriter telemetry;
+
+	if(g_options.telemetry_name_ && !telemetry.open(g_options.telemetry_name_))
+	{
+		fprintf(stderr, "%s: couldn't create the telemetry block\n", name);
+	}
+
+	GazeBroadcastWriter broadcast;
+
+	if(g_options.broadcast_name_ && !broadcast.open(g_options.broadcast_name_))
+	{
+		fprintf(stderr, "%s: couldn't create the broadcast ring\n", name);
+	}
+
+	uint64_t warmup_allocations = 0;
+	uint64_t measured_publishes = 0;
+	int64_t now_us = start_us;
+
+	while(now_us < end_us)
+	{
+		const int64_t wake_up_us = loop.get_next_poll_time_us();
+		waiter.wait_until_us(wake_up_us);
+		now_us = get_steady_time_us();
+
+		if(now_us < warmup_end_us)
+		{
+			const size_t count = publisher.count_;
+			loop.run_once(config, now_us, publisher);
+			publisher.count_ = count;
+			warmup_allocations = get_thread_allocation_counts().allocations_;
+		}
+		else
+		{
+			measured_publishes += loop.run_once(config, now_us, publisher);
+		}
+
+		// Same bookkeeping as the driver's update thread
+		loop.get_loop_stats().wakeup_lateness_us_.add(now_us - wake_up_us);
+		loop.get_loop_stats().poll_duration_us_.add(get_steady_time_us() - now_us);
+		telemetry.record(loop, now_us);
+		broadcast.record(loop);
+	}
+
+	const uint64_t allocation_count = get_thread_allocation_counts().allocations_ - warmup_allocations;
+
+	BenchResult result;
+	result.name_ = name;
+	result.ops_ = measured_publishes;
+	result.ns_per_op_ = measured_publishes ? duration_seconds * 1e9 / measured_publishes : 0.0;
+	result.p50_ns_ = get_percentile(publisher.sample_ages_ns_, publisher.count_, 50.0);
+	result.p99_ns_ = get_percentile(publisher.sample_ages_ns_, publisher.count_, 99.0);
+	result.p999_ns_ = get_percentile(publisher.sample_ages_ns_, publisher.count_, 99.9);
+	result.allocs_per_op_ = measured_publishes ? (double)allocation_count / measured_publishes : 0.0;
+
+	report(result);
+}
+
+static bool write_json(const char* path)
+{
+	FILE* file = fopen(path, "w");
+
+	if(!file)
+	{
+		return false;
+	}
+
+	fprintf(file, "{\n  \"iterations\": %d,\n  \"duration_seconds\": %.3f,\n  \"results\": [\n",
+		g_options.iterations_, g_options.duration_seconds_);
+
+	for(size_t index = 0; index < g_results.size(); index++)
+	{
+		const BenchResult& result = g_results[index];
+
+		fprintf(file, "    { \"name\": \"%s\", \"ops\": %llu, \"ns_per_op\": %.3f, \"p50_ns\": %.1f, \"p99_ns\": %.1f, \"p999_ns\": %.1f, \"allocs_per_op\": %.4f }%s\n",
+			result.name_.c_str(), (unsigned long long)result.ops_, result.ns_per_op_, result.p50_ns_, result.p99_ns_, result.p999_ns_,
+			result.allocs_per_op_, (index + 1 < g_results.size()) ? "," : "");
+	}
+
+	fprintf(file, "  ]\n}\n");
+
+	return fclose(file) == 0;
+}
+
+static bool parse_options(const int argc, char** argv)
+{
+	for(int index = 1; index < argc; index++)
+	{
+		const char* argument = argv[index];
+		const char* value = (index + 1 < argc) ? argv[index + 1] : nullptr;
+
+		if(!value)
+		{
+			return false;
+		}
+
+		if(strcmp(argument, "--iterations") == 0)
+		{
+			g_options.iterations_ = atoi(value);
+		}
+		else if(strcmp(argument, "--duration") == 0)
+		{
+			g_options.duration_seconds_ = atof(value);
+		}
+		else if(strcmp(argument, "--filter") == 0)
+		{
+			g_options.filter_ = value;
+		}
+		else if(strcmp(argument, "--json") == 0)
+		{
+			g_options.json_path_ = value;
+		}
+		else if(strcmp(argument, "--trace") == 0)
+		{
+			g_options.trace_path_ = value;
+		}
+		else if(strcmp(argument, "--telemetry") == 0)
+		{
+			g_options.telemetry_name_ = value;
+		}
+		else if(strcmp(argument, "--broadcast") == 0)
+		{
+			g_options.broadcast_name_ = value;
+		}
+		else
+		{
+			return false;
+		}
+
+		index++;
+	}
+
+	return (g_options.iterations_ > 0) && (g_options.duration_seconds_ > 0.0);
+}
+
+int main(int argc, char** argv)
+{
+	if(!parse_options(argc, argv))
+	{
+		fprintf(stderr, "usage: %s [--iterations N] [--duration SECONDS] [--filter SUBSTRING] [--json FILE] [--trace FILE] [--telemetry NAME] [--broadcast NAME]\n", argv[0]);
+		return 2;
+	}
+
+	const std::vector<AllXRGazeStates> samples = make_samples();
+
+	bench_timer();
+	bench_tracing();
+	bench_tracker_simulated();
+	bench_tracker_ipc();
+	bench_pipelines(samples);
+	bench_deduplicator(samples);
+	bench_calibration(samples);
+	bench_math(samples);
+	bench_batch(samples);
+	bench_debug_request();
+	bench_telemetry();
+	bench_broadcast();
+	bench_flight_recorder();
+	bench_quality();
+	bench_sanitizer();
+	bench_synthesizer();
+	bench_thread_policy();
+	bench_gaze_sources();
+	bench_social_gazes();
+	bench_calibration_session();
+	bench_gaze_reactor();
+	bench_update_loop();
+
+	if(g_options.json_path_ && !write_json(g_options.json_path_))
+	{
+		fprintf(stderr, "couldn't write %s\n", g_options.json_path_);
+		return 2;
+	}
+
+	if(g_options.trace_path_ && !get_trace_ring().dump(g_options.trace_path_))
+	{
+		fprintf(stderr, "couldn't write %s\n", g_options.trace_path_);
+		return 2;
+	}
+
+	return 0;
+}
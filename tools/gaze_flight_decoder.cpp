@@ -0,0 +1,305 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// Decodes a flight recorder dump (gaze_flight_recorder.h) the driver wrote to its calibration directory.
+// CSV by default, one row per record. With --timeline 1 it prints only what stands out instead: connection
+// and power state changes, stalls, gaps between new samples longer than --gap-ms, and a summary.
+//
+// usage: gaze_flight_decoder FILE [--timeline 1] [--gap-ms MS]
+//
+// Times are in milliseconds since the oldest record, the wall clock time of the dump is in the header line.
+// Exits with 1 if the file can't be read or isn't a dump this version understands.
+
+#include "gaze_flight_recorder.h"
+#include "gaze_poll_scheduler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+using namespace BVR;
+
+struct DecoderOptions
+{
+	const char* path_ = nullptr;
+	bool timeline_ = false;
+	int gap_ms_ = 50;
+};
+
+static bool parse_options(const int argc, char** argv, DecoderOptions& options)
+{
+	for(int index = 1; index < argc; index++)
+	{
+		const char* argument = argv[index];
+
+		if(strncmp(argument, "--", 2) != 0)
+		{
+			if(options.path_)
+			{
+				return false;
+			}
+
+			options.path_ = argument;
+			continue;
+		}
+
+		const char* value = (index + 1 < argc) ? argv[index + 1] : nullptr;
+
+		if(!value)
+		{
+			return false;
+		}
+
+		if(strcmp(argument, "--timeline") == 0)
+		{
+			options.timeline_ = atoi(value) != 0;
+		}
+		else if(strcmp(argument, "--gap-ms") == 0)
+		{
+			options.gap_ms_ = atoi(value);
+		}
+		else
+		{
+			return false;
+		}
+
+		index++;
+	}
+
+	return options.path_ && (options.gap_ms_ > 0);
+}
+
+static bool read_dump(const char* path, GazeFlightDumpHeader& header, std::vector<GazeFlightRecord>& records)
+{
+	FILE* file = fopen(path, "rb");
+
+	if(!file)
+	{
+		fprintf(stderr, "couldn't open %s\n", path);
+		return false;
+	}
+
+	bool success = (fread(&header, sizeof(header), 1, file) == 1);
+
+	if(!success || (header.magic_ != GAZE_FLIGHT_DUMP_MAGIC))
+	{
+		fprintf(stderr, "%s isn't a flight recorder dump\n", path);
+		success = false;
+	}
+	else if((header.version_ != GAZE_FLIGHT_DUMP_VERSION) || (header.record_size_ != sizeof(GazeFlightRecord)))
+	{
+		fprintf(stderr, "%s is version %u with %u byte records, expected version %u with %u\n", path,
+			(unsigned)header.version_, (unsigned)header.record_size_, (unsigned)GAZE_FLIGHT_DUMP_VERSION, (unsigned)sizeof(GazeFlightRecord));
+		success = false;
+	}
+	else
+	{
+		records.resize(header.num_records_);
+		const size_t num_read = records.empty() ? 0 : fread(records.data(), sizeof(GazeFlightRecord), records.size(), file);
+
+		if(num_read < records.size())
+		{
+			// A crash can cut the file short, keep what made it
+			fprintf(stderr, "%s is truncated, %zu of %zu records\n", path, num_read, records.size());
+			records.resize(num_read);
+		}
+	}
+
+	fclose(file);
+	return success;
+}
+
+static void print_header(const GazeFlightDumpHeader& header, const size_t num_records)
+{
+	const time_t dump_time = (time_t)(header.dump_unix_time_us_ / 1000000);
+	char dump_time_text[64] = "?";
+	const tm* dump_tm = gmtime(&dump_time);
+
+	if(dump_tm)
+	{
+		strftime(dump_time_text, sizeof(dump_time_text), "%Y-%m-%d %H:%M:%S UTC", dump_tm);
+	}
+
+	printf("# %s dump at %s, %zu records (%llu recorded in total)\n",
+		get_flight_dump_reason_name((GazeFlightDumpReason)header.reason_),
+		dump_time_text,
+		num_records,
+		(unsigned long long)header.total_records_);
+}
+
+static double get_time_ms(const GazeFlightRecord& record, const int64_t start_us)
+{
+	return (double)(record.time_us_ - start_us) / 1000.0;
+}
+
+static void print_csv(const std::vector<GazeFlightRecord>& records, const int64_t start_us)
+{
+	printf("time_ms,kind,sequence_number,wakeup_lateness_us,poll_duration_us,new_samples,available,left_valid,right_valid,"
+		"connected,power_state,gaze_x,gaze_y,gaze_z,value\n");
+
+	for(const GazeFlightRecord& record : records)
+	{
+		const uint16_t flags = record.flags_;
+
+		printf("%.3f,%s,%llu,%d,%d,%u,%d,%d,%d,%d,%s,%.4f,%.4f,%.4f,%u\n",
+			get_time_ms(record, start_us),
+			get_flight_record_kind_name((GazeFlightRecordKind)record.kind_),
+			(unsigned long long)record.sequence_number_,
+			record.wakeup_lateness_us_,
+			record.poll_duration_us_,
+			record.new_samples_,
+			(flags & GAZE_FLIGHT_FLAG_AVAILABLE) ? 1 : 0,
+			(flags & GAZE_FLIGHT_FLAG_LEFT_VALID) ? 1 : 0,
+			(flags & GAZE_FLIGHT_FLAG_RIGHT_VALID) ? 1 : 0,
+			(flags & GAZE_FLIGHT_FLAG_CONNECTED) ? 1 : 0,
+			get_power_state_name((GazePowerState)(flags >> GAZE_FLIGHT_FLAG_POWER_STATE_SHIFT)),
+			record.combined_gaze_[0], record.combined_gaze_[1], record.combined_gaze_[2],
+			record.value_);
+	}
+}
+
+static void print_timeline(const std::vector<GazeFlightRecord>& records, const int64_t start_us, const int gap_ms)
+{
+	const int64_t gap_us = (int64_t)gap_ms * 1000;
+
+	uint64_t polls = 0;
+	uint64_t new_samples = 0;
+	uint64_t available = 0;
+	uint64_t gaps = 0;
+	int32_t max_lateness_us = 0;
+	int32_t max_duration_us = 0;
+
+	bool has_last_sample = false;
+	int64_t last_sample_us = 0;
+
+	for(const GazeFlightRecord& record : records)
+	{
+		const GazeFlightRecordKind kind = (GazeFlightRecordKind)record.kind_;
+		const double time_ms = get_time_ms(record, start_us);
+
+		switch(kind)
+		{
+			case GazeFlightRecordKind::POLL_:
+			{
+				polls++;
+				available += (record.flags_ & GAZE_FLIGHT_FLAG_AVAILABLE) ? 1 : 0;
+				max_lateness_us = (record.wakeup_lateness_us_ > max_lateness_us) ? record.wakeup_lateness_us_ : max_lateness_us;
+				max_duration_us = (record.poll_duration_us_ > max_duration_us) ? record.poll_duration_us_ : max_duration_us;
+
+				if(record.new_samples_ == 0)
+				{
+					break;
+				}
+
+				new_samples += record.new_samples_;
+
+				if(has_last_sample && (record.time_us_ - last_sample_us) > gap_us)
+				{
+					gaps++;
+					printf("%12.3f  gap            %.1f ms without a new sample\n", time_ms, (double)(record.time_us_ - last_sample_us) / 1000.0);
+				}
+
+				has_last_sample = true;
+				last_sample_us = record.time_us_;
+				break;
+			}
+
+			case GazeFlightRecordKind::POWER_STATE_:
+				printf("%12.3f  power_state    %s\n", time_ms, get_power_state_name((GazePowerState)record.value_));
+				break;
+
+			case GazeFlightRecordKind::SETTINGS_:
+				printf("%12.3f  settings       generation %u\n", time_ms, record.value_);
+				break;
+
+			case GazeFlightRecordKind::RECEIVE_FAILURE_:
+				printf("%12.3f  receive_failure x%u\n", time_ms, record.value_);
+				break;
+
+			case GazeFlightRecordKind::STALL_:
+				printf("%12.3f  stall          %.1f ms\n", time_ms, (double)record.value_ / 1000.0);
+				break;
+
+			case GazeFlightRecordKind::DISCONNECTED_:
+				// Silence until the next sample is expected, don't report it as a gap
+				has_last_sample = false;
+				printf("%12.3f  %s\n", time_ms, get_flight_record_kind_name(kind));
+				break;
+
+			default:
+				printf("%12.3f  %s\n", time_ms, get_flight_record_kind_name(kind));
+				break;
+		}
+	}
+
+	const double span_ms = records.empty() ? 0.0 : get_time_ms(records.back(), start_us);
+
+	printf("# %.1f ms, %llu polls, %llu new samples, %.1f%% available, %llu gaps over %d ms, max lateness %d us, max poll %d us\n",
+		span_ms,
+		(unsigned long long)polls,
+		(unsigned long long)new_samples,
+		(polls > 0) ? 100.0 * (double)available / (double)polls : 0.0,
+		(unsigned long long)gaps,
+		gap_ms,
+		max_lateness_us,
+		max_duration_us);
+}
+
+int main(int argc, char** argv)
+{
+	DecoderOptions options;
+
+	if(!parse_options(argc, argv, options))
+	{
+		fprintf(stderr, "usage: %s FILE [--timeline 1] [--gap-ms MS]\n", argv[0]);
+		return 1;
+	}
+
+	GazeFlightDumpHeader header = {};
+	std::vector<GazeFlightRecord> records;
+
+	if(!read_dump(options.path_, header, records))
+	{
+		return 1;
+	}
+
+	const int64_t start_us = records.empty() ? header.dump_time_us_ : records.front().time_us_;
+
+	print_header(header, records.size());
+
+	if(options.timeline_)
+	{
+		print_timeline(records, start_us, options.gap_ms_);
+	}
+	else
+	{
+		print_csv(records, start_us);
+	}
+
+	return 0;
+}
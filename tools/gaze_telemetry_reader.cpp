@@ -0,0 +1,269 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// Prints the telemetry block the driver publishes in shared memory (gaze_telemetry.h), without going
+// through vrserver. Once by default, or one line every --watch milliseconds. With --broadcast it subscribes
+// to the gaze broadcast ring instead (gaze_broadcast.h) and prints every sample as it comes in.
+//
+// usage: gaze_telemetry_reader [--name NAME] [--watch MS] [--count N] [--broadcast 1]
+//
+// --count stops after N lines in watch or broadcast mode. Exits with 1 if there's no block to read (driver
+// not running, telemetryEnabled / gazeBroadcastEnabled off, or a driver writing an incompatible version).
+//
+// On Linux, gaze_bench --telemetry publishes a block from its realtime update loop to read from.
+
+#include "gaze_broadcast.h"
+#include "gaze_poll_scheduler.h"
+#include "gaze_telemetry.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+using namespace BVR;
+
+struct ReaderOptions
+{
+	const char* name_ = nullptr;
+	int watch_ms_ = 0;
+	int count_ = 0;
+	bool broadcast_ = false;
+};
+
+static bool parse_options(const int argc, char** argv, ReaderOptions& options)
+{
+	for(int index = 1; index < argc; index++)
+	{
+		const char* argument = argv[index];
+		const char* value = (index + 1 < argc) ? argv[index + 1] : nullptr;
+
+		if(!value)
+		{
+			return false;
+		}
+
+		if(strcmp(argument, "--name") == 0)
+		{
+			options.name_ = value;
+		}
+		else if(strcmp(argument, "--watch") == 0)
+		{
+			options.watch_ms_ = atoi(value);
+		}
+		else if(strcmp(argument, "--count") == 0)
+		{
+			options.count_ = atoi(value);
+		}
+		else if(strcmp(argument, "--broadcast") == 0)
+		{
+			options.broadcast_ = atoi(value) != 0;
+		}
+		else
+		{
+			return false;
+		}
+
+		index++;
+	}
+
+	return (options.watch_ms_ >= 0) && (options.count_ >= 0);
+}
+
+static void print_histogram(const char* name, const uint64_t buckets[GAZE_LATENCY_HISTOGRAM_BUCKETS])
+{
+	printf("%-18s", name);
+
+	for(int bucket = 0; bucket < GAZE_LATENCY_HISTOGRAM_BUCKETS; bucket++)
+	{
+		if(buckets[bucket] > 0)
+		{
+			printf(" <=%lld:%llu", (long long)GazeLatencyHistogram::get_bucket_upper_bound_us(bucket), (unsigned long long)buckets[bucket]);
+		}
+	}
+
+	printf("\n");
+}
+
+static void print_snapshot(const GazeTelemetrySnapshot& snapshot)
+{
+	printf("updates            %llu\n", (unsigned long long)snapshot.update_count_);
+	printf("connection         %s, %llu connects, %llu reconnects, %s\n",
+		snapshot.connected_ ? "connected" : "disconnected",
+		(unsigned long long)snapshot.connects_,
+		(unsigned long long)snapshot.reconnects_,
+		get_power_state_name((GazePowerState)snapshot.power_state_));
+	printf("combined gaze      %s (%.3f, %.3f, %.3f)\n",
+		snapshot.combined_gaze_valid_ ? "valid" : "invalid",
+		snapshot.combined_gaze_[0], snapshot.combined_gaze_[1], snapshot.combined_gaze_[2]);
+
+	for(int eye = 0; eye < NUM_EYES; eye++)
+	{
+		printf("%-18s %s (%.3f, %.3f, %.3f)\n",
+			(eye == LEFT) ? "left gaze" : "right gaze",
+			snapshot.per_eye_gazes_valid_[eye] ? "valid" : "invalid",
+			snapshot.per_eye_gazes_[eye][0], snapshot.per_eye_gazes_[eye][1], snapshot.per_eye_gazes_[eye][2]);
+	}
+
+	if(snapshot.social_gazes_)
+	{
+		printf("social gazes       ipd %.1f mm, left eye at (%.4f, %.4f, %.4f), right eye at (%.4f, %.4f, %.4f)\n",
+			1000.0f * snapshot.ipd_meters_,
+			snapshot.eye_origins_[LEFT][0], snapshot.eye_origins_[LEFT][1], snapshot.eye_origins_[LEFT][2],
+			snapshot.eye_origins_[RIGHT][0], snapshot.eye_origins_[RIGHT][1], snapshot.eye_origins_[RIGHT][2]);
+	}
+
+	printf("validity           %.1f%%\n", 100.0f * snapshot.validity_ratio_);
+	printf("sample age         %lld us\n", (long long)snapshot.sample_age_us_);
+	printf("wakeup lateness    %lld us (p50 %lld, p99 %lld)\n",
+		(long long)snapshot.wakeup_lateness_us_,
+		(long long)snapshot.wakeup_lateness_p50_us_,
+		(long long)snapshot.wakeup_lateness_p99_us_);
+	printf("poll duration p99  %lld us\n", (long long)snapshot.poll_duration_p99_us_);
+	printf("samples            %llu published, %llu deduplicated, %llu stale, %llu missed\n",
+		(unsigned long long)snapshot.published_,
+		(unsigned long long)snapshot.deduplicated_,
+		(unsigned long long)snapshot.stale_,
+		(unsigned long long)snapshot.missed_);
+	printf("quality            %.1f%% valid, %.1f Hz, precision %.3f deg rms, %u dropouts (longest %lld us), smoothing %.2f\n",
+		100.0f * snapshot.quality_validity_ratio_,
+		snapshot.quality_sample_rate_hz_,
+		snapshot.quality_precision_rms_deg_,
+		snapshot.quality_dropouts_,
+		(long long)snapshot.quality_longest_dropout_us_,
+		snapshot.smoothing_alpha_);
+
+	print_histogram("lateness (us)", snapshot.wakeup_lateness_buckets_);
+	print_histogram("duration (us)", snapshot.poll_duration_buckets_);
+}
+
+static void print_line(const GazeTelemetrySnapshot& snapshot)
+{
+	printf("%10llu %-12s %-7s valid %5.1f%% age %6lld us late %5lld us (p99 %5lld) gaze (%6.3f, %6.3f, %6.3f) missed %llu %5.1f Hz prec %.3f deg\n",
+		(unsigned long long)snapshot.update_count_,
+		snapshot.connected_ ? "connected" : "disconnected",
+		get_power_state_name((GazePowerState)snapshot.power_state_),
+		100.0f * snapshot.validity_ratio_,
+		(long long)snapshot.sample_age_us_,
+		(long long)snapshot.wakeup_lateness_us_,
+		(long long)snapshot.wakeup_lateness_p99_us_,
+		snapshot.combined_gaze_[0], snapshot.combined_gaze_[1], snapshot.combined_gaze_[2],
+		(unsigned long long)snapshot.missed_,
+		snapshot.quality_sample_rate_hz_,
+		snapshot.quality_precision_rms_deg_);
+}
+
+static int run_broadcast(const ReaderOptions& options)
+{
+	const char* name = options.name_ ? options.name_ : GAZE_BROADCAST_SHM_NAME;
+	GazeBroadcastReader reader;
+
+	if(!reader.open(name))
+	{
+		fprintf(stderr, "no broadcast ring at %s\n", name);
+		return 1;
+	}
+
+	GazeBroadcastSample sample;
+
+	for(int line = 0; (options.count_ == 0) || (line < options.count_);)
+	{
+		if(!reader.read(sample))
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			continue;
+		}
+
+		printf("%10llu %12lld us %-7s (%6.3f, %6.3f, %6.3f) dropped %llu\n",
+			(unsigned long long)sample.sequence_number_,
+			(long long)sample.poll_time_us_,
+			sample.combined_gaze_valid_ ? "valid" : "invalid",
+			sample.combined_gaze_[0], sample.combined_gaze_[1], sample.combined_gaze_[2],
+			(unsigned long long)reader.get_num_dropped());
+		fflush(stdout);
+
+		line++;
+	}
+
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	ReaderOptions options;
+
+	if(!parse_options(argc, argv, options))
+	{
+		fprintf(stderr, "usage: %s [--name NAME] [--watch MS] [--count N] [--broadcast 1]\n", argv[0]);
+		return 2;
+	}
+
+	if(options.broadcast_)
+	{
+		return run_broadcast(options);
+	}
+
+	if(!options.name_)
+	{
+		options.name_ = GAZE_TELEMETRY_SHM_NAME;
+	}
+
+	GazeTelemetryReader reader;
+
+	if(!reader.open(options.name_))
+	{
+		fprintf(stderr, "no telemetry block at %s\n", options.name_);
+		return 1;
+	}
+
+	GazeTelemetrySnapshot snapshot;
+
+	if(options.watch_ms_ == 0)
+	{
+		if(!reader.read(snapshot))
+		{
+			fprintf(stderr, "couldn't read a consistent snapshot\n");
+			return 1;
+		}
+
+		print_snapshot(snapshot);
+		return 0;
+	}
+
+	for(int line = 0; (options.count_ == 0) || (line < options.count_); line++)
+	{
+		if(reader.read(snapshot))
+		{
+			print_line(snapshot);
+			fflush(stdout);
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(options.watch_ms_));
+	}
+
+	return 0;
+}
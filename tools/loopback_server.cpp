@@ -0,0 +1,270 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "loopback_server.h"
+#include "gaze_poll_scheduler.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace BVR
+{
+
+LoopbackServer::~LoopbackServer()
+{
+	stop();
+}
+
+std::string get_loopback_endpoint_name()
+{
+	char name[128];
+
+#ifdef _WIN32
+	snprintf(name, sizeof(name), "\\\\.\\pipe\\PSVR2LoopbackServer%lu", (unsigned long)GetCurrentProcessId());
+#else
+	snprintf(name, sizeof(name), "/tmp/psvr2_loopback_%d.sock", (int)getpid());
+#endif
+
+	return name;
+}
+
+#ifdef _WIN32
+
+bool LoopbackServer::start(const char* endpoint, PSVR2ServerSimulator& simulator)
+{
+	stop();
+
+	endpoint_ = endpoint;
+	simulator_ = &simulator;
+	start_time_us_ = get_steady_time_us();
+
+	HANDLE pipe = CreateNamedPipeA(endpoint, PIPE_ACCESS_DUPLEX, PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_WAIT,
+		1, sizeof(SequencedResponse), sizeof(Request), 0, NULL);
+
+	if(pipe == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	pipe_handle_ = pipe;
+	stop_requested_ = false;
+	thread_ = std::thread(&LoopbackServer::serve, this);
+
+	return true;
+}
+
+void LoopbackServer::stop()
+{
+	if(!thread_.joinable())
+	{
+		return;
+	}
+
+	stop_requested_ = true;
+
+	// Kicks the server thread out of ConnectNamedPipe / ReadFile
+	CancelSynchronousIo((HANDLE)thread_.native_handle());
+	thread_.join();
+
+	CloseHandle((HANDLE)pipe_handle_);
+	pipe_handle_ = nullptr;
+}
+
+void LoopbackServer::serve()
+{
+	HANDLE pipe = (HANDLE)pipe_handle_;
+
+	while(!stop_requested_)
+	{
+		if(!ConnectNamedPipe(pipe, NULL) && (GetLastError() != ERROR_PIPE_CONNECTED))
+		{
+			if(stop_requested_)
+			{
+				break;
+			}
+
+			continue;
+		}
+
+		while(!stop_requested_)
+		{
+			Request request;
+			DWORD read_size = 0;
+
+			if(!ReadFile(pipe, &request, sizeof(request), &read_size, NULL) || (read_size != sizeof(request)))
+			{
+				break;
+			}
+
+			if(is_hung_)
+			{
+				continue;
+			}
+
+			SequencedResponse response;
+			simulator_->handle_request(get_steady_time_us() - start_time_us_, request, response);
+
+			const DWORD response_size = simulator_->get_settings().send_sequence_numbers_ ? sizeof(SequencedResponse) : sizeof(Response);
+			DWORD write_size = 0;
+
+			if(!WriteFile(pipe, &response, response_size, &write_size, NULL))
+			{
+				break;
+			}
+		}
+
+		DisconnectNamedPipe(pipe);
+	}
+}
+
+#else
+
+bool LoopbackServer::start(const char* endpoint, PSVR2ServerSimulator& simulator)
+{
+	stop();
+
+	endpoint_ = endpoint;
+	simulator_ = &simulator;
+	start_time_us_ = get_steady_time_us();
+
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+
+	if(endpoint_.size() >= sizeof(address.sun_path))
+	{
+		return false;
+	}
+
+	strcpy(address.sun_path, endpoint);
+	unlink(endpoint);
+
+	listen_socket_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+
+	if(listen_socket_ < 0)
+	{
+		return false;
+	}
+
+	if((bind(listen_socket_, (const sockaddr*)&address, sizeof(address)) != 0) || (listen(listen_socket_, 1) != 0))
+	{
+		close(listen_socket_);
+		listen_socket_ = -1;
+		return false;
+	}
+
+	stop_requested_ = false;
+	thread_ = std::thread(&LoopbackServer::serve, this);
+
+	return true;
+}
+
+void LoopbackServer::stop()
+{
+	if(!thread_.joinable())
+	{
+		return;
+	}
+
+	stop_requested_ = true;
+
+	// Wakes up accept() and recv() on the server thread
+	shutdown(listen_socket_, SHUT_RDWR);
+
+	const int client_socket = client_socket_.load();
+
+	if(client_socket >= 0)
+	{
+		shutdown(client_socket, SHUT_RDWR);
+	}
+
+	thread_.join();
+
+	close(listen_socket_);
+	listen_socket_ = -1;
+	unlink(endpoint_.c_str());
+}
+
+void LoopbackServer::serve()
+{
+	while(!stop_requested_)
+	{
+		const int client_socket = accept4(listen_socket_, NULL, NULL, SOCK_CLOEXEC);
+
+		if(client_socket < 0)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+
+			break;
+		}
+
+		client_socket_ = client_socket;
+
+		while(!stop_requested_)
+		{
+			Request request;
+
+			if(recv(client_socket, &request, sizeof(request), 0) != (ssize_t)sizeof(request))
+			{
+				break;
+			}
+
+			if(is_hung_)
+			{
+				continue;
+			}
+
+			SequencedResponse response;
+			simulator_->handle_request(get_steady_time_us() - start_time_us_, request, response);
+
+			const size_t response_size = simulator_->get_settings().send_sequence_numbers_ ? sizeof(SequencedResponse) : sizeof(Response);
+
+			if(send(client_socket, &response, response_size, MSG_NOSIGNAL) != (ssize_t)response_size)
+			{
+				break;
+			}
+		}
+
+		client_socket_ = -1;
+		close(client_socket);
+	}
+}
+
+#endif
+
+} // BVR
@@ -0,0 +1,77 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef LOOPBACK_SERVER_H
+#define LOOPBACK_SERVER_H
+
+#include "psvr2_server_simulator.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace BVR
+{
+	// Serves a PSVR2ServerSimulator over the platform's real IPC (named pipe on Windows, unix socket
+	// elsewhere) from a background thread, so the tracker can be measured end to end with the kernel in
+	// the loop. One client at a time, like the real server. The simulator belongs to the server thread
+	// while it runs.
+	class LoopbackServer
+	{
+	public:
+		~LoopbackServer();
+
+		bool start(const char* endpoint, PSVR2ServerSimulator& simulator);
+		void stop();
+
+		const char* get_endpoint() const { return endpoint_.c_str(); }
+
+		// While hung, requests are still read but never answered, like a server stuck in a deadlock.
+		void set_hung(const bool is_hung) { is_hung_ = is_hung; }
+
+	private:
+		void serve();
+
+		std::string endpoint_;
+		PSVR2ServerSimulator* simulator_ = nullptr;
+		int64_t start_time_us_ = 0;   // Steady clock origin of the simulator, like a server launched with us
+		std::thread thread_;
+		std::atomic<bool> stop_requested_ = false;
+		std::atomic<bool> is_hung_ = false;
+
+#ifdef _WIN32
+		void* pipe_handle_ = nullptr;
+#else
+		int listen_socket_ = -1;
+		std::atomic<int> client_socket_ = -1;
+#endif
+	};
+
+	// Somewhere private to put the endpoint, different for every process.
+	std::string get_loopback_endpoint_name();
+}
+
+#endif // LOOPBACK_SERVER_H
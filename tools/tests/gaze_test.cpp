@@ -0,0 +1,126 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "gaze_test.h"
+
+using namespace BVR;
+
+struct TestOptions
+{
+	const char* filter_ = nullptr;
+};
+
+static int g_checks = 0;
+static int g_failures = 0;
+static TestOptions g_options;
+
+void check(const bool condition, const char* test_name, const char* what)
+{
+	g_checks++;
+
+	if(!condition)
+	{
+		fprintf(stderr, "FAILED %s: %s\n", test_name, what);
+		g_failures++;
+	}
+}
+
+bool is_selected(const char* name)
+{
+	return !g_options.filter_ || strstr(name, g_options.filter_);
+}
+
+int get_num_failures()
+{
+	return g_failures;
+}
+
+std::vector<AllXRGazeStates> make_samples()
+{
+	std::vector<AllXRGazeStates> samples(TEST_NUM_SAMPLES);
+
+	for(int index = 0; index < TEST_NUM_SAMPLES; index++)
+	{
+		const float angle = (float)index * 0.01f;
+
+		AllXRGazeStates& sample = samples[index];
+		sample.combined_gaze_.direction_ = { sinf(angle) * 0.2f, cosf(angle) * 0.1f, -1.0f };
+		sample.combined_gaze_.is_valid_ = (index % 61) != 0; // The occasional blink
+		sample.per_eye_gazes_[LEFT] = sample.combined_gaze_;
+		sample.per_eye_gazes_[RIGHT] = sample.combined_gaze_;
+		sample.per_eye_gazes_[LEFT].direction_.x -= 0.03f;
+		sample.per_eye_gazes_[RIGHT].direction_.x += 0.03f;
+	}
+
+	return samples;
+}
+
+std::string get_flight_directory()
+{
+	const char* parent = TEST_FLIGHT_DIRECTORY_PARENT;
+	return std::string(parent ? parent : ".") + TEST_FLIGHT_SEPARATOR + "psvr2_gaze_tests_flight";
+}
+
+static bool parse_options(const int argc, char** argv)
+{
+	for(int index = 1; index < argc; index++)
+	{
+		const char* argument = argv[index];
+		const char* value = (index + 1 < argc) ? argv[index + 1] : nullptr;
+
+		if(!value)
+		{
+			return false;
+		}
+
+		if(strcmp(argument, "--filter") == 0)
+		{
+			g_options.filter_ = value;
+		}
+		else
+		{
+			return false;
+		}
+
+		index++;
+	}
+
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	if(!parse_options(argc, argv))
+	{
+		fprintf(stderr, "usage: %s [--filter SUBSTRING]\n", argv[0]);
+		return 2;
+	}
+
+	run_tests();
+
+	printf("%d check(s), %d failed\n", g_checks, g_failures);
+
+	return g_failures ? 1 : 0;
+}
@@ -0,0 +1,151 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Harness shared by the gaze core tests. Each test_<module>.cpp is its own executable and ctest case: it defines
+// run_tests(), which calls run_test() for each of its tests, and links gaze_test.cpp for main().
+//
+// Tests run against the in-process server simulator (and the loopback server for real IPC) so they need
+// neither a headset nor SteamVR. gaze_bench only measures.
+//
+// Hot paths are also checked for heap allocations once warmed up: everything the update thread runs per
+// poll has to stay off the heap.
+//
+// Whatever runs on the virtual clock is deterministic. Tests that wait on another thread give it
+// TEST_DEADLINE_US of real time and never assert on how long it took.
+//
+// usage: test_<module> [--filter SUBSTRING]
+//
+// Prints one line per test, the exit code is non-zero if any check failed.
+
+#ifndef GAZE_TEST_H
+#define GAZE_TEST_H
+
+#include "alloc_counter.h"
+#include "gaze_poll_scheduler.h"
+#include "gaze_update_loop.h"
+#include "Tracing.h"
+
+#include <chrono>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define TEST_ITERATIONS 20000       // Passes through a hot path, past its warmup
+#define TEST_DEADLINE_US 5000000    // Real time given to another thread, generous for loaded CI machines
+#define TEST_NUM_SAMPLES 1024       // Distinct gaze samples cycled through
+
+#ifdef _WIN32
+#define TEST_FLIGHT_DIRECTORY_PARENT getenv("TEMP")
+#define TEST_FLIGHT_SEPARATOR "\\"
+#else
+#define TEST_FLIGHT_DIRECTORY_PARENT "/tmp"
+#define TEST_FLIGHT_SEPARATOR "/"
+#endif
+
+// Defined by each test executable.
+void run_tests();
+
+void check(const bool condition, const char* test_name, const char* what);
+bool is_selected(const char* name);
+int get_num_failures();
+
+// Runs the function iterations times after a tenth of that to warm up, and checks the measured passes made no
+// heap allocation. The index keeps counting up across both, tests feeding it as a sequence number rely on that.
+template<typename Function>
+static void run_steady_state(const char* test_name, const int iterations, Function function)
+{
+	const int warmup_iterations = iterations / 10;
+	int index = 0;
+
+	for(; index < warmup_iterations; index++)
+	{
+		function(index);
+	}
+
+	const BVR::AllocationScope allocations;
+
+	for(; index < warmup_iterations + iterations; index++)
+	{
+		function(index);
+	}
+
+	const uint64_t allocation_count = allocations.get_allocations();
+	check(allocation_count == 0, test_name, "allocates in steady state");
+}
+
+// Waits up to TEST_DEADLINE_US for the condition.
+template<typename Condition>
+static bool wait_for(Condition condition)
+{
+	const int64_t deadline_us = BVR::get_steady_time_us() + TEST_DEADLINE_US;
+
+	while(!condition() && BVR::get_steady_time_us() < deadline_us)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	return condition();
+}
+
+template<typename Function>
+static void run_test(const char* name, Function function)
+{
+	if(!is_selected(name))
+	{
+		return;
+	}
+
+	const int failures = get_num_failures();
+	function(name);
+
+	printf("%-4s %s\n", (get_num_failures() == failures) ? "ok" : "FAIL", name);
+}
+
+// TEST_NUM_SAMPLES slowly moving gazes, with the occasional blink.
+std::vector<BVR::AllXRGazeStates> make_samples();
+
+// Scratch directory for the files tests write (flight dumps, replays).
+std::string get_flight_directory();
+
+// Counts what was published, single threaded.
+class RecordingPublisher : public BVR::GazePublisher
+{
+public:
+	void publish(const BVR::GazeUpdate& update) override
+	{
+		publishes_++;
+		new_samples_ += update.new_samples_;
+	}
+
+	uint64_t publishes_ = 0;
+	uint64_t new_samples_ = 0;
+};
+
+#endif // GAZE_TEST_H
@@ -0,0 +1,182 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Tests of the shared memory ring re-serving gazes to local consumers.
+
+#include "gaze_test.h"
+#include "gaze_broadcast.h"
+#include "gaze_update_loop.h"
+#include "psvr2_eye_tracking.h"
+#include "psvr2_server_simulator.h"
+
+#include <memory>
+
+using namespace BVR;
+
+#ifdef _WIN32
+#define TEST_BROADCAST_SHM_NAME "Local\\PSVR2GazeTestsBroadcast"
+#else
+#define TEST_BROADCAST_SHM_NAME "/psvr2_gaze_tests_broadcast"
+#endif
+
+static void test_broadcast_ring(const char* name)
+{
+	// The ring with a consumer on another thread that's sometimes too slow. It may lose samples, but
+	// never a torn one, and every sample is either read or counted as dropped.
+	GazeBroadcastBlock* block = new GazeBroadcastBlock();
+	GazeBroadcastSample sample = {};
+
+	GazeBroadcastReader reader;
+	reader.attach(*block);
+
+	std::atomic<bool> is_reading = true;
+	std::atomic<uint64_t> reads = 0;
+	uint64_t torn_reads = 0;
+	uint64_t out_of_order = 0;
+
+	std::thread consumer([&]()
+	{
+		GazeBroadcastSample copy;
+		uint64_t last_sequence_number = 0;
+
+		while(true)
+		{
+			const bool is_last_pass = !is_reading.load(std::memory_order_acquire);
+
+			while(reader.read(copy))
+			{
+				torn_reads += (copy.new_samples_ != copy.sequence_number_) || (copy.poll_time_us_ != (int64_t)copy.sequence_number_);
+				out_of_order += (copy.sequence_number_ <= last_sequence_number);
+				last_sequence_number = copy.sequence_number_;
+
+				// Dawdle now and then so the writer laps us
+				if((reads.fetch_add(1, std::memory_order_relaxed) % 1024) == 1023)
+				{
+					std::this_thread::sleep_for(std::chrono::microseconds(200));
+				}
+			}
+
+			if(is_last_pass)
+			{
+				break;
+			}
+		}
+	});
+
+	const int64_t deadline_us = get_steady_time_us() + TEST_DEADLINE_US;
+	uint64_t index = 0;
+
+	while(((index < TEST_ITERATIONS) || (reads.load(std::memory_order_relaxed) < 1000)) && (get_steady_time_us() < deadline_us))
+	{
+		index++;
+		sample.sequence_number_ = index;
+		sample.new_samples_ = index;
+		sample.poll_time_us_ = (int64_t)index;
+		write_gaze_broadcast(*block, sample);
+
+		if((index & 1023) == 0)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	is_reading.store(false, std::memory_order_release);
+	consumer.join();
+
+	const uint64_t written = block->write_index_.load();
+	check(torn_reads == 0 && out_of_order == 0, name, "consumer saw a torn or out of order sample");
+	check(reader.get_num_read() + reader.get_num_dropped() == written, name, "samples neither read nor counted as dropped");
+	check(reader.get_num_read() > 0, name, "consumer never got a sample");
+
+	delete block;
+}
+
+static void test_broadcast_record(const char* name)
+{
+	// Through real shared memory, fed by the update loop on a virtual clock. One consumer keeps up,
+	// one never reads until the end.
+	PSVR2ServerSimulatorSettings settings;
+	settings.sample_rate_hz_ = 120.0;
+	PSVR2ServerSimulator simulator(settings);
+
+	PSVR2SimulatedTransport* transport = new PSVR2SimulatedTransport(simulator);
+	PSVR2EyeTracker tracker{ std::unique_ptr<PSVR2Transport>(transport) };
+	GazeUpdateLoop loop(tracker);
+	RecordingPublisher publisher;
+
+	ShimConfig config;
+	config.adaptive_polling_ = false;
+	config.polling_rate_ms_ = 1;
+
+	GazeBroadcastWriter broadcast;
+	check(broadcast.open(TEST_BROADCAST_SHM_NAME), name, "couldn't create the broadcast ring");
+
+	GazeBroadcastReader fast_reader;
+	GazeBroadcastReader slow_reader;
+	check(fast_reader.open(TEST_BROADCAST_SHM_NAME) && slow_reader.open(TEST_BROADCAST_SHM_NAME), name, "couldn't open the ring");
+
+	int64_t now_us = 0;
+	transport->set_now_us(now_us);
+	loop.start(config, now_us);
+
+	GazeBroadcastSample sample;
+	uint64_t gaps = 0;
+	uint64_t last_sequence_number = 0;
+
+	run_steady_state(name, TEST_ITERATIONS, [&](const int)
+	{
+		now_us += 1000;
+		transport->set_now_us(now_us);
+		loop.run_once(config, now_us, publisher);
+		broadcast.record(loop);
+
+		while(fast_reader.read(sample))
+		{
+			gaps += (last_sequence_number != 0) && (sample.sequence_number_ != last_sequence_number + sample.new_samples_);
+			last_sequence_number = sample.sequence_number_;
+		}
+	});
+
+	const uint64_t written = broadcast.get_num_written();
+	check(written > GAZE_BROADCAST_CAPACITY, name, "too few samples to lap the slow reader");
+	check(fast_reader.get_num_read() == written && fast_reader.get_num_dropped() == 0 && gaps == 0, name, "consumer that kept up lost samples");
+
+	uint64_t slow_reads = 0;
+
+	while(slow_reader.read(sample))
+	{
+		slow_reads++;
+	}
+
+	check(slow_reads == GAZE_BROADCAST_CAPACITY && slow_reader.get_num_dropped() == written - GAZE_BROADCAST_CAPACITY, name, "slow consumer didn't resync to the oldest sample");
+
+	broadcast.close();
+}
+
+void run_tests()
+{
+	run_test("broadcast_ring", test_broadcast_ring);
+	run_test("broadcast_record", test_broadcast_record);
+}
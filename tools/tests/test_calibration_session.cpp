@@ -0,0 +1,269 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Tests of calibration sessions on their own thread, against a synthetic user.
+
+#include "gaze_test.h"
+#include "gaze_calibration_session.h"
+#include "gaze_math.h"
+#include "gaze_update_loop.h"
+#include "psvr2_eye_tracking.h"
+#include "psvr2_server_simulator.h"
+
+#include <memory>
+
+using namespace BVR;
+
+// A user who looks at every target the session shows, 200 ms after it moves, through a tracker that's off
+// by a fixed linear distortion. Samples at 125 Hz on a 1 ms virtual clock, the session processed every 10 ms.
+// Returns when the session ends (or after a minute of virtual time).
+static int64_t run_synthetic_calibration(GazeCalibrationSession& session, const float distortion[9], const int invalid_eye,
+	std::vector<int64_t>* hold_times_us)
+{
+	int64_t now_us = 0;
+	session.process(now_us);
+
+	GazeCalibrationTarget target;
+	int64_t shown_time_us = -1;
+	XrVector3f previous = { 0.0f, 0.0f, -1.0f };
+	XrVector3f looking = previous;
+
+	for(; now_us < 60000000; now_us += 1000)
+	{
+		if(session.get_target(target) && (target.calibration_index_ != INVALID_INDEX) && (target.shown_time_us_ != shown_time_us))
+		{
+			if(hold_times_us && (shown_time_us >= 0))
+			{
+				hold_times_us->push_back(target.shown_time_us_ - shown_time_us);
+			}
+
+			shown_time_us = target.shown_time_us_;
+			previous = looking;
+		}
+
+		looking = (now_us - shown_time_us >= 200000) ? target.pose_.direction_ : previous;
+
+		if((now_us % 8000) == 0)
+		{
+			XRGazeState gaze;
+			gaze.direction_ = gaze_vector_store(gaze_vector_normalize3(gaze_vector_transform3(distortion, gaze_vector_load(looking))));
+			gaze.is_valid_ = true;
+
+			AllXRGazeStates gazes;
+			gazes.combined_gaze_ = gaze;
+			gazes.per_eye_gazes_[LEFT] = gaze;
+			gazes.per_eye_gazes_[RIGHT] = gaze;
+
+			if(invalid_eye != INVALID_INDEX)
+			{
+				gazes.per_eye_gazes_[invalid_eye].is_valid_ = false;
+			}
+
+			session.add_sample(now_us, gazes);
+		}
+
+		if((now_us % 10000) == 0)
+		{
+			session.process(now_us);
+
+			if(!session.is_active())
+			{
+				break;
+			}
+		}
+	}
+
+	return now_us;
+}
+
+// Largest angle in degrees between a raster target and what the calibration makes of its distorted reading.
+static float get_calibration_error_deg(const float matrix[9], const float distortion[9])
+{
+	GazeCalibration targets;
+	GazeCalibration solved;
+	solved.set_matrix(matrix);
+
+	float max_error = 0.0f;
+
+	for(int index = 0; index < CALIBRATION_NUM_POINTS; index++)
+	{
+		const XrVector3f target = targets.get_raster_point().target_;
+		const XrVector3f measured = gaze_vector_store(gaze_vector_normalize3(gaze_vector_transform3(distortion, gaze_vector_load(target))));
+		const XrVector3f corrected = solved.apply_calibration(measured);
+
+		const float cosine = std::min(1.0f, corrected.x * target.x + corrected.y * target.y + corrected.z * target.z);
+		max_error = std::max(max_error, acosf(cosine) * 57.2957795f);
+
+		targets.start_calibration();
+		for(int skip = 0; skip <= index; skip++)
+		{
+			targets.increment_raster();
+		}
+	}
+
+	return max_error;
+}
+
+static void test_calibration_session(const char* name)
+{
+	// A couple of degrees off in yaw and 5% short vertically
+	const float distortion[9] = { 0.9994f, 0.0f, 0.0349f, 0.0f, 0.95f, 0.0f, -0.0349f, 0.0f, 0.9994f };
+
+	// The combined gaze: every target held for the settle time plus its samples, nothing from the eyes'
+	// way there taken, and the distortion solved away
+	{
+		GazeCalibrationSession session;
+		std::vector<int64_t> hold_times_us;
+
+		session.start(false, true);
+		run_synthetic_calibration(session, distortion, INVALID_INDEX, &hold_times_us);
+
+		GazeCalibrationResults results;
+		const bool has_results = (session.get_num_finished_sessions() == 1) && session.get_results(results);
+
+		check(has_results && (results.solved_mask_ == (1u << COMBINED_CALIBRATION_INDEX)), name, "combined calibration didn't finish");
+		check(hold_times_us.size() == CALIBRATION_NUM_POINTS - 1, name, "targets didn't all show");
+
+		const int64_t expected_hold_us = CALIBRATION_SETTLE_US + CALIBRATION_SAMPLES_PER_POINT * 8000;
+
+		for(const int64_t hold_time_us : hold_times_us)
+		{
+			check((hold_time_us >= expected_hold_us - 10000) && (hold_time_us <= expected_hold_us + 20000), name, "target not moved on the session clock");
+		}
+
+		check(session.get_stats().settling_.load() > 0 && session.get_stats().skipped_points_.load() == 0, name, "settling samples weren't ignored");
+		check(has_results && get_calibration_error_deg(results.matrices_[COMBINED_CALIBRATION_INDEX], distortion) < 0.05f, name, "distortion not solved");
+		check(!session.is_active() && session.get_calibration_cube().direction_.z == -1.0f, name, "target outlived the session");
+	}
+
+	// Per eye, left then right. The left eye never tracks, its targets time out and it stays uncalibrated.
+	{
+		GazeCalibrationSession session;
+		session.start(true, false);
+		const int64_t end_us = run_synthetic_calibration(session, distortion, LEFT, nullptr);
+
+		GazeCalibrationResults results;
+		const bool has_results = session.get_results(results);
+
+		check(has_results && (results.solved_mask_ == (1u << RIGHT_CALIBRATION_INDEX)), name, "untracked eye was solved");
+		check(session.get_stats().skipped_points_.load() == CALIBRATION_NUM_POINTS, name, "untracked eye's targets didn't time out");
+		check(end_us >= CALIBRATION_NUM_POINTS * CALIBRATION_POINT_TIMEOUT_US, name, "timeouts too early");
+		check(has_results && get_calibration_error_deg(results.matrices_[RIGHT_CALIBRATION_INDEX], distortion) < 0.05f, name, "right eye not solved");
+	}
+
+	// The update loop feeds the session and applies what it solved on its next poll, the tracker never
+	// sees the session itself
+	{
+		PSVR2ServerSimulatorSettings settings;
+		PSVR2ServerSimulator simulator(settings);
+
+		PSVR2SimulatedTransport* transport = new PSVR2SimulatedTransport(simulator);
+		PSVR2EyeTracker tracker{ std::unique_ptr<PSVR2Transport>(transport) };
+		GazeUpdateLoop loop(tracker);
+		RecordingPublisher publisher;
+
+		ShimConfig config;
+		config.adaptive_polling_ = false;
+		config.polling_rate_ms_ = 1;
+
+		GazeCalibrationSession& session = loop.get_calibration_session();
+		session.set_directory("");
+
+		int64_t now_us = 0;
+		transport->set_now_us(now_us);
+		loop.start(config, now_us);
+
+		session.start(false, true);
+		session.process(now_us);
+
+		for(int poll = 0; poll < 100; poll++)
+		{
+			now_us += 1000;
+			transport->set_now_us(now_us);
+			loop.run_once(config, now_us, publisher);
+		}
+
+		const uint64_t queued = session.get_stats().settling_.load();
+		session.process(now_us);
+		check(session.get_stats().settling_.load() > queued, name, "loop didn't queue its samples");
+
+		session.stop();
+		session.process(now_us);
+
+		// Then a synthetic session to completion, picked up by the loop
+		session.start(false, true);
+		run_synthetic_calibration(session, distortion, INVALID_INDEX, nullptr);
+
+		check(!tracker.is_combined_calibrated(), name, "calibration applied before the loop polled");
+		now_us += 1000;
+		transport->set_now_us(now_us);
+		loop.run_once(config, now_us, publisher);
+		check(tracker.is_combined_calibrated(), name, "loop didn't apply the solved calibration");
+	}
+
+	// The session thread: asleep until started, shows the first target, hides it when stopped
+	{
+		GazeCalibrationSession session;
+		session.start_thread();
+		session.start(false, true);
+
+		GazeCalibrationTarget target;
+		check(wait_for([&]() { return session.get_target(target) && target.calibration_index_ == COMBINED_CALIBRATION_INDEX; }) && target.raster_index_ == 0,
+			name, "session thread didn't start the session");
+
+		session.stop();
+
+		check(wait_for([&]() { return !session.is_active(); }), name, "session thread didn't stop the session");
+		session.stop_thread();
+	}
+
+	// What the update thread does per new sample during a session, the session thread draining every 64
+	{
+		GazeCalibrationSession session;
+		session.start(false, true);
+		session.process(0);
+
+		AllXRGazeStates gazes;
+		gazes.combined_gaze_.direction_ = { 0.0f, 0.0f, -1.0f };
+		gazes.combined_gaze_.is_valid_ = true;
+
+		run_steady_state(name, TEST_ITERATIONS, [&](const int index)
+		{
+			session.add_sample(index, gazes);
+
+			if((index & 63) == 63)
+			{
+				session.process(index);
+			}
+		});
+
+		check(session.get_stats().dropped_.load() == 0, name, "queue overflowed");
+	}
+}
+
+void run_tests()
+{
+	run_test("calibration_session", test_calibration_session);
+}
@@ -0,0 +1,161 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Tests of the stats and control endpoint behind HmdShimDriver::DebugRequest.
+
+#include "gaze_test.h"
+#include "gaze_debug_request.h"
+#include "gaze_debug_stats.h"
+#include "gaze_update_loop.h"
+#include "psvr2_eye_tracking.h"
+#include "psvr2_server_simulator.h"
+
+#include <memory>
+
+using namespace BVR;
+
+static void test_latency_histogram(const char* name)
+{
+	GazeLatencyHistogram histogram;
+
+	for(int index = 0; index < TEST_ITERATIONS; index++)
+	{
+		histogram.add(index & 0xfff);
+	}
+
+	check(histogram.get_max_us() == 0xfff, name, "wrong maximum");
+	check(histogram.get_percentile_us(50.0) >= 0x7ff && histogram.get_percentile_us(50.0) <= 0xfff, name, "median in the wrong bucket");
+
+	histogram.reset();
+	check(histogram.get_count() == 0 && histogram.get_percentile_us(99.0) == 0, name, "reset left values behind");
+}
+
+// Remembers what the debug endpoint asked to change instead of going through vrsettings.
+class RecordingSettingsWriter : public GazeSettingsWriter
+{
+public:
+	bool write_bool(const char* key, const bool value) override
+	{
+		snprintf(last_write_, sizeof(last_write_), "%s=%s", key, value ? "true" : "false");
+		writes_++;
+		return true;
+	}
+
+	bool write_int(const char* key, const int value) override
+	{
+		snprintf(last_write_, sizeof(last_write_), "%s=%d", key, value);
+		writes_++;
+		return true;
+	}
+
+	void commit() override
+	{
+		commits_++;
+	}
+
+	char last_write_[64] = {};
+	int writes_ = 0;
+	int commits_ = 0;
+};
+
+static void test_debug_request(const char* name)
+{
+	PSVR2ServerSimulatorSettings settings;
+	settings.sample_rate_hz_ = 120.0;
+	PSVR2ServerSimulator simulator(settings);
+
+	PSVR2SimulatedTransport* transport = new PSVR2SimulatedTransport(simulator);
+	PSVR2EyeTracker tracker{ std::unique_ptr<PSVR2Transport>(transport) };
+	GazeUpdateLoop loop(tracker);
+	RecordingPublisher publisher;
+
+	ShimConfigStore config_store;
+	ShimConfig config = config_store.get();
+	config.adaptive_polling_ = false;
+	config.polling_rate_ms_ = 1;
+	config_store.publish(config);
+
+	int64_t now_us = 0;
+	transport->set_now_us(now_us);
+	loop.start(config_store.get(), now_us);
+
+	for(int poll = 0; poll < 1000; poll++)
+	{
+		now_us += 1000;
+		transport->set_now_us(now_us);
+		loop.run_once(config_store.get(), now_us, publisher);
+		loop.get_loop_stats().poll_duration_us_.add(poll % 50);
+	}
+
+	RecordingSettingsWriter settings_writer;
+	GazeDebugSources sources;
+	sources.loop_ = &loop;
+	sources.config_store_ = &config_store;
+	sources.settings_writer_ = &settings_writer;
+
+	char response[4096];
+	bool handled = true;
+
+	// Answered from atomics, it may come from any thread at any time
+	run_steady_state(name, TEST_ITERATIONS / 20, [&](const int)
+	{
+		handled = handled && handle_gaze_debug_request(GAZE_DEBUG_REQUEST_PREFIX " stats", response, sizeof(response), sources);
+	});
+
+	check(handled && strstr(response, "\"ok\":true") && strstr(response, "\"connected\":true,\"connects\":1"), name, "stats missing or wrong connection state");
+	check(strstr(response, "\"published\":") && strstr(response, "\"poll_duration_us\":{\"count\":1000") && strstr(response, "\"combinedGaze\":"), name, "stats incomplete");
+
+	// Requests for the real driver must pass through untouched
+	strcpy(response, "untouched");
+	check(!handle_gaze_debug_request("psvr2_shimmy stats", response, sizeof(response), sources) &&
+		!handle_gaze_debug_request("some_driver_command", response, sizeof(response), sources) &&
+		!handle_gaze_debug_request(nullptr, response, sizeof(response), sources) &&
+		strcmp(response, "untouched") == 0, name, "answered a request meant for the real driver");
+
+	handle_gaze_debug_request(GAZE_DEBUG_REQUEST_PREFIX " set pollingRateMs 4", response, sizeof(response), sources);
+	check(strcmp(settings_writer.last_write_, "pollingRateMs=4") == 0 && settings_writer.commits_ == 1, name, "set didn't write the setting");
+
+	handle_gaze_debug_request(GAZE_DEBUG_REQUEST_PREFIX " set pollingRateMs fast", response, sizeof(response), sources);
+	handle_gaze_debug_request(GAZE_DEBUG_REQUEST_PREFIX " set noSuchSetting 1", response, sizeof(response), sources);
+	check(settings_writer.writes_ == 1 && strstr(response, "\"ok\":false"), name, "set accepted a bad request");
+
+	handle_gaze_debug_request(GAZE_DEBUG_REQUEST_PREFIX " mode per_eye raw", response, sizeof(response), sources);
+	check(strcmp(settings_writer.last_write_, "applyCalibration=false") == 0 && settings_writer.writes_ == 4 && settings_writer.commits_ == 2, name, "mode didn't write the gaze settings");
+
+	// Too small for the stats, the answer must still be a whole JSON document
+	char small_response[64];
+	handle_gaze_debug_request(GAZE_DEBUG_REQUEST_PREFIX " stats", small_response, sizeof(small_response), sources);
+	check(strstr(small_response, "buffer too small") != nullptr, name, "truncated response");
+
+	handle_gaze_debug_request(GAZE_DEBUG_REQUEST_PREFIX " reset_stats", response, sizeof(response), sources);
+	check(tracker.get_publish_stats().published_.load() == 0 && loop.get_loop_stats().poll_duration_us_.get_count() == 0 &&
+		loop.get_scheduler().get_cadence_stats().polls_.load() == 0, name, "reset_stats left counters behind");
+}
+
+void run_tests()
+{
+	run_test("latency_histogram", test_latency_histogram);
+	run_test("debug_request", test_debug_request);
+}
@@ -0,0 +1,246 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Tests of the flight recorder's ring and its binary dumps.
+
+#include "gaze_test.h"
+#include "gaze_flight_recorder.h"
+#include "gaze_update_loop.h"
+#include "psvr2_eye_tracking.h"
+#include "psvr2_server_simulator.h"
+
+#include <algorithm>
+#include <memory>
+
+#ifndef _WIN32
+#include <signal.h>
+#endif
+
+using namespace BVR;
+
+static bool read_flight_dump(const char* path, GazeFlightDumpHeader& header, std::vector<GazeFlightRecord>& records)
+{
+	FILE* file = fopen(path, "rb");
+
+	if(!file)
+	{
+		return false;
+	}
+
+	bool success = (fread(&header, sizeof(header), 1, file) == 1) && (header.magic_ == GAZE_FLIGHT_DUMP_MAGIC) &&
+		(header.version_ == GAZE_FLIGHT_DUMP_VERSION) && (header.record_size_ == sizeof(GazeFlightRecord));
+
+	if(success)
+	{
+		records.resize(header.num_records_);
+		success = records.empty() || (fread(records.data(), sizeof(GazeFlightRecord), records.size(), file) == records.size());
+	}
+
+	fclose(file);
+	return success;
+}
+
+static size_t count_flight_records(const std::vector<GazeFlightRecord>& records, const GazeFlightRecordKind kind)
+{
+	return (size_t)std::count_if(records.begin(), records.end(), [kind](const GazeFlightRecord& record) { return record.kind_ == (uint16_t)kind; });
+}
+
+static void test_flight_record_event(const char* name)
+{
+	const std::string directory = get_flight_directory();
+	GazeFlightRecorder* recorder = new GazeFlightRecorder();
+
+	run_steady_state(name, TEST_ITERATIONS, [&](const int index)
+	{
+		recorder->record_event(GazeFlightRecordKind::SETTINGS_, index, (uint32_t)index);
+	});
+
+	check(recorder->get_num_recorded() > GAZE_FLIGHT_RECORDER_CAPACITY, name, "too few records to wrap the ring");
+
+	// Wrapped: the dump holds the newest CAPACITY records, oldest first
+	const std::string path = directory + TEST_FLIGHT_SEPARATOR + "event.psfr";
+	recorder->set_dump_directory(directory.c_str());
+
+	GazeFlightDumpHeader header = {};
+	std::vector<GazeFlightRecord> records;
+	const bool is_read = recorder->dump(GazeFlightDumpReason::REQUEST_, path.c_str()) && read_flight_dump(path.c_str(), header, records);
+	check(is_read && header.total_records_ == recorder->get_num_recorded(), name, "couldn't read the dump back");
+
+	bool is_ordered = (records.size() == GAZE_FLIGHT_RECORDER_CAPACITY);
+
+	for(size_t index = 0; is_ordered && index < records.size(); index++)
+	{
+		is_ordered = (records[index].time_us_ == (int64_t)(header.total_records_ - records.size() + index));
+	}
+
+	check(is_ordered, name, "dump isn't the newest records in order");
+
+	remove(path.c_str());
+	delete recorder;
+}
+
+static void test_flight_record(const char* name)
+{
+	// Fed by the update loop on a virtual clock, like the driver does after every pass
+	PSVR2ServerSimulatorSettings settings;
+	settings.sample_rate_hz_ = 120.0;
+	PSVR2ServerSimulator simulator(settings);
+
+	PSVR2SimulatedTransport* transport = new PSVR2SimulatedTransport(simulator);
+	PSVR2EyeTracker tracker{ std::unique_ptr<PSVR2Transport>(transport) };
+	GazeUpdateLoop loop(tracker);
+	RecordingPublisher publisher;
+
+	ShimConfig config;
+	config.adaptive_polling_ = false;
+	config.polling_rate_ms_ = 1;
+
+	const std::string directory = get_flight_directory();
+	GazeFlightRecorder* recorder = new GazeFlightRecorder();
+	recorder->set_dump_directory(directory.c_str());
+
+	int64_t now_us = 0;
+	transport->set_now_us(now_us);
+	loop.start(config, now_us);
+
+	const auto run_pass = [&](const int64_t lateness_us)
+	{
+		now_us += 1000;
+		loop.run_once(config, now_us, publisher);
+		loop.get_loop_stats().wakeup_lateness_us_.add(lateness_us);
+		loop.get_loop_stats().poll_duration_us_.add(now_us & 0x3f);
+		recorder->record(loop, now_us);
+	};
+
+	run_steady_state(name, TEST_ITERATIONS, [&](const int)
+	{
+		transport->set_now_us(now_us + 1000);
+		run_pass(0);
+	});
+
+	check(recorder->get_num_stalls() == 0 && recorder->get_num_dumps() == 0, name, "stalled on a healthy loop");
+
+	// The server goes quiet (its clock stops) for 400 ms: one stall however many polls it lasts
+	for(int pass = 0; pass < 400; pass++)
+	{
+		run_pass(0);
+	}
+
+	check(recorder->get_num_stalls() == 1, name, "a silent server wasn't one stall");
+
+	// Two late wakeups make three stalls within the window, that's a dump. Three more right after aren't,
+	// stall dumps are rate limited.
+	transport->set_now_us(now_us);
+	run_pass(GAZE_FLIGHT_STALL_US + 1000);
+	run_pass(0);
+	run_pass(GAZE_FLIGHT_STALL_US + 1000);
+
+	// Only flagged, the update thread never writes the file itself
+	check(recorder->get_num_stalls() == 3 && recorder->get_num_dumps() == 0 && recorder->has_pending_dump(), name, "repeated stalls didn't flag a dump");
+	check(recorder->write_pending_dump() && !recorder->has_pending_dump() && recorder->get_num_dumps() == 1, name, "repeated stalls didn't dump");
+	check(!recorder->write_pending_dump(), name, "the stall dump was written twice");
+
+	for(int pass = 0; pass < 3; pass++)
+	{
+		transport->set_now_us(now_us + 1000);
+		run_pass(GAZE_FLIGHT_STALL_US + 1000);
+	}
+
+	check(recorder->get_num_stalls() == 6 && !recorder->has_pending_dump(), name, "stall dumps aren't rate limited");
+
+	const char* path = recorder->get_dump_path(GazeFlightDumpReason::STALLS_);
+	GazeFlightDumpHeader header = {};
+	std::vector<GazeFlightRecord> records;
+	check(read_flight_dump(path, header, records) && header.reason_ == (uint32_t)GazeFlightDumpReason::STALLS_, name, "couldn't read the stall dump back");
+	check(count_flight_records(records, GazeFlightRecordKind::STALL_) == 3 && !records.empty() && records.back().kind_ == (uint16_t)GazeFlightRecordKind::STALL_,
+		name, "stall dump doesn't end with the three stalls");
+
+	bool is_ordered = (header.num_records_ == std::min<uint64_t>(header.total_records_, GAZE_FLIGHT_RECORDER_CAPACITY));
+
+	for(size_t index = 1; is_ordered && index < records.size(); index++)
+	{
+		is_ordered = (records[index].time_us_ >= records[index - 1].time_us_);
+	}
+
+	check(is_ordered, name, "stall dump isn't the newest records in order");
+
+	remove(path);
+	delete recorder;
+}
+
+#ifndef _WIN32
+typedef void (*SignalHandler)(int);
+
+static void foreign_signal_handler(int)
+{
+}
+
+static SignalHandler get_signal_handler(const int signal_number)
+{
+	struct sigaction action = {};
+	sigaction(signal_number, nullptr, &action);
+	return action.sa_handler;
+}
+
+static void test_flight_crash_handler(const char* name)
+{
+	// Uninstalling puts back what was there before, but only where ours is still the one installed. A
+	// handler someone put on top meanwhile may chain to ours, so it stays and ours with it.
+	const SignalHandler original_segv_handler = get_signal_handler(SIGSEGV);
+	const SignalHandler original_bus_handler = get_signal_handler(SIGBUS);
+
+	install_flight_recorder_crash_handler();
+	check(get_signal_handler(SIGSEGV) != original_segv_handler && get_signal_handler(SIGBUS) != original_bus_handler, name, "not installed");
+
+	struct sigaction foreign_action = {};
+	foreign_action.sa_handler = foreign_signal_handler;
+	sigemptyset(&foreign_action.sa_mask);
+
+	struct sigaction our_action = {};
+	sigaction(SIGBUS, &foreign_action, &our_action);
+
+	uninstall_flight_recorder_crash_handler();
+	check(get_signal_handler(SIGSEGV) == original_segv_handler, name, "the previous handler wasn't put back");
+	check(get_signal_handler(SIGBUS) == foreign_signal_handler, name, "a handler installed on top of ours was replaced");
+
+	// Installing again leaves the one still in someone's chain alone, it can't become its own previous handler
+	install_flight_recorder_crash_handler();
+	check(get_signal_handler(SIGBUS) == foreign_signal_handler, name, "installed twice into the same chain");
+
+	// Once theirs is gone ours can go too
+	sigaction(SIGBUS, &our_action, nullptr);
+	uninstall_flight_recorder_crash_handler();
+	check(get_signal_handler(SIGSEGV) == original_segv_handler && get_signal_handler(SIGBUS) == original_bus_handler, name, "the previous handlers weren't put back");
+}
+#endif
+
+void run_tests()
+{
+	run_test("flight_record_event", test_flight_record_event);
+	run_test("flight_record", test_flight_record);
+#ifndef _WIN32
+	run_test("flight_crash_handler", test_flight_crash_handler);
+#endif
+}
@@ -0,0 +1,182 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Tests of the gaze source registry: simulated and replayed sources behind the update loop.
+
+#include "gaze_test.h"
+#include "gaze_replay.h"
+#include "gaze_source.h"
+#include "gaze_update_loop.h"
+#include "psvr2_eye_tracking.h"
+
+#include <memory>
+#include <string>
+
+using namespace BVR;
+
+// Collects the combined gaze of every new sample published.
+class SourcePublisher : public GazePublisher
+{
+public:
+	explicit SourcePublisher(const size_t capacity) { gazes_.reserve(capacity); }
+
+	void publish(const GazeUpdate& update) override
+	{
+		if((update.new_samples_ > 0) && update.is_available_ && (gazes_.size() < gazes_.capacity()))
+		{
+			gazes_.push_back(update.combined_gaze_);
+		}
+	}
+
+	std::vector<XrVector3f> gazes_;
+};
+
+static void test_gaze_sources(const char* name)
+{
+	// Every source is built in, each with an exchange bound to its own transport type
+	for(int type = 0; type < (int)GazeSourceType::NUM_SOURCES_; type++)
+	{
+		const GazeSourceType source = (GazeSourceType)type;
+		const std::unique_ptr<PSVR2Transport> transport = create_gaze_source_transport(source);
+
+		check(is_gaze_source_supported(source), name, "source isn't built in");
+		check(transport->get_exchange_function() != &exchange_messages<PSVR2Transport>, name, "source makes a virtual call per message");
+	}
+
+	// The driver's loop on the simulated source, which runs on the real clock: the gazeSource setting swaps
+	// the tracker's transport and it connects without a server. The flight recorder keeps what was published.
+	const std::string directory = get_flight_directory();
+	const std::string path = directory + TEST_FLIGHT_SEPARATOR + "source.psfr";
+
+	GazeFlightRecorder* recorder = new GazeFlightRecorder();
+	recorder->set_dump_directory(directory.c_str());
+
+	PSVR2EyeTracker tracker;
+	GazeUpdateLoop loop(tracker, true);
+
+	ShimConfig config;
+	config.adaptive_polling_ = false;
+	config.polling_rate_ms_ = 1;
+	config.gaze_source_ = (int)GazeSourceType::SIMULATED_;
+
+	// Until the publisher got that many gazes, however long the machine takes
+	const auto run_until = [&](SourcePublisher& publisher, const size_t num_gazes)
+	{
+		const int64_t deadline_us = get_steady_time_us() + TEST_DEADLINE_US;
+		loop.start(config, get_steady_time_us());
+
+		while((publisher.gazes_.size() < num_gazes) && (get_steady_time_us() < deadline_us))
+		{
+			const int64_t now_us = get_steady_time_us();
+			loop.run_once(config, now_us, publisher);
+			recorder->record(loop, now_us);
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	};
+
+	SourcePublisher simulated(1000);
+	run_until(simulated, 40);
+
+	check(loop.get_loop_stats().gaze_source_.load() == (int)GazeSourceType::SIMULATED_ && tracker.is_connected(), name, "loop isn't on the simulated source");
+	check(simulated.gazes_.size() >= 40, name, "simulated source published nothing");
+	check(recorder->dump(GazeFlightDumpReason::REQUEST_, path.c_str()), name, "couldn't dump the simulated run");
+
+	// The dump played back on a set clock: each recorded sample at its time, again one pass later
+	{
+		std::vector<GazeFlightRecord> samples;
+		GazeReplayTransport replay;
+
+		bool is_exact = read_flight_dump_samples(path.c_str(), samples) && replay.open(path.c_str()) && (replay.get_num_samples() == samples.size());
+
+		for(int pass = 0; pass < 2; pass++)
+		{
+			for(size_t index = 0; is_exact && index < samples.size(); index++)
+			{
+				replay.set_now_us(pass * replay.get_duration_us() + samples[index].time_us_ - samples[0].time_us_);
+
+				const Request request(GET_GAZES_);
+				SequencedResponse response;
+				size_t size_read = 0;
+
+				is_exact = replay.send(&request, sizeof(request)) && replay.receive(&response, sizeof(response), size_read) &&
+					(response.sequence_number_ == pass * samples.size() + index + 1) &&
+					(memcmp(&response.gazes_.combined_gaze_.direction_, samples[index].combined_gaze_, sizeof(samples[index].combined_gaze_)) == 0);
+			}
+		}
+
+		check(is_exact, name, "replay doesn't serve the recorded samples at their times");
+	}
+
+	// Then the same loop switched to replaying it: everything it publishes was recorded
+	{
+		config.gaze_source_ = (int)GazeSourceType::REPLAY_;
+		config.set_replay_file(path.c_str());
+
+		SourcePublisher replayed(1000);
+		run_until(replayed, 20);
+
+		size_t matched = 0;
+
+		for(const XrVector3f& gaze : replayed.gazes_)
+		{
+			for(const XrVector3f& recorded : simulated.gazes_)
+			{
+				if(fabsf(gaze.x - recorded.x) + fabsf(gaze.y - recorded.y) + fabsf(gaze.z - recorded.z) < 1.0e-5f)
+				{
+					matched++;
+					break;
+				}
+			}
+		}
+
+		check(loop.get_loop_stats().gaze_source_.load() == (int)GazeSourceType::REPLAY_ && tracker.is_connected(), name, "loop isn't on the replay source");
+		check(replayed.gazes_.size() >= 20 && matched == replayed.gazes_.size(), name, "replay published gazes that weren't recorded");
+	}
+
+	// Polling the replay source, through the tracker
+	{
+		GazeReplayTransport* replay = new GazeReplayTransport();
+		PSVR2EyeTracker replay_tracker{ std::unique_ptr<PSVR2Transport>(replay) };
+		replay_tracker.set_server_pipe_name(path.c_str());
+		replay->set_now_us(0);
+
+		check(replay_tracker.connect(), name, "tracker couldn't open the replay");
+
+		run_steady_state(name, TEST_ITERATIONS, [&](const int index)
+		{
+			replay->set_now_us((int64_t)index * 1000);
+			replay_tracker.update_gazes();
+		});
+	}
+
+	remove(path.c_str());
+	delete recorder;
+}
+
+void run_tests()
+{
+	run_test("gaze_sources", test_gaze_sources);
+}
@@ -0,0 +1,229 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Tests of the portable vector math and the SIMD batch kernels, against their scalar references.
+
+#include "gaze_test.h"
+#include "gaze_batch.h"
+#include "gaze_math.h"
+
+#include <algorithm>
+
+using namespace BVR;
+
+static void test_math(const char* name)
+{
+	// Rotating forward by yaw / pitch has a closed form to compare against
+	double max_error = 0.0;
+
+	for(int index = 0; index < 64; index++)
+	{
+		const float yaw = (float)(index - 32) * 0.05f;
+		const float pitch = (float)((index * 7) % 64 - 32) * 0.04f;
+
+		const GazeQuaternion rotation = gaze_quaternion_from_yaw_pitch(yaw, pitch);
+		const XrVector3f rotated = gaze_vector_store(gaze_quaternion_rotate(rotation, gaze_vector_forward()));
+		const XrVector3f expected = { -sinf(yaw) * cosf(pitch), sinf(pitch), -cosf(yaw) * cosf(pitch) };
+
+		// And back again through the shortest arc
+		const GazeQuaternion arc = gaze_quaternion_from_forward(gaze_vector_load(expected));
+		const XrVector3f arc_rotated = gaze_vector_store(gaze_quaternion_rotate(arc, gaze_vector_forward()));
+
+		max_error = std::max(max_error, (double)fabsf(rotated.x - expected.x) + fabsf(rotated.y - expected.y) + fabsf(rotated.z - expected.z));
+		max_error = std::max(max_error, (double)fabsf(arc_rotated.x - expected.x) + fabsf(arc_rotated.y - expected.y) + fabsf(arc_rotated.z - expected.z));
+	}
+
+	check(max_error < 1.0e-5, name, "rotation doesn't match the closed form");
+}
+
+static bool is_same_batch(const GazeBatch& a, const GazeBatch& b)
+{
+	const size_t size = a.size();
+
+	return (size == b.size()) &&
+		(memcmp(a.x(), b.x(), size * sizeof(float)) == 0) &&
+		(memcmp(a.y(), b.y(), size * sizeof(float)) == 0) &&
+		(memcmp(a.z(), b.z(), size * sizeof(float)) == 0) &&
+		(memcmp(a.valid(), b.valid(), size * sizeof(uint32_t)) == 0);
+}
+
+// Per eye gazes of every sample, plus the inputs the kernels have to get right: not a number, infinite,
+// zero, tiny, overflowing, and pairs at 0, 90 and 180 degrees. The odd size leaves a tail for the scalar code.
+static void make_batches(const std::vector<AllXRGazeStates>& samples, GazeBatch& left, GazeBatch& right)
+{
+	for(const AllXRGazeStates& sample : samples)
+	{
+		left.push_back(sample.per_eye_gazes_[LEFT]);
+		right.push_back(sample.per_eye_gazes_[RIGHT]);
+	}
+
+	const float infinity = std::numeric_limits<float>::infinity();
+	const float not_a_number = std::numeric_limits<float>::quiet_NaN();
+
+	const XrVector3f edge_cases[][2] =
+	{
+		{ { not_a_number, 0.0f, -1.0f }, { 0.0f, 0.0f, -1.0f } },
+		{ { 0.0f, infinity, -1.0f }, { 0.0f, 0.0f, -1.0f } },
+		{ { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, -1.0f } },
+		{ { 1.0e-7f, 0.0f, 0.0f }, { 1.0e-5f, 0.0f, 0.0f } },
+		{ { 1.0e30f, 1.0e30f, 0.0f }, { 0.0f, 0.0f, -1.0f } },
+		{ { 0.3f, -0.2f, -1.0f }, { 0.3f, -0.2f, -1.0f } },
+		{ { 0.3f, -0.2f, -1.0f }, { -0.3f, 0.2f, 1.0f } },
+		{ { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, -1.0f } },
+		{ { -0.0f, -0.0f, -2.0f }, { 0.001f, 0.0f, -1.0f } },
+	};
+
+	for(const auto& edge_case : edge_cases)
+	{
+		XRGazeState gaze;
+		gaze.is_valid_ = true;
+
+		gaze.direction_ = edge_case[0];
+		left.push_back(gaze);
+
+		gaze.direction_ = edge_case[1];
+		right.push_back(gaze);
+	}
+}
+
+static void test_batch(const char* name)
+{
+	const std::vector<AllXRGazeStates> samples = make_samples();
+	const float matrix[9] = { 1.02f, 0.01f, 0.0f, -0.01f, 0.98f, 0.02f, 0.0f, 0.0f, 1.0f };
+
+	GazeBatch source_left;
+	GazeBatch source_right;
+	make_batches(samples, source_left, source_right);
+
+	const size_t size = source_left.size();
+
+	// Scalar reference: reject, normalize, calibrate, and the angle between the eyes
+	GazeBatch reference_left = source_left;
+	GazeBatch reference_right = source_right;
+	std::vector<float> reference_radians(size);
+
+	gaze_batch_reject_invalid(reference_left, GazeSimdBackend::SCALAR_);
+	gaze_batch_reject_invalid(reference_right, GazeSimdBackend::SCALAR_);
+	const GazeBatch rejected_left = reference_left;
+
+	gaze_batch_normalize(reference_left, GazeSimdBackend::SCALAR_);
+	gaze_batch_normalize(reference_right, GazeSimdBackend::SCALAR_);
+	const GazeBatch normalized_left = reference_left;
+
+	gaze_batch_apply_calibration(matrix, reference_left, GazeSimdBackend::SCALAR_);
+	gaze_batch_angular_distance(reference_left, reference_right, reference_radians.data(), GazeSimdBackend::SCALAR_);
+
+	// The scalar reference itself against the single gaze code and libm
+	GazeCalibration calibration;
+	calibration.set_matrix(matrix);
+
+	bool matches_calibration = true;
+	double max_angle_error = 0.0;
+	size_t num_rejected = 0;
+
+	// Blinks and the first five edge cases
+	const size_t expected_rejected = 5 + (size_t)std::count_if(samples.begin(), samples.end(), [](const AllXRGazeStates& sample) { return !sample.per_eye_gazes_[LEFT].is_valid_; });
+
+	for(size_t index = 0; index < size; index++)
+	{
+		if(!reference_left.is_valid(index) || !reference_right.is_valid(index))
+		{
+			num_rejected++;
+			matches_calibration = matches_calibration && isnan(reference_radians[index]);
+			continue;
+		}
+
+		const XrVector3f expected = calibration.apply_calibration(normalized_left.get(index).direction_);
+		const XrVector3f actual = reference_left.get(index).direction_;
+		matches_calibration = matches_calibration && (memcmp(&expected, &actual, sizeof(expected)) == 0);
+
+		const XrVector3f a = reference_left.get(index).direction_;
+		const XrVector3f b = reference_right.get(index).direction_;
+		const double cx = (double)a.y * b.z - (double)a.z * b.y;
+		const double cy = (double)a.z * b.x - (double)a.x * b.z;
+		const double cz = (double)a.x * b.y - (double)a.y * b.x;
+		const double dot = (double)a.x * b.x + (double)a.y * b.y + (double)a.z * b.z;
+		const double angle = atan2(sqrt(cx * cx + cy * cy + cz * cz), dot);
+
+		max_angle_error = std::max(max_angle_error, fabs(angle - (double)reference_radians[index]));
+	}
+
+	check(num_rejected == expected_rejected, name, "scalar: wrong number of rejected gazes");
+	check(matches_calibration, name, "scalar: differs from GazeCalibration::apply_calibration");
+	check(max_angle_error < 1.0e-6, name, "scalar: inaccurate angle");
+
+	const GazeSimdBackend backends[] = { GazeSimdBackend::SCALAR_, GazeSimdBackend::SSE_, GazeSimdBackend::AVX2_ };
+
+	for(const GazeSimdBackend backend : backends)
+	{
+		if(!is_gaze_simd_backend_supported(backend))
+		{
+			continue;
+		}
+
+		const std::string suffix = get_gaze_simd_backend_name(backend);
+		const std::string reject_what = suffix + ": reject_invalid differs from scalar";
+		const std::string normalize_what = suffix + ": normalize differs from scalar";
+		const std::string calibration_what = suffix + ": apply_calibration differs from scalar";
+		const std::string distance_what = suffix + ": angular_distance differs from scalar";
+
+		// Bit for bit against the scalar reference, on the whole batch
+		GazeBatch left = source_left;
+		GazeBatch right = source_right;
+		std::vector<float> radians(size);
+
+		gaze_batch_reject_invalid(left, backend);
+		gaze_batch_reject_invalid(right, backend);
+		check(is_same_batch(left, rejected_left), name, reject_what.c_str());
+
+		gaze_batch_normalize(left, backend);
+		gaze_batch_normalize(right, backend);
+		check(is_same_batch(left, normalized_left) && is_same_batch(right, reference_right), name, normalize_what.c_str());
+
+		gaze_batch_apply_calibration(matrix, left, backend);
+		check(is_same_batch(left, reference_left), name, calibration_what.c_str());
+
+		gaze_batch_angular_distance(left, right, radians.data(), backend);
+		check(memcmp(radians.data(), reference_radians.data(), size * sizeof(float)) == 0, name, distance_what.c_str());
+
+		// Copying into a batch of the same size reuses its storage, the kernels themselves never allocate
+		GazeBatch work_left = source_left;
+
+		run_steady_state(name, TEST_ITERATIONS / 100, [&](const int)
+		{
+			work_left = source_left;
+			gaze_batch_reject_invalid(work_left, backend);
+			gaze_batch_normalize(work_left, backend);
+			gaze_batch_apply_calibration(matrix, work_left, backend);
+			gaze_batch_angular_distance(work_left, reference_right, radians.data(), backend);
+		});
+	}
+}
+
+void run_tests()
+{
+	run_test("math", test_math);
+	run_test("batch", test_batch);
+}
@@ -0,0 +1,94 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Tests of the specialized gaze pipelines against each other, and the calibration matrices.
+
+#include "gaze_test.h"
+#include "gaze_calibration.h"
+#include "gaze_pipeline.h"
+
+using namespace BVR;
+
+static void test_pipelines(const char* name)
+{
+	const std::vector<AllXRGazeStates> samples = make_samples();
+
+	GazeCalibration calibrations[NUM_CALIBRATIONS];
+	const float matrix[9] = { 1.02f, 0.01f, 0.0f, -0.01f, 0.98f, 0.02f, 0.0f, 0.0f, 1.0f };
+
+	for(GazeCalibration& calibration : calibrations)
+	{
+		calibration.set_matrix(matrix);
+	}
+
+	GazeSanitizer sanitizer;
+	const GazePipelineContext context = { calibrations, &sanitizer };
+
+	for(uint32_t flags = 0; flags < 8; flags++)
+	{
+		const GazePipelineFunction pipeline = select_gaze_pipeline(flags);
+		GazeFrame frame;
+		uint64_t valid = 0;
+
+		run_steady_state(name, TEST_ITERATIONS / 4, [&](const int index)
+		{
+			pipeline(samples[index % TEST_NUM_SAMPLES], context, frame);
+			valid += frame.combined_gaze_.is_valid_ + frame.per_eye_gazes_[LEFT].is_valid_ + frame.per_eye_gazes_[RIGHT].is_valid_;
+		});
+
+		const bool has_combined = (flags & GAZE_PIPELINE_COMBINED) != 0;
+		const bool has_per_eye = (flags & GAZE_PIPELINE_PER_EYE) != 0;
+
+		check((valid != 0) == (has_combined || has_per_eye), name, "gazes produced by a pipeline without that stage");
+	}
+}
+
+static void test_calibration(const char* name)
+{
+	const std::vector<AllXRGazeStates> samples = make_samples();
+
+	GazeCalibration calibration;
+	const float matrix[9] = { 1.02f, 0.01f, 0.0f, -0.01f, 0.98f, 0.02f, 0.0f, 0.0f, 1.0f };
+	calibration.set_matrix(matrix);
+
+	float min_length = 2.0f;
+	float max_length = 0.0f;
+
+	for(const AllXRGazeStates& sample : samples)
+	{
+		const XrVector3f corrected = calibration.apply_calibration(sample.combined_gaze_.direction_);
+		const float length = sqrtf(corrected.x * corrected.x + corrected.y * corrected.y + corrected.z * corrected.z);
+		min_length = (length < min_length) ? length : min_length;
+		max_length = (length > max_length) ? length : max_length;
+	}
+
+	check((min_length > 0.999f) && (max_length < 1.001f), name, "result not normalized");
+}
+
+void run_tests()
+{
+	run_test("pipelines", test_pipelines);
+	run_test("calibration", test_calibration);
+}
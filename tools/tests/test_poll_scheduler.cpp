@@ -0,0 +1,82 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Tests of poll scheduling from the observed server cadence.
+
+#include "gaze_test.h"
+#include "gaze_poll_scheduler.h"
+
+using namespace BVR;
+
+static void test_poll_scheduler_stall(const char* name)
+{
+	// A 120 Hz server on a virtual clock, polled wherever the scheduler asks
+	const int64_t period_us = 8333;
+
+	GazePollSettings settings;
+	settings.adaptive_ = true;
+
+	GazePollScheduler scheduler;
+	scheduler.set_settings(settings);
+	scheduler.start(0);
+
+	int64_t last_poll_us = 0;
+
+	while(last_poll_us < 2000000)
+	{
+		const int64_t now_us = scheduler.get_next_poll_time_us();
+		const uint64_t new_samples = (uint64_t)((now_us / period_us) - (last_poll_us / period_us));
+
+		scheduler.on_poll(now_us, true, new_samples);
+		last_poll_us = now_us;
+	}
+
+	check(scheduler.get_cadence_estimator().is_locked(), name, "didn't lock on to the server cadence");
+
+	// Then the server stops producing: a quick retry, half a period, and the fixed interval from there on
+	const int64_t half_period_us = period_us / 2;
+	int64_t gaps_us[6] = {};
+
+	for(int64_t& gap_us : gaps_us)
+	{
+		const int64_t now_us = scheduler.get_next_poll_time_us();
+		scheduler.on_poll(now_us, true, 0);
+
+		gap_us = scheduler.get_next_poll_time_us() - now_us;
+	}
+
+	check(gaps_us[0] < half_period_us, name, "first empty poll wasn't retried right away");
+	check(labs((long)(gaps_us[1] - half_period_us)) <= (half_period_us / 20), name, "second empty poll didn't back off to half a period");
+
+	for(int index = 2; index < 6; index++)
+	{
+		check(gaps_us[index] >= settings.active_interval_us_, name, "stalled server polled faster than the fixed interval");
+	}
+}
+
+void run_tests()
+{
+	run_test("poll_scheduler_stall", test_poll_scheduler_stall);
+}
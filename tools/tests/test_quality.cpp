@@ -0,0 +1,143 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Tests of the sliding window gaze quality metrics and the adaptive smoothing they drive.
+
+#include "gaze_test.h"
+#include "gaze_math.h"
+#include "gaze_quality.h"
+
+using namespace BVR;
+
+// A 120 Hz stream with a known quality: fixations jittering by exactly TEST_QUALITY_JITTER_DEG from one
+// sample to the next, a 10 degree saccade every TEST_QUALITY_PERIOD samples and a dropout of
+// TEST_QUALITY_DROPOUT samples in each period.
+#define TEST_QUALITY_INTERVAL_US 8333
+#define TEST_QUALITY_PERIOD 240
+#define TEST_QUALITY_DROPOUT_START 100
+#define TEST_QUALITY_DROPOUT 12
+#define TEST_QUALITY_JITTER_DEG 0.5f
+
+static XRGazeState make_quality_sample(const int index)
+{
+	const float degrees_to_radians = 0.0174532925f;
+	const int period = index / TEST_QUALITY_PERIOD;
+	const int position = index % TEST_QUALITY_PERIOD;
+
+	const float yaw_deg = (float)((period % 3) * 10) + (((index & 1) != 0) ? 0.5f : -0.5f) * TEST_QUALITY_JITTER_DEG;
+
+	XRGazeState gaze;
+	gaze.direction_ = gaze_vector_store(gaze_quaternion_rotate(gaze_quaternion_from_yaw_pitch(yaw_deg * degrees_to_radians, 0.0f), gaze_vector_forward()));
+	gaze.is_valid_ = (position < TEST_QUALITY_DROPOUT_START) || (position >= TEST_QUALITY_DROPOUT_START + TEST_QUALITY_DROPOUT);
+
+	return gaze;
+}
+
+static void test_quality_monitor(const char* name)
+{
+	GazeQualityMonitor monitor;
+
+	run_steady_state(name, TEST_ITERATIONS, [&](const int index)
+	{
+		const int64_t time_us = (int64_t)index * TEST_QUALITY_INTERVAL_US;
+		monitor.add_sample(time_us, make_quality_sample(index));
+		monitor.update(time_us);
+	});
+
+	// A fresh one over a known stretch: the last dropout is well inside the window at the end
+	monitor.reset();
+	const int num_samples = 4 * TEST_QUALITY_PERIOD + 160;
+	int64_t time_us = 0;
+
+	for(int index = 0; index < num_samples; index++)
+	{
+		time_us = (int64_t)index * TEST_QUALITY_INTERVAL_US;
+		monitor.add_sample(time_us, make_quality_sample(index));
+		monitor.update(time_us);
+	}
+
+	const GazeQualityStats& stats = monitor.get_stats();
+	const float expected_validity = (float)(TEST_QUALITY_PERIOD - TEST_QUALITY_DROPOUT) / TEST_QUALITY_PERIOD;
+	const int64_t expected_dropout_us = (int64_t)(TEST_QUALITY_DROPOUT + 1) * TEST_QUALITY_INTERVAL_US;
+
+	check(fabsf(stats.sample_rate_hz_.load() - 1000000.0f / TEST_QUALITY_INTERVAL_US) < 1.0f, name, "wrong sample rate");
+	check(fabsf(stats.precision_rms_deg_.load() - TEST_QUALITY_JITTER_DEG) < 0.01f, name, "precision isn't the jitter, or counted the saccades");
+	check(fabsf(stats.validity_ratio_.load() - expected_validity) < 0.02f, name, "wrong validity ratio");
+	check(stats.dropouts_.load() == 1 && stats.longest_dropout_us_.load() == expected_dropout_us && stats.current_dropout_us_.load() == 0, name, "wrong dropouts");
+
+	// A dropout in progress counts, and the window forgets everything once it slid past
+	const XRGazeState invalid;
+	monitor.add_sample(time_us + TEST_QUALITY_INTERVAL_US, invalid);
+	monitor.update(time_us + 500000);
+	check(stats.current_dropout_us_.load() == 500000 && stats.longest_dropout_us_.load() == 500000, name, "ongoing dropout not counted");
+
+	monitor.update(time_us + 2 * GAZE_QUALITY_WINDOW_US);
+	check(stats.sample_rate_hz_.load() == 0.0f && stats.precision_rms_deg_.load() == 0.0f && stats.dropouts_.load() == 0, name, "window didn't slide");
+}
+
+static void test_adaptive_smoothing(const char* name)
+{
+	check(GazeSmoother::get_alpha(GAZE_SMOOTHING_GOOD_PRECISION_DEG) == 1.0f && GazeSmoother::get_alpha(2.0f * GAZE_SMOOTHING_POOR_PRECISION_DEG) == GAZE_SMOOTHING_MIN_ALPHA,
+		name, "alpha doesn't follow precision");
+
+	// Through the smoother at its strongest, the jitter has to shrink and a saccade has to come through whole
+	GazeSmoother smoother;
+	GazeQualityMonitor smoothed_quality;
+	float saccade_error_deg = 0.0f;
+	int64_t last_time_us = 0;
+
+	run_steady_state(name, TEST_ITERATIONS, [&](const int index)
+	{
+		const XRGazeState gaze = make_quality_sample(index);
+		last_time_us = (int64_t)index * TEST_QUALITY_INTERVAL_US;
+
+		if(!gaze.is_valid_)
+		{
+			smoother.reset();
+			return;
+		}
+
+		XRGazeState smoothed = gaze;
+		smoothed.direction_ = smoother.apply(gaze.direction_, GAZE_SMOOTHING_MIN_ALPHA);
+
+		if((index % TEST_QUALITY_PERIOD) == 0)
+		{
+			saccade_error_deg = std::max(saccade_error_deg, get_gaze_angle_deg(smoothed.direction_, gaze.direction_));
+		}
+
+		smoothed_quality.add_sample(last_time_us, smoothed);
+	});
+
+	smoothed_quality.update(last_time_us);
+
+	check(smoothed_quality.get_precision_rms_deg() < 0.5f * TEST_QUALITY_JITTER_DEG, name, "didn't reduce the jitter");
+	check(saccade_error_deg == 0.0f, name, "lagged behind a saccade");
+}
+
+void run_tests()
+{
+	run_test("quality_monitor", test_quality_monitor);
+	run_test("adaptive_smoothing", test_adaptive_smoothing);
+}
@@ -0,0 +1,146 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Tests of the shared reactor thread feeding every attached device.
+
+#include "gaze_test.h"
+#include "gaze_reactor.h"
+
+#include <atomic>
+
+using namespace BVR;
+
+// Counts what the reactor thread hands it, read from the test's thread.
+class CountingPublisher : public GazePublisher
+{
+public:
+	void publish(const GazeUpdate& update) override
+	{
+		publishes_.fetch_add(1, std::memory_order_relaxed);
+
+		if(update.new_samples_ > 0)
+		{
+			new_samples_.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	std::atomic<uint64_t> publishes_ = 0;
+	std::atomic<uint64_t> new_samples_ = 0;
+};
+
+// The simulated source on a fixed 1 ms cadence, nothing leaving the process.
+static void publish_reactor_config(ShimConfigStore& config_store)
+{
+	ShimConfig config;
+	config.gaze_source_ = (int)GazeSourceType::SIMULATED_;
+	config.adaptive_polling_ = false;
+	config.polling_rate_ms_ = 1;
+	config.telemetry_enabled_ = false;
+	config.broadcast_enabled_ = false;
+	config.generation_++;
+	config_store.publish(config);
+}
+
+static void test_gaze_reactor(const char* name)
+{
+	ShimConfigStore config_store;
+	publish_reactor_config(config_store);
+
+	GazeReactor reactor(config_store);
+	CountingPublisher first;
+	CountingPublisher second;
+
+	// The first attach starts the thread, the second one only joins the fan-out
+	check(reactor.attach(first) == 1 && reactor.is_running(), name, "first attach didn't start the reactor");
+	check(reactor.attach(second) == 2 && reactor.attach(second) == 2, name, "attaching twice counted twice");
+
+	check(wait_for([&]() { return first.new_samples_.load() > 10 && second.new_samples_.load() > 10; }), name, "not every publisher got the samples");
+
+	GazeUpdateLoop& loop = reactor.get_loop();
+	check(loop.get_loop_stats().gaze_source_.load() == (int)GazeSourceType::SIMULATED_ && loop.get_loop_stats().connects_.load() == 1, name, "more than one connection for two publishers");
+
+	// A device activating next to a running reactor
+	{
+		CountingPublisher third;
+
+		run_steady_state(name, TEST_ITERATIONS / 10, [&](const int)
+		{
+			reactor.attach(third);
+			reactor.detach(third);
+		});
+
+		check(reactor.get_num_attached() == 2, name, "attach and detach didn't balance");
+	}
+
+	// Detaching one keeps the other fed
+	check(reactor.detach(first) == 1 && reactor.is_running(), name, "detaching one publisher stopped the reactor");
+
+	{
+		const uint64_t first_publishes = first.publishes_.load();
+		const uint64_t second_samples = second.new_samples_.load();
+
+		check(wait_for([&]() { return second.new_samples_.load() > second_samples + 10; }), name, "remaining publisher starved");
+		check(first.publishes_.load() == first_publishes, name, "detached publisher still published to");
+	}
+
+	// The last one stops the thread and closes the connection
+	check(reactor.detach(second) == 0 && !reactor.is_running() && !reactor.get_tracker().is_connected(), name, "last detach left the reactor running");
+	check(reactor.detach(second) == 0, name, "detaching twice went negative");
+
+	{
+		const uint64_t second_publishes = second.publishes_.load();
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		check(second.publishes_.load() == second_publishes, name, "published after the last detach");
+	}
+
+	// And a later activation brings it back
+	{
+		const uint64_t first_samples = first.new_samples_.load();
+
+		check(reactor.attach(first) == 1 && reactor.is_running(), name, "reattach didn't restart the reactor");
+		check(wait_for([&]() { return first.new_samples_.load() > first_samples + 10; }), name, "restarted reactor didn't publish");
+		check(reactor.detach(first) == 0 && !reactor.is_running(), name, "reactor didn't stop again");
+	}
+
+	// Devices that never deactivated, the driver's Cleanup stops the thread before the reactor goes away
+	{
+		check(reactor.attach(first) == 1 && reactor.attach(second) == 2, name, "reattach after a stop failed");
+		reactor.stop();
+
+		const uint64_t first_publishes = first.publishes_.load();
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+		check(!reactor.is_running() && (reactor.get_num_attached() == 0) && !reactor.get_tracker().is_connected(), name, "stop left the reactor running");
+		check(first.publishes_.load() == first_publishes, name, "published after stop");
+
+		reactor.stop();
+		check(reactor.detach(first) == 0, name, "detach after stop went negative");
+	}
+}
+
+void run_tests()
+{
+	run_test("gaze_reactor", test_gaze_reactor);
+}
@@ -0,0 +1,230 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Tests of the sanitization stage, fed hostile input.
+
+#include "gaze_test.h"
+#include "gaze_math.h"
+#include "gaze_pipeline.h"
+#include "gaze_sanitizer.h"
+
+using namespace BVR;
+
+// Deterministic and allocation free, for generating inputs inside loops.
+struct TestRandom
+{
+	uint64_t state_ = 0x9e3779b97f4a7c15ull;
+
+	uint32_t next()
+	{
+		state_ ^= state_ << 13;
+		state_ ^= state_ >> 7;
+		state_ ^= state_ << 17;
+		return (uint32_t)(state_ >> 32);
+	}
+
+	// [0, 1)
+	float next_float() { return (float)(next() >> 8) / 16777216.0f; }
+};
+
+// What a misbehaving server might send: mostly a slowly wandering gaze, sometimes a little off unit length,
+// and now and then NaN, Inf, zero, huge, or a jump no eye could make.
+static XRGazeState make_hostile_gaze(TestRandom& random, XrVector3f& wander)
+{
+	wander.x += (random.next_float() - 0.5f) * 0.01f;
+	wander.y += (random.next_float() - 0.5f) * 0.01f;
+	wander.x = std::max(-0.5f, std::min(0.5f, wander.x));
+	wander.y = std::max(-0.5f, std::min(0.5f, wander.y));
+
+	XRGazeState gaze;
+	gaze.direction_ = gaze_vector_store(gaze_vector_normalize3(gaze_vector_set(wander.x, wander.y, -1.0f, 0.0f)));
+	gaze.is_valid_ = (random.next() % 16) != 0;
+
+	const uint32_t kind = random.next() % 64;
+	const float infinity = std::numeric_limits<float>::infinity();
+
+	switch(kind)
+	{
+		case 0: gaze.direction_.x = std::numeric_limits<float>::quiet_NaN(); break;
+		case 1: gaze.direction_.y = infinity; break;
+		case 2: gaze.direction_.z = -infinity; break;
+		case 3: gaze.direction_ = { 0.0f, 0.0f, 0.0f }; break;
+		case 4: gaze.direction_ = { 1.0e30f, 1.0e30f, 1.0e30f }; break;
+		case 5: gaze.direction_ = { -gaze.direction_.x, -gaze.direction_.y, -gaze.direction_.z }; break; // Backwards
+		case 6: gaze.direction_ = { 1.0f, 0.0f, 0.0f }; break;                                        // 90 degrees off
+		default:
+		{
+			if(kind < 24)
+			{
+				// Not quite unit length
+				const float scale = 0.7f + random.next_float() * 0.8f;
+				gaze.direction_ = { gaze.direction_.x * scale, gaze.direction_.y * scale, gaze.direction_.z * scale };
+			}
+			break;
+		}
+	}
+
+	return gaze;
+}
+
+static bool is_sane_length(const float length)
+{
+	return (length >= GAZE_SANITIZE_MIN_LENGTH) && (length <= GAZE_SANITIZE_MAX_LENGTH);
+}
+
+static void test_sanitizer(const char* name)
+{
+	// Properties over a long hostile stream: every output is a finite unit vector, nothing invalid comes out
+	// valid, accepted gazes never move faster than allowed unless the rejection cap was hit, and every
+	// garbage direction claimed valid got counted.
+	{
+		GazeSanitizer sanitizer;
+		TestRandom random;
+		XrVector3f wander = { 0.0f, 0.0f, -1.0f };
+
+		const float max_angle_per_sample_deg = GAZE_SANITIZE_MAX_DEG_PER_S / GAZE_SANITIZE_SAMPLE_RATE_HZ;
+		uint64_t non_unit = 0;
+		uint64_t invalid_accepted = 0;
+		uint64_t too_fast_accepted = 0;
+		uint64_t expected_non_finite = 0;
+		uint64_t accepted = 0;
+
+		bool has_last = false;
+		XrVector3f last = {};
+		uint64_t samples_since_last = 0;
+		int rejections = 0;
+
+		for(int index = 0; index < 200000; index++)
+		{
+			const XRGazeState input = make_hostile_gaze(random, wander);
+			const uint64_t sample_delta = 1 + (random.next() % 8 == 0);
+			const XRGazeState output = sanitizer.sanitize(COMBINED_CALIBRATION_INDEX, input, sample_delta);
+
+			const float input_length = gaze_vector_length3(gaze_vector_load(input.direction_));
+			const float output_length = gaze_vector_length3(gaze_vector_load(output.direction_));
+			const bool is_input_sane = is_sane_length(input_length);
+
+			non_unit += !(fabsf(output_length - 1.0f) < 1.0e-5f);
+			invalid_accepted += output.is_valid_ && !(input.is_valid_ && is_input_sane);
+			expected_non_finite += input.is_valid_ && !is_input_sane;
+
+			samples_since_last = std::min<uint64_t>(samples_since_last + sample_delta, GAZE_SANITIZE_MAX_SAMPLES_SINCE_VALID);
+
+			if(output.is_valid_)
+			{
+				if(has_last && get_gaze_angle_deg(last, output.direction_) > max_angle_per_sample_deg * samples_since_last)
+				{
+					// Only allowed once the sanitizer gave up on the old direction
+					too_fast_accepted += (rejections < GAZE_SANITIZE_MAX_REJECTIONS);
+				}
+
+				has_last = true;
+				last = output.direction_;
+				samples_since_last = 0;
+				rejections = 0;
+				accepted++;
+			}
+			else if(input.is_valid_ && is_input_sane)
+			{
+				rejections++;
+			}
+		}
+
+		const GazeSanitizeStats& stats = sanitizer.get_stats();
+
+		check(non_unit == 0, name, "output direction not a finite unit vector");
+		check(invalid_accepted == 0, name, "invalid or garbage input came out valid");
+		check(too_fast_accepted == 0, name, "accepted a gaze moving faster than an eye can");
+		check(stats.non_finite_.load() == expected_non_finite && stats.too_fast_.load() > 0 && stats.renormalized_.load() > 0, name, "wrong rejection counters");
+		check(accepted > 150000, name, "rejected too much of a mostly sane stream");
+	}
+
+	// The median filter takes out a single sample spike entirely, and lets a real step through one sample late
+	{
+		GazeSanitizer sanitizer;
+		sanitizer.set_median_filter(true);
+
+		XRGazeState steady;
+		steady.direction_ = { 0.0f, 0.0f, -1.0f };
+		steady.is_valid_ = true;
+
+		XRGazeState spike = steady;
+		spike.direction_ = gaze_vector_store(gaze_quaternion_rotate(gaze_quaternion_from_yaw_pitch(0.1f, 0.0f), gaze_vector_forward()));
+
+		float spike_error_deg = 0.0f;
+		const XRGazeState sequence[] = { steady, steady, steady, spike, steady, steady };
+
+		for(const XRGazeState& gaze : sequence)
+		{
+			spike_error_deg = std::max(spike_error_deg, get_gaze_angle_deg(sanitizer.sanitize(LEFT_CALIBRATION_INDEX, gaze, 1).direction_, steady.direction_));
+		}
+
+		check(spike_error_deg == 0.0f && sanitizer.get_stats().spikes_.load() == 1, name, "median filter let a spike through");
+
+		const XRGazeState first_step = sanitizer.sanitize(LEFT_CALIBRATION_INDEX, spike, 1);
+		const XRGazeState second_step = sanitizer.sanitize(LEFT_CALIBRATION_INDEX, spike, 1);
+
+		check(get_gaze_angle_deg(first_step.direction_, steady.direction_) == 0.0f && get_gaze_angle_deg(second_step.direction_, spike.direction_) < 1.0e-3f,
+			name, "median filter didn't follow a step");
+	}
+
+	// An eye following something smoothly is held back a sample by the median, but that's no spike
+	{
+		GazeSanitizer sanitizer;
+		sanitizer.set_median_filter(true);
+
+		float lag_deg = 0.0f;
+
+		for(int sample = 0; sample < 200; sample++)
+		{
+			XRGazeState gaze;
+			gaze.direction_ = gaze_vector_store(gaze_quaternion_rotate(gaze_quaternion_from_yaw_pitch(0.01f * (float)sample, 0.005f * (float)sample), gaze_vector_forward()));
+			gaze.is_valid_ = true;
+
+			lag_deg = std::max(lag_deg, get_gaze_angle_deg(sanitizer.sanitize(LEFT_CALIBRATION_INDEX, gaze, 1).direction_, gaze.direction_));
+		}
+
+		check(lag_deg > 0.0f && sanitizer.get_stats().spikes_.load() == 0, name, "a smoothly moving eye counted as spikes");
+	}
+
+	// Every gaze goes through it on the update thread
+	{
+		TestRandom random;
+		XrVector3f wander = { 0.0f, 0.0f, -1.0f };
+
+		GazeSanitizer sanitizer;
+		sanitizer.set_median_filter(true);
+
+		run_steady_state(name, TEST_ITERATIONS, [&](const int)
+		{
+			sanitizer.sanitize(COMBINED_CALIBRATION_INDEX, make_hostile_gaze(random, wander), 1);
+		});
+	}
+}
+
+void run_tests()
+{
+	run_test("sanitizer", test_sanitizer);
+}
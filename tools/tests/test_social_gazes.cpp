@@ -0,0 +1,184 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Tests of per eye social gazes, published from the same pipeline pass.
+
+#include "gaze_test.h"
+#include "gaze_broadcast.h"
+#include "gaze_telemetry.h"
+#include "gaze_update_loop.h"
+#include "psvr2_eye_tracking.h"
+#include "psvr2_server_simulator.h"
+
+#include <memory>
+
+using namespace BVR;
+
+// Where the two social gaze rays of every new sample pass closest to each other.
+class SocialGazePublisher : public GazePublisher
+{
+public:
+	void publish(const GazeUpdate& update) override
+	{
+		const GazeSocialGaze& left = update.social_gazes_[LEFT];
+		const GazeSocialGaze& right = update.social_gazes_[RIGHT];
+
+		if((update.new_samples_ == 0) || !left.gaze_.is_valid_ || !right.gaze_.is_valid_)
+		{
+			return;
+		}
+
+		// Closest points of origin + t * direction on both rays
+		const XrVector3f& d0 = left.gaze_.direction_;
+		const XrVector3f& d1 = right.gaze_.direction_;
+		const XrVector3f w = { left.origin_.x - right.origin_.x, left.origin_.y - right.origin_.y, left.origin_.z - right.origin_.z };
+
+		const float b = d0.x * d1.x + d0.y * d1.y + d0.z * d1.z;
+		const float d = d0.x * w.x + d0.y * w.y + d0.z * w.z;
+		const float e = d1.x * w.x + d1.y * w.y + d1.z * w.z;
+		const float denominator = 1.0f - b * b;
+
+		if(denominator < 1.0e-9f)
+		{
+			return; // Parallel, looking at infinity
+		}
+
+		const float t0 = (b * e - d) / denominator;
+		const float t1 = (e - b * d) / denominator;
+
+		const XrVector3f p0 = { left.origin_.x + t0 * d0.x, left.origin_.y + t0 * d0.y, left.origin_.z + t0 * d0.z };
+		const XrVector3f p1 = { right.origin_.x + t1 * d1.x, right.origin_.y + t1 * d1.y, right.origin_.z + t1 * d1.z };
+
+		const float miss = sqrtf((p0.x - p1.x) * (p0.x - p1.x) + (p0.y - p1.y) * (p0.y - p1.y) + (p0.z - p1.z) * (p0.z - p1.z));
+		const float distance = sqrtf(0.25f * ((p0.x + p1.x) * (p0.x + p1.x) + (p0.y + p1.y) * (p0.y + p1.y) + (p0.z + p1.z) * (p0.z + p1.z)));
+
+		samples_++;
+		max_miss_m_ = std::max(max_miss_m_, miss);
+		min_distance_m_ = std::min(min_distance_m_, distance);
+		max_distance_m_ = std::max(max_distance_m_, distance);
+		ipd_meters_ = update.ipd_meters_;
+	}
+
+	uint64_t samples_ = 0;
+	float max_miss_m_ = 0.0f;
+	float min_distance_m_ = std::numeric_limits<float>::max();
+	float max_distance_m_ = 0.0f;
+	float ipd_meters_ = 0.0f;
+};
+
+#ifdef _WIN32
+#define TEST_SOCIAL_SHM_NAME "Local\\PSVR2GazeTestsSocial"
+#else
+#define TEST_SOCIAL_SHM_NAME "/psvr2_gaze_tests_social"
+#endif
+
+static void test_social_gazes(const char* name)
+{
+	// Noise free synthetic eye movements verging at 0.5 to 5 m, from eyes as far apart as the origins
+	PSVR2ServerSimulatorSettings settings;
+	settings.sample_rate_hz_ = 120.0;
+	settings.synthesize_eye_movements_ = true;
+	settings.synthesizer_.noise_deg_ = 0.0f;
+	settings.synthesizer_.drift_deg_ = 0.0f;
+	settings.synthesizer_.ipd_meters_ = 0.07f;
+	PSVR2ServerSimulator simulator(settings);
+
+	PSVR2SimulatedTransport* transport = new PSVR2SimulatedTransport(simulator);
+	PSVR2EyeTracker tracker{ std::unique_ptr<PSVR2Transport>(transport) };
+	GazeUpdateLoop loop(tracker);
+	SocialGazePublisher publisher;
+
+	ShimConfig config;
+	config.adaptive_polling_ = false;
+	config.polling_rate_ms_ = 1;
+	config.per_eye_gazes_ = false;
+	config.social_gazes_ = true;
+
+	GazeTelemetryWriter telemetry;
+	check(telemetry.open(TEST_SOCIAL_SHM_NAME), name, "couldn't create the telemetry block");
+
+	int64_t now_us = 0;
+	transport->set_now_us(now_us);
+	loop.start(config, now_us);
+	loop.set_ipd_meters(0.07f);
+
+	run_steady_state(name, TEST_ITERATIONS, [&](const int)
+	{
+		now_us += 1000;
+		transport->set_now_us(now_us);
+		loop.run_once(config, now_us, publisher);
+		telemetry.record(loop, now_us);
+	});
+
+	// The setting alone turns the per eye stage on, the same fetch feeds both
+	check(tracker.is_per_eye_gazes_enabled(), name, "per eye gazes weren't computed");
+	check(publisher.samples_ > 10 && publisher.ipd_meters_ == 0.07f, name, "no social gazes published");
+	// The synthesizer pitches both eyes alike, which misses by ipd * sin(yaw) * tan(pitch) off center:
+	// 15 mm at 35 degrees of yaw (field plus vergence) and 20 degrees of pitch
+	check(publisher.max_miss_m_ < 0.016f, name, "eye rays don't meet");
+	check(publisher.min_distance_m_ > 0.4f && publisher.max_distance_m_ < 6.25f, name, "eye rays meet outside the fixation distances");
+
+	// What consumers get out of shared memory is the last update, origins included
+	{
+		const GazeUpdate& update = loop.get_last_update();
+
+		GazeTelemetryReader reader;
+		GazeTelemetrySnapshot snapshot = {};
+		check(reader.open(TEST_SOCIAL_SHM_NAME) && reader.read(snapshot), name, "couldn't read the block back");
+
+		bool is_same = snapshot.social_gazes_ && (snapshot.ipd_meters_ == 0.07f);
+
+		for(int eye = 0; eye < NUM_EYES; eye++)
+		{
+			const GazeSocialGaze& social_gaze = update.social_gazes_[eye];
+
+			is_same = is_same && (snapshot.eye_origins_[eye][0] == social_gaze.origin_.x) && (snapshot.eye_origins_[eye][0] == ((eye == LEFT) ? -0.035f : 0.035f)) &&
+				(snapshot.per_eye_gazes_valid_[eye] == social_gaze.gaze_.is_valid_) &&
+				(snapshot.per_eye_gazes_[eye][0] == social_gaze.gaze_.direction_.x) && (snapshot.per_eye_gazes_[eye][2] == social_gaze.gaze_.direction_.z);
+		}
+
+		check(is_same, name, "telemetry doesn't carry the social gazes");
+	}
+
+	// No IPD from the headset falls back to the default, turning the setting off drops them
+	loop.set_ipd_meters(0.0f);
+	now_us += 1000;
+	transport->set_now_us(now_us);
+	loop.run_once(config, now_us, publisher);
+	check(loop.get_last_update().ipd_meters_ == GAZE_DEFAULT_IPD_METERS, name, "no default IPD");
+
+	config.social_gazes_ = false;
+	config.generation_++;
+	now_us += 1000;
+	transport->set_now_us(now_us);
+	loop.run_once(config, now_us, publisher);
+	check(!tracker.is_per_eye_gazes_enabled() && !loop.get_last_update().social_gazes_[LEFT].gaze_.is_valid_ &&
+		(loop.get_last_update().ipd_meters_ == 0.0f), name, "social gazes outlived the setting");
+}
+
+void run_tests()
+{
+	run_test("social_gazes", test_social_gazes);
+}
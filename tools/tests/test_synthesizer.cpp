@@ -0,0 +1,187 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Tests of the synthetic eye movement generator.
+
+#include "gaze_test.h"
+#include "gaze_math.h"
+#include "gaze_sanitizer.h"
+#include "gaze_synthesizer.h"
+#include "psvr2_eye_tracking.h"
+#include "psvr2_server_simulator.h"
+
+#include <memory>
+
+using namespace BVR;
+
+static bool is_same_gazes(const AllXRGazeStates& a, const AllXRGazeStates& b)
+{
+	const XRGazeState* a_gazes[] = { &a.combined_gaze_, &a.per_eye_gazes_[LEFT], &a.per_eye_gazes_[RIGHT] };
+	const XRGazeState* b_gazes[] = { &b.combined_gaze_, &b.per_eye_gazes_[LEFT], &b.per_eye_gazes_[RIGHT] };
+
+	for(int index = 0; index < 3; index++)
+	{
+		if(memcmp(&a_gazes[index]->direction_, &b_gazes[index]->direction_, sizeof(XrVector3f)) != 0 || a_gazes[index]->is_valid_ != b_gazes[index]->is_valid_)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void test_synthesizer(const char* name)
+{
+	// Same seed, same stream. Another seed, another one.
+	{
+		GazeSynthesizerSettings settings;
+		settings.seed_ = 7;
+
+		GazeSynthesizer first(settings);
+		GazeSynthesizer second(settings);
+
+		settings.seed_ = 8;
+		GazeSynthesizer other(settings);
+
+		bool is_same = true;
+		bool is_other_same = true;
+
+		for(int index = 0; index < 100000; index++)
+		{
+			AllXRGazeStates a;
+			AllXRGazeStates b;
+			AllXRGazeStates c;
+			const GazeMovement a_movement = first.next(a);
+			const GazeMovement b_movement = second.next(b);
+			other.next(c);
+
+			is_same = is_same && is_same_gazes(a, b) && (a_movement == b_movement);
+			is_other_same = is_other_same && is_same_gazes(a, c);
+		}
+
+		check(is_same, name, "same seed gave different streams");
+		check(!is_other_same, name, "different seeds gave the same stream");
+	}
+
+	// A couple of hours of eye movements: every kind shows up, blinks take about as much time as the rates
+	// say, saccades are fast but never faster than an eye, so the sanitizer lets every real movement through.
+	{
+		const int num_samples = 1000000;
+		const GazeSynthesizerSettings settings;
+		const float sample_rate_hz = (float)settings.sample_rate_hz_;
+
+		GazeSynthesizer synthesizer(settings);
+		GazeSanitizer sanitizer;
+
+		uint64_t movement_counts[6] = {};
+		uint64_t non_unit = 0;
+		float max_saccade_deg_per_s = 0.0f;
+
+		AllXRGazeStates previous = {};
+		GazeMovement previous_movement = GazeMovement::BLINK_;
+
+		for(int index = 0; index < num_samples; index++)
+		{
+			AllXRGazeStates gazes;
+			const GazeMovement movement = synthesizer.next(gazes);
+			movement_counts[(int)movement]++;
+
+			non_unit += !(fabsf(gaze_vector_length3(gaze_vector_load(gazes.combined_gaze_.direction_)) - 1.0f) < 1.0e-5f);
+
+			if(movement == GazeMovement::SACCADE_ && previous_movement == GazeMovement::SACCADE_)
+			{
+				max_saccade_deg_per_s = std::max(max_saccade_deg_per_s, get_gaze_angle_deg(previous.combined_gaze_.direction_, gazes.combined_gaze_.direction_) * sample_rate_hz);
+			}
+
+			sanitizer.sanitize(COMBINED_CALIBRATION_INDEX, gazes.combined_gaze_, 1);
+			sanitizer.sanitize(LEFT_CALIBRATION_INDEX, gazes.per_eye_gazes_[LEFT], 1);
+			sanitizer.sanitize(RIGHT_CALIBRATION_INDEX, gazes.per_eye_gazes_[RIGHT], 1);
+
+			previous = gazes;
+			previous_movement = movement;
+		}
+
+		bool has_every_movement = true;
+
+		for(const uint64_t count : movement_counts)
+		{
+			has_every_movement = has_every_movement && (count > 0);
+		}
+
+		const double blink_share = (double)movement_counts[(int)GazeMovement::BLINK_] / num_samples;
+
+		check(has_every_movement, name, "some kind of eye movement never happened");
+		check(non_unit == 0, name, "synthesized a direction that isn't a unit vector");
+		check(blink_share > 0.02 && blink_share < 0.10, name, "blinks don't match their rate and duration");
+		check(max_saccade_deg_per_s > 200.0f && max_saccade_deg_per_s < GAZE_SANITIZE_MAX_DEG_PER_S, name, "saccade velocities off the main sequence");
+		check(sanitizer.get_stats().too_fast_.load() == 0, name, "sanitizer rejected a synthesized eye movement");
+	}
+
+	// The same movements end to end, served by the simulator to a tracker: a minute of polls sees both the
+	// eyes and the blinks
+	{
+		PSVR2ServerSimulatorSettings settings;
+		settings.synthesize_eye_movements_ = true;
+
+		PSVR2ServerSimulator simulator(settings);
+		PSVR2SimulatedTransport* transport = new PSVR2SimulatedTransport(simulator);
+		PSVR2EyeTracker tracker{ std::unique_ptr<PSVR2Transport>(transport) };
+		tracker.set_gazes_enabled(true, true);
+
+		transport->set_now_us(0);
+		tracker.connect();
+
+		int valid_frames = 0;
+		int invalid_frames = 0;
+
+		for(int poll = 1; poll <= 60 * 120; poll++)
+		{
+			transport->set_now_us((int64_t)poll * 8333);
+
+			if(tracker.update_gazes() && tracker.is_new_sample())
+			{
+				(tracker.get_gaze_frame().combined_gaze_.is_valid_ ? valid_frames : invalid_frames)++;
+			}
+		}
+
+		check(valid_frames > 6000 && invalid_frames > 0, name, "tracker didn't see the synthesized movements");
+	}
+
+	// The simulator synthesizes on the thread that polls it
+	{
+		GazeSynthesizer synthesizer;
+
+		run_steady_state(name, TEST_ITERATIONS, [&](const int)
+		{
+			AllXRGazeStates gazes;
+			synthesizer.next(gazes);
+		});
+	}
+}
+
+void run_tests()
+{
+	run_test("synthesizer", test_synthesizer);
+}
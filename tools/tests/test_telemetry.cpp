@@ -0,0 +1,149 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Tests of the shared memory telemetry block and its seqlock.
+
+#include "gaze_test.h"
+#include "gaze_telemetry.h"
+#include "gaze_update_loop.h"
+#include "psvr2_eye_tracking.h"
+#include "psvr2_server_simulator.h"
+
+#include <memory>
+
+using namespace BVR;
+
+#ifdef _WIN32
+#define TEST_TELEMETRY_SHM_NAME "Local\\PSVR2GazeTestsTelemetry"
+#else
+#define TEST_TELEMETRY_SHM_NAME "/psvr2_gaze_tests_telemetry"
+#endif
+
+static void test_telemetry_seqlock(const char* name)
+{
+	// The seqlock against a reader hammering it from another thread. Every snapshot the writer publishes
+	// has the same value in several places, a torn read would show them disagreeing.
+	GazeTelemetryBlock* block = new GazeTelemetryBlock();
+	GazeTelemetrySnapshot snapshot = {};
+
+	std::atomic<bool> is_reading = true;
+	std::atomic<uint64_t> reads = 0;
+	uint64_t torn_reads = 0;
+
+	std::thread reader([&]()
+	{
+		GazeTelemetrySnapshot copy;
+
+		while(is_reading.load(std::memory_order_relaxed))
+		{
+			if(read_gaze_telemetry(*block, copy))
+			{
+				reads.fetch_add(1, std::memory_order_relaxed);
+				torn_reads += (copy.published_ != copy.update_count_) || (copy.poll_duration_buckets_[GAZE_LATENCY_HISTOGRAM_BUCKETS - 1] != copy.update_count_);
+			}
+		}
+	});
+
+	// Keeps writing until the reader got its share. On a single CPU it only runs when the writer is preempted.
+	const int64_t deadline_us = get_steady_time_us() + TEST_DEADLINE_US;
+	uint64_t index = 0;
+
+	while(((index < TEST_ITERATIONS) || (reads.load(std::memory_order_relaxed) < 1000)) && (get_steady_time_us() < deadline_us))
+	{
+		index++;
+		snapshot.update_count_ = index;
+		snapshot.published_ = index;
+		snapshot.poll_duration_buckets_[GAZE_LATENCY_HISTOGRAM_BUCKETS - 1] = index;
+		write_gaze_telemetry(*block, snapshot);
+
+		if((index & 1023) == 0)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	is_reading = false;
+	reader.join();
+
+	check(reads.load() > 0, name, "reader never got a snapshot");
+	check(torn_reads == 0, name, "reader saw a torn snapshot");
+
+	delete block;
+}
+
+static void test_telemetry_record(const char* name)
+{
+	// The writer the driver runs, through real shared memory, fed by the update loop on a virtual clock
+	PSVR2ServerSimulatorSettings settings;
+	settings.sample_rate_hz_ = 120.0;
+	PSVR2ServerSimulator simulator(settings);
+
+	PSVR2SimulatedTransport* transport = new PSVR2SimulatedTransport(simulator);
+	PSVR2EyeTracker tracker{ std::unique_ptr<PSVR2Transport>(transport) };
+	GazeUpdateLoop loop(tracker);
+	RecordingPublisher publisher;
+
+	ShimConfig config;
+	config.adaptive_polling_ = false;
+	config.polling_rate_ms_ = 1;
+
+	GazeTelemetryWriter telemetry;
+	check(telemetry.open(TEST_TELEMETRY_SHM_NAME), name, "couldn't create the telemetry block");
+
+	int64_t now_us = 0;
+	transport->set_now_us(now_us);
+	loop.start(config, now_us);
+	uint64_t polls = 0;
+
+	run_steady_state(name, TEST_ITERATIONS, [&](const int)
+	{
+		now_us += 1000;
+		transport->set_now_us(now_us);
+		loop.run_once(config, now_us, publisher);
+		loop.get_loop_stats().wakeup_lateness_us_.add(now_us & 0x3f);
+		telemetry.record(loop, now_us);
+		polls++;
+	});
+
+	GazeTelemetryReader reader;
+	GazeTelemetrySnapshot snapshot = {};
+	check(reader.open(TEST_TELEMETRY_SHM_NAME) && reader.read(snapshot), name, "couldn't read the block back");
+
+	check(snapshot.update_count_ == polls && snapshot.connected_ && snapshot.connects_ == 1, name, "wrong loop state");
+	check(snapshot.published_ == tracker.get_publish_stats().published_.load() && snapshot.published_ > 0, name, "wrong sample counters");
+	check(snapshot.validity_ratio_ > 0.5f && snapshot.sample_age_us_ < 10000, name, "gaze never looked valid or fresh");
+	check(snapshot.wakeup_lateness_p99_us_ <= 0x3f && snapshot.wakeup_lateness_buckets_[0] > 0, name, "wrong lateness histogram");
+
+	// Gone for new readers once the writer closes
+	telemetry.close();
+	reader.close();
+	check(!reader.open(TEST_TELEMETRY_SHM_NAME), name, "block outlived its writer");
+}
+
+void run_tests()
+{
+	run_test("telemetry_seqlock", test_telemetry_seqlock);
+	run_test("telemetry_record", test_telemetry_record);
+}
@@ -0,0 +1,119 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Tests of the update thread's scheduling policy.
+
+#include "gaze_test.h"
+#include "gaze_thread_policy.h"
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/prctl.h>
+#endif
+
+using namespace BVR;
+
+static void test_thread_policy(const char* name)
+{
+	// On a thread of its own, so whatever goes wrong can't stick to the test thread
+	std::thread worker([&]()
+	{
+		GazeThreadPolicy policy;
+		const GazeThreadStats& stats = policy.get_stats();
+
+#ifdef __linux__
+		cpu_set_t original_cpus;
+		CPU_ZERO(&original_cpus);
+		sched_getaffinity(0, sizeof(original_cpus), &original_cpus);
+		const int original_timer_slack_ns = prctl(PR_GET_TIMERSLACK, 0, 0, 0, 0);
+#endif
+
+		GazeThreadSettings settings;
+		settings.affinity_mask_ = 1;
+		settings.high_resolution_timer_ = true;
+		policy.apply(settings);
+
+		check(stats.affinity_mask_.load() == 1, name, "affinity wasn't applied");
+		check(stats.high_resolution_timer_.load(), name, "timer resolution wasn't applied");
+
+#ifdef __linux__
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		sched_getaffinity(0, sizeof(cpus), &cpus);
+
+		check(CPU_COUNT(&cpus) == 1 && CPU_ISSET(0, &cpus), name, "thread isn't pinned to CPU 0");
+		check(prctl(PR_GET_TIMERSLACK, 0, 0, 0, 0) == 1000, name, "timer slack wasn't lowered");
+#endif
+
+		// Same settings again, nothing to do
+		const uint64_t failures = stats.apply_failures_.load();
+		policy.apply(settings);
+		check(stats.apply_failures_.load() == failures, name, "reapplying the same settings did something");
+
+		// Real-time scheduling needs privileges, without them it's a counted failure and the thread keeps going
+		settings.priority_ = GazeThreadPriority::GAMES_;
+		policy.apply(settings);
+
+		const bool is_games = stats.priority_.load() == (int)GazeThreadPriority::GAMES_;
+		check(is_games != (stats.apply_failures_.load() > failures), name, "priority neither applied nor counted as a failure");
+
+#ifdef __linux__
+		int policy_now = 0;
+		sched_param param = {};
+		pthread_getschedparam(pthread_self(), &policy_now, &param);
+		check(!is_games || (policy_now == SCHED_FIFO), name, "GAMES_ in effect without SCHED_FIFO");
+#endif
+
+		policy.revert();
+
+		check(stats.priority_.load() == (int)GazeThreadPriority::DEFAULT_ && stats.affinity_mask_.load() == 0 && !stats.high_resolution_timer_.load(), name, "revert left settings in effect");
+
+#ifdef __linux__
+		CPU_ZERO(&cpus);
+		sched_getaffinity(0, sizeof(cpus), &cpus);
+		pthread_getschedparam(pthread_self(), &policy_now, &param);
+
+		check(CPU_EQUAL(&cpus, &original_cpus), name, "affinity wasn't restored");
+		check(prctl(PR_GET_TIMERSLACK, 0, 0, 0, 0) == original_timer_slack_ns, name, "timer slack wasn't restored");
+		check(policy_now == SCHED_OTHER, name, "scheduling policy wasn't restored");
+#endif
+
+		// Every poll is bracketed
+		run_steady_state(name, TEST_ITERATIONS, [&](const int)
+		{
+			policy.begin_poll();
+			policy.end_poll(0);
+		});
+
+		check(stats.polls_.load() > 0, name, "polls weren't counted");
+	});
+
+	worker.join();
+}
+
+void run_tests()
+{
+	run_test("thread_policy", test_thread_policy);
+}
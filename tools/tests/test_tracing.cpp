@@ -0,0 +1,76 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Tests of the trace ring, its string arguments and its per-second summaries.
+
+#include "gaze_test.h"
+#include "Tracing.h"
+
+using namespace BVR;
+
+static void test_tracing(const char* name)
+{
+#if TRACE_LEVEL >= TRACE_LEVEL_LIFECYCLE
+	TraceLocalActivity(local);
+	const uint64_t traced_before = get_trace_ring().get_num_written();
+	uint64_t calls = 0;
+
+	run_steady_state(name, TEST_ITERATIONS, [&](const int index)
+	{
+		TraceLoggingWriteTagged(local, "GazeTests_Event", TLArg(index, "Index"), TLArg("text", "Text"));
+		calls++;
+	});
+
+	check(get_trace_ring().get_num_written() - traced_before == calls, name, "lost records");
+#endif
+
+#if TRACE_LEVEL >= TRACE_LEVEL_SUMMARY
+	TraceSummaryDeclare(summary);
+	int64_t now_us = 0;
+
+	run_steady_state(name, TEST_ITERATIONS, [&](const int index)
+	{
+		now_us += 1000;
+		TraceSummaryAdd(summary, index & 0xff);
+		TraceSummaryFlush(local, "GazeTests_Summary", summary, now_us);
+	});
+#endif
+
+	// Strings come as arrays (literals, fixed buffers) or pointers, only a pointer can be null
+	{
+		const char buffer[8] = "buffer";
+		const char* pointer = "pointer";
+		const char* null_pointer = nullptr;
+
+		check(strcmp(make_trace_arg(buffer).text_, "buffer") == 0, name, "char array argument");
+		check(strcmp(make_trace_arg(pointer).text_, "pointer") == 0, name, "string pointer argument");
+		check((make_trace_arg(null_pointer).type_ == TraceArgType::TEXT_) && (make_trace_arg(null_pointer).text_[0] == 0), name, "null string argument");
+	}
+}
+
+void run_tests()
+{
+	run_test("tracing", test_tracing);
+}
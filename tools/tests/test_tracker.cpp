@@ -0,0 +1,184 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Tests of receiving through PSVR2EyeTracker: the wire layout, the slot pool, deduplication and real IPC.
+
+#include "gaze_test.h"
+#include "gaze_deduplicator.h"
+#include "loopback_server.h"
+#include "psvr2_decode.h"
+#include "psvr2_eye_tracking.h"
+#include "psvr2_server_simulator.h"
+
+#include <memory>
+#include <string>
+
+using namespace BVR;
+
+static void test_tracker_simulated(const char* name)
+{
+	// A 1 kHz poll of a 120 Hz server, on a virtual clock
+	PSVR2ServerSimulatorSettings settings;
+	settings.sample_rate_hz_ = 120.0;
+	PSVR2ServerSimulator simulator(settings);
+
+	PSVR2SimulatedTransport* transport = new PSVR2SimulatedTransport(simulator);
+	PSVR2EyeTracker tracker{ std::unique_ptr<PSVR2Transport>(transport) };
+
+	int64_t now_us = 0;
+	transport->set_now_us(now_us);
+
+	const bool connected = tracker.connect();
+	check(connected, name, "handshake with the simulator failed");
+
+	if(!connected)
+	{
+		return;
+	}
+
+	uint64_t new_samples = 0;
+	uint64_t valid_gazes = 0;
+
+	run_steady_state(name, TEST_ITERATIONS, [&](const int)
+	{
+		now_us += 1000;
+		transport->set_now_us(now_us);
+
+		XrVector3f gaze;
+
+		if(tracker.update_gazes() && tracker.get_combined_gaze(gaze))
+		{
+			valid_gazes++;
+		}
+
+		new_samples += tracker.get_new_sample_count();
+	});
+
+	// Sample deltas add up to the newest sequence number, minus the first one which starts the count
+	const uint64_t expected = simulator.get_latest_sequence_number();
+	check(new_samples + 1 >= expected && new_samples <= expected, name, "lost or invented samples");
+	check(valid_gazes > 0, name, "never produced a valid gaze");
+
+	// Only the current sample may still hold a slot
+	check(tracker.get_slot_pool().get_num_free_slots() == GAZE_SLOT_POOL_SIZE - 1, name, "leaked receive slots");
+}
+
+static void test_tracker_ipc(const char* name)
+{
+	// Round trips through the kernel to a server thread, with the server producing samples much faster
+	// than we poll so most requests return something new
+	PSVR2ServerSimulatorSettings settings;
+	settings.sample_rate_hz_ = 100000.0;
+	PSVR2ServerSimulator simulator(settings);
+
+	const std::string endpoint = get_loopback_endpoint_name();
+	LoopbackServer server;
+
+	if(!server.start(endpoint.c_str(), simulator))
+	{
+		check(false, name, "couldn't start the loopback server");
+		return;
+	}
+
+	PSVR2EyeTracker tracker;
+	tracker.set_server_pipe_name(endpoint.c_str());
+
+	const bool connected = tracker.connect();
+	check(connected, name, "couldn't connect to the loopback server");
+
+	if(!connected)
+	{
+		return;
+	}
+
+	uint64_t failures = 0;
+
+	run_steady_state(name, TEST_ITERATIONS / 4, [&](const int)
+	{
+		failures += !tracker.update_gazes();
+	});
+
+	check(failures == 0, name, "round trips failed");
+
+	tracker.disconnect();
+	server.stop();
+}
+
+static void test_response_layout(const char* name)
+{
+	// A message built byte by byte the way README.md describes it, not from our own struct
+	unsigned char message[64] = {};
+	const uint32_t type = (uint32_t)GET_GAZES_OK_;
+	const uint64_t sequence_number = 0x0102030405060708ull;
+
+	memcpy(message, &type, sizeof(type));
+	memcpy(message + 56, &sequence_number, sizeof(sequence_number));
+
+	SequencedResponse response;
+	memcpy(&response, message, sizeof(message));
+
+	bool has_sequence_number = false;
+
+	check(decode_response(response, 64, GET_GAZES_OK_, has_sequence_number) == ResponseDecodeResult::OK_ && has_sequence_number, name, "64 byte message rejected");
+	check(response.sequence_number_ == sequence_number, name, "sequence number isn't at offset 56");
+	check(decode_response(response, 52, GET_GAZES_OK_, has_sequence_number) == ResponseDecodeResult::OK_ && !has_sequence_number, name, "legacy 52 byte message rejected");
+	check(decode_response(response, 60, GET_GAZES_OK_, has_sequence_number) == ResponseDecodeResult::BAD_SIZE_, name, "unpadded 60 byte message accepted");
+}
+
+static void test_deduplicator(const char* name)
+{
+	const std::vector<AllXRGazeStates> samples = make_samples();
+
+	GazeDeduplicator sequenced;
+	uint64_t fresh = 0;
+	int calls = 0;
+
+	run_steady_state(name, TEST_ITERATIONS, [&](const int index)
+	{
+		// Every sample shows up twice, like a 2x oversampling poll
+		fresh += sequenced.classify(samples[(index / 2) % TEST_NUM_SAMPLES], true, (uint64_t)(index / 2) + 1) == GazeSampleVerdict::NEW_;
+		calls++;
+	});
+
+	check(fresh == (uint64_t)(calls + 1) / 2, name, "wrong number of new samples by sequence number");
+
+	GazeDeduplicator hashed;
+	fresh = 0;
+
+	run_steady_state(name, TEST_ITERATIONS, [&](const int index)
+	{
+		fresh += hashed.classify(samples[(index / 2) % TEST_NUM_SAMPLES], false, 0) == GazeSampleVerdict::NEW_;
+	});
+
+	check(fresh > 0, name, "content hash never saw a new sample");
+}
+
+void run_tests()
+{
+	run_test("tracker_simulated", test_tracker_simulated);
+	run_test("tracker_ipc", test_tracker_ipc);
+	run_test("response_layout", test_response_layout);
+	run_test("deduplicator", test_deduplicator);
+}
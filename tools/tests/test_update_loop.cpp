@@ -0,0 +1,455 @@
+//--------------------------------------------------------------------------------------
+// Copyright (c) 2025 BattleAxeVR. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+// MIT License
+//
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Tests of the whole update loop, on a virtual clock and over real IPC.
+
+#include "gaze_test.h"
+#include "gaze_update_loop.h"
+#include "loopback_server.h"
+#include "psvr2_eye_tracking.h"
+#include "psvr2_server_simulator.h"
+
+#include <memory>
+#include <string>
+
+using namespace BVR;
+
+// Answers from a simulator, each answer one word short while is_truncating_ is set, which the tracker
+// rejects. The server behind it is alive all along.
+class TruncatingTransport final : public PSVR2Transport
+{
+public:
+	explicit TruncatingTransport(const PSVR2ServerSimulatorSettings& settings) : transport_(settings) {}
+
+	bool open(const char* endpoint) override { return transport_.open(endpoint); }
+	void close() override { transport_.close(); }
+	bool is_open() const override { return transport_.is_open(); }
+
+	bool send(const void* data, const size_t size) override { return transport_.send(data, size); }
+
+	bool receive(void* data, const size_t capacity, size_t& size_read) override
+	{
+		if(!transport_.receive(data, capacity, size_read))
+		{
+			return false;
+		}
+
+		size_read -= is_truncating_ ? sizeof(uint32_t) : 0;
+		return true;
+	}
+
+	PSVR2ExchangeFunction get_exchange_function() const override { return &exchange_messages<TruncatingTransport>; }
+
+	bool is_truncating_ = false;
+
+private:
+	PSVR2SimulatedTransport transport_;
+};
+
+static void test_update_loop_virtual_clock(const char* name)
+{
+	// One run_once per millisecond of simulated time
+	PSVR2ServerSimulatorSettings settings;
+	settings.sample_rate_hz_ = 120.0;
+	PSVR2ServerSimulator simulator(settings);
+
+	PSVR2SimulatedTransport* transport = new PSVR2SimulatedTransport(simulator);
+	PSVR2EyeTracker tracker{ std::unique_ptr<PSVR2Transport>(transport) };
+	GazeUpdateLoop loop(tracker);
+	RecordingPublisher publisher;
+
+	ShimConfig config;
+	config.adaptive_polling_ = false;
+	config.polling_rate_ms_ = 1;
+
+	int64_t now_us = 0;
+	transport->set_now_us(now_us);
+	loop.start(config, now_us);
+
+	// Settings are applied (and traced) on the first pass
+	loop.run_once(config, now_us, publisher);
+	const uint64_t traced_before = get_trace_ring().get_num_written();
+
+	run_steady_state(name, TEST_ITERATIONS, [&](const int)
+	{
+		now_us += 1000;
+		transport->set_now_us(now_us);
+		loop.run_once(config, now_us, publisher);
+	});
+
+	check(publisher.new_samples_ > 0, name, "nothing was published");
+
+	// Below TRACE_LEVEL_VERBOSE nothing in the loop traces per iteration, not even a disabled check
+	const bool traces_iterations = TRACE_LEVEL >= TRACE_LEVEL_VERBOSE;
+	check(traces_iterations || (get_trace_ring().get_num_written() == traced_before), name, "traced per iteration below TRACE_LEVEL_VERBOSE");
+}
+
+static void test_update_loop_per_eye_only(const char* name)
+{
+	// Per eye gazes only (psvr2_shim mode per_eye, or social gazes alone): the combined gaze is never valid,
+	// but someone is looking, so the loop must keep polling at full rate past the idle timeout
+	PSVR2ServerSimulatorSettings settings;
+	settings.sample_rate_hz_ = 120.0;
+	PSVR2ServerSimulator simulator(settings);
+
+	PSVR2SimulatedTransport* transport = new PSVR2SimulatedTransport(simulator);
+	PSVR2EyeTracker tracker{ std::unique_ptr<PSVR2Transport>(transport) };
+	GazeUpdateLoop loop(tracker);
+	RecordingPublisher publisher;
+
+	ShimConfig config;
+	config.combined_gaze_ = false;
+	config.per_eye_gazes_ = true;
+	config.social_gazes_ = false;
+	config.adaptive_polling_ = false;
+	config.polling_rate_ms_ = 1;
+
+	int64_t now_us = 0;
+	transport->set_now_us(now_us);
+	loop.start(config, now_us);
+
+	const int64_t end_us = 3 * (int64_t)config.idle_timeout_ms_ * 1000;
+
+	while(now_us < end_us)
+	{
+		now_us += 1000;
+		transport->set_now_us(now_us);
+		loop.run_once(config, now_us, publisher);
+	}
+
+	const GazePollScheduler& scheduler = loop.get_scheduler();
+
+	check(scheduler.get_state() == GazePowerState::ACTIVE_, name, "went idle while the per eye gazes were valid");
+	check(scheduler.get_stats().transitions_.load() == 0, name, "left the active state");
+	check(publisher.new_samples_ > 0, name, "new samples without a combined gaze weren't published");
+}
+
+static void test_update_loop_blinks(const char* name)
+{
+	// Blinking eyes on an adaptive loop: a new sample without a valid gaze is still a sample the server
+	// produced, it mustn't look like an empty poll and throw the cadence estimate off
+	PSVR2ServerSimulatorSettings settings;
+	settings.sample_rate_hz_ = 120.0;
+	settings.synthesize_eye_movements_ = true;
+	settings.synthesizer_.blink_rate_ = 2.0f;
+	settings.synthesizer_.tracking_loss_rate_ = 0.0f;
+	PSVR2ServerSimulator simulator(settings);
+
+	PSVR2SimulatedTransport* transport = new PSVR2SimulatedTransport(simulator);
+	PSVR2EyeTracker tracker{ std::unique_ptr<PSVR2Transport>(transport) };
+	GazeUpdateLoop loop(tracker);
+	RecordingPublisher publisher;
+
+	ShimConfig config;
+	config.adaptive_polling_ = true;
+
+	int64_t now_us = 0;
+	transport->set_now_us(now_us);
+	loop.start(config, now_us);
+
+	// Wakes up exactly when asked to, on a 100 us grid
+	while(now_us < 30000000)
+	{
+		now_us += 100;
+		transport->set_now_us(now_us);
+		loop.run_once(config, now_us, publisher);
+	}
+
+	const GazeCadenceStats& cadence_stats = loop.get_scheduler().get_cadence_stats();
+
+	check(loop.get_scheduler().get_cadence_estimator().is_locked(), name, "not locked on to the server cadence");
+	check(cadence_stats.lock_losses_.load() == 0, name, "blinks lost the cadence lock");
+}
+
+static void test_update_loop_settings_keep_history(const char* name)
+{
+	// New settings that leave the pipeline as it is must not switch it, that would reset the sanitizer
+	// and the median filter would start over. With a full history the filtered gaze of a sweep trails the
+	// raw one by a sample, after a reset it's the raw gaze.
+	PSVR2ServerSimulatorSettings settings;
+	settings.sample_rate_hz_ = 120.0;
+	PSVR2ServerSimulator simulator(settings);
+
+	PSVR2SimulatedTransport* transport = new PSVR2SimulatedTransport(simulator);
+	PSVR2EyeTracker tracker{ std::unique_ptr<PSVR2Transport>(transport) };
+	GazeUpdateLoop loop(tracker);
+	RecordingPublisher publisher;
+
+	ShimConfig config;
+	config.combined_gaze_ = true;
+	config.median_filter_ = true;
+	config.adaptive_polling_ = false;
+	config.polling_rate_ms_ = 1;
+
+	int64_t now_us = 0;
+	transport->set_now_us(now_us);
+	loop.start(config, now_us);
+
+	const auto poll_new_sample = [&]()
+	{
+		const uint64_t new_samples = publisher.new_samples_;
+
+		while(publisher.new_samples_ == new_samples)
+		{
+			now_us += 1000;
+			transport->set_now_us(now_us);
+			loop.run_once(config, now_us, publisher);
+		}
+	};
+
+	for(int sample = 0; sample < 4; sample++)
+	{
+		poll_new_sample();
+	}
+
+	const uint32_t pipeline_flags = tracker.get_pipeline_flags();
+
+	config.polling_rate_ms_ = 2;
+	config.generation_++;
+	poll_new_sample();
+
+	const XrVector3f& raw = tracker.get_raw_gazes().combined_gaze_.direction_;
+	const XrVector3f& filtered = tracker.get_gaze_frame().combined_gaze_.direction_;
+
+	check(tracker.get_pipeline_flags() == pipeline_flags, name, "the pipeline changed");
+	check((raw.x != filtered.x) || (raw.y != filtered.y) || (raw.z != filtered.z), name, "the sanitizer's history was reset");
+}
+
+static void test_update_loop_ipc(const char* name)
+{
+	// The same over real IPC. The first pass applies the settings and connects, which may allocate, the
+	// warmup takes care of it.
+	PSVR2ServerSimulatorSettings settings;
+	settings.sample_rate_hz_ = 100000.0;
+	PSVR2ServerSimulator simulator(settings);
+
+	const std::string endpoint = get_loopback_endpoint_name();
+	LoopbackServer server;
+	check(server.start(endpoint.c_str(), simulator), name, "couldn't start the loopback server");
+
+	PSVR2EyeTracker tracker;
+	GazeUpdateLoop loop(tracker);
+	RecordingPublisher publisher;
+
+	ShimConfig config;
+	config.adaptive_polling_ = false;
+	config.set_server_pipe_name(endpoint.c_str());
+
+	int64_t now_us = 0;
+	loop.start(config, now_us);
+
+	run_steady_state(name, TEST_ITERATIONS / 4, [&](const int)
+	{
+		now_us += 5000;
+		loop.run_once(config, now_us, publisher);
+	});
+
+	check(tracker.is_connected() && (publisher.new_samples_ > 0), name, "nothing was published");
+
+	tracker.disconnect();
+	server.stop();
+}
+
+static void test_update_loop_reconnect(const char* name)
+{
+	// The server goes away under a connected loop and comes back at the same endpoint. The loop has to
+	// notice, drop the connection, and pick the new server up without being restarted.
+	PSVR2ServerSimulatorSettings settings;
+	settings.sample_rate_hz_ = 100000.0;
+	PSVR2ServerSimulator simulator(settings);
+
+	const std::string endpoint = get_loopback_endpoint_name();
+	std::unique_ptr<LoopbackServer> server(new LoopbackServer());
+	check(server->start(endpoint.c_str(), simulator), name, "couldn't start the loopback server");
+
+	PSVR2EyeTracker tracker;
+	GazeUpdateLoop loop(tracker);
+	RecordingPublisher publisher;
+	const GazeLoopStats& stats = loop.get_loop_stats();
+
+	ShimConfig config;
+	config.adaptive_polling_ = false;
+	config.polling_rate_ms_ = 1;
+	config.set_server_pipe_name(endpoint.c_str());
+
+	// One poll per pass on the virtual clock, the server producing on the real one meanwhile
+	int64_t now_us = 0;
+	loop.start(config, now_us);
+
+	const auto poll_until = [&](const auto condition)
+	{
+		return wait_for([&]()
+		{
+			now_us += 1000;
+			loop.run_once(config, now_us, publisher);
+			return condition();
+		});
+	};
+
+	check(poll_until([&]() { return publisher.new_samples_ > 10; }), name, "nothing was published");
+	check(stats.connects_.load() == 1 && stats.disconnects_.load() == 0, name, "wrong connection count before the restart");
+
+	server->stop();
+
+	check(poll_until([&]() { return !tracker.is_connected(); }), name, "lost server never noticed");
+	check(stats.disconnects_.load() == 1 && !stats.connected_.load() && stats.receive_failures_.load() >= GAZE_MAX_RECEIVE_FAILURES, name, "lost server not counted");
+
+	// A restarted server starts over, sequence numbers included
+	simulator.reset(settings);
+	server.reset(new LoopbackServer());
+	check(server->start(endpoint.c_str(), simulator), name, "couldn't restart the loopback server");
+
+	const uint64_t new_samples = publisher.new_samples_;
+
+	check(poll_until([&]() { return publisher.new_samples_ > new_samples + 10; }), name, "nothing published after the restart");
+	check(stats.connects_.load() == 2 && stats.disconnects_.load() == 1 && stats.connected_.load(), name, "wrong connection count after the restart");
+
+	tracker.disconnect();
+	server->stop();
+}
+
+static void test_update_loop_rejected_answers(const char* name)
+{
+	// Answers that fail to decode are dropped but the server is clearly there, the connection stays up
+	// no matter how many come in a row.
+	PSVR2ServerSimulatorSettings settings;
+	settings.sample_rate_hz_ = 1000.0;
+
+	TruncatingTransport* transport = new TruncatingTransport(settings);
+	PSVR2EyeTracker tracker((std::unique_ptr<PSVR2Transport>(transport)));
+	GazeUpdateLoop loop(tracker);
+	RecordingPublisher publisher;
+	const GazeLoopStats& stats = loop.get_loop_stats();
+
+	ShimConfig config;
+	config.adaptive_polling_ = false;
+	config.polling_rate_ms_ = 1;
+
+	int64_t now_us = 0;
+	loop.start(config, now_us);
+
+	// The first poll is one period in
+	now_us += 1000;
+	loop.run_once(config, now_us, publisher);
+
+	check(tracker.is_connected(), name, "didn't connect");
+
+	transport->is_truncating_ = true;
+
+	for(int poll = 0; poll < GAZE_MAX_RECEIVE_FAILURES * 4; poll++)
+	{
+		now_us += 1000;
+		loop.run_once(config, now_us, publisher);
+	}
+
+	check(tracker.is_connected() && (stats.disconnects_.load() == 0), name, "rejected answers dropped the connection");
+	check(stats.receive_failures_.load() == GAZE_MAX_RECEIVE_FAILURES * 4, name, "rejected answers not counted as receive failures");
+	check(tracker.get_decode_stats().bad_size_.load() == GAZE_MAX_RECEIVE_FAILURES * 4, name, "rejected answers not counted as decode errors");
+
+	transport->is_truncating_ = false;
+
+	const uint64_t new_samples = publisher.new_samples_;
+
+	check(wait_for([&]()
+	{
+		now_us += 1000;
+		loop.run_once(config, now_us, publisher);
+		return publisher.new_samples_ > new_samples;
+	}), name, "nothing published once the answers were fine again");
+
+	tracker.disconnect();
+}
+
+static void test_update_loop_hung_server(const char* name)
+{
+	// A server that still takes requests but never answers. Every poll gives up after the receive
+	// timeout, and after GAZE_MAX_RECEIVE_FAILURES of those the loop drops the connection like for a
+	// server that went away.
+	PSVR2ServerSimulatorSettings settings;
+	settings.sample_rate_hz_ = 100000.0;
+	PSVR2ServerSimulator simulator(settings);
+
+	const std::string endpoint = get_loopback_endpoint_name();
+	LoopbackServer server;
+	check(server.start(endpoint.c_str(), simulator), name, "couldn't start the loopback server");
+
+	PSVR2EyeTracker tracker;
+	GazeUpdateLoop loop(tracker);
+	RecordingPublisher publisher;
+	const GazeLoopStats& stats = loop.get_loop_stats();
+
+	ShimConfig config;
+	config.adaptive_polling_ = false;
+	config.polling_rate_ms_ = 1;
+	config.set_server_pipe_name(endpoint.c_str());
+
+	int64_t now_us = 0;
+	loop.start(config, now_us);
+
+	const auto poll_until = [&](const auto condition)
+	{
+		return wait_for([&]()
+		{
+			now_us += 1000;
+			loop.run_once(config, now_us, publisher);
+			return condition();
+		});
+	};
+
+	check(poll_until([&]() { return publisher.new_samples_ > 10; }), name, "nothing was published");
+
+	server.set_hung(true);
+
+	const uint64_t receive_failures = stats.receive_failures_.load();
+	const int64_t hang_time_us = get_steady_time_us();
+
+	check(poll_until([&]() { return !tracker.is_connected(); }), name, "hung server never noticed");
+	check(stats.disconnects_.load() == 1, name, "hung server not counted as lost");
+	check(stats.receive_failures_.load() - receive_failures == GAZE_MAX_RECEIVE_FAILURES, name, "wrong number of timeouts before giving up");
+	check(get_steady_time_us() - hang_time_us >= GAZE_MAX_RECEIVE_FAILURES * PSVR2_SERVER_RECEIVE_TIMEOUT_MS * 1000, name, "gave up before the timeouts ran out");
+
+	// Once it recovers the loop connects again
+	server.set_hung(false);
+
+	const uint64_t new_samples = publisher.new_samples_;
+
+	check(poll_until([&]() { return publisher.new_samples_ > new_samples + 10; }), name, "nothing published after the server recovered");
+	check(stats.connects_.load() == 2 && stats.connected_.load(), name, "wrong connection count after the server recovered");
+
+	tracker.disconnect();
+	server.stop();
+}
+
+void run_tests()
+{
+	run_test("update_loop_virtual_clock", test_update_loop_virtual_clock);
+	run_test("update_loop_per_eye_only", test_update_loop_per_eye_only);
+	run_test("update_loop_blinks", test_update_loop_blinks);
+	run_test("update_loop_settings_keep_history", test_update_loop_settings_keep_history);
+	run_test("update_loop_ipc", test_update_loop_ipc);
+	run_test("update_loop_reconnect", test_update_loop_reconnect);
+	run_test("update_loop_rejected_answers", test_update_loop_rejected_answers);
+	run_test("update_loop_hung_server", test_update_loop_hung_server);
+}